@@ -0,0 +1,92 @@
+#include "BenchDB.h"
+#include "../KVStore.h"
+#include "../LSMTree.h"
+#include "../ShardedStore.h"
+#include <algorithm>
+
+namespace {
+
+class KVStoreBenchDB : public BenchDB {
+public:
+    explicit KVStoreBenchDB(std::unique_ptr<KVStore> store) : store_(std::move(store)) {}
+
+    std::string name() const override { return "kvstore"; }
+    bool put(const std::string& key, const std::string& value) override { return store_->put(key, value); }
+    std::optional<std::string> get(const std::string& key) override { return store_->get(key); }
+    bool remove(const std::string& key) override { return store_->remove(key); }
+    std::vector<std::pair<std::string, std::string>>
+        scan(const std::string& start_key, const std::string& end_key) override {
+        return store_->scan(start_key, end_key);
+    }
+    void flush() override { store_->flush_memtable(); }
+
+private:
+    std::unique_ptr<KVStore> store_;
+};
+
+class LSMTreeBenchDB : public BenchDB {
+public:
+    LSMTreeBenchDB(const std::string& db_dir, size_t memtable_size)
+        : tree_(db_dir, LSMTree::Config(memtable_size)) {}
+
+    std::string name() const override { return "lsm"; }
+    bool put(const std::string& key, const std::string& value) override { return tree_.put(key, value); }
+    std::optional<std::string> get(const std::string& key) override { return tree_.get(key); }
+    bool remove(const std::string& key) override { return tree_.remove(key); }
+    std::vector<std::pair<std::string, std::string>>
+        scan(const std::string& start_key, const std::string& end_key) override {
+        return tree_.scan(start_key, end_key);
+    }
+    void flush() override { tree_.flush_memtable(); }
+
+private:
+    LSMTree tree_;
+};
+
+class ShardedBenchDB : public BenchDB {
+public:
+    ShardedBenchDB(const std::string& db_dir, size_t memtable_size, size_t shards)
+        : store_(db_dir, ShardedStore::Config(shards, LSMTree::Config(memtable_size))) {}
+
+    std::string name() const override { return "sharded" + std::to_string(store_.num_shards()); }
+    bool put(const std::string& key, const std::string& value) override { return store_.put(key, value); }
+    std::optional<std::string> get(const std::string& key) override { return store_.get(key); }
+    bool remove(const std::string& key) override { return store_.remove(key); }
+    std::vector<std::pair<std::string, std::string>>
+        scan(const std::string& start_key, const std::string& end_key) override {
+        return store_.scan(start_key, end_key);
+    }
+    void flush() override { store_.flush(); }
+
+private:
+    ShardedStore store_;
+};
+
+}
+
+std::unique_ptr<BenchDB> open_bench_db(const std::string& engine, const std::string& db_dir,
+                                       size_t memtable_size) {
+    if (engine == "lsm") {
+        return std::make_unique<LSMTreeBenchDB>(db_dir, memtable_size);
+    }
+    if (engine == "kvstore") {
+        auto store = KVStore::open(db_dir, memtable_size);
+        if (!store) {
+            return nullptr;
+        }
+        return std::make_unique<KVStoreBenchDB>(std::move(store));
+    }
+    if (engine.rfind("sharded", 0) == 0) {
+        // sharded<N>, every shard gets a memtable of memtable_size
+        std::string digits = engine.substr(7);
+        size_t shards = 4;
+        if (!digits.empty()) {
+            if (digits.find_first_not_of("0123456789") != std::string::npos) {
+                return nullptr;
+            }
+            shards = std::stoul(digits);
+        }
+        return std::make_unique<ShardedBenchDB>(db_dir, memtable_size, std::max<size_t>(1, shards));
+    }
+    return nullptr;
+}
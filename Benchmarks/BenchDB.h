@@ -0,0 +1,33 @@
+#ifndef KVDB_BENCHDB_H
+#define KVDB_BENCHDB_H
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <optional>
+
+/**
+ * Thin adapter so the benchmarks drive KVStore, LSMTree and ShardedStore through the same calls
+ */
+class BenchDB {
+public:
+    virtual ~BenchDB() = default;
+
+    virtual std::string name() const = 0;
+    virtual bool put(const std::string& key, const std::string& value) = 0;
+    virtual std::optional<std::string> get(const std::string& key) = 0;
+    virtual bool remove(const std::string& key) = 0;
+    virtual std::vector<std::pair<std::string, std::string>>
+        scan(const std::string& start_key, const std::string& end_key) = 0;
+    virtual void flush() = 0;
+};
+
+/**
+ * Open an engine by name
+ * @param engine "lsm", "kvstore" or "sharded<N>" for a ShardedStore of N shards (4 if N is left out)
+ * @return nullptr if the engine name is unknown or the database failed to open
+ */
+std::unique_ptr<BenchDB> open_bench_db(const std::string& engine, const std::string& db_dir,
+                                       size_t memtable_size);
+
+#endif // KVDB_BENCHDB_H
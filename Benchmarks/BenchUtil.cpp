@@ -0,0 +1,158 @@
+#include "BenchUtil.h"
+#include <iostream>
+#include <iomanip>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <algorithm>
+#include <cstdio>
+
+bool BenchFlags::parse(int argc, char* argv[]) {
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg.rfind("--", 0) != 0) {
+            std::cerr << "Unexpected argument: " << arg << std::endl;
+            return false;
+        }
+
+        auto equals = arg.find('=');
+        if (equals == std::string::npos) {
+            values_[arg.substr(2)] = "1";  // bare --flag means true
+        } else {
+            values_[arg.substr(2, equals - 2)] = arg.substr(equals + 1);
+        }
+    }
+    return true;
+}
+
+std::string BenchFlags::get_string(const std::string& name, const std::string& default_value) const {
+    auto it = values_.find(name);
+    return it != values_.end() ? it->second : default_value;
+}
+
+int64_t BenchFlags::get_int(const std::string& name, int64_t default_value) const {
+    auto it = values_.find(name);
+    if (it == values_.end()) {
+        return default_value;
+    }
+    try {
+        return std::stoll(it->second);
+    } catch (const std::exception&) {
+        std::cerr << "Invalid value for --" << name << ": " << it->second << std::endl;
+        return default_value;
+    }
+}
+
+double BenchFlags::get_double(const std::string& name, double default_value) const {
+    auto it = values_.find(name);
+    if (it == values_.end()) {
+        return default_value;
+    }
+    try {
+        return std::stod(it->second);
+    } catch (const std::exception&) {
+        std::cerr << "Invalid value for --" << name << ": " << it->second << std::endl;
+        return default_value;
+    }
+}
+
+std::string make_bench_key(uint64_t index, size_t key_size) {
+    char digits[32];
+    int length = std::snprintf(digits, sizeof(digits), "%020llu", static_cast<unsigned long long>(index));
+
+    // Keep the low digits when the key is shorter, pad with zeros when it's longer
+    if (key_size <= static_cast<size_t>(length)) {
+        return std::string(digits + length - key_size, key_size);
+    }
+    return std::string(key_size - length, '0') + digits;
+}
+
+ValueGenerator::ValueGenerator(uint64_t seed) {
+    std::mt19937_64 rng(seed);
+    std::uniform_int_distribution<int> printable(' ', '~');
+    data_.resize(1024 * 1024);
+    for (auto& c : data_) {
+        c = static_cast<char>(printable(rng));
+    }
+}
+
+std::string ValueGenerator::next(size_t length) {
+    if (length > data_.size()) {
+        length = data_.size();
+    }
+    if (position_ + length > data_.size()) {
+        position_ = 0;
+    }
+    std::string value = data_.substr(position_, length);
+    position_ += length;
+    return value;
+}
+
+bool BenchThread::done(uint64_t planned, std::chrono::steady_clock::time_point deadline) const {
+    if (deadline != std::chrono::steady_clock::time_point()) {
+        // Checking the clock every op would show up in the latencies
+        return (ops % 64 == 0) && std::chrono::steady_clock::now() >= deadline;
+    }
+    return ops >= planned;
+}
+
+BenchResult run_bench_threads(int threads, uint64_t seed, const std::function<void(BenchThread&)>& body) {
+    threads = std::max(threads, 1);
+
+    std::vector<std::unique_ptr<BenchThread>> states;
+    for (int i = 0; i < threads; i++) {
+        states.push_back(std::make_unique<BenchThread>(i, seed + static_cast<uint64_t>(i) * 1000003));
+    }
+
+    // Hold every thread at the gate so they start together
+    std::mutex gate_mutex;
+    std::condition_variable gate;
+    bool open = false;
+
+    std::vector<std::thread> workers;
+    for (auto& state : states) {
+        workers.emplace_back([&, thread = state.get()] {
+            {
+                std::unique_lock<std::mutex> lock(gate_mutex);
+                gate.wait(lock, [&] { return open; });
+            }
+            body(*thread);
+        });
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    {
+        std::lock_guard<std::mutex> lock(gate_mutex);
+        open = true;
+    }
+    gate.notify_all();
+
+    for (auto& worker : workers) {
+        worker.join();
+    }
+
+    BenchResult result;
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    for (const auto& state : states) {
+        result.latency.merge(state->latency);
+        result.ops += state->ops;
+        result.bytes += state->bytes;
+        result.found += state->found;
+    }
+    return result;
+}
+
+void print_bench_result(const std::string& name, const BenchResult& result) {
+    // Very short runs can finish inside one clock tick
+    double seconds = std::max(result.seconds, 1e-9);
+    double ops = static_cast<double>(result.ops);
+
+    std::cout << std::left << std::setw(18) << name << ": " << std::right << std::fixed
+              << std::setprecision(3) << std::setw(10) << (ops > 0 ? seconds * 1e6 / ops : 0.0) << " micros/op "
+              << std::setprecision(0) << std::setw(10) << ops / seconds << " ops/sec "
+              << std::setprecision(1) << std::setw(8) << result.bytes / seconds / (1024.0 * 1024.0) << " MB/s";
+    if (result.found != result.ops) {
+        std::cout << " (" << result.found << " of " << result.ops << " found)";
+    }
+    std::cout << "\n    latency (us): " << result.latency.summary() << std::endl;
+}
@@ -0,0 +1,100 @@
+#ifndef KVDB_BENCHUTIL_H
+#define KVDB_BENCHUTIL_H
+
+#include "../Histogram.h"
+#include <string>
+#include <map>
+#include <random>
+#include <chrono>
+#include <functional>
+#include <cstdint>
+
+/**
+ * Command line flags of the form --name=value
+ */
+class BenchFlags {
+public:
+    /**
+     * @return false if an argument isn't a --name=value flag
+     */
+    bool parse(int argc, char* argv[]);
+
+    bool has(const std::string& name) const { return values_.count(name) > 0; }
+    std::string get_string(const std::string& name, const std::string& default_value) const;
+    int64_t get_int(const std::string& name, int64_t default_value) const;
+    double get_double(const std::string& name, double default_value) const;
+
+private:
+    std::map<std::string, std::string> values_;
+};
+
+/**
+ * Fixed width key for an index, zero padded so keys sort in index order
+ */
+std::string make_bench_key(uint64_t index, size_t key_size);
+
+/**
+ * Hands out values cut from a 1 MB block of random bytes, so data is produced on the fly
+ * without holding the whole data set in memory
+ */
+class ValueGenerator {
+public:
+    explicit ValueGenerator(uint64_t seed);
+
+    std::string next(size_t length);
+
+private:
+    std::string data_;
+    size_t position_ = 0;
+};
+
+/**
+ * Per thread state of a benchmark run. Every thread records into its own histogram,
+ * they're merged when the run ends
+ */
+struct BenchThread {
+    int id = 0;
+    std::mt19937_64 rng;
+    ValueGenerator values;
+    Histogram latency;  // nanoseconds per operation
+    uint64_t ops = 0;
+    uint64_t bytes = 0;
+    uint64_t found = 0;
+
+    BenchThread(int id_, uint64_t seed)
+        : id(id_), rng(seed), values(seed ^ 0x9e3779b97f4a7c15ULL) {}
+
+    /**
+     * Whether the thread is done, after planned ops or once the deadline passes
+     * @param deadline Zero time point when the run is bounded by op count only
+     */
+    bool done(uint64_t planned, std::chrono::steady_clock::time_point deadline) const;
+};
+
+struct BenchResult {
+    Histogram latency;
+    uint64_t ops = 0;
+    uint64_t bytes = 0;
+    uint64_t found = 0;
+    double seconds = 0.0;
+};
+
+/**
+ * Run body on the given number of threads, all released together, and merge their stats
+ */
+BenchResult run_bench_threads(int threads, uint64_t seed, const std::function<void(BenchThread&)>& body);
+
+/**
+ * Print a db_bench style line: micros/op, ops/sec, MB/s and latency percentiles
+ */
+void print_bench_result(const std::string& name, const BenchResult& result);
+
+/**
+ * Nanoseconds elapsed since start
+ */
+inline uint64_t elapsed_ns(std::chrono::steady_clock::time_point start) {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - start).count());
+}
+
+#endif // KVDB_BENCHUTIL_H
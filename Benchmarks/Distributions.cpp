@@ -0,0 +1,69 @@
+#include "Distributions.h"
+#include <cmath>
+#include <algorithm>
+
+namespace {
+    double zeta_range(uint64_t from, uint64_t to, double theta) {
+        double sum = 0.0;
+        for (uint64_t i = from; i < to; i++) {
+            sum += 1.0 / std::pow(static_cast<double>(i + 1), theta);
+        }
+        return sum;
+    }
+}
+
+ZipfianGenerator::ZipfianGenerator(uint64_t item_count, double theta)
+    : item_count_(std::max<uint64_t>(item_count, 1)),
+      theta_(theta),
+      alpha_(1.0 / (1.0 - theta)),
+      zeta2_(zeta_range(0, 2, theta)),
+      zetan_(zeta_range(0, item_count_, theta)) {
+    eta_ = (1.0 - std::pow(2.0 / static_cast<double>(item_count_), 1.0 - theta_)) / (1.0 - zeta2_ / zetan_);
+}
+
+void ZipfianGenerator::extend_to(uint64_t item_count) {
+    // Only ever grows, recomputing from scratch for every insert would be quadratic
+    zetan_ += zeta_range(item_count_, item_count, theta_);
+    item_count_ = item_count;
+    eta_ = (1.0 - std::pow(2.0 / static_cast<double>(item_count_), 1.0 - theta_)) / (1.0 - zeta2_ / zetan_);
+}
+
+uint64_t ZipfianGenerator::next(std::mt19937_64& rng, uint64_t item_count) {
+    if (item_count > item_count_) {
+        extend_to(item_count);
+    }
+
+    double u = std::uniform_real_distribution<double>(0.0, 1.0)(rng);
+    double uz = u * zetan_;
+
+    if (uz < 1.0) {
+        return 0;
+    }
+    if (uz < 1.0 + std::pow(0.5, theta_)) {
+        return 1;
+    }
+
+    auto item = static_cast<uint64_t>(static_cast<double>(item_count_) * std::pow(eta_ * u - eta_ + 1.0, alpha_));
+    return std::min(item, item_count_ - 1);
+}
+
+uint64_t fnv_hash64(uint64_t value) {
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    for (int i = 0; i < 8; i++) {
+        hash ^= value & 0xff;
+        hash *= 0x100000001b3ULL;
+        value >>= 8;
+    }
+    return hash;
+}
+
+uint64_t ScrambledZipfianGenerator::next(std::mt19937_64& rng) {
+    return fnv_hash64(zipfian_.next(rng)) % item_count_;
+}
+
+uint64_t LatestGenerator::next(std::mt19937_64& rng, uint64_t item_count) {
+    if (item_count == 0) {
+        return 0;
+    }
+    return item_count - 1 - zipfian_.next(rng, item_count);
+}
@@ -0,0 +1,74 @@
+#ifndef KVDB_DISTRIBUTIONS_H
+#define KVDB_DISTRIBUTIONS_H
+
+#include <cstdint>
+#include <random>
+
+/**
+ * Key choosers for the YCSB workloads, following the generators in YCSB's core package.
+ * Each returns an item number in [0, item_count). Generators are cheap to copy once built,
+ * so a run builds one and hands every thread its own copy.
+ */
+
+/**
+ * Zipfian over [0, item_count) where item 0 is the most popular, Gray et al.'s
+ * "Quickly generating billion-record synthetic databases". theta near 1 is more skewed.
+ * The item count can grow between calls, zeta is extended incrementally when it does.
+ */
+class ZipfianGenerator {
+public:
+    ZipfianGenerator(uint64_t item_count, double theta = 0.99);
+
+    uint64_t next(std::mt19937_64& rng, uint64_t item_count);
+    uint64_t next(std::mt19937_64& rng) { return next(rng, item_count_); }
+
+    double theta() const { return theta_; }
+
+private:
+    uint64_t item_count_;
+    double theta_;
+    double alpha_;
+    double zeta2_;
+    double zetan_;
+    double eta_;
+
+    void extend_to(uint64_t item_count);
+};
+
+/**
+ * Zipfian popularity spread over the key space, so the hot items aren't all adjacent
+ */
+class ScrambledZipfianGenerator {
+public:
+    ScrambledZipfianGenerator(uint64_t item_count, double theta = 0.99)
+        : item_count_(item_count), zipfian_(item_count, theta) {}
+
+    uint64_t next(std::mt19937_64& rng);
+
+private:
+    uint64_t item_count_;
+    ZipfianGenerator zipfian_;
+};
+
+/**
+ * Skewed towards the most recently inserted items
+ */
+class LatestGenerator {
+public:
+    LatestGenerator(uint64_t item_count, double theta = 0.99) : zipfian_(item_count, theta) {}
+
+    /**
+     * @param item_count Items inserted so far, the newest is item_count - 1
+     */
+    uint64_t next(std::mt19937_64& rng, uint64_t item_count);
+
+private:
+    ZipfianGenerator zipfian_;
+};
+
+/**
+ * 64-bit FNV-1a of an item number, used to scramble item order
+ */
+uint64_t fnv_hash64(uint64_t value);
+
+#endif // KVDB_DISTRIBUTIONS_H
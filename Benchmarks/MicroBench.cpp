@@ -0,0 +1,175 @@
+#include "MicroBench.h"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <ctime>
+
+namespace {
+    // Swallows the engine's progress output while a benchmark runs
+    class NullBuffer : public std::streambuf {
+    protected:
+        int overflow(int c) override { return c; }
+    };
+}
+
+void MicroState::pause_timing() {
+    if (running_) {
+        elapsed_ns_ += static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - start_).count());
+        running_ = false;
+    }
+}
+
+void MicroState::resume_timing() {
+    if (!running_) {
+        running_ = true;
+        start_ = std::chrono::steady_clock::now();
+    }
+}
+
+void MicroState::stop_timing() {
+    pause_timing();
+}
+
+void MicroBenchRunner::add(const std::string& name, std::function<void(MicroState&)> body) {
+    benchmarks_.emplace_back(name, std::move(body));
+}
+
+MicroResult MicroBenchRunner::run_one(const std::string& name, const std::function<void(MicroState&)>& body) const {
+    auto timed_run = [&](uint64_t iterations) {
+        MicroState state(iterations);
+        body(state);
+        return state.elapsed_ns();
+    };
+
+    // Grow the iteration count until one run takes min_time
+    uint64_t min_ns = static_cast<uint64_t>(options_.min_time * 1e9);
+    uint64_t iterations = 1;
+    while (true) {
+        uint64_t ns = timed_run(iterations);
+        if (ns >= min_ns || iterations >= (uint64_t{1} << 40)) {
+            break;
+        }
+        // Aim a bit past the target, at most 10x at a time since early runs are noisy
+        double scale = ns > 0 ? 1.4 * static_cast<double>(min_ns) / static_cast<double>(ns) : 10.0;
+        iterations = std::max(iterations + 1, static_cast<uint64_t>(static_cast<double>(iterations) * std::min(scale, 10.0)));
+    }
+
+    for (int i = 0; i < options_.warmup; i++) {
+        timed_run(iterations);
+    }
+
+    MicroResult result;
+    result.name = name;
+    result.iterations = iterations;
+    uint64_t bytes_per_iteration = 0;
+    for (int i = 0; i < std::max(options_.repetitions, 1); i++) {
+        MicroState state(iterations);
+        body(state);
+        bytes_per_iteration = state.bytes_per_iteration();
+        result.ns_per_op.push_back(static_cast<double>(state.elapsed_ns()) / static_cast<double>(iterations));
+    }
+
+    std::vector<double> sorted = result.ns_per_op;
+    std::sort(sorted.begin(), sorted.end());
+    double sum = 0.0;
+    for (double ns : sorted) {
+        sum += ns;
+    }
+    result.mean = sum / static_cast<double>(sorted.size());
+    result.median = sorted.size() % 2 ? sorted[sorted.size() / 2]
+                                      : (sorted[sorted.size() / 2 - 1] + sorted[sorted.size() / 2]) / 2.0;
+    double variance = 0.0;
+    for (double ns : sorted) {
+        variance += (ns - result.mean) * (ns - result.mean);
+    }
+    result.stddev = sorted.size() > 1 ? std::sqrt(variance / static_cast<double>(sorted.size() - 1)) : 0.0;
+    result.min = sorted.front();
+    result.max = sorted.back();
+    if (bytes_per_iteration > 0 && result.median > 0) {
+        result.bytes_per_second = static_cast<double>(bytes_per_iteration) * 1e9 / result.median;
+    }
+
+    return result;
+}
+
+std::vector<MicroResult> MicroBenchRunner::run() {
+    std::vector<MicroResult> results;
+
+    std::cout << std::left << std::setw(36) << "Benchmark" << std::right
+              << std::setw(14) << "median ns" << std::setw(14) << "mean ns"
+              << std::setw(10) << "cv %" << std::setw(14) << "iterations" << std::setw(12) << "MB/s" << std::endl;
+
+    for (const auto& [name, body] : benchmarks_) {
+        if (!options_.filter.empty() && name.find(options_.filter) == std::string::npos) {
+            continue;
+        }
+
+        NullBuffer discard;
+        std::streambuf* console = std::cout.rdbuf(&discard);
+        MicroResult result = run_one(name, body);
+        std::cout.rdbuf(console);
+        double cv = result.mean > 0 ? 100.0 * result.stddev / result.mean : 0.0;
+
+        std::cout << std::left << std::setw(36) << name << std::right << std::fixed
+                  << std::setprecision(1) << std::setw(14) << result.median << std::setw(14) << result.mean
+                  << std::setw(10) << cv << std::setw(14) << result.iterations << std::setw(12);
+        if (result.bytes_per_second > 0) {
+            std::cout << result.bytes_per_second / (1024.0 * 1024.0);
+        } else {
+            std::cout << "-";
+        }
+        std::cout << std::endl;
+
+        results.push_back(std::move(result));
+    }
+
+    return results;
+}
+
+std::string MicroBenchRunner::to_json(const std::vector<MicroResult>& results, const MicroOptions& options) {
+    std::ostringstream out;
+    out << std::setprecision(6) << std::fixed;
+
+    std::time_t now = std::time(nullptr);
+    char date[32];
+    std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%SZ", std::gmtime(&now));
+
+    out << "{\n  \"context\": {\n"
+        << "    \"date\": \"" << date << "\",\n"
+#ifdef NDEBUG
+        << "    \"build_type\": \"release\",\n"
+#else
+        << "    \"build_type\": \"debug\",\n"
+#endif
+#ifdef __VERSION__
+        << "    \"compiler\": \"" << __VERSION__ << "\",\n"
+#endif
+        << "    \"min_time\": " << options.min_time << ",\n"
+        << "    \"warmup\": " << options.warmup << ",\n"
+        << "    \"repetitions\": " << options.repetitions << "\n"
+        << "  },\n  \"benchmarks\": [";
+
+    for (size_t i = 0; i < results.size(); i++) {
+        const auto& result = results[i];
+        out << (i ? "," : "") << "\n    {\n"
+            << "      \"name\": \"" << result.name << "\",\n"
+            << "      \"iterations\": " << result.iterations << ",\n"
+            << "      \"median_ns\": " << result.median << ",\n"
+            << "      \"mean_ns\": " << result.mean << ",\n"
+            << "      \"stddev_ns\": " << result.stddev << ",\n"
+            << "      \"min_ns\": " << result.min << ",\n"
+            << "      \"max_ns\": " << result.max << ",\n"
+            << "      \"bytes_per_second\": " << result.bytes_per_second << ",\n"
+            << "      \"repetitions_ns\": [";
+        for (size_t j = 0; j < result.ns_per_op.size(); j++) {
+            out << (j ? ", " : "") << result.ns_per_op[j];
+        }
+        out << "]\n    }";
+    }
+    out << "\n  ]\n}\n";
+
+    return out.str();
+}
@@ -0,0 +1,129 @@
+#ifndef KVDB_MICROBENCH_H
+#define KVDB_MICROBENCH_H
+
+#include <string>
+#include <vector>
+#include <functional>
+#include <chrono>
+#include <cstdint>
+#include <atomic>
+
+/**
+ * Minimal microbenchmark harness, no external dependencies.
+ *
+ * A benchmark body loops while keep_running() returns true and does one operation per
+ * iteration. The harness picks the iteration count so a run lasts at least min_time,
+ * does warmup runs that are thrown away, then times several repetitions and reports the
+ * mean, median, spread and minimum of nanoseconds per operation.
+ */
+
+/**
+ * Keep the compiler from optimising a value, or the work producing it, away
+ */
+template <typename T>
+inline void do_not_optimize(const T& value) {
+#if defined(__GNUC__) || defined(__clang__)
+    asm volatile("" : : "m"(value) : "memory");
+#else
+    std::atomic_signal_fence(std::memory_order_seq_cst);
+    static_cast<void>(value);
+#endif
+}
+
+/**
+ * Force pending memory writes to be treated as observable
+ */
+inline void clobber_memory() {
+#if defined(__GNUC__) || defined(__clang__)
+    asm volatile("" : : : "memory");
+#else
+    std::atomic_signal_fence(std::memory_order_seq_cst);
+#endif
+}
+
+class MicroState {
+public:
+    explicit MicroState(uint64_t iterations) : iterations_(iterations) {}
+
+    /**
+     * Call once per iteration, the clock starts on the first call and stops on the last
+     */
+    bool keep_running() {
+        if (done_ == 0 && !started_) {
+            started_ = true;
+            start_ = std::chrono::steady_clock::now();
+        }
+        if (done_ < iterations_) {
+            done_++;
+            return true;
+        }
+        stop_timing();
+        return false;
+    }
+
+    // Exclude per iteration setup from the timing
+    void pause_timing();
+    void resume_timing();
+
+    uint64_t iterations() const { return iterations_; }
+    uint64_t elapsed_ns() const { return elapsed_ns_; }
+
+    // Optional throughput, per iteration
+    void set_bytes_per_iteration(uint64_t bytes) { bytes_per_iteration_ = bytes; }
+    uint64_t bytes_per_iteration() const { return bytes_per_iteration_; }
+
+private:
+    uint64_t iterations_;
+    uint64_t done_ = 0;
+    bool started_ = false;
+    bool running_ = true;
+    std::chrono::steady_clock::time_point start_;
+    uint64_t elapsed_ns_ = 0;
+    uint64_t bytes_per_iteration_ = 0;
+
+    void stop_timing();
+};
+
+struct MicroResult {
+    std::string name;
+    uint64_t iterations = 0;  // per repetition
+    std::vector<double> ns_per_op;  // one per repetition
+    double mean = 0.0;
+    double median = 0.0;
+    double stddev = 0.0;
+    double min = 0.0;
+    double max = 0.0;
+    double bytes_per_second = 0.0;
+};
+
+struct MicroOptions {
+    double min_time = 0.1;  // seconds per repetition
+    int warmup = 1;
+    int repetitions = 5;
+    std::string filter;     // only run benchmarks whose name contains this
+};
+
+class MicroBenchRunner {
+public:
+    explicit MicroBenchRunner(const MicroOptions& options) : options_(options) {}
+
+    void add(const std::string& name, std::function<void(MicroState&)> body);
+
+    /**
+     * Run every registered benchmark that passes the filter, printing a table as they go
+     */
+    std::vector<MicroResult> run();
+
+    /**
+     * Results as JSON, to diff between builds
+     */
+    static std::string to_json(const std::vector<MicroResult>& results, const MicroOptions& options);
+
+private:
+    MicroOptions options_;
+    std::vector<std::pair<std::string, std::function<void(MicroState&)>>> benchmarks_;
+
+    MicroResult run_one(const std::string& name, const std::function<void(MicroState&)>& body) const;
+};
+
+#endif // KVDB_MICROBENCH_H
@@ -0,0 +1,363 @@
+// db_bench style workloads against KVStore and LSMTree
+//
+//   kvdb_bench --engine=lsm,kvstore --benchmarks=fillseq,readrandom --num=100000
+//              --key_size=16 --value_size=100 --threads=4 --duration=10
+//
+// Keys are zero padded indexes in [0, num), values are generated on the fly. fill* workloads
+// start from an empty database, the rest run against what the previous workloads left.
+
+#include "BenchDB.h"
+#include "BenchUtil.h"
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <filesystem>
+#include <thread>
+#include <atomic>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+struct BenchConfig {
+    std::vector<std::string> engines;
+    std::vector<std::string> benchmarks;
+    uint64_t num;
+    uint64_t reads;
+    size_t key_size;
+    size_t value_size;
+    int threads;
+    double duration;     // seconds per workload, 0 runs num (or reads) operations instead
+    uint64_t seek_nexts; // keys returned by each seekrandom scan
+    size_t memtable_size;
+    std::string db;
+    uint64_t seed;
+};
+
+std::vector<std::string> split(const std::string& list) {
+    std::vector<std::string> items;
+    std::istringstream in(list);
+    std::string item;
+    while (std::getline(in, item, ',')) {
+        if (!item.empty()) {
+            items.push_back(item);
+        }
+    }
+    return items;
+}
+
+void print_usage() {
+    std::cout << "Usage: kvdb_bench [--name=value ...]\n"
+              << "  --engine=lsm,kvstore       engines to run, in order, sharded<N> for N shards\n"
+              << "  --benchmarks=LIST          fillseq, fillrandom, overwrite, readrandom, readseq,\n"
+              << "                             seekrandom, deleterandom, readwhilewriting,\n"
+              << "                             readscaling (readrandom on 1, 2, 4 .. threads)\n"
+              << "  --num=100000               keys in the key space\n"
+              << "  --reads=-1                 operations per read workload, -1 uses num\n"
+              << "  --key_size=16 --value_size=100\n"
+              << "  --threads=1                client threads\n"
+              << "  --duration=0               seconds per workload, 0 runs a fixed op count\n"
+              << "  --seek_nexts=10            keys read by each seekrandom scan\n"
+              << "  --memtable_size=1048576\n"
+              << "  --db=kvdb_bench_db         directory prefix, one per engine\n"
+              << "  --seed=301\n";
+}
+
+class BenchRunner {
+public:
+    BenchRunner(const BenchConfig& config, const std::string& engine)
+        : config_(config), engine_(engine), db_dir_(config.db + "_" + engine) {}
+
+    bool run(const std::string& benchmark) {
+        // Writes start from an empty database so results don't depend on the workload order
+        bool fresh = benchmark == "fillseq" || benchmark == "fillrandom";
+        if (fresh || !db_) {
+            if (!open(fresh || !db_)) {
+                return false;
+            }
+        }
+
+        BenchResult result;
+        if (benchmark == "fillseq") {
+            result = write(false);
+        } else if (benchmark == "fillrandom" || benchmark == "overwrite") {
+            result = write(true);
+        } else if (benchmark == "readrandom") {
+            result = read_random();
+        } else if (benchmark == "readseq") {
+            result = read_seq();
+        } else if (benchmark == "seekrandom") {
+            result = seek_random();
+        } else if (benchmark == "deleterandom") {
+            result = delete_random();
+        } else if (benchmark == "readwhilewriting") {
+            result = read_while_writing();
+        } else if (benchmark == "readscaling") {
+            read_scaling();
+            return true;
+        } else {
+            std::cerr << "Unknown benchmark: " << benchmark << std::endl;
+            return false;
+        }
+
+        print_bench_result(benchmark, result);
+        return true;
+    }
+
+    void close() {
+        db_.reset();
+        fs::remove_all(db_dir_);
+    }
+
+private:
+    const BenchConfig& config_;
+    std::string engine_;
+    std::string db_dir_;
+    std::unique_ptr<BenchDB> db_;
+
+    bool open(bool destroy) {
+        db_.reset();
+        if (destroy) {
+            fs::remove_all(db_dir_);
+        }
+        db_ = open_bench_db(engine_, db_dir_, config_.memtable_size);
+        if (!db_) {
+            std::cerr << "Failed to open " << engine_ << " database at " << db_dir_ << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+    std::chrono::steady_clock::time_point deadline() const {
+        if (config_.duration <= 0) {
+            return {};
+        }
+        return std::chrono::steady_clock::now() +
+               std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                   std::chrono::duration<double>(config_.duration));
+    }
+
+    uint64_t per_thread(uint64_t total, int threads) const {
+        return std::max<uint64_t>(1, total / static_cast<uint64_t>(std::max(threads, 1)));
+    }
+
+    uint64_t per_thread(uint64_t total) const {
+        return per_thread(total, config_.threads);
+    }
+
+    uint64_t random_key(BenchThread& thread) const {
+        return thread.rng() % config_.num;
+    }
+
+    BenchResult write(bool random) {
+        uint64_t planned = per_thread(config_.num);
+        auto until = deadline();
+
+        return run_bench_threads(config_.threads, config_.seed, [&](BenchThread& thread) {
+            uint64_t first = static_cast<uint64_t>(thread.id) * planned;
+            while (!thread.done(planned, until)) {
+                uint64_t index = random ? random_key(thread) : (first + thread.ops % planned) % config_.num;
+                std::string key = make_bench_key(index, config_.key_size);
+                std::string value = thread.values.next(config_.value_size);
+
+                auto start = std::chrono::steady_clock::now();
+                bool ok = db_->put(key, value);
+                thread.latency.add(elapsed_ns(start));
+
+                thread.ops++;
+                thread.found += ok;
+                thread.bytes += key.size() + value.size();
+            }
+        });
+    }
+
+    BenchResult read_random() {
+        return read_random(config_.threads);
+    }
+
+    BenchResult read_random(int threads) {
+        uint64_t planned = per_thread(config_.reads, threads);
+        auto until = deadline();
+
+        return run_bench_threads(threads, config_.seed, [&](BenchThread& thread) {
+            while (!thread.done(planned, until)) {
+                std::string key = make_bench_key(random_key(thread), config_.key_size);
+
+                auto start = std::chrono::steady_clock::now();
+                auto value = db_->get(key);
+                thread.latency.add(elapsed_ns(start));
+
+                thread.ops++;
+                if (value) {
+                    thread.found++;
+                    thread.bytes += key.size() + value->size();
+                }
+            }
+        });
+    }
+
+    // Each thread walks the whole key space in scans of 100 keys, every key read counts as
+    // one op, latency is per scan
+    BenchResult read_seq() {
+        const uint64_t chunk = 100;
+        auto until = deadline();
+
+        return run_bench_threads(config_.threads, config_.seed, [&](BenchThread& thread) {
+            uint64_t reads = 0;
+            for (uint64_t first = 0; first < config_.num; first += chunk) {
+                if (until != std::chrono::steady_clock::time_point() && std::chrono::steady_clock::now() >= until) {
+                    break;
+                }
+                uint64_t last = std::min(first + chunk, config_.num) - 1;
+
+                auto start = std::chrono::steady_clock::now();
+                auto entries = db_->scan(make_bench_key(first, config_.key_size), make_bench_key(last, config_.key_size));
+                thread.latency.add(elapsed_ns(start));
+
+                reads += last - first + 1;
+                for (const auto& [key, value] : entries) {
+                    thread.bytes += key.size() + value.size();
+                }
+                thread.found += entries.size();
+            }
+            thread.ops = reads;
+        });
+    }
+
+    BenchResult seek_random() {
+        uint64_t planned = per_thread(config_.reads);
+        auto until = deadline();
+
+        return run_bench_threads(config_.threads, config_.seed, [&](BenchThread& thread) {
+            while (!thread.done(planned, until)) {
+                uint64_t first = random_key(thread);
+                uint64_t last = std::min(first + config_.seek_nexts, config_.num) - 1;
+
+                auto start = std::chrono::steady_clock::now();
+                auto entries = db_->scan(make_bench_key(first, config_.key_size), make_bench_key(last, config_.key_size));
+                thread.latency.add(elapsed_ns(start));
+
+                thread.ops++;
+                if (!entries.empty()) {
+                    thread.found++;
+                }
+                for (const auto& [key, value] : entries) {
+                    thread.bytes += key.size() + value.size();
+                }
+            }
+        });
+    }
+
+    BenchResult delete_random() {
+        uint64_t planned = per_thread(config_.num);
+        auto until = deadline();
+
+        return run_bench_threads(config_.threads, config_.seed, [&](BenchThread& thread) {
+            while (!thread.done(planned, until)) {
+                std::string key = make_bench_key(random_key(thread), config_.key_size);
+
+                auto start = std::chrono::steady_clock::now();
+                bool ok = db_->remove(key);
+                thread.latency.add(elapsed_ns(start));
+
+                thread.ops++;
+                thread.found += ok;
+                thread.bytes += key.size();
+            }
+        });
+    }
+
+    // Readers as in readrandom, plus one extra thread overwriting random keys until they finish.
+    // Only the readers are reported, the writer's rate is printed alongside
+    BenchResult read_while_writing() {
+        std::atomic<bool> stop{false};
+        std::atomic<uint64_t> writes{0};
+
+        std::thread writer([&] {
+            BenchThread thread(-1, config_.seed ^ 0xabcdef);
+            while (!stop.load(std::memory_order_relaxed)) {
+                db_->put(make_bench_key(random_key(thread), config_.key_size), thread.values.next(config_.value_size));
+                writes.fetch_add(1, std::memory_order_relaxed);
+            }
+        });
+
+        BenchResult result = read_random();
+        stop.store(true);
+        writer.join();
+
+        std::cout << "    background writer: " << static_cast<uint64_t>(writes.load() / std::max(result.seconds, 1e-9))
+                  << " writes/sec" << std::endl;
+        return result;
+    }
+
+    // readrandom at doubling thread counts up to --threads, each line with its speedup over
+    // one thread. Reads share the store, so throughput should grow with the cores in use
+    void read_scaling() {
+        std::vector<int> counts;
+        for (int threads = 1; threads < config_.threads; threads *= 2) {
+            counts.push_back(threads);
+        }
+        counts.push_back(config_.threads);
+
+        double base = 0.0;
+        for (int threads : counts) {
+            BenchResult result = read_random(threads);
+            double rate = result.ops / std::max(result.seconds, 1e-9);
+            if (base == 0.0) {
+                base = rate;
+            }
+            print_bench_result("readrandom/" + std::to_string(threads) + "t", result);
+            std::cout << "    speedup over 1 thread: " << std::setprecision(2) << rate / base << "x" << std::endl;
+        }
+    }
+};
+
+}
+
+int main(int argc, char* argv[]) {
+    BenchFlags flags;
+    if (!flags.parse(argc, argv) || flags.has("help")) {
+        print_usage();
+        return flags.has("help") ? 0 : 1;
+    }
+
+    BenchConfig config;
+    config.engines = split(flags.get_string("engine", "lsm,kvstore"));
+    config.benchmarks = split(flags.get_string("benchmarks",
+        "fillseq,readrandom,readseq,seekrandom,fillrandom,overwrite,readwhilewriting,deleterandom"));
+    config.num = static_cast<uint64_t>(std::max<int64_t>(1, flags.get_int("num", 100000)));
+    int64_t reads = flags.get_int("reads", -1);
+    config.reads = reads < 0 ? config.num : static_cast<uint64_t>(reads);
+    config.key_size = static_cast<size_t>(std::max<int64_t>(1, flags.get_int("key_size", 16)));
+    config.value_size = static_cast<size_t>(std::max<int64_t>(0, flags.get_int("value_size", 100)));
+    config.threads = static_cast<int>(std::max<int64_t>(1, flags.get_int("threads", 1)));
+    config.duration = flags.get_double("duration", 0.0);
+    config.seek_nexts = static_cast<uint64_t>(std::max<int64_t>(1, flags.get_int("seek_nexts", 10)));
+    config.memtable_size = static_cast<size_t>(std::max<int64_t>(4096, flags.get_int("memtable_size", 1024 * 1024)));
+    config.db = flags.get_string("db", "kvdb_bench_db");
+    config.seed = static_cast<uint64_t>(flags.get_int("seed", 301));
+
+    // Engines print progress on stdout, so the report goes to stdout too but after each run
+    std::cout << "Keys:       " << config.key_size << " bytes each\n"
+              << "Values:     " << config.value_size << " bytes each\n"
+              << "Entries:    " << config.num << "\n"
+              << "Threads:    " << config.threads << "\n"
+              << "Duration:   " << (config.duration > 0 ? std::to_string(config.duration) + " s" : "fixed op count") << "\n"
+              << "Memtable:   " << config.memtable_size << " bytes" << std::endl;
+
+    int status = 0;
+    for (const auto& engine : config.engines) {
+        std::cout << "\n=== " << engine << " ===" << std::endl;
+        BenchRunner runner(config, engine);
+        for (const auto& benchmark : config.benchmarks) {
+            if (!runner.run(benchmark)) {
+                status = 1;
+                break;
+            }
+        }
+        runner.close();
+    }
+
+    return status;
+}
@@ -0,0 +1,276 @@
+// Microbenchmarks for the engine's core kernels
+//
+//   micro_bench [--filter=sstable] [--min_time=0.1] [--repetitions=5] [--warmup=1] [--json=out.json]
+//
+// Each kernel runs at several sizes. Keys are picked from a precomputed random order, so
+// the key generation isn't what gets measured. --json writes the results for diffing builds.
+
+#include "MicroBench.h"
+#include "BenchUtil.h"
+#include "../Memtable.h"
+#include "../SSTableWriter.h"
+#include "../SSTableReader.h"
+#include "../WriteAheadLog.h"
+#include "../BufferPool.h"
+#include "../Compactor.h"
+#include <iostream>
+#include <fstream>
+#include <filesystem>
+#include <random>
+#include <memory>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+const std::string DATA_DIR = "micro_bench_data";
+const size_t KEY_SIZE = 16;
+const size_t VALUE_SIZE = 100;
+
+std::vector<std::string> make_keys(size_t count) {
+    std::vector<std::string> keys;
+    keys.reserve(count);
+    for (size_t i = 0; i < count; i++) {
+        keys.push_back(make_bench_key(i, KEY_SIZE));
+    }
+    return keys;
+}
+
+// Random probe order into [0, count), cycled through by the benchmark loops
+std::vector<uint32_t> make_order(size_t count, size_t length = 1 << 16) {
+    std::mt19937 rng(42);
+    std::vector<uint32_t> order(length);
+    for (auto& index : order) {
+        index = static_cast<uint32_t>(rng() % count);
+    }
+    return order;
+}
+
+std::string write_table(const std::string& name, size_t count, size_t stride = 1, size_t offset = 0) {
+    std::string filename = (fs::path(DATA_DIR) / name).string();
+    if (fs::exists(filename)) {
+        return filename;
+    }
+
+    ValueGenerator values(count);
+    std::vector<std::pair<std::string, Memtable::Entry>> entries;
+    entries.reserve(count);
+    for (size_t i = 0; i < count; i++) {
+        entries.emplace_back(make_bench_key(i * stride + offset, KEY_SIZE), Memtable::Entry(values.next(VALUE_SIZE), false));
+    }
+    SSTableWriter::write(filename, entries);
+    return filename;
+}
+
+void add_memtable_benchmarks(MicroBenchRunner& runner) {
+    for (size_t count : {1000, 10000, 100000}) {
+        // Overwrites into a table already holding count keys, so its size stays put
+        runner.add("memtable/put/" + std::to_string(count), [count](MicroState& state) {
+            auto keys = make_keys(count);
+            auto order = make_order(count);
+            ValueGenerator values(1);
+            std::string value = values.next(VALUE_SIZE);
+
+            Memtable memtable(SIZE_MAX);
+            for (const auto& key : keys) {
+                memtable.put(key, value);
+            }
+
+            size_t i = 0;
+            while (state.keep_running()) {
+                bool ok = memtable.put(keys[order[i++ & (order.size() - 1)]], value);
+                do_not_optimize(ok);
+            }
+            state.set_bytes_per_iteration(KEY_SIZE + VALUE_SIZE);
+        });
+
+        runner.add("memtable/get/" + std::to_string(count), [count](MicroState& state) {
+            auto keys = make_keys(count);
+            auto order = make_order(count);
+            ValueGenerator values(1);
+
+            Memtable memtable(SIZE_MAX);
+            for (const auto& key : keys) {
+                memtable.put(key, values.next(VALUE_SIZE));
+            }
+
+            size_t i = 0;
+            while (state.keep_running()) {
+                auto value = memtable.get(keys[order[i++ & (order.size() - 1)]]);
+                do_not_optimize(value);
+            }
+        });
+    }
+}
+
+void add_sstable_benchmarks(MicroBenchRunner& runner) {
+    for (size_t count : {1000, 10000, 100000}) {
+        runner.add("sstable/get_hit/" + std::to_string(count), [count](MicroState& state) {
+            SSTableReader reader(write_table("lookup_" + std::to_string(count) + ".sst", count));
+            auto keys = make_keys(count);
+            auto order = make_order(count);
+
+            size_t i = 0;
+            while (state.keep_running()) {
+                auto value = reader.get(keys[order[i++ & (order.size() - 1)]]);
+                do_not_optimize(value);
+            }
+        });
+
+        // Keys between the stored ones, so every probe searches all the way down
+        runner.add("sstable/get_miss/" + std::to_string(count), [count](MicroState& state) {
+            SSTableReader reader(write_table("lookup_" + std::to_string(count) + ".sst", count));
+            auto order = make_order(count);
+            std::vector<std::string> misses;
+            for (size_t i = 0; i < count; i++) {
+                misses.push_back(make_bench_key(i, KEY_SIZE) + "~");
+            }
+
+            size_t i = 0;
+            while (state.keep_running()) {
+                auto value = reader.get(misses[order[i++ & (order.size() - 1)]]);
+                do_not_optimize(value);
+            }
+        });
+    }
+}
+
+void add_wal_benchmarks(MicroBenchRunner& runner) {
+    // Unsynced appends time the encoding and the write, wal/append_sync adds the fsync
+    std::vector<std::pair<size_t, bool>> cases = {{16, false}, {128, false}, {1024, false}, {128, true}};
+    for (auto [value_size, sync] : cases) {
+        std::string name = sync ? "wal/append_sync/" : "wal/append/";
+        runner.add(name + std::to_string(value_size), [value_size, sync](MicroState& state) {
+            WriteAheadLog wal((fs::path(DATA_DIR) / "append.wal").string(), nullptr, sync);
+            wal.clear();
+            ValueGenerator values(1);
+            std::string value = values.next(value_size);
+            auto keys = make_keys(1024);
+
+            size_t i = 0;
+            while (state.keep_running()) {
+                bool ok = wal.log_put(keys[i++ & 1023], value);
+                do_not_optimize(ok);
+
+                // Keep the log from growing without bound over long runs
+                if ((i & 0xffff) == 0) {
+                    state.pause_timing();
+                    wal.clear();
+                    state.resume_timing();
+                }
+            }
+            state.set_bytes_per_iteration(KEY_SIZE + value_size);
+            wal.clear();
+        });
+    }
+}
+
+void add_buffer_pool_benchmarks(MicroBenchRunner& runner) {
+    for (size_t capacity : {64, 1024, 8192}) {
+        runner.add("buffer_pool/get_page_hit/" + std::to_string(capacity), [capacity](MicroState& state) {
+            BufferPool pool(capacity);
+            std::vector<PageId> ids;
+            for (size_t i = 0; i < capacity; i++) {
+                ids.emplace_back("table.sst", i * Page::PAGE_SIZE);
+                pool.add_page(ids.back(), Page());
+                pool.unpin_page(ids.back());
+            }
+            auto order = make_order(capacity);
+
+            size_t i = 0;
+            while (state.keep_running()) {
+                const PageId& id = ids[order[i++ & (order.size() - 1)]];
+                Page* page = pool.get_page(id);
+                do_not_optimize(page);
+                pool.unpin_page(id);
+            }
+        });
+
+        // Every lookup misses and the page is added, evicting the least recently used
+        runner.add("buffer_pool/miss_and_add/" + std::to_string(capacity), [capacity](MicroState& state) {
+            BufferPool pool(capacity);
+            uint64_t next_page = 0;
+
+            while (state.keep_running()) {
+                PageId id("table.sst", (next_page++) * Page::PAGE_SIZE);
+                Page* page = pool.get_page(id);
+                if (!page) {
+                    pool.add_page(id, Page());
+                    pool.unpin_page(id);
+                }
+                do_not_optimize(page);
+            }
+        });
+    }
+}
+
+void add_compaction_benchmarks(MicroBenchRunner& runner) {
+    struct Shape { size_t tables; size_t entries; };
+    for (Shape shape : {Shape{2, 1000}, Shape{4, 1000}, Shape{4, 10000}}) {
+        std::string name = "compactor/merge/" + std::to_string(shape.tables) + "x" + std::to_string(shape.entries);
+        runner.add(name, [shape](MicroState& state) {
+            auto buffer_pool = std::make_shared<BufferPool>(1024);
+            Compactor compactor(buffer_pool);
+
+            // Interleaved key ranges so the merge has to pick between every input
+            std::vector<std::shared_ptr<SSTableReader>> inputs;
+            for (size_t t = 0; t < shape.tables; t++) {
+                std::string file = write_table("merge_" + std::to_string(shape.tables) + "x" + std::to_string(shape.entries)
+                                               + "_" + std::to_string(t) + ".sst", shape.entries, shape.tables, t);
+                inputs.push_back(std::make_shared<SSTableReader>(file));
+            }
+
+            while (state.keep_running()) {
+                auto outputs = compactor.compact(inputs, 1, false);
+                do_not_optimize(outputs);
+
+                state.pause_timing();
+                for (const auto& output : outputs) {
+                    std::string file = output->get_filename();
+                    fs::remove(file);
+                }
+                state.resume_timing();
+            }
+            state.set_bytes_per_iteration(shape.tables * shape.entries * (KEY_SIZE + VALUE_SIZE));
+        });
+    }
+}
+
+}
+
+int main(int argc, char* argv[]) {
+    BenchFlags flags;
+    if (!flags.parse(argc, argv) || flags.has("help")) {
+        std::cout << "Usage: micro_bench [--filter=SUBSTRING] [--min_time=0.1] [--warmup=1]\n"
+                  << "                   [--repetitions=5] [--json=FILE]\n";
+        return flags.has("help") ? 0 : 1;
+    }
+
+    MicroOptions options;
+    options.filter = flags.get_string("filter", "");
+    options.min_time = flags.get_double("min_time", 0.1);
+    options.warmup = static_cast<int>(flags.get_int("warmup", 1));
+    options.repetitions = static_cast<int>(std::max<int64_t>(1, flags.get_int("repetitions", 5)));
+
+    fs::remove_all(DATA_DIR);
+    fs::create_directories(DATA_DIR);
+
+    MicroBenchRunner runner(options);
+    add_memtable_benchmarks(runner);
+    add_sstable_benchmarks(runner);
+    add_wal_benchmarks(runner);
+    add_buffer_pool_benchmarks(runner);
+    add_compaction_benchmarks(runner);
+
+    auto results = runner.run();
+
+    std::string json_path = flags.get_string("json", "");
+    if (!json_path.empty()) {
+        std::ofstream json(json_path);
+        json << MicroBenchRunner::to_json(results, options);
+        std::cout << "Wrote " << results.size() << " results to " << json_path << std::endl;
+    }
+
+    fs::remove_all(DATA_DIR);
+    return 0;
+}
@@ -0,0 +1,103 @@
+// Replay a trace recorded with LSMTree::start_trace against a fresh LSMTree
+//
+//   trace_replay --trace=ops.trace --threads=4 --speed=2
+//
+// Calls run at their traced times divided by speed, --speed=0 runs them back to back.
+// Each traced thread is pinned to one replay thread so its calls stay in order, and with
+// --threads=1 the trace replays in exactly the order it was recorded.
+
+#include "BenchUtil.h"
+#include "../LSMTree.h"
+#include "../TraceReplayer.h"
+#include <iostream>
+#include <iomanip>
+#include <filesystem>
+#include <set>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+void print_usage() {
+    std::cout << "Usage: trace_replay --trace=PATH [--name=value ...]\n"
+              << "  --trace=                   trace file to replay\n"
+              << "  --threads=1                replay threads, traced threads are spread over them\n"
+              << "  --speed=1.0                1 keeps the traced timing, 0 replays as fast as possible\n"
+              << "  --memtable_size=1048576\n"
+              << "  --db=trace_replay_db       scratch directory, removed afterwards\n";
+}
+
+}
+
+int main(int argc, char* argv[]) {
+    BenchFlags flags;
+    if (!flags.parse(argc, argv) || flags.has("help") || !flags.has("trace")) {
+        print_usage();
+        return flags.has("help") ? 0 : 1;
+    }
+
+    std::string trace_path = flags.get_string("trace", "");
+    std::string db_dir = flags.get_string("db", "trace_replay_db");
+    TraceReplayer::Options options(
+        static_cast<int>(std::max<int64_t>(1, flags.get_int("threads", 1))),
+        std::max(0.0, flags.get_double("speed", 1.0)));
+    size_t memtable_size = static_cast<size_t>(std::max<int64_t>(4096, flags.get_int("memtable_size", 1024 * 1024)));
+
+    TraceReader reader;
+    if (!reader.open(trace_path)) {
+        std::cerr << "Not a trace file: " << trace_path << std::endl;
+        return 1;
+    }
+    std::vector<TraceRecord> records;
+    TraceRecord record;
+    std::set<uint32_t> traced_threads;
+    uint64_t bytes = 0;  // keys and values written
+    while (reader.next(record)) {
+        traced_threads.insert(record.thread);
+        bytes += record.key.size() + record.value_size;
+        for (const auto& entry : record.batch) {
+            bytes += entry.key.size() + entry.value_size;
+        }
+        records.push_back(std::move(record));
+    }
+    uint64_t traced_us = records.empty() ? 0 : records.back().timestamp_us;
+
+    std::cout << "Trace:    " << records.size() << " calls from " << traced_threads.size() << " threads over "
+              << std::fixed << std::setprecision(3) << traced_us / 1e6 << " s\n"
+              << "Replay:   " << options.threads << " threads at speed " << std::setprecision(1) << options.speed
+              << (options.speed == 0 ? " (as fast as possible)" : "") << std::endl;
+
+    fs::remove_all(db_dir);
+    TraceReplayer::Result result;
+    {
+        LSMTree db(db_dir, LSMTree::Config(memtable_size));
+        result = TraceReplayer(db).replay(std::move(records), options);
+    }
+    fs::remove_all(db_dir);
+
+    BenchResult total;
+    for (const auto& latency : result.latency) {
+        total.latency.merge(latency);
+    }
+    total.ops = result.ops;
+    total.bytes = bytes;
+    total.found = result.ops;
+    total.seconds = result.seconds;
+    print_bench_result("replay", total);
+    if (options.speed > 0) {
+        std::cout << "    max lag behind schedule: " << std::setprecision(3) << result.max_lag_us / 1000.0 << " ms\n";
+    }
+    if (result.failed > 0) {
+        std::cout << "    " << result.failed << " writes failed\n";
+    }
+
+    for (size_t op = 0; op < TraceReplayer::OP_COUNT; op++) {
+        const Histogram& latency = result.latency[op];
+        if (latency.count() == 0) {
+            continue;
+        }
+        std::cout << "    [" << TraceReplayer::op_name(static_cast<TraceOp>(op)) << "] " << latency.count()
+                  << " calls\n        latency (us): " << latency.summary() << std::endl;
+    }
+    return 0;
+}
@@ -0,0 +1,396 @@
+// YCSB core workloads A-F against KVStore and LSMTree
+//
+//   ycsb_bench --engine=lsm --workloads=a,b,c,f,d,e --recordcount=100000
+//              --operationcount=100000 --threads=4 --theta=0.99
+//
+//   A  50% read, 50% update                      zipfian
+//   B  95% read, 5% update                       zipfian
+//   C  100% read                                 zipfian
+//   D  95% read, 5% insert                       latest
+//   E  95% scan, 5% insert                       zipfian, scans of 1 to max_scan_length keys
+//   F  50% read, 50% read-modify-write           zipfian
+//
+// Records are loaded once per engine, then the workloads run in the order given against the
+// same data, as YCSB recommends. Keys are inserted in order ("user" + zero padded record number)
+// so a scan is a key range. Popularity is scrambled across the key space instead.
+
+#include "BenchDB.h"
+#include "BenchUtil.h"
+#include "Distributions.h"
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <filesystem>
+#include <atomic>
+#include <array>
+#include <optional>
+#include <thread>
+#include <vector>
+#include <cctype>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+enum class Distribution { UNIFORM, ZIPFIAN, LATEST };
+
+enum Operation { READ, UPDATE, INSERT, SCAN, READ_MODIFY_WRITE, OPERATION_COUNT };
+const char* OPERATION_NAMES[OPERATION_COUNT] = {"READ", "UPDATE", "INSERT", "SCAN", "READ-MODIFY-WRITE"};
+
+struct Workload {
+    std::string name;
+    std::array<double, OPERATION_COUNT> proportions;
+    Distribution distribution;
+};
+
+std::optional<Workload> core_workload(char letter) {
+    switch (std::tolower(letter)) {
+        case 'a': return Workload{"workloada", {0.5, 0.5, 0, 0, 0}, Distribution::ZIPFIAN};
+        case 'b': return Workload{"workloadb", {0.95, 0.05, 0, 0, 0}, Distribution::ZIPFIAN};
+        case 'c': return Workload{"workloadc", {1.0, 0, 0, 0, 0}, Distribution::ZIPFIAN};
+        case 'd': return Workload{"workloadd", {0.95, 0, 0.05, 0, 0}, Distribution::LATEST};
+        case 'e': return Workload{"workloade", {0, 0, 0.05, 0.95, 0}, Distribution::ZIPFIAN};
+        case 'f': return Workload{"workloadf", {0.5, 0, 0, 0, 0.5}, Distribution::ZIPFIAN};
+        default: return std::nullopt;
+    }
+}
+
+struct YcsbConfig {
+    std::vector<std::string> engines;
+    std::string workloads;
+    std::string distribution;  // overrides the workloads' own when set
+    uint64_t record_count;
+    uint64_t operation_count;
+    size_t key_size;
+    size_t value_size;
+    uint64_t max_scan_length;
+    double theta;
+    int threads;
+    double duration;
+    size_t memtable_size;
+    std::string db;
+    uint64_t seed;
+    bool histogram;  // print every non-empty bucket
+};
+
+// Per thread latency per operation type, merged after the run
+struct OperationStats {
+    std::array<Histogram, OPERATION_COUNT> latency;
+    std::array<uint64_t, OPERATION_COUNT> failed{};
+};
+
+void print_operation_stats(const std::vector<OperationStats>& threads, double seconds, bool buckets) {
+    for (int op = 0; op < OPERATION_COUNT; op++) {
+        Histogram merged;
+        uint64_t failed = 0;
+        for (const auto& stats : threads) {
+            merged.merge(stats.latency[op]);
+            failed += stats.failed[op];
+        }
+        if (merged.count() == 0) {
+            continue;
+        }
+
+        std::cout << "    [" << OPERATION_NAMES[op] << "] " << std::fixed << std::setprecision(0)
+                  << merged.count() / std::max(seconds, 1e-9) << " ops/sec";
+        if (failed > 0) {
+            std::cout << ", " << failed << " failed";
+        }
+        std::cout << "\n        latency (us): " << merged.summary() << std::endl;
+
+        if (buckets) {
+            uint64_t seen = 0;
+            for (size_t i = 0; i < Histogram::BUCKET_COUNT; i++) {
+                uint64_t count = merged.bucket_count(i);
+                if (count == 0) {
+                    continue;
+                }
+                seen += count;
+                std::cout << "        <= " << std::setw(12) << std::setprecision(3)
+                          << Histogram::bucket_upper_bound(i) / 1000.0 << " us " << std::setw(10) << count
+                          << std::setw(10) << std::setprecision(4) << 100.0 * seen / merged.count() << "%\n";
+            }
+        }
+    }
+}
+
+class YcsbRunner {
+public:
+    YcsbRunner(const YcsbConfig& config, const std::string& engine)
+        : config_(config), engine_(engine), db_dir_(config.db + "_" + engine) {}
+
+    ~YcsbRunner() {
+        db_.reset();
+        fs::remove_all(db_dir_);
+    }
+
+    bool load() {
+        fs::remove_all(db_dir_);
+        db_ = open_bench_db(engine_, db_dir_, config_.memtable_size);
+        if (!db_) {
+            std::cerr << "Failed to open " << engine_ << " database at " << db_dir_ << std::endl;
+            return false;
+        }
+
+        uint64_t threads = static_cast<uint64_t>(config_.threads);
+        uint64_t per_thread = (config_.record_count + threads - 1) / threads;
+
+        auto result = run_bench_threads(config_.threads, config_.seed, [&](BenchThread& thread) {
+            uint64_t first = static_cast<uint64_t>(thread.id) * per_thread;
+            uint64_t last = std::min(first + per_thread, config_.record_count);
+            for (uint64_t record = first; record < last; record++) {
+                std::string key = record_key(record);
+                std::string value = thread.values.next(config_.value_size);
+
+                auto start = std::chrono::steady_clock::now();
+                bool ok = db_->put(key, value);
+                thread.latency.add(elapsed_ns(start));
+
+                thread.ops++;
+                thread.found += ok;
+                thread.bytes += key.size() + value.size();
+            }
+        });
+
+        inserted_ = config_.record_count;
+        next_insert_ = config_.record_count;
+        print_bench_result("load", result);
+        return true;
+    }
+
+    void run(const Workload& workload) {
+        Distribution distribution = workload.distribution;
+        if (config_.distribution == "uniform") distribution = Distribution::UNIFORM;
+        if (config_.distribution == "zipfian") distribution = Distribution::ZIPFIAN;
+        if (config_.distribution == "latest") distribution = Distribution::LATEST;
+
+        // Built once, zeta over a large key space takes a while, and copied per thread
+        double inserts = workload.proportions[INSERT] * static_cast<double>(config_.operation_count);
+        uint64_t key_space = inserted_.load() + static_cast<uint64_t>(inserts * 2) + 1;
+        ScrambledZipfianGenerator scrambled(key_space, config_.theta);
+        LatestGenerator latest(inserted_.load(), config_.theta);
+
+        std::vector<OperationStats> operation_stats(config_.threads);
+        uint64_t planned = std::max<uint64_t>(1, config_.operation_count / static_cast<uint64_t>(config_.threads));
+        auto until = config_.duration > 0
+            ? std::chrono::steady_clock::now() + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                  std::chrono::duration<double>(config_.duration))
+            : std::chrono::steady_clock::time_point();
+
+        auto result = run_bench_threads(config_.threads, config_.seed, [&](BenchThread& thread) {
+            ScrambledZipfianGenerator thread_scrambled = scrambled;
+            LatestGenerator thread_latest = latest;
+            OperationStats& stats = operation_stats[thread.id];
+            std::uniform_real_distribution<double> pick(0.0, 1.0);
+
+            auto choose_record = [&]() -> uint64_t {
+                uint64_t available = inserted_.load(std::memory_order_acquire);
+                switch (distribution) {
+                    case Distribution::UNIFORM:
+                        return thread.rng() % available;
+                    case Distribution::LATEST:
+                        return thread_latest.next(thread.rng, available);
+                    case Distribution::ZIPFIAN:
+                    default: {
+                        // The key space leaves room for inserts, redraw records not inserted yet
+                        uint64_t record = thread_scrambled.next(thread.rng);
+                        for (int i = 0; i < 8 && record >= available; i++) {
+                            record = thread_scrambled.next(thread.rng);
+                        }
+                        return record % available;
+                    }
+                }
+            };
+
+            while (!thread.done(planned, until)) {
+                Operation op = choose_operation(workload, pick(thread.rng));
+
+                auto start = std::chrono::steady_clock::now();
+                bool ok = execute(op, thread, choose_record);
+                uint64_t ns = elapsed_ns(start);
+
+                thread.latency.add(ns);
+                stats.latency[op].add(ns);
+                if (!ok) {
+                    stats.failed[op]++;
+                }
+                thread.ops++;
+                thread.found += ok;
+            }
+        });
+
+        print_bench_result(workload.name, result);
+        print_operation_stats(operation_stats, result.seconds, config_.histogram);
+    }
+
+private:
+    const YcsbConfig& config_;
+    std::string engine_;
+    std::string db_dir_;
+    std::unique_ptr<BenchDB> db_;
+    std::atomic<uint64_t> next_insert_{0};
+    std::atomic<uint64_t> inserted_{0};  // every record below this has been written
+
+    std::string record_key(uint64_t record) const {
+        return "user" + make_bench_key(record, config_.key_size > 4 ? config_.key_size - 4 : 1);
+    }
+
+    static Operation choose_operation(const Workload& workload, double roll) {
+        for (int op = 0; op < OPERATION_COUNT; op++) {
+            roll -= workload.proportions[op];
+            if (roll < 0) {
+                return static_cast<Operation>(op);
+            }
+        }
+        return READ;
+    }
+
+    template <typename Chooser>
+    bool execute(Operation op, BenchThread& thread, Chooser& choose_record) {
+        switch (op) {
+            case READ: {
+                auto value = db_->get(record_key(choose_record()));
+                if (value) {
+                    thread.bytes += value->size();
+                }
+                return value.has_value();
+            }
+            case UPDATE: {
+                std::string value = thread.values.next(config_.value_size);
+                thread.bytes += value.size();
+                return db_->put(record_key(choose_record()), value);
+            }
+            case INSERT: {
+                uint64_t record = next_insert_.fetch_add(1);
+                std::string value = thread.values.next(config_.value_size);
+                bool ok = db_->put(record_key(record), value);
+                thread.bytes += value.size();
+
+                // Readers only pick records once every record before them is in
+                uint64_t expected = record;
+                while (!inserted_.compare_exchange_weak(expected, record + 1) && expected < record) {
+                    expected = record;
+                    std::this_thread::yield();
+                }
+                return ok;
+            }
+            case SCAN: {
+                uint64_t first = choose_record();
+                uint64_t length = 1 + thread.rng() % config_.max_scan_length;
+                auto entries = db_->scan(record_key(first), record_key(first + length - 1));
+                for (const auto& [key, value] : entries) {
+                    thread.bytes += key.size() + value.size();
+                }
+                return !entries.empty();
+            }
+            case READ_MODIFY_WRITE: {
+                std::string key = record_key(choose_record());
+                auto value = db_->get(key);
+                std::string updated = thread.values.next(config_.value_size);
+                thread.bytes += updated.size() + (value ? value->size() : 0);
+                return db_->put(key, updated) && value.has_value();
+            }
+            default:
+                return false;
+        }
+    }
+};
+
+void print_usage() {
+    std::cout << "Usage: ycsb_bench [--name=value ...]\n"
+              << "  --engine=lsm,kvstore       engines to run, in order\n"
+              << "  --workloads=abcfde         core workloads to run, in order\n"
+              << "  --distribution=            uniform, zipfian or latest, overrides the workloads'\n"
+              << "  --theta=0.99               zipfian skew, in (0, 1)\n"
+              << "  --recordcount=100000       records loaded before the workloads\n"
+              << "  --operationcount=100000    operations per workload\n"
+              << "  --key_size=16 --value_size=100\n"
+              << "  --max_scan_length=100\n"
+              << "  --threads=1                client threads\n"
+              << "  --duration=0               seconds per workload, 0 runs operationcount instead\n"
+              << "  --histogram                print every latency bucket\n"
+              << "  --memtable_size=1048576\n"
+              << "  --db=ycsb_bench_db         directory prefix, one per engine\n"
+              << "  --seed=301\n";
+}
+
+std::vector<std::string> split(const std::string& list) {
+    std::vector<std::string> items;
+    std::istringstream in(list);
+    std::string item;
+    while (std::getline(in, item, ',')) {
+        if (!item.empty()) {
+            items.push_back(item);
+        }
+    }
+    return items;
+}
+
+}
+
+int main(int argc, char* argv[]) {
+    BenchFlags flags;
+    if (!flags.parse(argc, argv) || flags.has("help")) {
+        print_usage();
+        return flags.has("help") ? 0 : 1;
+    }
+
+    YcsbConfig config;
+    config.engines = split(flags.get_string("engine", "lsm,kvstore"));
+    config.workloads = flags.get_string("workloads", "abcfde");
+    config.distribution = flags.get_string("distribution", "");
+    config.record_count = static_cast<uint64_t>(std::max<int64_t>(1, flags.get_int("recordcount", 100000)));
+    config.operation_count = static_cast<uint64_t>(std::max<int64_t>(1, flags.get_int("operationcount", 100000)));
+    config.key_size = static_cast<size_t>(std::max<int64_t>(8, flags.get_int("key_size", 16)));
+    config.value_size = static_cast<size_t>(std::max<int64_t>(0, flags.get_int("value_size", 100)));
+    config.max_scan_length = static_cast<uint64_t>(std::max<int64_t>(1, flags.get_int("max_scan_length", 100)));
+    config.theta = flags.get_double("theta", 0.99);
+    config.threads = static_cast<int>(std::max<int64_t>(1, flags.get_int("threads", 1)));
+    config.duration = flags.get_double("duration", 0.0);
+    config.memtable_size = static_cast<size_t>(std::max<int64_t>(4096, flags.get_int("memtable_size", 1024 * 1024)));
+    config.db = flags.get_string("db", "ycsb_bench_db");
+    config.seed = static_cast<uint64_t>(flags.get_int("seed", 301));
+    config.histogram = flags.has("histogram");
+
+    if (config.theta <= 0.0 || config.theta >= 1.0) {
+        std::cerr << "--theta must be in (0, 1)" << std::endl;
+        return 1;
+    }
+    if (!config.distribution.empty() && config.distribution != "uniform" &&
+        config.distribution != "zipfian" && config.distribution != "latest") {
+        std::cerr << "Unknown distribution: " << config.distribution << std::endl;
+        return 1;
+    }
+
+    std::vector<Workload> workloads;
+    for (char letter : config.workloads) {
+        if (letter == ',') {
+            continue;
+        }
+        auto workload = core_workload(letter);
+        if (!workload) {
+            std::cerr << "Unknown workload: " << letter << std::endl;
+            return 1;
+        }
+        workloads.push_back(*workload);
+    }
+
+    std::cout << "Records:    " << config.record_count << " of " << config.key_size << " + "
+              << config.value_size << " bytes\n"
+              << "Operations: " << config.operation_count << " per workload\n"
+              << "Threads:    " << config.threads << "\n"
+              << "Theta:      " << config.theta << std::endl;
+
+    for (const auto& engine : config.engines) {
+        std::cout << "\n=== " << engine << " ===" << std::endl;
+        YcsbRunner runner(config, engine);
+        if (!runner.load()) {
+            return 1;
+        }
+        for (const auto& workload : workloads) {
+            runner.run(workload);
+        }
+    }
+
+    return 0;
+}
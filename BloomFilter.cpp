@@ -0,0 +1,79 @@
+#include "BloomFilter.h"
+#include "Hash.h"
+#include <algorithm>
+#include <cstring>
+
+namespace {
+    constexpr size_t MIN_FILTER_BITS = 64;
+    constexpr uint32_t MAX_PROBES = 30;
+}
+
+BloomFilter::BloomFilter(size_t expected_keys, size_t bits_per_key) {
+    // k = bits_per_key * ln(2) minimises the false positive rate
+    num_probes_ = static_cast<uint32_t>(static_cast<double>(bits_per_key) * 0.69);
+    num_probes_ = std::clamp<uint32_t>(num_probes_, 1, MAX_PROBES);
+
+    size_t bits = std::max(expected_keys * bits_per_key, MIN_FILTER_BITS);
+    bits_.assign((bits + 7) / 8, 0);
+}
+
+void BloomFilter::add(const std::string& key) {
+    const uint64_t nbits = bits_.size() * 8;
+    uint64_t h = hash64(key);
+    const uint64_t delta = (h >> 33) | (h << 31);
+
+    for (uint32_t i = 0; i < num_probes_; ++i) {
+        const uint64_t bit = h % nbits;
+        bits_[bit / 8] |= static_cast<uint8_t>(1u << (bit % 8));
+        h += delta;
+    }
+}
+
+bool BloomFilter::may_contain(const std::string& key) const {
+    const uint64_t nbits = bits_.size() * 8;
+    if (nbits == 0) {
+        return true;
+    }
+
+    uint64_t h = hash64(key);
+    const uint64_t delta = (h >> 33) | (h << 31);
+
+    for (uint32_t i = 0; i < num_probes_; ++i) {
+        const uint64_t bit = h % nbits;
+        if ((bits_[bit / 8] & (1u << (bit % 8))) == 0) {
+            return false;
+        }
+        h += delta;
+    }
+
+    return true;
+}
+
+std::string BloomFilter::serialize() const {
+    std::string out;
+    out.resize(sizeof(num_probes_) + bits_.size());
+    std::memcpy(out.data(), &num_probes_, sizeof(num_probes_));
+    if (!bits_.empty()) {
+        std::memcpy(out.data() + sizeof(num_probes_), bits_.data(), bits_.size());
+    }
+    return out;
+}
+
+std::optional<BloomFilter> BloomFilter::deserialize(const std::string& data) {
+    if (data.size() <= sizeof(uint32_t)) {
+        return std::nullopt;
+    }
+
+    BloomFilter filter;
+    std::memcpy(&filter.num_probes_, data.data(), sizeof(filter.num_probes_));
+    if (filter.num_probes_ == 0 || filter.num_probes_ > MAX_PROBES) {
+        return std::nullopt;
+    }
+
+    filter.bits_.assign(data.begin() + sizeof(uint32_t), data.end());
+    return filter;
+}
+
+size_t BloomFilter::memory_usage() const {
+    return sizeof(BloomFilter) + bits_.capacity();
+}
@@ -0,0 +1,64 @@
+#ifndef KVDB_BLOOMFILTER_H
+#define KVDB_BLOOMFILTER_H
+
+#include <string>
+#include <vector>
+#include <optional>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * Classic bloom filter using double hashing over a single stable 64-bit hash.
+ *
+ * Serialized format:
+ * - Probe count (uint32_t)
+ * - Bit array (remaining bytes)
+ */
+class BloomFilter
+{
+public:
+    /**
+     * Create an empty filter sized for a number of keys
+     * @param expected_keys number of keys that will be added
+     * @param bits_per_key bits of filter per key (10 gives ~1% false positives)
+     */
+    BloomFilter(size_t expected_keys, size_t bits_per_key);
+
+    /**
+     * Add a key to the filter
+     */
+    void add(const std::string& key);
+
+    /**
+     * Check if a key might be in the set
+     * @return false if the key was definitely never added
+     */
+    [[nodiscard]] bool may_contain(const std::string& key) const;
+
+    /**
+     * Serialize filter for storage in an SSTable
+     */
+    [[nodiscard]] std::string serialize() const;
+
+    /**
+     * Rebuild a filter from serialized bytes
+     * @return empty optional if data is malformed
+     */
+    static std::optional<BloomFilter> deserialize(const std::string& data);
+
+    /**
+     * Get approximate memory usage in bytes
+     */
+    [[nodiscard]] size_t memory_usage() const;
+
+    [[nodiscard]] size_t bit_count() const { return bits_.size() * 8; }
+    [[nodiscard]] uint32_t probe_count() const { return num_probes_; }
+
+private:
+    BloomFilter() = default;
+
+    std::vector<uint8_t> bits_;
+    uint32_t num_probes_ = 1;
+};
+
+#endif // KVDB_BLOOMFILTER_H
@@ -10,6 +10,7 @@
 #include <sstream>
 #include <iomanip>
 #include <filesystem>
+#include <fstream>
 #include <chrono>
 #include <algorithm>
 #include <memory>
@@ -81,6 +82,8 @@ void CLI::process_command(const std::string& line) {
         flush_memtable();
     } else if (command == "stats") {
         show_stats();
+    } else if (command == "compaction-stats") {
+        show_compaction_stats();
     } else if (command == "list") {
         list_databases(iss);
     } else if (command == "benchmark") {
@@ -118,6 +121,7 @@ void CLI::show_help() {
     std::cout << "System Operations:\n";
     std::cout << "  flush                            - Force flush memtable to disk\n";
     std::cout << "  stats                            - Show database statistics\n";
+    std::cout << "  compaction-stats                 - Show per-level flush/compaction work and amplification\n";
     std::cout << "  benchmark [ops] [key_size] [val_size] - Run performance benchmark\n\n";
 
     std::cout << "File System Operations:\n";
@@ -375,6 +379,18 @@ void CLI::show_stats() {
         std::cout << "  Total Data:  " << stats.total_data_size << " entries\n";
         std::cout << "  Memtable Flushes: " << stats.memtable_flushes << "\n\n";
 
+        std::cout << "Latency (us):\n";
+        for (int op = 0; op < OperationLatencies::OPERATION_COUNT; op++) {
+            auto operation = static_cast<OperationLatencies::Operation>(op);
+            Histogram histogram = db_->get_latency_histogram(operation);
+            if (histogram.count() == 0) {
+                continue;
+            }
+            std::cout << "  " << std::left << std::setw(12) << OperationLatencies::name(operation) << std::right
+                      << histogram.summary() << "\n";
+        }
+        std::cout << "\n";
+
         std::cout << "Database Path: " << current_db_path_ << "\n";
 
     } catch (const std::exception& e) {
@@ -382,6 +398,16 @@ void CLI::show_stats() {
     }
 }
 
+void CLI::show_compaction_stats() {
+    if (!db_) {
+        std::cout << "No database is open. Use 'open <db_name>' first.\n";
+        return;
+    }
+
+    std::cout << "\n=== Compaction Statistics ===\n\n";
+    std::cout << db_->get_compaction_stats().to_string() << "\n";
+}
+
 void CLI::list_databases(std::istringstream& iss) {
     std::string pattern = "*";
     iss >> pattern;  // Optional pattern
@@ -23,6 +23,7 @@ class CLI {
     void scan_range(std::istringstream& iss);
     void flush_memtable();
     void show_stats();
+    void show_compaction_stats();
     void list_databases(std::istringstream& iss);
     void run_benchmark(std::istringstream& iss);
     void clear_screen();
@@ -0,0 +1,336 @@
+#include "ColumnFamilyDB.h"
+#include <sstream>
+#include <cctype>
+
+namespace {
+    const char* DEFAULT_COLUMN_FAMILY_NAME = "default";
+
+    // Files the database keeps next to the family directories
+    const char* RESERVED_NAMES[] = {"LOG", "wal.log", "column_families"};
+
+    // A family name becomes a directory under db_dir and a whitespace separated manifest
+    // field, so it can't be empty, start with a dot, hold a separator or whitespace, or
+    // clash with the database's own files or their temp and rotated copies
+    bool valid_family_name(const std::string& name) {
+        if (name.empty() || name[0] == '.') {
+            return false;
+        }
+        for (unsigned char c : name) {
+            if (c == '/' || c == '\\' || std::isspace(c) || std::iscntrl(c)) {
+                return false;
+            }
+        }
+        for (const char* reserved : RESERVED_NAMES) {
+            std::string prefix = std::string(reserved) + ".";
+            if (name == reserved || name.compare(0, prefix.size(), prefix) == 0) {
+                return false;
+            }
+        }
+        return true;
+    }
+}
+
+ColumnFamilyDB::ColumnFamilyDB(const std::string& db_dir,
+                               const std::vector<ColumnFamilyDescriptor>& families,
+                               size_t max_wal_entries,
+                               std::shared_ptr<Env> env)
+    : db_dir_(db_dir),
+      env_(env ? std::move(env) : Env::default_env()),
+      max_wal_entries_(max_wal_entries) {
+    env_->create_dirs(db_dir_);
+    logger_ = std::make_shared<Logger>(db_dir_ + "/LOG", Logger::Options(), env_);
+
+    std::vector<ColumnFamilyDescriptor> valid_families;
+    std::map<std::string, LSMTree::Config> configs;
+    for (const auto& descriptor : families) {
+        if (!valid_family_name(descriptor.name)) {
+            logger_->error("Skipping column family with invalid name '", descriptor.name, "'");
+            continue;
+        }
+        valid_families.push_back(descriptor);
+        configs[descriptor.name] = descriptor.config;
+    }
+
+    {
+        std::unique_lock<std::shared_mutex> lock(families_mutex_);
+
+        // Families from earlier runs keep their ids, the WAL refers to them by id
+        auto manifest = load_manifest();
+        manifest.try_emplace(DEFAULT_COLUMN_FAMILY, DEFAULT_COLUMN_FAMILY_NAME);
+        for (const auto& [id, name] : manifest) {
+            auto it = configs.find(name);
+            if (it == configs.end() && id != DEFAULT_COLUMN_FAMILY) {
+                logger_->warn("Column family '", name, "' not listed, opening with default config");
+            }
+            open_family(id, name, it != configs.end() ? it->second : LSMTree::Config());
+        }
+
+        for (const auto& descriptor : valid_families) {
+            if (ids_.find(descriptor.name) == ids_.end()) {
+                open_family(next_id_, descriptor.name, descriptor.config);
+            }
+        }
+
+        save_manifest();
+    }
+
+    wal_ = std::make_unique<WriteAheadLog>(db_dir_ + "/wal.log", env_);
+    recover_from_wal();
+}
+
+ColumnFamilyDB::~ColumnFamilyDB() {
+    flush();
+}
+
+void ColumnFamilyDB::open_family(uint32_t id, const std::string& name, const LSMTree::Config& config) {
+    LSMTree::Config family_config = config;
+    family_config.use_wal = false;  // logged to the shared WAL instead
+    family_config.env = env_;
+    if (!family_config.logger) {
+        family_config.logger = logger_;
+    }
+
+    families_[id] = ColumnFamily{name, std::make_unique<LSMTree>(db_dir_ + "/" + name, family_config)};
+    ids_[name] = id;
+    next_id_ = std::max(next_id_, id + 1);
+}
+
+std::map<uint32_t, std::string> ColumnFamilyDB::load_manifest() const {
+    std::map<uint32_t, std::string> manifest;
+
+    std::string contents;
+    env_->read_file(db_dir_ + "/column_families", contents);
+    std::istringstream file(contents);
+    std::string line;
+    while (std::getline(file, line)) {
+        std::istringstream fields(line);
+        uint32_t id;
+        std::string name;
+        if (fields >> id >> name) {
+            manifest[id] = name;
+        }
+    }
+
+    return manifest;
+}
+
+bool ColumnFamilyDB::save_manifest() const {
+    // Write a temp file and rename it, so a crash never leaves a half written manifest
+    std::ostringstream file;
+    for (const auto& [id, family] : families_) {
+        file << id << " " << family.name << "\n";
+    }
+
+    if (!env_->write_file_atomic(db_dir_ + "/column_families", file.str())) {
+        logger_->error("Failed to write column family manifest");
+        return false;
+    }
+    return true;
+}
+
+void ColumnFamilyDB::recover_from_wal() {
+    std::vector<WriteAheadLog::LogEntry> entries;
+    if (!wal_->recover(entries)) {
+        logger_->error("Failed to recover shared WAL. Starting fresh.");
+        wal_->clear();
+        return;
+    }
+
+    // Split into one batch per family, keeping the logged order
+    std::map<uint32_t, WriteBatch> batches;
+    for (const auto& entry : entries) {
+        if (entry.type == WriteAheadLog::OpType::PUT) {
+            batches[entry.column_family].put(entry.key, entry.value);
+        } else {
+            batches[entry.column_family].remove(entry.key);
+        }
+    }
+
+    std::shared_lock<std::shared_mutex> lock(families_mutex_);
+    for (const auto& [id, batch] : batches) {
+        LSMTree* tree = find_family(id);
+        if (!tree) {
+            logger_->warn("Skipping ", batch.count(), " WAL entries for unknown column family ", id);
+            continue;
+        }
+        tree->write(batch);
+    }
+
+    wal_entries_ = entries.size();
+}
+
+LSMTree* ColumnFamilyDB::find_family(uint32_t id) const {
+    auto it = families_.find(id);
+    return it != families_.end() ? it->second.tree.get() : nullptr;
+}
+
+std::optional<uint32_t> ColumnFamilyDB::create_column_family(const ColumnFamilyDescriptor& descriptor) {
+    if (!valid_family_name(descriptor.name)) {
+        return std::nullopt;
+    }
+
+    std::unique_lock<std::shared_mutex> lock(families_mutex_);
+
+    if (ids_.find(descriptor.name) != ids_.end()) {
+        return std::nullopt;
+    }
+
+    uint32_t id = next_id_;
+    open_family(id, descriptor.name, descriptor.config);
+    save_manifest();
+    return id;
+}
+
+std::optional<uint32_t> ColumnFamilyDB::column_family_id(const std::string& name) const {
+    std::shared_lock<std::shared_mutex> lock(families_mutex_);
+    auto it = ids_.find(name);
+    if (it == ids_.end()) {
+        return std::nullopt;
+    }
+    return it->second;
+}
+
+std::vector<std::string> ColumnFamilyDB::list_column_families() const {
+    std::shared_lock<std::shared_mutex> lock(families_mutex_);
+    std::vector<std::string> names;
+    for (const auto& [id, family] : families_) {
+        names.push_back(family.name);
+    }
+    return names;
+}
+
+bool ColumnFamilyDB::put(uint32_t column_family, const std::string& key, const std::string& value) {
+    WriteBatch batch;
+    batch.put(column_family, key, value);
+    return write(batch);
+}
+
+bool ColumnFamilyDB::remove(uint32_t column_family, const std::string& key) {
+    WriteBatch batch;
+    batch.remove(column_family, key);
+    return write(batch);
+}
+
+std::optional<std::string> ColumnFamilyDB::get(uint32_t column_family, const std::string& key) {
+    std::shared_lock<std::shared_mutex> lock(families_mutex_);
+    LSMTree* tree = find_family(column_family);
+    return tree ? tree->get(key) : std::nullopt;
+}
+
+std::vector<std::pair<std::string, std::string>>
+ColumnFamilyDB::scan(uint32_t column_family, const std::string& start_key, const std::string& end_key) {
+    std::shared_lock<std::shared_mutex> lock(families_mutex_);
+    LSMTree* tree = find_family(column_family);
+    if (!tree) {
+        return {};
+    }
+    return tree->scan(start_key, end_key);
+}
+
+bool ColumnFamilyDB::write(const WriteBatch& batch) {
+    if (batch.empty()) {
+        return true;
+    }
+
+    std::shared_lock<std::shared_mutex> families_lock(families_mutex_);
+    std::lock_guard<std::mutex> lock(write_mutex_);
+
+    // 1. Split by family, refusing the whole batch if any family is missing
+    std::map<uint32_t, WriteBatch> batches;
+    for (const auto& op : batch.ops()) {
+        if (!find_family(op.column_family)) {
+            logger_->error("Unknown column family: ", op.column_family);
+            return false;
+        }
+        if (op.type == WriteAheadLog::OpType::PUT) {
+            batches[op.column_family].put(op.key, op.value);
+        } else {
+            batches[op.column_family].remove(op.key);
+        }
+    }
+
+    // 2. One WAL append for every family
+    if (!wal_->log_batch(batch.ops())) {
+        logger_->error("Failed to write batch to shared WAL");
+        return false;
+    }
+    wal_entries_ += batch.count();
+
+    // 3. Apply each family's part, flushing it if its own memtable fills up
+    for (const auto& [id, family_batch] : batches) {
+        find_family(id)->write(family_batch);
+    }
+
+    maybe_clear_wal();
+    return true;
+}
+
+void ColumnFamilyDB::maybe_clear_wal() {
+    bool all_flushed = true;
+    for (const auto& [id, family] : families_) {
+        if (family.tree->get_memtable_size() > 0) {
+            all_flushed = false;
+            break;
+        }
+    }
+
+    // A long lived small family would otherwise pin the WAL forever
+    if (!all_flushed && wal_entries_ >= max_wal_entries_) {
+        all_flushed = flush_families();
+    }
+
+    if (all_flushed && wal_entries_ > 0) {
+        wal_->clear();
+        wal_entries_ = 0;
+    }
+}
+
+bool ColumnFamilyDB::flush_families() {
+    bool all_flushed = true;
+    for (const auto& [id, family] : families_) {
+        if (family.tree->get_memtable_size() > 0 && !family.tree->flush_memtable()) {
+            all_flushed = false;
+        }
+    }
+
+    // flush_memtable also returns false while a background flush holds the memtable, so
+    // only an empty memtable proves the data reached an SSTable
+    for (const auto& [id, family] : families_) {
+        if (family.tree->get_memtable_size() > 0) {
+            all_flushed = false;
+        }
+    }
+    return all_flushed;
+}
+
+void ColumnFamilyDB::flush() {
+    std::shared_lock<std::shared_mutex> families_lock(families_mutex_);
+    std::lock_guard<std::mutex> lock(write_mutex_);
+
+    // Background flushes in flight would make ours a no-op
+    for (const auto& [id, family] : families_) {
+        family.tree->wait_for_background_jobs();
+    }
+
+    // Writes still only in a memtable stay in the WAL
+    if (!flush_families()) {
+        logger_->error("Not every column family flushed, keeping the shared WAL");
+        return;
+    }
+    wal_->clear();
+    wal_entries_ = 0;
+}
+
+std::optional<LSMTree::Stats> ColumnFamilyDB::get_stats(uint32_t column_family) const {
+    std::shared_lock<std::shared_mutex> lock(families_mutex_);
+    LSMTree* tree = find_family(column_family);
+    if (!tree) {
+        return std::nullopt;
+    }
+    return tree->get_stats();
+}
+
+size_t ColumnFamilyDB::get_wal_entry_count() const {
+    std::lock_guard<std::mutex> lock(write_mutex_);
+    return wal_entries_;
+}
@@ -0,0 +1,136 @@
+#ifndef KVDB_COLUMNFAMILYDB_H
+#define KVDB_COLUMNFAMILYDB_H
+
+#include "LSMTree.h"
+#include "Logger.h"
+#include "WriteAheadLog.h"
+#include "WriteBatch.h"
+#include <string>
+#include <vector>
+#include <map>
+#include <memory>
+#include <optional>
+#include <mutex>
+#include <shared_mutex>
+
+/**
+ * Several LSM trees (column families) behind one shared WAL.
+ *
+ * Every family has its own memtable, LevelManager and configuration, stored under
+ * <db_dir>/<family name>. Writes are logged once to <db_dir>/wal.log tagged with their
+ * family id, so a WriteBatch touching several families recovers all or nothing.
+ *
+ * The shared WAL can only be cleared once no family holds unflushed data. When it grows
+ * past max_wal_entries, every family with unflushed data is flushed so it can be cleared.
+ * Recovery replays the whole log into each family. Entries already flushed are replayed
+ * as well, which is harmless since the log holds every write since it was last cleared.
+ */
+class ColumnFamilyDB {
+public:
+    static constexpr uint32_t DEFAULT_COLUMN_FAMILY = 0;
+
+    struct ColumnFamilyDescriptor {
+        std::string name;
+        LSMTree::Config config;
+    };
+
+    /**
+     * Open or create a database
+     * @param families Families to open with their configs, "default" is added if missing.
+     *                 Families found on disk but not listed are opened with a default config,
+     *                 ones with an invalid name are logged and skipped
+     * @param max_wal_entries WAL entries before unflushed families are forced to flush
+     * @param env file system for the WAL, the manifest and every family, nullptr for Env::default_env()
+     */
+    explicit ColumnFamilyDB(const std::string& db_dir,
+                            const std::vector<ColumnFamilyDescriptor>& families = {},
+                            size_t max_wal_entries = 100000,
+                            std::shared_ptr<Env> env = nullptr);
+
+    ~ColumnFamilyDB();
+
+    // No copying
+    ColumnFamilyDB(const ColumnFamilyDB&) = delete;
+    ColumnFamilyDB& operator=(const ColumnFamilyDB&) = delete;
+
+    /**
+     * Create a family at runtime
+     * @return Its id, or nullopt if the name is taken or invalid (empty, starting with a dot,
+     *         holding a path separator or whitespace, or naming one of the database's files)
+     */
+    std::optional<uint32_t> create_column_family(const ColumnFamilyDescriptor& descriptor);
+
+    /**
+     * Look up a family id by name
+     */
+    std::optional<uint32_t> column_family_id(const std::string& name) const;
+
+    std::vector<std::string> list_column_families() const;
+
+    bool put(uint32_t column_family, const std::string& key, const std::string& value);
+    bool remove(uint32_t column_family, const std::string& key);
+    std::optional<std::string> get(uint32_t column_family, const std::string& key);
+    std::vector<std::pair<std::string, std::string>>
+        scan(uint32_t column_family, const std::string& start_key, const std::string& end_key);
+
+    /**
+     * Apply a batch whose operations may target several families
+     * @return false if a family doesn't exist or the WAL write failed, nothing is applied then
+     */
+    bool write(const WriteBatch& batch);
+
+    /**
+     * Flush every family's memtable and clear the shared WAL, which is kept if any family
+     * still holds unflushed data afterwards
+     */
+    void flush();
+
+    /**
+     * Statistics of one family, nullopt if it doesn't exist
+     */
+    std::optional<LSMTree::Stats> get_stats(uint32_t column_family) const;
+
+    size_t get_wal_entry_count() const;
+
+private:
+    struct ColumnFamily {
+        std::string name;
+        std::unique_ptr<LSMTree> tree;
+    };
+
+    // Families by id, and ids by name, persisted in <db_dir>/column_families
+    std::map<uint32_t, ColumnFamily> families_;
+    std::map<std::string, uint32_t> ids_;
+    uint32_t next_id_ = 1;
+    mutable std::shared_mutex families_mutex_;  // exclusive only to add a family
+
+    std::string db_dir_;
+    std::shared_ptr<Env> env_;
+    std::shared_ptr<Logger> logger_;  // writes <db_dir>/LOG, shared with families that don't bring their own
+    std::unique_ptr<WriteAheadLog> wal_;
+    size_t wal_entries_ = 0;
+    size_t max_wal_entries_;
+    mutable std::mutex write_mutex_;  // one writer at a time on the shared WAL
+
+    // Manifest of family ids and names
+    std::map<uint32_t, std::string> load_manifest() const;
+    bool save_manifest() const;
+
+    // Open a family's tree, caller holds families_mutex_ exclusively
+    void open_family(uint32_t id, const std::string& name, const LSMTree::Config& config);
+
+    // Family tree or nullptr, caller holds families_mutex_
+    LSMTree* find_family(uint32_t id) const;
+
+    // Replay the shared WAL into the families
+    void recover_from_wal();
+
+    // Clear the WAL when nothing unflushed depends on it, caller holds write_mutex_
+    void maybe_clear_wal();
+
+    // Flush every family with unflushed data, true if all memtables are empty afterwards,
+    // caller holds write_mutex_
+    bool flush_families();
+};
+
+#endif // KVDB_COLUMNFAMILYDB_H
@@ -0,0 +1,93 @@
+#include "CompactionStats.h"
+#include <iomanip>
+#include <sstream>
+
+void CompactionStats::update_amplification() {
+    uint64_t total_bytes = 0;
+    uint64_t bytes_written = 0;
+    uint64_t last_level_bytes = 0;
+    size_t probes = 0;
+
+    for (const auto& level : levels) {
+        total_bytes += level.bytes;
+        bytes_written += level.bytes_written;
+        probes += level.max_overlap;
+        if (level.bytes > 0) {
+            last_level_bytes = level.bytes;
+        }
+    }
+
+    write_amplification = bytes_flushed == 0 ? 0.0
+        : static_cast<double>(bytes_written) / static_cast<double>(bytes_flushed);
+    read_amplification = static_cast<double>(probes);
+    space_amplification = last_level_bytes == 0 ? 0.0
+        : static_cast<double>(total_bytes) / static_cast<double>(last_level_bytes);
+}
+
+std::string CompactionStats::to_string() const {
+    std::ostringstream out;
+    out << std::fixed << std::setprecision(1);
+
+    auto kb = [](uint64_t bytes) { return static_cast<double>(bytes) / 1024.0; };
+
+    out << std::left << std::setw(7) << "Level" << std::right
+        << std::setw(7) << "Files" << std::setw(11) << "Size(KB)" << std::setw(9) << "Overlap"
+        << std::setw(7) << "Comp" << std::setw(11) << "Read(KB)" << std::setw(11) << "Write(KB)"
+        << std::setw(7) << "W-Amp" << std::setw(10) << "KeysIn" << std::setw(10) << "KeysOut"
+        << std::setw(8) << "Tomb" << std::setw(8) << "Dup" << std::setw(10) << "Time(ms)" << "\n";
+
+    LevelCompactionStats sum;
+    auto row = [&](const std::string& name, const LevelCompactionStats& level, double amp) {
+        out << std::left << std::setw(7) << name << std::right
+            << std::setw(7) << level.files << std::setw(11) << kb(level.bytes) << std::setw(9) << level.max_overlap
+            << std::setw(7) << level.compactions << std::setw(11) << kb(level.bytes_read)
+            << std::setw(11) << kb(level.bytes_written) << std::setw(7) << amp
+            << std::setw(10) << level.keys_in << std::setw(10) << level.keys_out
+            << std::setw(8) << level.tombstones_dropped << std::setw(8) << level.duplicates_dropped
+            << std::setw(10) << level.duration_us / 1000.0 << "\n";
+    };
+
+    for (size_t i = 0; i < levels.size(); i++) {
+        const auto& level = levels[i];
+        if (level.files == 0 && level.compactions == 0) {
+            continue;
+        }
+        // Level 0 is written by flushes, which read nothing from disk
+        double amp = i == 0 ? (level.bytes_written > 0 ? 1.0 : 0.0)
+            : level.bytes_read == 0 ? 0.0 : static_cast<double>(level.bytes_written) / static_cast<double>(level.bytes_read);
+        row("L" + std::to_string(i), level, amp);
+
+        sum.files += level.files;
+        sum.bytes += level.bytes;
+        sum.max_overlap += level.max_overlap;
+        sum.compactions += level.compactions;
+        sum.bytes_read += level.bytes_read;
+        sum.bytes_written += level.bytes_written;
+        sum.keys_in += level.keys_in;
+        sum.keys_out += level.keys_out;
+        sum.tombstones_dropped += level.tombstones_dropped;
+        sum.duplicates_dropped += level.duplicates_dropped;
+        sum.duration_us += level.duration_us;
+    }
+    row("Sum", sum, write_amplification);
+
+    out << std::setprecision(2)
+        << "\nWrite amplification: " << write_amplification
+        << "\nRead amplification:  " << read_amplification
+        << "\nSpace amplification: " << space_amplification << "\n";
+
+    if (!recent.empty()) {
+        out << std::setprecision(1) << "\nRecent compactions:\n";
+        for (const auto& record : recent) {
+            out << "  L" << record.source_level << " -> L" << record.target_level << ": "
+                << record.input_files << " files (" << kb(record.input_bytes) << " KB) -> "
+                << record.output_files << " files (" << kb(record.output_bytes) << " KB), keys "
+                << record.keys_in << " -> " << record.keys_out << ", "
+                << record.tombstones_dropped << " tombstones and "
+                << record.duplicates_dropped << " duplicates dropped, "
+                << record.duration_us / 1000.0 << " ms\n";
+        }
+    }
+
+    return out.str();
+}
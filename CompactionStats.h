@@ -0,0 +1,77 @@
+#ifndef KVDB_COMPACTIONSTATS_H
+#define KVDB_COMPACTIONSTATS_H
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+/**
+ * One finished compaction. Bytes are on-disk SSTable sizes
+ */
+struct CompactionRecord {
+    int source_level = 0;
+    int target_level = 0;
+    size_t input_files = 0;
+    size_t output_files = 0;
+    uint64_t input_bytes = 0;
+    uint64_t output_bytes = 0;
+    uint64_t keys_in = 0;
+    uint64_t keys_out = 0;
+    uint64_t tombstones_dropped = 0;
+    uint64_t duplicates_dropped = 0;
+    uint64_t duration_us = 0;
+
+    // Bytes written per byte read
+    double write_amplification() const {
+        return input_bytes == 0 ? 0.0 : static_cast<double>(output_bytes) / static_cast<double>(input_bytes);
+    }
+};
+
+/**
+ * Live layout of one level and the work done writing into it. Level 0 is written by
+ * memtable flushes, deeper levels by compactions from the level above
+ */
+struct LevelCompactionStats {
+    size_t files = 0;                // live SSTables
+    uint64_t bytes = 0;              // ... and their on-disk size
+    size_t max_overlap = 0;          // most SSTables a point lookup may probe in this level
+
+    size_t compactions = 0;          // flushes for level 0
+    size_t files_in = 0;
+    size_t files_out = 0;
+    uint64_t bytes_read = 0;
+    uint64_t bytes_written = 0;
+    uint64_t keys_in = 0;
+    uint64_t keys_out = 0;
+    uint64_t tombstones_dropped = 0;
+    uint64_t duplicates_dropped = 0;
+    uint64_t duration_us = 0;
+};
+
+/**
+ * Per level compaction totals since the engine was opened, the most recent compactions,
+ * and the amplification they add up to:
+ *
+ *  - write: bytes written by flushes and compactions per byte flushed
+ *  - read: SSTables a point lookup may probe, level 0 files plus the worst overlap below
+ *  - space: on-disk bytes per byte in the last non-empty level, which holds the most
+ *    compacted copy of the data
+ */
+struct CompactionStats {
+    std::vector<LevelCompactionStats> levels;
+    std::vector<CompactionRecord> recent;  // oldest first
+    uint64_t bytes_flushed = 0;
+
+    double write_amplification = 0.0;
+    double read_amplification = 0.0;
+    double space_amplification = 0.0;
+
+    // Compute the amplification fields from levels and bytes_flushed
+    void update_amplification();
+
+    // Level table followed by the recent compactions, for the CLI
+    std::string to_string() const;
+};
+
+#endif // KVDB_COMPACTIONSTATS_H
@@ -1,240 +1,176 @@
 #include "Compactor.h"
 #include <algorithm>
 #include <queue>
-#include <fstream>
 #include <iostream>
 #include <chrono>
 #include <cstring>
-#include <sys/stat.h>  // For file timestamps
-
-namespace {
-    // Helper to check if a value is a tombstone
-    bool is_tombstone(const std::string& value) {
-        return value.empty(); // Empty string represents tombstone
-    }
-}
+#include <atomic>
 
 Compactor::Compactor(std::shared_ptr<BufferPool> buffer_pool, const Config& config)
-    : buffer_pool_(buffer_pool), config_(config) {}
+    : buffer_pool_(buffer_pool), config_(config),
+      logger_(config.logger ? config.logger : Logger::stderr_logger()),
+      env_(config.table_options.env ? config.table_options.env : Env::default_env()) {}
 
 std::vector<std::shared_ptr<SSTableReader>> Compactor::compact(
     const std::vector<std::shared_ptr<SSTableReader>>& input_sstables,
     int target_level,
-    bool is_largest_level) {
+    bool is_largest_level,
+    Stats* job_stats) {
 
-    std::lock_guard<std::mutex> lock(stats_mutex_);
-    stats_.compactions_performed++;
-
-    std::cout << "Compacting " << input_sstables.size()
-              << " SSTables to level " << target_level
-              << (is_largest_level ? " (largest level)" : "") << std::endl;
+    Stats job;
+    job.compactions_performed = 1;
 
     // If only one SSTable and no filtering needed, just return it
+    std::vector<std::shared_ptr<SSTableReader>> output;
     if (input_sstables.size() == 1 && !is_largest_level) {
-        std::cout << "Single SSTable, no merging needed" << std::endl;
-        return input_sstables;
+        job.entries_read = job.entries_written = input_sstables[0]->size();
+        output = input_sstables;
+    } else {
+        // Perform the merge
+        output = merge_sstables(input_sstables, target_level, is_largest_level, job);
     }
 
-    // Perform the merge
-    return merge_sstables(input_sstables, target_level, is_largest_level);
+    add_job_stats(job);
+    if (job_stats) {
+        *job_stats = job;
+    }
+    return output;
 }
 
 std::vector<std::shared_ptr<SSTableReader>> Compactor::merge_sstables(
     const std::vector<std::shared_ptr<SSTableReader>>& sstables,
     int target_level,
-    bool is_largest_level) {
+    bool is_largest_level,
+    Stats& job) {
 
     if (sstables.empty()) {
         return {};
     }
 
-    // Generate output filename with timestamp
-    uint64_t timestamp = std::chrono::duration_cast<std::chrono::nanoseconds>(
-        std::chrono::system_clock::now().time_since_epoch()).count();
-    std::string output_filename = generate_output_filename(target_level, timestamp);
-
     // Perform multi-way merge
-    multiway_merge(sstables, output_filename, is_largest_level);
-
-    // Load and return the new SSTable
-    auto new_sstable = std::make_shared<SSTableReader>(output_filename);
-    if (!new_sstable->is_valid()) {
-        std::cerr << "Failed to load compacted SSTable: " << output_filename << std::endl;
-        return {};
+    auto output_filenames = multiway_merge(sstables, target_level, is_largest_level, job);
+
+    // Load and return the new SSTables
+    std::vector<std::shared_ptr<SSTableReader>> output;
+    for (const auto& filename : output_filenames) {
+        auto new_sstable = std::make_shared<SSTableReader>(filename, env_);
+        if (!new_sstable->is_valid()) {
+            logger_->error("Failed to load compacted SSTable: ", filename);
+            for (const auto& written : output_filenames) {
+                env_->remove_file(written);
+            }
+            return {};
+        }
+        output.push_back(new_sstable);
     }
 
-    std::cout << "Created compacted SSTable: " << output_filename
-              << " with " << new_sstable->size() << " entries" << std::endl;
-
-    return {new_sstable};
+    return output;
 }
 
-// Get file modification time in nanoseconds
-uint64_t Compactor::get_file_timestamp(const std::string& filename) const {
-    try {
-        // Use C++17 filesystem API
-        auto ftime = fs::last_write_time(filename);
-
-        // Convert to nanoseconds since epoch
-        auto s = std::chrono::time_point_cast<std::chrono::nanoseconds>(ftime);
-        return s.time_since_epoch().count();
-
-    } catch (const fs::filesystem_error& e) {
-        std::cerr << "Warning: Could not get timestamp for " << filename
-                  << ": " << e.what() << std::endl;
-
-        // Fallback: use current time
-        return std::chrono::duration_cast<std::chrono::nanoseconds>(
-            std::chrono::system_clock::now().time_since_epoch()).count();
-    }
-}
-
-void Compactor::multiway_merge(
+std::vector<std::string> Compactor::multiway_merge(
     const std::vector<std::shared_ptr<SSTableReader>>& sstables,
-    const std::string& output_filename,
-    bool is_largest_level) {
+    int target_level,
+    bool is_largest_level,
+    Stats& job) {
 
-    // Create iterators with timestamps
+    // One iterator per input, its position in the input list is its recency
     std::vector<std::unique_ptr<SSTableIterator>> iterators;
     iterators.reserve(sstables.size());
 
     for (size_t i = 0; i < sstables.size(); ++i) {
-        uint64_t timestamp = get_file_timestamp(sstables[i]->get_filename());
-        iterators.emplace_back(
-            std::make_unique<SSTableIterator>(sstables[i], timestamp));
+        iterators.emplace_back(std::make_unique<SSTableIterator>(sstables[i], i));
     }
 
     // Min-heap for merge (using greater for min-heap)
-    // Sorts by key, then by timestamp (newer files have higher priority)
+    // Sorts by key, then newest input first
     std::priority_queue<MergeEntry, std::vector<MergeEntry>, std::greater<MergeEntry>> heap;
 
     // Initialize heap with first entry from each iterator
-    for (size_t i = 0; i < iterators.size(); ++i) {
-        if (iterators[i]->has_next()) {
-            MergeEntry entry = iterators[i]->next();
-            entry.source_index = i;
-            heap.push(entry);
+    for (const auto& iterator : iterators) {
+        if (iterator->has_next()) {
+            heap.push(iterator->next());
         }
     }
 
-    // Use a temporary memtable to collect results
-    Memtable memtable(1024 * 1024 * 10); // 10MB temporary memtable
+    std::vector<std::string> output_filenames;
+    std::vector<std::pair<std::string, Memtable::Entry>> entries;
+    size_t pending_bytes = 0;
+
+    auto write_output = [&]() {
+        std::string filename = generate_output_filename(target_level);
+        if (!SSTableWriter::write(filename, entries, config_.table_options)) {
+            for (const auto& written : output_filenames) {
+                env_->remove_file(written);
+            }
+            throw std::runtime_error("Failed to write SSTable: " + filename);
+        }
+        output_filenames.push_back(filename);
+
+        uint64_t file_size = 0;
+        if (env_->get_file_size(filename, file_size)) {
+            job.bytes_written += file_size;
+        }
+        entries.clear();
+        pending_bytes = 0;
+    };
+
     std::string prev_key;
-    uint64_t prev_timestamp = 0;
     bool has_prev = false;
 
     while (!heap.empty()) {
         MergeEntry current = heap.top();
         heap.pop();
 
-        // Update read statistics
-        update_stats_read(current.key.size() + current.value.size());
-        stats_.entries_read++;
+        // Refill from the same iterator
+        auto& source = iterators[current.source_index];
+        if (source->has_next()) {
+            heap.push(source->next());
+        }
 
-        // Check if we should skip this entry
-        if (!should_keep_entry(current, is_largest_level)) {
-            if (current.is_deleted) {
-                stats_.tombstones_removed++;
-            }
+        // Update read statistics
+        job.bytes_read += current.key.size() + current.value.size();
+        job.entries_read++;
 
-            // Get next entry from the same iterator
-            if (iterators[current.source_index]->has_next()) {
-                MergeEntry next_entry = iterators[current.source_index]->next();
-                next_entry.source_index = current.source_index;
-                heap.push(next_entry);
-            }
+        // The newest version of a key pops first, older ones are shadowed by it
+        if (has_prev && current.key == prev_key) {
+            job.duplicates_removed++;
             continue;
         }
+        prev_key = current.key;
+        has_prev = true;
 
-        // Handle duplicates (same key)
-        if (has_prev && current.key == prev_key) {
-            // Same key as previous entry
-            // Keep the one with higher timestamp (newer file)
-
-            if (current.timestamp > prev_timestamp) {
-                // Current is newer, replace previous
-                // Remove previous from memtable
-                if (!memtable.remove(prev_key)) {
-                    // Key might not exist yet (if previous was just in buffer)
-                }
-
-                // Add current to memtable
-                if (current.is_deleted) {
-                    memtable.remove(current.key);
-                } else {
-                    memtable.put(current.key, current.value);
-                }
-
-                prev_timestamp = current.timestamp;
-                stats_.duplicates_removed++;
-
-            } else {
-                // Previous is newer, skip current
-                stats_.duplicates_removed++;
-
-                // Get next entry from the same iterator
-                if (iterators[current.source_index]->has_next()) {
-                    MergeEntry next_entry = iterators[current.source_index]->next();
-                    next_entry.source_index = current.source_index;
-                    heap.push(next_entry);
-                }
-                continue;
-            }
-
-        } else {
-            // New key
-            if (has_prev) {
-                // Add previous to memtable
-                // (We buffer one entry to handle duplicates)
-                // Actually, we add immediately for simplicity
-            }
-
-            // Add current to memtable
-            if (current.is_deleted) {
-                memtable.remove(current.key);
-            } else {
-                memtable.put(current.key, current.value);
-            }
-
-            prev_key = current.key;
-            prev_timestamp = current.timestamp;
-            has_prev = true;
-            stats_.entries_written++;
+        // A dropped tombstone still shadows the older versions skipped above
+        if (!should_keep_entry(current, is_largest_level)) {
+            job.tombstones_removed++;
+            continue;
         }
 
-        // Get next entry from the same iterator
-        if (iterators[current.source_index]->has_next()) {
-            MergeEntry next_entry = iterators[current.source_index]->next();
-            next_entry.source_index = current.source_index;
-            heap.push(next_entry);
-        }
-    }
+        pending_bytes += current.key.size() + current.value.size();
+        entries.emplace_back(current.key, Memtable::Entry(current.value, current.is_deleted));
+        job.entries_written++;
 
-    // Write memtable to SSTable using your existing SSTableWriter
-    auto entries = memtable.get_all_entries();
-    if (!SSTableWriter::write(output_filename, entries)) {
-        throw std::runtime_error("Failed to write SSTable: " + output_filename);
+        if (config_.target_file_size > 0 && pending_bytes >= config_.target_file_size) {
+            write_output();
+        }
     }
 
-    // Update written bytes statistics
-    std::ifstream in_file(output_filename, std::ios::binary | std::ios::ate);
-    if (in_file) {
-        size_t file_size = in_file.tellg();
-        update_stats_written(file_size);
+    // Everything cancelled out still leaves one empty table for a plain merge
+    if (!entries.empty() || output_filenames.empty()) {
+        write_output();
     }
 
-    std::cout << "Merge completed: " << stats_.entries_written
-              << " entries written, " << stats_.tombstones_removed
-              << " tombstones removed, " << stats_.duplicates_removed
-              << " duplicates removed" << std::endl;
+    logger_->debug("Merged ", sstables.size(), " SSTables into ", output_filenames.size(), " files: ",
+                   job.entries_written, " entries written, ", job.tombstones_removed, " tombstones and ",
+                   job.duplicates_removed, " duplicates removed");
+    return output_filenames;
 }
 
 // SSTableIterator Implementation
 Compactor::SSTableIterator::SSTableIterator(
     std::shared_ptr<SSTableReader> sstable,
-    uint64_t timestamp)
+    size_t source_index)
     : sstable_(sstable),
-      timestamp_(timestamp),
+      source_index_(source_index),
       current_index_(0),
       eof_(false) {
 
@@ -253,7 +189,7 @@ Compactor::MergeEntry Compactor::SSTableIterator::next() {
     MergeEntry entry;
     const std::string& key = all_keys_[current_index_];
     entry.key = key;
-    entry.timestamp = timestamp_;
+    entry.source_index = source_index_;
 
     // Check if deleted
     entry.is_deleted = sstable_->is_deleted(key);
@@ -283,10 +219,17 @@ Compactor::Stats Compactor::get_stats() const {
     return stats_;
 }
 
-std::string Compactor::generate_output_filename(int target_level, uint64_t timestamp) {
-    // Create a temporary filename with timestamp
+std::string Compactor::generate_output_filename(int target_level) {
+    if (config_.output_filename) {
+        return config_.output_filename(target_level);
+    }
+
+    // Create a temporary filename with timestamp, the counter keeps split outputs apart
+    static std::atomic<uint64_t> counter{0};
+    uint64_t timestamp = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
     return "./temp_compact_level" + std::to_string(target_level) +
-           "_" + std::to_string(timestamp) + ".sst";
+           "_" + std::to_string(timestamp) + "_" + std::to_string(counter++) + ".sst";
 }
 
 bool Compactor::should_keep_entry(const MergeEntry& entry, bool is_largest_level) {
@@ -304,10 +247,13 @@ bool Compactor::should_keep_entry(const MergeEntry& entry, bool is_largest_level
     return !is_largest_level;
 }
 
-void Compactor::update_stats_read(size_t bytes) {
-    stats_.bytes_read += bytes;
-}
-
-void Compactor::update_stats_written(size_t bytes) {
-    stats_.bytes_written += bytes;
+void Compactor::add_job_stats(const Stats& job) {
+    std::lock_guard<std::mutex> lock(stats_mutex_);
+    stats_.compactions_performed += job.compactions_performed;
+    stats_.entries_read += job.entries_read;
+    stats_.entries_written += job.entries_written;
+    stats_.tombstones_removed += job.tombstones_removed;
+    stats_.duplicates_removed += job.duplicates_removed;
+    stats_.bytes_read += job.bytes_read;
+    stats_.bytes_written += job.bytes_written;
 }
\ No newline at end of file
@@ -4,6 +4,7 @@
 #include "SSTableReader.h"
 #include "SSTableWriter.h"
 #include "BufferPool.h"
+#include "Logger.h"
 #include <vector>
 #include <memory>
 #include <string>
@@ -20,6 +21,10 @@ public:
         size_t buffer_size;
         size_t max_merge_fan_in;
         bool remove_tombstones;
+        SSTableWriter::Options table_options;  // meta blocks for output SSTables, and the env they go to
+        std::shared_ptr<Logger> logger;        // nullptr logs warnings and errors to stderr
+        size_t target_file_size = 0;           // start a new output SSTable past this many bytes, 0 writes one
+        std::function<std::string(int)> output_filename;  // name for the next output in a level, nullptr for a temp file
 
         Config(
             size_t buffer_size_ = 4096,
@@ -35,12 +40,6 @@ public:
     // Constructor
     Compactor(std::shared_ptr<BufferPool> buffer_pool, const Config& config = Config());
 
-    // Compact multiple SSTables into one or more new SSTables
-    std::vector<std::shared_ptr<SSTableReader>> compact(
-        const std::vector<std::shared_ptr<SSTableReader>>& input_sstables,
-        int target_level,
-        bool is_largest_level);
-
     // Statistics
     struct Stats {
         size_t compactions_performed = 0;
@@ -52,6 +51,15 @@ public:
         size_t bytes_written = 0;
     };
 
+    // Compact multiple SSTables into one or more new SSTables, outputs sorted by key and disjoint
+    // Inputs are ordered oldest first, so for a key in several inputs the last one wins
+    // job_stats, when given, receives the counters of this compaction alone
+    std::vector<std::shared_ptr<SSTableReader>> compact(
+        const std::vector<std::shared_ptr<SSTableReader>>& input_sstables,
+        int target_level,
+        bool is_largest_level,
+        Stats* job_stats = nullptr);
+
     Stats get_stats() const;
 
 private:
@@ -60,20 +68,19 @@ private:
         std::string key;
         std::string value;
         bool is_deleted;
-        uint64_t timestamp;         // File modification time as sequence
-        size_t source_index;        // Which SSTable it came from
+        size_t source_index;        // Which SSTable it came from, a higher index is newer
 
-        // For min-heap comparison: sort by key, then by timestamp (newer first)
+        // For min-heap comparison: sort by key, then newer source first
         bool operator>(const MergeEntry& other) const {
             if (key != other.key) return key > other.key;
-            return timestamp < other.timestamp;  // Older (smaller timestamp) comes first
+            return source_index < other.source_index;
         }
     };
 
     // Iterator for reading from SSTable
     class SSTableIterator {
     public:
-        SSTableIterator(std::shared_ptr<SSTableReader> sstable, uint64_t timestamp);
+        SSTableIterator(std::shared_ptr<SSTableReader> sstable, size_t source_index);
 
         bool has_next() const;
         MergeEntry next();
@@ -81,7 +88,7 @@ private:
 
     private:
         std::shared_ptr<SSTableReader> sstable_;
-        uint64_t timestamp_;
+        size_t source_index_;
         size_t current_index_;
         std::vector<std::string> all_keys_;
         bool eof_;
@@ -90,6 +97,8 @@ private:
     // Configuration
     std::shared_ptr<BufferPool> buffer_pool_;
     Config config_;
+    std::shared_ptr<Logger> logger_;
+    std::shared_ptr<Env> env_;
 
     // Statistics
     mutable Stats stats_;
@@ -99,22 +108,20 @@ private:
     std::vector<std::shared_ptr<SSTableReader>> merge_sstables(
         const std::vector<std::shared_ptr<SSTableReader>>& sstables,
         int target_level,
-        bool is_largest_level);
+        bool is_largest_level,
+        Stats& job);
 
-    // Multi-way merge using min-heap and file timestamps
-    void multiway_merge(
+    // Multi-way merge using a min-heap, returns the files written
+    std::vector<std::string> multiway_merge(
         const std::vector<std::shared_ptr<SSTableReader>>& sstables,
-        const std::string& output_filename,
-        bool is_largest_level);
-
-    // Get file modification time as timestamp (nanoseconds since epoch)
-    uint64_t get_file_timestamp(const std::string& filename) const;
+        int target_level,
+        bool is_largest_level,
+        Stats& job);
 
     // Helper methods
-    std::string generate_output_filename(int target_level, uint64_t timestamp);
+    std::string generate_output_filename(int target_level);
     bool should_keep_entry(const MergeEntry& entry, bool is_largest_level);
-    void update_stats_read(size_t bytes);
-    void update_stats_written(size_t bytes);
+    void add_job_stats(const Stats& job);
 };
 
 #endif // COMPACTOR_H
\ No newline at end of file
@@ -0,0 +1,472 @@
+#include "Env.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <filesystem>
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace fs = std::filesystem;
+
+namespace {
+    constexpr size_t STREAM_BUFFER_SIZE = 64 * 1024;
+    constexpr size_t WRITE_BUFFER_SIZE = 64 * 1024;
+
+    // Write all of data, retrying short writes and interrupts
+    bool write_fully(int fd, const char* data, size_t n) {
+        while (n > 0) {
+            ssize_t written = ::write(fd, data, n);
+            if (written < 0) {
+                if (errno == EINTR) continue;
+                return false;
+            }
+            data += written;
+            n -= static_cast<size_t>(written);
+        }
+        return true;
+    }
+
+    bool pread_fully(int fd, uint64_t offset, size_t n, char* scratch, size_t& bytes_read) {
+        bytes_read = 0;
+        while (bytes_read < n) {
+            ssize_t got = ::pread(fd, scratch + bytes_read, n - bytes_read, static_cast<off_t>(offset + bytes_read));
+            if (got < 0) {
+                if (errno == EINTR) continue;
+                return false;
+            }
+            if (got == 0) {
+                break;  // end of file
+            }
+            bytes_read += static_cast<size_t>(got);
+        }
+        return true;
+    }
+
+    class PosixSequentialFile : public SequentialFile {
+    public:
+        explicit PosixSequentialFile(int fd) : fd_(fd) {}
+        ~PosixSequentialFile() override { ::close(fd_); }
+
+        bool read(size_t n, char* scratch, size_t& bytes_read) override {
+            bytes_read = 0;
+            while (bytes_read < n) {
+                ssize_t got = ::read(fd_, scratch + bytes_read, n - bytes_read);
+                if (got < 0) {
+                    if (errno == EINTR) continue;
+                    return false;
+                }
+                if (got == 0) {
+                    break;
+                }
+                bytes_read += static_cast<size_t>(got);
+            }
+            return true;
+        }
+
+        bool skip(uint64_t n) override {
+            return ::lseek(fd_, static_cast<off_t>(n), SEEK_CUR) >= 0;
+        }
+
+    private:
+        int fd_;
+    };
+
+    class PosixRandomAccessFile : public RandomAccessFile {
+    public:
+        PosixRandomAccessFile(int fd, uint64_t size) : fd_(fd), size_(size) {}
+        ~PosixRandomAccessFile() override { ::close(fd_); }
+
+        bool read(uint64_t offset, size_t n, char* scratch, size_t& bytes_read) const override {
+            return pread_fully(fd_, offset, n, scratch, bytes_read);
+        }
+
+        uint64_t size() const override { return size_; }
+
+    private:
+        int fd_;
+        uint64_t size_;
+    };
+
+    // Buffers appends in user space so many small writes become one system call
+    class PosixWritableFile : public WritableFile {
+    public:
+        PosixWritableFile(int fd, uint64_t size) : fd_(fd), size_(size) {
+            buffer_.reserve(WRITE_BUFFER_SIZE);
+        }
+
+        ~PosixWritableFile() override { close(); }
+
+        bool append(const char* data, size_t n) override {
+            if (fd_ < 0) return false;
+            size_ += n;
+            if (buffer_.size() + n <= WRITE_BUFFER_SIZE) {
+                buffer_.append(data, n);
+                return true;
+            }
+            return flush() && write_fully(fd_, data, n);
+        }
+
+        bool flush() override {
+            if (fd_ < 0) return false;
+            bool ok = write_fully(fd_, buffer_.data(), buffer_.size());
+            buffer_.clear();
+            return ok;
+        }
+
+        bool sync() override {
+            return flush() && ::fsync(fd_) == 0;
+        }
+
+        bool close() override {
+            if (fd_ < 0) return true;
+            bool ok = flush();
+            ok = ::close(fd_) == 0 && ok;
+            fd_ = -1;
+            return ok;
+        }
+
+        uint64_t size() const override { return size_; }
+
+    private:
+        int fd_;
+        uint64_t size_;
+        std::string buffer_;
+    };
+
+    class PosixRandomRWFile : public RandomRWFile {
+    public:
+        explicit PosixRandomRWFile(int fd) : fd_(fd) {}
+        ~PosixRandomRWFile() override { ::close(fd_); }
+
+        bool write(uint64_t offset, const char* data, size_t n) override {
+            while (n > 0) {
+                ssize_t written = ::pwrite(fd_, data, n, static_cast<off_t>(offset));
+                if (written < 0) {
+                    if (errno == EINTR) continue;
+                    return false;
+                }
+                data += written;
+                offset += static_cast<uint64_t>(written);
+                n -= static_cast<size_t>(written);
+            }
+            return true;
+        }
+
+        bool read(uint64_t offset, size_t n, char* scratch, size_t& bytes_read) const override {
+            return pread_fully(fd_, offset, n, scratch, bytes_read);
+        }
+
+        bool sync() override { return ::fsync(fd_) == 0; }
+
+        uint64_t size() const override {
+            struct stat st {};
+            return ::fstat(fd_, &st) == 0 ? static_cast<uint64_t>(st.st_size) : 0;
+        }
+
+    private:
+        int fd_;
+    };
+
+    class PosixFileLock : public FileLock {
+    public:
+        explicit PosixFileLock(int fd) : fd_(fd) {}
+        ~PosixFileLock() override {
+            ::flock(fd_, LOCK_UN);
+            ::close(fd_);
+        }
+
+    private:
+        int fd_;
+    };
+
+    class PosixEnv : public Env {
+    public:
+        std::unique_ptr<SequentialFile> new_sequential_file(const std::string& path) override {
+            int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+            if (fd < 0) return nullptr;
+            return std::make_unique<PosixSequentialFile>(fd);
+        }
+
+        std::unique_ptr<RandomAccessFile> new_random_access_file(const std::string& path) override {
+            int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+            if (fd < 0) return nullptr;
+            struct stat st {};
+            if (::fstat(fd, &st) != 0) {
+                ::close(fd);
+                return nullptr;
+            }
+            return std::make_unique<PosixRandomAccessFile>(fd, static_cast<uint64_t>(st.st_size));
+        }
+
+        std::unique_ptr<WritableFile> new_writable_file(const std::string& path) override {
+            int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+            if (fd < 0) return nullptr;
+            return std::make_unique<PosixWritableFile>(fd, 0);
+        }
+
+        std::unique_ptr<WritableFile> new_appendable_file(const std::string& path) override {
+            int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+            if (fd < 0) return nullptr;
+            struct stat st {};
+            ::fstat(fd, &st);
+            return std::make_unique<PosixWritableFile>(fd, static_cast<uint64_t>(st.st_size));
+        }
+
+        std::unique_ptr<RandomRWFile> new_random_rw_file(const std::string& path) override {
+            int fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+            if (fd < 0) return nullptr;
+            return std::make_unique<PosixRandomRWFile>(fd);
+        }
+
+        bool file_exists(const std::string& path) override {
+            return ::access(path.c_str(), F_OK) == 0;
+        }
+
+        bool get_file_size(const std::string& path, uint64_t& size) override {
+            struct stat st {};
+            if (::stat(path.c_str(), &st) != 0) return false;
+            size = static_cast<uint64_t>(st.st_size);
+            return true;
+        }
+
+        bool get_modification_time(const std::string& path, uint64_t& nanos) override {
+            struct stat st {};
+            if (::stat(path.c_str(), &st) != 0) return false;
+            nanos = static_cast<uint64_t>(st.st_mtim.tv_sec) * 1000000000ULL + static_cast<uint64_t>(st.st_mtim.tv_nsec);
+            return true;
+        }
+
+        bool get_children(const std::string& dir, std::vector<std::string>& names) override {
+            names.clear();
+            std::error_code ec;
+            for (fs::directory_iterator it(dir, ec), end; !ec && it != end; it.increment(ec)) {
+                names.push_back(it->path().filename().string());
+            }
+            return !ec;
+        }
+
+        bool create_dirs(const std::string& dir) override {
+            std::error_code ec;
+            fs::create_directories(dir, ec);
+            return !ec;
+        }
+
+        bool remove_file(const std::string& path) override {
+            return ::unlink(path.c_str()) == 0;
+        }
+
+        bool remove_dir_all(const std::string& dir) override {
+            std::error_code ec;
+            fs::remove_all(dir, ec);
+            return !ec;
+        }
+
+        bool rename_file(const std::string& from, const std::string& to) override {
+            return ::rename(from.c_str(), to.c_str()) == 0;
+        }
+
+        std::unique_ptr<FileLock> lock_file(const std::string& path) override {
+            int fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+            if (fd < 0) return nullptr;
+            // flock locks belong to the open file, so a second open in this process is refused too
+            if (::flock(fd, LOCK_EX | LOCK_NB) != 0) {
+                ::close(fd);
+                return nullptr;
+            }
+            return std::make_unique<PosixFileLock>(fd);
+        }
+    };
+}
+
+std::shared_ptr<Env> Env::default_env() {
+    static auto env = std::make_shared<PosixEnv>();
+    return env;
+}
+
+bool Env::read_file(const std::string& path, std::string& contents) {
+    auto file = new_random_access_file(path);
+    if (!file) {
+        return false;
+    }
+    contents.resize(file->size());
+    size_t bytes_read = 0;
+    if (!file->read(0, contents.size(), contents.data(), bytes_read)) {
+        return false;
+    }
+    contents.resize(bytes_read);
+    return true;
+}
+
+bool Env::write_file_atomic(const std::string& path, const std::string& contents) {
+    std::string temp_path = path + ".tmp";
+    auto file = new_writable_file(temp_path);
+    if (!file || !file->append(contents) || !file->sync() || !file->close()) {
+        remove_file(temp_path);
+        return false;
+    }
+    return rename_file(temp_path, path);
+}
+
+EnvInputStream::Buffer::Buffer(std::unique_ptr<RandomAccessFile> file)
+    : file_(std::move(file)), buffer_(STREAM_BUFFER_SIZE) {
+    setg(buffer_.data(), buffer_.data(), buffer_.data());
+}
+
+EnvInputStream::Buffer::int_type EnvInputStream::Buffer::underflow() {
+    if (!file_) {
+        return traits_type::eof();
+    }
+    buffer_offset_ += static_cast<uint64_t>(gptr() - eback());
+    size_t bytes_read = 0;
+    if (!file_->read(buffer_offset_, buffer_.size(), buffer_.data(), bytes_read) || bytes_read == 0) {
+        setg(buffer_.data(), buffer_.data(), buffer_.data());
+        return traits_type::eof();
+    }
+    setg(buffer_.data(), buffer_.data(), buffer_.data() + bytes_read);
+    return traits_type::to_int_type(*gptr());
+}
+
+std::streamsize EnvInputStream::Buffer::xsgetn(char* s, std::streamsize n) {
+    std::streamsize copied = 0;
+
+    // Whatever is buffered first
+    std::streamsize available = egptr() - gptr();
+    if (available > 0) {
+        copied = std::min(available, n);
+        std::memcpy(s, gptr(), static_cast<size_t>(copied));
+        gbump(static_cast<int>(copied));
+    }
+
+    // Large reads go straight into the caller's memory
+    if (n - copied >= static_cast<std::streamsize>(buffer_.size()) && file_) {
+        uint64_t offset = buffer_offset_ + static_cast<uint64_t>(gptr() - eback());
+        size_t bytes_read = 0;
+        if (!file_->read(offset, static_cast<size_t>(n - copied), s + copied, bytes_read)) {
+            return copied;
+        }
+        copied += static_cast<std::streamsize>(bytes_read);
+        buffer_offset_ = offset + bytes_read;
+        setg(buffer_.data(), buffer_.data(), buffer_.data());
+        return copied;
+    }
+
+    while (copied < n && underflow() != traits_type::eof()) {
+        std::streamsize chunk = std::min(egptr() - gptr(), n - copied);
+        std::memcpy(s + copied, gptr(), static_cast<size_t>(chunk));
+        gbump(static_cast<int>(chunk));
+        copied += chunk;
+    }
+    return copied;
+}
+
+EnvInputStream::Buffer::pos_type EnvInputStream::Buffer::seekoff(off_type off, std::ios_base::seekdir dir,
+                                                                  std::ios_base::openmode which) {
+    if (!file_ || !(which & std::ios_base::in)) {
+        return pos_type(off_type(-1));
+    }
+    int64_t current = static_cast<int64_t>(buffer_offset_) + (gptr() - eback());
+    int64_t base = dir == std::ios_base::beg ? 0
+        : dir == std::ios_base::cur ? current
+        : static_cast<int64_t>(file_->size());
+    return seekpos(pos_type(base + off), which);
+}
+
+EnvInputStream::Buffer::pos_type EnvInputStream::Buffer::seekpos(pos_type pos, std::ios_base::openmode which) {
+    auto target = static_cast<int64_t>(pos);
+    if (!file_ || !(which & std::ios_base::in) || target < 0) {
+        return pos_type(off_type(-1));
+    }
+
+    // Stay in the buffered window when possible
+    int64_t window_start = static_cast<int64_t>(buffer_offset_);
+    int64_t window_end = window_start + (egptr() - eback());
+    if (target >= window_start && target <= window_end) {
+        setg(eback(), eback() + (target - window_start), egptr());
+    } else {
+        buffer_offset_ = static_cast<uint64_t>(target);
+        setg(buffer_.data(), buffer_.data(), buffer_.data());
+    }
+    return pos;
+}
+
+EnvInputStream::EnvInputStream(std::unique_ptr<RandomAccessFile> file)
+    : std::istream(nullptr), buffer_(std::move(file)) {
+    rdbuf(&buffer_);
+    if (!buffer_.is_open()) {
+        setstate(std::ios_base::failbit);
+    }
+}
+
+EnvOutputStream::Buffer::Buffer(std::unique_ptr<WritableFile> file)
+    : file_(std::move(file)), buffer_(STREAM_BUFFER_SIZE) {
+    setp(buffer_.data(), buffer_.data() + buffer_.size());
+}
+
+bool EnvOutputStream::Buffer::drain() {
+    if (!file_) {
+        return false;
+    }
+    size_t pending = static_cast<size_t>(pptr() - pbase());
+    bool ok = pending == 0 || file_->append(pbase(), pending);
+    setp(buffer_.data(), buffer_.data() + buffer_.size());
+    return ok;
+}
+
+EnvOutputStream::Buffer::int_type EnvOutputStream::Buffer::overflow(int_type c) {
+    if (!drain()) {
+        return traits_type::eof();
+    }
+    if (!traits_type::eq_int_type(c, traits_type::eof())) {
+        *pptr() = traits_type::to_char_type(c);
+        pbump(1);
+    }
+    return traits_type::not_eof(c);
+}
+
+std::streamsize EnvOutputStream::Buffer::xsputn(const char* s, std::streamsize n) {
+    if (n <= epptr() - pptr()) {
+        std::memcpy(pptr(), s, static_cast<size_t>(n));
+        pbump(static_cast<int>(n));
+        return n;
+    }
+    // Doesn't fit, hand over what is buffered and then the whole write
+    if (!drain() || !file_->append(s, static_cast<size_t>(n))) {
+        return 0;
+    }
+    return n;
+}
+
+int EnvOutputStream::Buffer::sync() {
+    return drain() && file_->flush() ? 0 : -1;
+}
+
+EnvOutputStream::EnvOutputStream(std::unique_ptr<WritableFile> file)
+    : std::ostream(nullptr), buffer_(std::move(file)) {
+    rdbuf(&buffer_);
+    if (!buffer_.is_open()) {
+        setstate(std::ios_base::failbit);
+    }
+}
+
+EnvOutputStream::~EnvOutputStream() {
+    close();
+}
+
+bool EnvOutputStream::sync() {
+    if (!buffer_.is_open() || closed_) {
+        return false;
+    }
+    flush();
+    return good() && buffer_.file()->sync();
+}
+
+bool EnvOutputStream::close() {
+    if (!buffer_.is_open() || closed_) {
+        return false;
+    }
+    closed_ = true;
+    flush();
+    return buffer_.file()->close() && good();
+}
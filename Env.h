@@ -0,0 +1,196 @@
+#ifndef KVDB_ENV_H
+#define KVDB_ENV_H
+
+#include <cstdint>
+#include <istream>
+#include <memory>
+#include <ostream>
+#include <streambuf>
+#include <string>
+#include <vector>
+
+/**
+ * File read front to back
+ */
+class SequentialFile {
+public:
+    virtual ~SequentialFile() = default;
+
+    /**
+     * Read up to n bytes, fewer only at the end of the file
+     * @return false on an I/O error
+     */
+    virtual bool read(size_t n, char* scratch, size_t& bytes_read) = 0;
+    virtual bool skip(uint64_t n) = 0;
+};
+
+/**
+ * File read at any offset, safe to share between threads
+ */
+class RandomAccessFile {
+public:
+    virtual ~RandomAccessFile() = default;
+
+    // Read up to n bytes at offset, fewer only at the end of the file
+    virtual bool read(uint64_t offset, size_t n, char* scratch, size_t& bytes_read) const = 0;
+    virtual uint64_t size() const = 0;
+};
+
+/**
+ * File written by appending. Data may sit in a buffer until flush(), and may sit in the
+ * OS until sync()
+ */
+class WritableFile {
+public:
+    virtual ~WritableFile() = default;
+
+    virtual bool append(const char* data, size_t n) = 0;
+    bool append(const std::string& data) { return append(data.data(), data.size()); }
+    virtual bool flush() = 0;
+    virtual bool sync() = 0;
+    virtual bool close() = 0;
+    virtual uint64_t size() const = 0;
+};
+
+/**
+ * File read and overwritten in place, for headers updated after the data they describe
+ */
+class RandomRWFile {
+public:
+    virtual ~RandomRWFile() = default;
+
+    virtual bool write(uint64_t offset, const char* data, size_t n) = 0;
+    virtual bool read(uint64_t offset, size_t n, char* scratch, size_t& bytes_read) const = 0;
+    virtual bool sync() = 0;
+    virtual uint64_t size() const = 0;
+};
+
+/**
+ * Held lock on a file, released when destroyed
+ */
+class FileLock {
+public:
+    virtual ~FileLock() = default;
+};
+
+/**
+ * Everything the engine needs from the operating system's file system.
+ *
+ * Env::default_env() goes to the local disk through POSIX calls, MemEnv keeps every file in
+ * memory. Components take a std::shared_ptr<Env> and fall back to default_env() when given
+ * nullptr. Methods report failure through their return value, factories return nullptr.
+ */
+class Env {
+public:
+    virtual ~Env() = default;
+
+    // Shared POSIX environment
+    static std::shared_ptr<Env> default_env();
+
+    virtual std::unique_ptr<SequentialFile> new_sequential_file(const std::string& path) = 0;
+    virtual std::unique_ptr<RandomAccessFile> new_random_access_file(const std::string& path) = 0;
+
+    // Create path, or truncate it if it exists
+    virtual std::unique_ptr<WritableFile> new_writable_file(const std::string& path) = 0;
+
+    // Open path to append to it, creating it if needed
+    virtual std::unique_ptr<WritableFile> new_appendable_file(const std::string& path) = 0;
+
+    // Open path in place, creating it empty if needed
+    virtual std::unique_ptr<RandomRWFile> new_random_rw_file(const std::string& path) = 0;
+
+    virtual bool file_exists(const std::string& path) = 0;
+    virtual bool get_file_size(const std::string& path, uint64_t& size) = 0;
+    virtual bool get_modification_time(const std::string& path, uint64_t& nanos) = 0;
+
+    // Names, not paths, of the files and directories directly in dir
+    virtual bool get_children(const std::string& dir, std::vector<std::string>& names) = 0;
+
+    virtual bool create_dirs(const std::string& dir) = 0;
+    virtual bool remove_file(const std::string& path) = 0;
+    virtual bool remove_dir_all(const std::string& dir) = 0;
+    virtual bool rename_file(const std::string& from, const std::string& to) = 0;
+
+    /**
+     * Take an exclusive lock on path, creating the file if needed
+     * @return nullptr if another process or Env user holds it
+     */
+    virtual std::unique_ptr<FileLock> lock_file(const std::string& path) = 0;
+
+    // Read the whole file into contents
+    bool read_file(const std::string& path, std::string& contents);
+
+    // Replace path with contents through a temp file and a rename, synced before the rename
+    bool write_file_atomic(const std::string& path, const std::string& contents);
+};
+
+/**
+ * std::istream over a RandomAccessFile, so binary parsers written against streams can read
+ * from any Env. Seeking within the buffered window doesn't touch the file
+ */
+class EnvInputStream : public std::istream {
+public:
+    // A null file leaves the stream failed
+    explicit EnvInputStream(std::unique_ptr<RandomAccessFile> file);
+
+private:
+    class Buffer : public std::streambuf {
+    public:
+        explicit Buffer(std::unique_ptr<RandomAccessFile> file);
+
+        bool is_open() const { return file_ != nullptr; }
+
+    protected:
+        int_type underflow() override;
+        std::streamsize xsgetn(char* s, std::streamsize n) override;
+        pos_type seekoff(off_type off, std::ios_base::seekdir dir, std::ios_base::openmode which) override;
+        pos_type seekpos(pos_type pos, std::ios_base::openmode which) override;
+
+    private:
+        std::unique_ptr<RandomAccessFile> file_;
+        std::vector<char> buffer_;
+        uint64_t buffer_offset_ = 0;  // file offset of eback()
+    };
+
+    Buffer buffer_;
+};
+
+/**
+ * std::ostream over a WritableFile, writes are gathered into large appends
+ */
+class EnvOutputStream : public std::ostream {
+public:
+    // A null file leaves the stream failed
+    explicit EnvOutputStream(std::unique_ptr<WritableFile> file);
+    ~EnvOutputStream() override;
+
+    // Flush the stream and sync the file
+    bool sync();
+
+    // Flush and close the file, the destructor closes it too
+    bool close();
+
+private:
+    class Buffer : public std::streambuf {
+    public:
+        explicit Buffer(std::unique_ptr<WritableFile> file);
+
+        bool is_open() const { return file_ != nullptr; }
+        bool drain();
+        WritableFile* file() { return file_.get(); }
+
+    protected:
+        int_type overflow(int_type c) override;
+        std::streamsize xsputn(const char* s, std::streamsize n) override;
+        int sync() override;
+
+    private:
+        std::unique_ptr<WritableFile> file_;
+        std::vector<char> buffer_;
+    };
+
+    Buffer buffer_;
+    bool closed_ = false;
+};
+
+#endif // KVDB_ENV_H
@@ -0,0 +1,70 @@
+#include "EventListener.h"
+
+EventNotifier::EventNotifier(std::vector<std::shared_ptr<EventListener>> listeners,
+                             std::shared_ptr<Logger> logger)
+    : listeners_(std::move(listeners)),
+      logger_(logger ? std::move(logger) : Logger::stderr_logger()) {
+    if (!listeners_.empty()) {
+        thread_ = std::thread(&EventNotifier::run, this);
+    }
+}
+
+EventNotifier::~EventNotifier() {
+    if (!thread_.joinable()) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    work_cv_.notify_one();
+    thread_.join();
+}
+
+void EventNotifier::notify(std::function<void(EventListener&)> event) {
+    if (!enabled()) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        queue_.push_back(std::move(event));
+    }
+    work_cv_.notify_one();
+}
+
+void EventNotifier::wait_idle() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    idle_cv_.wait(lock, [this] { return queue_.empty() && in_flight_ == 0; });
+}
+
+void EventNotifier::run() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+        work_cv_.wait(lock, [this] { return stopping_ || !queue_.empty(); });
+        if (queue_.empty()) {
+            return;  // stopping and drained
+        }
+
+        auto event = std::move(queue_.front());
+        queue_.pop_front();
+        in_flight_++;
+        lock.unlock();
+
+        // A throwing listener must not take the notifier down with it
+        for (const auto& listener : listeners_) {
+            try {
+                event(*listener);
+            } catch (const std::exception& e) {
+                logger_->error("Event listener threw: ", e.what());
+            } catch (...) {
+                logger_->error("Event listener threw an unknown exception");
+            }
+        }
+
+        lock.lock();
+        in_flight_--;
+        if (queue_.empty() && in_flight_ == 0) {
+            idle_cv_.notify_all();
+        }
+    }
+}
@@ -0,0 +1,130 @@
+#ifndef KVDB_EVENTLISTENER_H
+#define KVDB_EVENTLISTENER_H
+
+#include "CompactionStats.h"
+#include "Logger.h"
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+struct FlushJobInfo {
+    std::string db_path;
+    std::string file_path;    // level 0 table written, empty until the flush ends
+    size_t entries = 0;
+    uint64_t file_size = 0;
+    uint64_t duration_us = 0;
+    bool success = false;     // meaningful at the end only
+};
+
+struct CompactionJobInfo {
+    std::string db_path;
+    CompactionRecord stats;   // levels and input side at begin, filled in at the end
+    std::vector<std::string> input_files;
+    std::vector<std::string> output_files;
+    bool success = false;     // meaningful at the end only
+};
+
+enum class WriteStallCondition {
+    NORMAL,
+    DELAYED,  // level 0 past the slowdown trigger, every write is held back briefly
+    STOPPED   // writers wait while a flush compacts inline, or until level 0 drops below the stop trigger
+};
+
+struct WriteStallInfo {
+    std::string db_path;
+    WriteStallCondition previous = WriteStallCondition::NORMAL;
+    WriteStallCondition current = WriteStallCondition::NORMAL;
+};
+
+enum class TableFileReason {
+    FLUSH,
+    COMPACTION
+};
+
+struct TableFileCreationInfo {
+    std::string db_path;
+    std::string file_path;
+    int level = 0;
+    uint64_t file_size = 0;
+    size_t entries = 0;
+    TableFileReason reason = TableFileReason::FLUSH;
+};
+
+struct TableFileDeletionInfo {
+    std::string db_path;
+    std::string file_path;
+    int level = 0;
+};
+
+struct WalRolloverInfo {
+    std::string db_path;
+    std::string wal_path;
+    uint64_t bytes_dropped = 0;  // log size when it was cleared, its records are now in an SSTable
+};
+
+/**
+ * Hooks into engine activity, for telemetry. Register through LSMTree::Config::listeners.
+ *
+ * Callbacks run one at a time, in event order, on a notifier thread, never on the thread
+ * doing the work and never under an engine lock, so a slow listener delays later events
+ * but not reads or writes. Every callback defaults to doing nothing.
+ */
+class EventListener {
+public:
+    virtual ~EventListener() = default;
+
+    virtual void on_flush_begin(const FlushJobInfo&) {}
+    virtual void on_flush_completed(const FlushJobInfo&) {}
+    virtual void on_compaction_begin(const CompactionJobInfo&) {}
+    virtual void on_compaction_completed(const CompactionJobInfo&) {}
+    virtual void on_stall_conditions_changed(const WriteStallInfo&) {}
+    virtual void on_table_file_created(const TableFileCreationInfo&) {}
+    virtual void on_table_file_deleted(const TableFileDeletionInfo&) {}
+    virtual void on_wal_rollover(const WalRolloverInfo&) {}
+};
+
+/**
+ * Queues events for the listeners and delivers them on its own thread. With no listeners
+ * no thread is started and notify() returns straight away
+ */
+class EventNotifier {
+public:
+    // logger gets listener failures, nullptr logs them to stderr
+    explicit EventNotifier(std::vector<std::shared_ptr<EventListener>> listeners,
+                           std::shared_ptr<Logger> logger = nullptr);
+
+    // Delivers what is still queued before returning
+    ~EventNotifier();
+
+    bool enabled() const { return !listeners_.empty(); }
+
+    // Queue one callback for every listener
+    void notify(std::function<void(EventListener&)> event);
+
+    // Block until every queued event has been delivered
+    void wait_idle();
+
+    EventNotifier(const EventNotifier&) = delete;
+    EventNotifier& operator=(const EventNotifier&) = delete;
+
+private:
+    std::vector<std::shared_ptr<EventListener>> listeners_;
+    std::shared_ptr<Logger> logger_;
+    std::deque<std::function<void(EventListener&)>> queue_;
+    size_t in_flight_ = 0;  // popped but not yet delivered
+    bool stopping_ = false;
+    std::mutex mutex_;
+    std::condition_variable work_cv_;
+    std::condition_variable idle_cv_;
+    std::thread thread_;
+
+    void run();
+};
+
+#endif // KVDB_EVENTLISTENER_H
@@ -0,0 +1,43 @@
+#include "Hash.h"
+#include <cstring>
+
+uint64_t hash64(const char* data, size_t length, uint64_t seed) {
+    constexpr uint64_t m = 0xc6a4a7935bd1e995ULL;
+    constexpr int r = 47;
+
+    uint64_t h = seed ^ (length * m);
+
+    // Body: mix 8 bytes at a time
+    const size_t blocks = length / 8;
+    for (size_t i = 0; i < blocks; ++i) {
+        uint64_t k;
+        std::memcpy(&k, data + i * 8, sizeof(k));
+
+        k *= m;
+        k ^= k >> r;
+        k *= m;
+
+        h ^= k;
+        h *= m;
+    }
+
+    // Tail: remaining 0-7 bytes
+    const auto* tail = reinterpret_cast<const unsigned char*>(data + blocks * 8);
+    switch (length & 7) {
+        case 7: h ^= static_cast<uint64_t>(tail[6]) << 48; [[fallthrough]];
+        case 6: h ^= static_cast<uint64_t>(tail[5]) << 40; [[fallthrough]];
+        case 5: h ^= static_cast<uint64_t>(tail[4]) << 32; [[fallthrough]];
+        case 4: h ^= static_cast<uint64_t>(tail[3]) << 24; [[fallthrough]];
+        case 3: h ^= static_cast<uint64_t>(tail[2]) << 16; [[fallthrough]];
+        case 2: h ^= static_cast<uint64_t>(tail[1]) << 8; [[fallthrough]];
+        case 1: h ^= static_cast<uint64_t>(tail[0]);
+                h *= m;
+        default: break;
+    }
+
+    h ^= h >> r;
+    h *= m;
+    h ^= h >> r;
+
+    return h;
+}
@@ -0,0 +1,18 @@
+#ifndef KVDB_HASH_H
+#define KVDB_HASH_H
+
+#include <string>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * Stable 64-bit hash (MurmurHash64A) for anything that gets persisted to disk.
+ * std::hash is implementation defined, so it cannot be used for on-disk filters.
+ */
+uint64_t hash64(const char* data, size_t length, uint64_t seed = 0);
+
+inline uint64_t hash64(const std::string& data, uint64_t seed = 0) {
+    return hash64(data.data(), data.size(), seed);
+}
+
+#endif // KVDB_HASH_H
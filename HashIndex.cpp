@@ -0,0 +1,108 @@
+#include "HashIndex.h"
+#include "Hash.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace {
+    // Keep directory hashes independent of the bloom filter hashes
+    constexpr uint64_t HASH_INDEX_SEED = 0x4B564442;
+
+    // Largest position a 2 byte bucket can hold next to its two markers
+    constexpr size_t MAX_NARROW_POSITION = 0xFFFD;
+}
+
+HashIndex::HashIndex(const std::vector<std::string>& sorted_keys, double util_ratio) {
+    if (util_ratio <= 0.0) {
+        util_ratio = 0.75;
+    }
+
+    bucket_count_ = static_cast<uint32_t>(std::max<size_t>(
+        1, static_cast<size_t>(std::ceil(static_cast<double>(sorted_keys.size()) / util_ratio))));
+    bucket_width_ = sorted_keys.size() <= MAX_NARROW_POSITION ? 2 : 4;
+    buckets_.assign(static_cast<size_t>(bucket_count_) * bucket_width_, 0xFF);  // all EMPTY
+
+    for (size_t i = 0; i < sorted_keys.size(); ++i) {
+        const size_t bucket = bucket_for(sorted_keys[i]);
+        const uint32_t current = get_bucket(bucket);
+        set_bucket(bucket, current == empty_marker() ? static_cast<uint32_t>(i) : collision_marker());
+    }
+}
+
+size_t HashIndex::bucket_for(const std::string& key) const {
+    return hash64(key, HASH_INDEX_SEED) % bucket_count_;
+}
+
+uint32_t HashIndex::get_bucket(size_t bucket) const {
+    if (bucket_width_ == 2) {
+        uint16_t value;
+        std::memcpy(&value, buckets_.data() + bucket * 2, sizeof(value));
+        return value;
+    }
+    uint32_t value;
+    std::memcpy(&value, buckets_.data() + bucket * 4, sizeof(value));
+    return value;
+}
+
+void HashIndex::set_bucket(size_t bucket, uint32_t value) {
+    if (bucket_width_ == 2) {
+        const auto narrow = static_cast<uint16_t>(value);
+        std::memcpy(buckets_.data() + bucket * 2, &narrow, sizeof(narrow));
+    } else {
+        std::memcpy(buckets_.data() + bucket * 4, &value, sizeof(value));
+    }
+}
+
+HashIndex::LookupResult HashIndex::lookup(const std::string& key) const {
+    if (bucket_count_ == 0) {
+        return {Probe::UNKNOWN, 0};
+    }
+
+    const uint32_t value = get_bucket(bucket_for(key));
+    if (value == empty_marker()) {
+        return {Probe::ABSENT, 0};
+    }
+    if (value == collision_marker()) {
+        return {Probe::UNKNOWN, 0};
+    }
+    return {Probe::CANDIDATE, value};
+}
+
+std::string HashIndex::serialize() const {
+    std::string out;
+    out.append(reinterpret_cast<const char*>(&bucket_count_), sizeof(bucket_count_));
+    out.append(reinterpret_cast<const char*>(&bucket_width_), sizeof(bucket_width_));
+    out.append(reinterpret_cast<const char*>(buckets_.data()), buckets_.size());
+    return out;
+}
+
+std::optional<HashIndex> HashIndex::deserialize(const std::string& data, size_t entry_count) {
+    if (data.size() < 2 * sizeof(uint32_t)) {
+        return std::nullopt;
+    }
+
+    HashIndex index;
+    std::memcpy(&index.bucket_count_, data.data(), sizeof(uint32_t));
+    std::memcpy(&index.bucket_width_, data.data() + sizeof(uint32_t), sizeof(uint32_t));
+
+    if (index.bucket_count_ == 0 || (index.bucket_width_ != 2 && index.bucket_width_ != 4) ||
+        data.size() - 2 * sizeof(uint32_t) != static_cast<size_t>(index.bucket_count_) * index.bucket_width_) {
+        return std::nullopt;
+    }
+
+    index.buckets_.assign(data.begin() + 2 * sizeof(uint32_t), data.end());
+
+    // Positions must point into the directory the index was loaded for
+    for (size_t b = 0; b < index.bucket_count_; ++b) {
+        const uint32_t value = index.get_bucket(b);
+        if (value != index.empty_marker() && value != index.collision_marker() && value >= entry_count) {
+            return std::nullopt;
+        }
+    }
+
+    return index;
+}
+
+size_t HashIndex::memory_usage() const {
+    return sizeof(HashIndex) + buckets_.capacity();
+}
@@ -0,0 +1,85 @@
+#ifndef KVDB_HASHINDEX_H
+#define KVDB_HASHINDEX_H
+
+#include <string>
+#include <vector>
+#include <optional>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * Compact hash map from key hash to key directory position
+ *
+ * Every key is hashed into one bucket. A bucket holds the position of its only key,
+ * EMPTY if no key hashed there (the key is definitely absent) or COLLISION if several
+ * did, in which case the caller falls back to searching the directory. Buckets are
+ * 2 bytes wide for tables under 64K entries and 4 bytes otherwise.
+ *
+ * Serialized format:
+ * - Bucket count (uint32_t)
+ * - Bucket width in bytes (uint32_t): 2 or 4
+ * - Buckets (bucket count * width bytes)
+ */
+class HashIndex
+{
+public:
+    enum class Probe {
+        ABSENT,     // no key hashed to the bucket
+        UNKNOWN,    // bucket is shared, search the directory
+        CANDIDATE   // only this position can hold the key
+    };
+
+    struct LookupResult
+    {
+        Probe probe;
+        size_t position;  // valid for CANDIDATE
+    };
+
+    /**
+     * Build an index over a key directory
+     * @param sorted_keys keys in directory order
+     * @param util_ratio keys per bucket, lower means fewer collisions and more space
+     */
+    HashIndex(const std::vector<std::string>& sorted_keys, double util_ratio);
+
+    /**
+     * Look a key up
+     */
+    [[nodiscard]] LookupResult lookup(const std::string& key) const;
+
+    /**
+     * Serialize index for storage in an SSTable
+     */
+    [[nodiscard]] std::string serialize() const;
+
+    /**
+     * Rebuild an index from serialized bytes
+     * @param entry_count number of directory entries the index must point into
+     * @return empty optional if data is malformed
+     */
+    static std::optional<HashIndex> deserialize(const std::string& data, size_t entry_count);
+
+    /**
+     * Get approximate memory usage in bytes
+     */
+    [[nodiscard]] size_t memory_usage() const;
+
+    [[nodiscard]] size_t bucket_count() const { return bucket_count_; }
+    [[nodiscard]] size_t bucket_width() const { return bucket_width_; }
+
+private:
+    HashIndex() = default;
+
+    uint32_t bucket_count_ = 0;
+    uint32_t bucket_width_ = 0;
+    std::vector<uint8_t> buckets_;
+
+    [[nodiscard]] uint32_t empty_marker() const { return bucket_width_ == 2 ? 0xFFFF : 0xFFFFFFFF; }
+    [[nodiscard]] uint32_t collision_marker() const { return empty_marker() - 1; }
+
+    [[nodiscard]] uint32_t get_bucket(size_t bucket) const;
+    void set_bucket(size_t bucket, uint32_t value);
+    [[nodiscard]] size_t bucket_for(const std::string& key) const;
+};
+
+#endif //KVDB_HASHINDEX_H
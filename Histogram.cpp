@@ -0,0 +1,180 @@
+#include "Histogram.h"
+#include <algorithm>
+#include <bit>
+#include <limits>
+#include <sstream>
+#include <iomanip>
+
+size_t Histogram::bucket_index(uint64_t value) {
+    if (value < SUB_BUCKETS) {
+        return static_cast<size_t>(value);
+    }
+
+    // Position of the highest set bit picks the power of two, the next bits the sub-bucket
+    int exponent = 63 - std::countl_zero(value);
+    int shift = exponent - SUB_BUCKET_BITS;
+    size_t sub_bucket = static_cast<size_t>(value >> shift) - SUB_BUCKETS;
+    return static_cast<size_t>(shift + 1) * SUB_BUCKETS + sub_bucket;
+}
+
+uint64_t Histogram::bucket_upper_bound(size_t index) {
+    if (index < SUB_BUCKETS) {
+        return index;
+    }
+
+    int shift = static_cast<int>(index / SUB_BUCKETS) - 1;
+    uint64_t sub_bucket = index % SUB_BUCKETS + SUB_BUCKETS;
+    uint64_t lower = sub_bucket << shift;
+    uint64_t width = uint64_t{1} << shift;
+    return lower + (width - 1);
+}
+
+void Histogram::add(uint64_t value) {
+    buckets_[bucket_index(value)]++;
+    count_++;
+    sum_ += value;
+    min_ = std::min(min_, value);
+    max_ = std::max(max_, value);
+}
+
+void Histogram::merge(const Histogram& other) {
+    for (size_t i = 0; i < BUCKET_COUNT; i++) {
+        buckets_[i] += other.buckets_[i];
+    }
+    count_ += other.count_;
+    sum_ += other.sum_;
+    min_ = std::min(min_, other.min_);
+    max_ = std::max(max_, other.max_);
+}
+
+void Histogram::subtract(const Histogram& earlier) {
+    uint64_t upper = max_;
+    min_ = std::numeric_limits<uint64_t>::max();
+    max_ = 0;
+    for (size_t i = 0; i < BUCKET_COUNT; i++) {
+        buckets_[i] -= std::min(buckets_[i], earlier.buckets_[i]);
+        if (buckets_[i] > 0) {
+            uint64_t lower = i == 0 ? 0 : bucket_upper_bound(i - 1) + 1;
+            min_ = std::min(min_, lower);
+            max_ = std::min(bucket_upper_bound(i), upper);
+        }
+    }
+    count_ -= std::min(count_, earlier.count_);
+    sum_ -= std::min(sum_, earlier.sum_);
+}
+
+void Histogram::clear() {
+    buckets_.fill(0);
+    count_ = 0;
+    sum_ = 0;
+    min_ = std::numeric_limits<uint64_t>::max();
+    max_ = 0;
+}
+
+double Histogram::mean() const {
+    return count_ ? static_cast<double>(sum_) / static_cast<double>(count_) : 0.0;
+}
+
+uint64_t Histogram::percentile(double p) const {
+    if (count_ == 0) {
+        return 0;
+    }
+
+    // Rank of the value we're after, 1-based so p = 100 lands on the last value
+    double clamped = std::clamp(p, 0.0, 100.0);
+    uint64_t rank = std::max<uint64_t>(1, static_cast<uint64_t>(clamped / 100.0 * static_cast<double>(count_) + 0.5));
+
+    uint64_t seen = 0;
+    for (size_t i = 0; i < BUCKET_COUNT; i++) {
+        seen += buckets_[i];
+        if (seen >= rank) {
+            return std::clamp(bucket_upper_bound(i), min(), max_);
+        }
+    }
+    return max_;
+}
+
+std::string Histogram::summary(double scale) const {
+    std::ostringstream out;
+    out << std::fixed << std::setprecision(2)
+        << "count " << count_
+        << " avg " << mean() / scale
+        << " p50 " << percentile(50.0) / scale
+        << " p90 " << percentile(90.0) / scale
+        << " p99 " << percentile(99.0) / scale
+        << " p99.9 " << percentile(99.9) / scale
+        << " max " << max() / scale;
+    return out.str();
+}
+
+ConcurrentHistogram::ConcurrentHistogram()
+    : stripes_(std::make_unique<Stripe[]>(STRIPES)) {}
+
+void ConcurrentHistogram::add(uint64_t value) {
+    // Threads take stripes round robin the first time they record anything
+    static std::atomic<size_t> next_stripe{0};
+    thread_local const size_t stripe_index = next_stripe.fetch_add(1, std::memory_order_relaxed) % STRIPES;
+    Stripe& stripe = stripes_[stripe_index];
+
+    stripe.buckets[Histogram::bucket_index(value)].fetch_add(1, std::memory_order_relaxed);
+    stripe.sum.fetch_add(value, std::memory_order_relaxed);
+
+    uint64_t current = stripe.min.load(std::memory_order_relaxed);
+    while (value < current && !stripe.min.compare_exchange_weak(current, value, std::memory_order_relaxed)) {}
+    current = stripe.max.load(std::memory_order_relaxed);
+    while (value > current && !stripe.max.compare_exchange_weak(current, value, std::memory_order_relaxed)) {}
+}
+
+Histogram ConcurrentHistogram::snapshot() const {
+    Histogram result;
+    for (size_t s = 0; s < STRIPES; s++) {
+        const Stripe& stripe = stripes_[s];
+        for (size_t i = 0; i < Histogram::BUCKET_COUNT; i++) {
+            uint64_t count = stripe.buckets[i].load(std::memory_order_relaxed);
+            result.buckets_[i] += count;
+            result.count_ += count;
+        }
+        result.sum_ += stripe.sum.load(std::memory_order_relaxed);
+        result.min_ = std::min(result.min_, stripe.min.load(std::memory_order_relaxed));
+        result.max_ = std::max(result.max_, stripe.max.load(std::memory_order_relaxed));
+    }
+
+    // A value recorded mid-read may be in a bucket but not yet in min or max
+    if (result.count_ > 0 && result.min_ > result.max_) {
+        result.min_ = result.max_;
+    }
+    return result;
+}
+
+void ConcurrentHistogram::clear() {
+    for (size_t s = 0; s < STRIPES; s++) {
+        Stripe& stripe = stripes_[s];
+        for (auto& bucket : stripe.buckets) {
+            bucket.store(0, std::memory_order_relaxed);
+        }
+        stripe.sum.store(0, std::memory_order_relaxed);
+        stripe.min.store(UINT64_MAX, std::memory_order_relaxed);
+        stripe.max.store(0, std::memory_order_relaxed);
+    }
+}
+
+const char* OperationLatencies::name(Operation op) {
+    switch (op) {
+        case PUT: return "put";
+        case GET: return "get";
+        case DELETE: return "delete";
+        case WRITE_BATCH: return "write_batch";
+        case SCAN: return "scan";
+        case FLUSH: return "flush";
+        case COMPACTION: return "compaction";
+        case WAL_WRITE: return "wal_write";
+        case WAL_SYNC: return "wal_sync";
+        default: return "unknown";
+    }
+}
+
+void OperationLatencies::clear() {
+    for (auto& histogram : histograms_) {
+        histogram.clear();
+    }
+}
@@ -0,0 +1,142 @@
+#ifndef KVDB_HISTOGRAM_H
+#define KVDB_HISTOGRAM_H
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstddef>
+#include <memory>
+#include <string>
+
+/**
+ * Log-linear histogram of non-negative values, typically latencies in nanoseconds.
+ *
+ * Values below 2^SUB_BUCKET_BITS get a bucket each, every larger power of two is split
+ * into 2^SUB_BUCKET_BITS equal buckets, so any percentile is within 1/16 (6.25%) of the
+ * recorded value. Histograms are fixed size and merge by adding buckets, so each thread
+ * can record into its own and the results get merged once at the end.
+ */
+class Histogram {
+public:
+    static constexpr int SUB_BUCKET_BITS = 4;
+    static constexpr size_t SUB_BUCKETS = size_t{1} << SUB_BUCKET_BITS;
+    static constexpr size_t BUCKET_COUNT = (64 - SUB_BUCKET_BITS + 1) * SUB_BUCKETS;
+
+    Histogram() { clear(); }
+
+    void add(uint64_t value);
+    void merge(const Histogram& other);
+    void clear();
+
+    /**
+     * Remove an earlier snapshot of this histogram, leaving what was recorded in between.
+     * min and max become the bounds of the lowest and highest buckets left
+     */
+    void subtract(const Histogram& earlier);
+
+    // Total of all recorded values
+    uint64_t sum() const { return sum_; }
+
+    uint64_t count() const { return count_; }
+    uint64_t min() const { return count_ ? min_ : 0; }
+    uint64_t max() const { return max_; }
+    double mean() const;
+
+    /**
+     * Value below which the given percentage of recorded values fall
+     * @param p Percentile in [0, 100]
+     * @return Upper bound of the bucket holding it, capped at max()
+     */
+    uint64_t percentile(double p) const;
+
+    /**
+     * One line summary, values divided by scale (1000 turns nanoseconds into micros)
+     */
+    std::string summary(double scale = 1000.0) const;
+
+    // Bucket layout, exposed for exporting raw buckets
+    static size_t bucket_index(uint64_t value);
+    static uint64_t bucket_upper_bound(size_t index);
+    uint64_t bucket_count(size_t index) const { return buckets_[index]; }
+
+private:
+    friend class ConcurrentHistogram;
+
+    std::array<uint64_t, BUCKET_COUNT> buckets_;
+    uint64_t count_;
+    uint64_t sum_;
+    uint64_t min_;
+    uint64_t max_;
+};
+
+/**
+ * Histogram that many threads record into without locking.
+ *
+ * Threads are spread over a few stripes of relaxed atomic counters, so concurrent
+ * writers rarely touch the same cache lines. Reading merges the stripes into a plain
+ * Histogram. A read racing with writers may miss their latest values, but never
+ * returns a torn bucket.
+ */
+class ConcurrentHistogram {
+public:
+    static constexpr size_t STRIPES = 8;
+
+    ConcurrentHistogram();
+
+    // No copying
+    ConcurrentHistogram(const ConcurrentHistogram&) = delete;
+    ConcurrentHistogram& operator=(const ConcurrentHistogram&) = delete;
+
+    void add(uint64_t value);
+    Histogram snapshot() const;
+    void clear();
+
+private:
+    struct alignas(64) Stripe {
+        std::array<std::atomic<uint64_t>, Histogram::BUCKET_COUNT> buckets{};
+        std::atomic<uint64_t> sum{0};
+        std::atomic<uint64_t> min{UINT64_MAX};
+        std::atomic<uint64_t> max{0};
+    };
+    std::unique_ptr<Stripe[]> stripes_;
+};
+
+/**
+ * Latency of every engine operation type, in nanoseconds
+ */
+class OperationLatencies {
+public:
+    enum Operation { PUT, GET, DELETE, WRITE_BATCH, SCAN, FLUSH, COMPACTION, WAL_WRITE, WAL_SYNC, OPERATION_COUNT };
+
+    static const char* name(Operation op);
+
+    void record(Operation op, uint64_t ns) { histograms_[op].add(ns); }
+    Histogram snapshot(Operation op) const { return histograms_[op].snapshot(); }
+    void clear();
+
+    // Records the lifetime of the scope it's declared in
+    class Timer {
+    public:
+        Timer(OperationLatencies& latencies, Operation op)
+            : latencies_(latencies), op_(op), start_(std::chrono::steady_clock::now()) {}
+
+        ~Timer() {
+            latencies_.record(op_, static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now() - start_).count()));
+        }
+
+        Timer(const Timer&) = delete;
+        Timer& operator=(const Timer&) = delete;
+
+    private:
+        OperationLatencies& latencies_;
+        Operation op_;
+        std::chrono::steady_clock::time_point start_;
+    };
+
+private:
+    std::array<ConcurrentHistogram, OPERATION_COUNT> histograms_;
+};
+
+#endif // KVDB_HISTOGRAM_H
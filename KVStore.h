@@ -5,16 +5,28 @@
 #ifndef KVDB_KVSTORE_H
 #define KVDB_KVSTORE_H
 
-#include "Memtable.h"
-#include "SSTableReader.h"
-#include "WriteAheadLog.h"
+#include "LSMTree.h"
+#include "Histogram.h"
+#include "CompactionStats.h"
+#include "Logger.h"
 #include <string>
 #include <vector>
-#include <map>
 #include <memory>
 #include <optional>
-#include <mutex>
-
+#include <atomic>
+#include <shared_mutex>
+
+/**
+ * Database used by the CLI, a facade over a leveled LSMTree in the database directory
+ *
+ * Tables are compacted level by level, so a lookup probes level 0 plus at most one table per
+ * deeper level. A directory written by the earlier flat layout (sst_<counter>_<timestamp>.sst
+ * files and wal.bin next to them) is migrated into the tree on open, oldest table first, and
+ * the old files are removed once the migrated data is flushed.
+ *
+ * Operations share one lock and only close() takes it exclusively, so reads run in parallel
+ * with each other and with writes. The tree orders writes among themselves.
+ */
 class KVStore
 {
 public:
@@ -75,6 +87,16 @@ public:
      */
     KVDBStats get_stats() const;
 
+    /**
+     * Latency distribution of one operation type in nanoseconds, since the store was opened
+     */
+    Histogram get_latency_histogram(OperationLatencies::Operation op) const;
+
+    /**
+     * Flush and compaction work per level, with amplification
+     */
+    CompactionStats get_compaction_stats() const;
+
     /**
      * Force flush current memtable
      */
@@ -108,52 +130,27 @@ private:
     bool initialize();
 
     /**
-     * Check if memtable needs flushing
-     */
-    void check_and_flush_memtable();
-
-    /**
-     * Flush current memtable to sstable
-     * @return true if successful false otherwise
-     */
-    bool flush_memtable_internal();
-
-    /**
-     *Load existing SSTables from DB directory
-     */
-    void load_existing_sstables();
-
-    /**
-     * Recover from WAL if exists
-     */
-    void recover_from_wal();
-
-    /**
-     * Generate unique SSTable filename
-     */
-    std::string generate_sst_filename() const;
-
-    /**
-     * Search all SSTables for a key (newest to oldest)
+     * Replay sst_*.sst files of the flat layout into the tree, oldest first
      */
-    std::optional<std::string> search_sstables(const std::string& key) const;
+    bool migrate_legacy_sstables();
 
     /**
-     * Scan all SSTables for a key range
+     * Replay wal.bin of the flat layout, it is newer than every legacy SSTable
      */
-    void scan_sstables(const std::string& start_key,
-        const std::string& end_key,
-        std::map<std::string, std::string>& results) const;
+    bool migrate_legacy_wal();
 
     // private member vars
     std::string db_path_;
     size_t memtable_size_;
-    Memtable memtable_;
-    std::unique_ptr<WriteAheadLog> wal_;
-    std::vector<std::unique_ptr<SSTableReader>> sstables_;
-    mutable std::mutex mutex_;  // for thread safety
-    mutable KVDBStats stats_;
-    uint64_t sst_counter_;  // for unique SSTable naming
+    std::shared_ptr<Logger> logger_;    // writes db_path/LOG, shared with the tree
+    std::unique_ptr<LSMTree> lsm_;      // nullptr once closed
+    mutable std::shared_mutex mutex_;   // shared by operations, exclusive for close()
+
+    // Operation counts, bumped by concurrent callers
+    std::atomic<uint64_t> puts_{0};
+    std::atomic<uint64_t> gets_{0};
+    std::atomic<uint64_t> deletes_{0};
+    std::atomic<uint64_t> scans_{0};
 };
 
 #endif //KVDB_KVSTORE_H
\ No newline at end of file
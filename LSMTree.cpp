@@ -1,79 +1,134 @@
 #include "LSMTree.h"
 #include "SSTableWriter.h"
-#include <filesystem>
-#include <fstream>
 #include <algorithm>
 #include <iostream>
 #include <chrono>
+#include <stdexcept>
+#include <thread>
 
-namespace fs = std::filesystem;
+namespace {
+    // Keys remembered for transaction validation before the table is reset
+    constexpr size_t MAX_TRACKED_WRITES = 64 * 1024;
+}
 
 LSMTree::LSMTree(const std::string& data_dir,
                  size_t memtable_size,
                  size_t buffer_pool_size,
                  size_t bits_per_entry)
-    : data_directory_(data_dir),
-      memtable_max_size_(memtable_size),
-      buffer_pool_size_(buffer_pool_size),
-      bits_per_entry_(bits_per_entry),
-      memtable_(memtable_size) {
+    : LSMTree(data_dir, Config(memtable_size, buffer_pool_size, bits_per_entry)) {}
+
+LSMTree::LSMTree(const std::string& data_dir, const Config& config)
+    : env_(config.env ? config.env : Env::default_env()),
+      data_directory_(data_dir),
+      memtable_max_size_(config.memtable_size),
+      buffer_pool_size_(config.buffer_pool_size),
+      bits_per_entry_(config.bits_per_entry),
+      config_(config),
+      memtable_(config.memtable_size) {
+
+    // Create main directory, one LSMTree per directory at a time
+    env_->create_dirs(data_directory_);
+    db_lock_ = env_->lock_file(data_directory_ + "/LOCK");
+    if (!db_lock_) {
+        throw std::runtime_error("Database directory is locked by another instance: " + data_directory_);
+    }
 
-    // Create main directory
-    fs::create_directories(data_directory_);
+    // Log to data_dir/LOG unless the owner shares its logger
+    logger_ = config_.logger;
+    if (!logger_) {
+        Logger::Options log_options;
+        log_options.level = config_.log_level;
+        logger_ = std::make_shared<Logger>(data_directory_ + "/LOG", log_options, env_);
+    }
 
-    // Initialize buffer pool
-    buffer_pool_ = std::make_unique<BufferPool>(buffer_pool_size);
+    // Initialize buffer pool, unless the owner shares one across trees
+    buffer_pool_ = config_.buffer_pool ? config_.buffer_pool : std::make_shared<BufferPool>(buffer_pool_size_);
 
     // Initialize Write-Ahead Log
-    std::string wal_path = data_directory_ + "/wal.log";
-    wal_ = std::make_unique<WriteAheadLog>(wal_path);
+    if (config_.use_wal) {
+        std::string wal_path = data_directory_ + "/wal.log";
+        wal_ = std::make_unique<WriteAheadLog>(wal_path, env_, config_.sync_wal, &latencies_);
+    }
 
-    // Initialize LevelManager
-    LevelManager::Config lm_config;
-    lm_config.level0_max_sstables = 2;  // Compact when 2 SSTables in level 0
-    lm_config.size_ratio = 2;           // Size ratio between levels
-    lm_config.max_levels = 7;           // Levels 0-6
+    events_ = std::make_shared<EventNotifier>(config_.listeners, logger_);
+
+    // Initialize LevelManager, compacted SSTables get the same meta blocks as flushed ones
+    LevelManager::Config lm_config = config_.level_config;
+    lm_config.table_options = make_table_options();
+    lm_config.events = events_;
+    lm_config.logger = logger_;
+    lm_config.env = env_;
 
     level_manager_ = std::make_unique<LevelManager>(data_directory_, buffer_pool_, lm_config);
 
+    // Initialize row cache
+    if (config_.row_cache_size > 0) {
+        row_cache_ = std::make_unique<RowCache>(config_.row_cache_size);
+    }
+
+    // Initialize negative lookup cache
+    if (config_.negative_cache_size > 0) {
+        negative_cache_ = std::make_unique<NegativeCache>(config_.negative_cache_size);
+    }
+
     // Recover from WAL if it exists
-    recover_from_wal();
+    if (wal_) {
+        recover_from_wal();
+    }
+
+    // Start dumping metrics once everything they read exists
+    if (config_.stats_dump_period.count() > 0) {
+        std::string path = config_.stats_dump_path;
+        if (path.empty()) {
+            path = data_directory_ + (config_.stats_dump_format == MetricsFormat::PROMETHEUS
+                ? "/metrics.prom" : "/metrics.jsonl");
+        }
+        stats_dumper_ = std::make_unique<StatsDumper>([this] { return get_metrics(); }, path,
+                                                      config_.stats_dump_period, config_.stats_dump_format, env_);
+    }
 }
 
 LSMTree::~LSMTree() {
+    // Queued jobs hold this tree, anything scheduled from here on runs inline
+    closing_ = true;
+    wait_for_background_jobs();
+
     // Ensure memtable is flushed before destruction
     if (memtable_.size() > 0) {
         flush_memtable();
     }
+
+    // Last dump sees the final flush
+    stats_dumper_.reset();
 }
 
 bool LSMTree::wal_file_exists() const {
     std::string wal_path = data_directory_ + "/wal.log";
-    return fs::exists(wal_path);
+    return env_->file_exists(wal_path);
 }
 
 void LSMTree::recover_from_wal() {
     // Check if WAL file exists
     if (!wal_file_exists()) {
-        std::cout << "No WAL file found, starting fresh." << std::endl;
+        logger_->info("No WAL file found, starting fresh.");
         return;
     }
 
-    std::cout << "Recovering from WAL..." << std::endl;
+    logger_->info("Recovering from WAL...");
 
     try {
         // Use the recover method from WriteAheadLog
         std::vector<WriteAheadLog::LogEntry> entries;
         if (!wal_->recover(entries)) {
-            std::cerr << "Failed to recover from WAL. Starting fresh." << std::endl;
+            logger_->error("Failed to recover from WAL. Starting fresh.");
             wal_->clear();
             return;
         }
 
-        std::cout << "Recovered " << entries.size() << " entries from WAL." << std::endl;
+        logger_->info("Recovered ", entries.size(), " entries from WAL.");
 
         if (entries.empty()) {
-            std::cout << "WAL is empty, nothing to recover." << std::endl;
+            logger_->info("WAL is empty, nothing to recover.");
             return;
         }
 
@@ -86,17 +141,17 @@ void LSMTree::recover_from_wal() {
             }
         }
 
-        std::cout << "Applied " << entries.size() << " entries to memtable." << std::endl;
+        logger_->info("Applied ", entries.size(), " entries to memtable.");
 
         // If memtable is too big after recovery, flush it
         if (should_flush_memtable()) {
-            std::cout << "Memtable is full after recovery, flushing..." << std::endl;
+            logger_->info("Memtable is full after recovery, flushing...");
             flush_memtable();
         }
 
     } catch (const std::exception& e) {
-        std::cerr << "Error during WAL recovery: " << e.what() << std::endl;
-        std::cerr << "Clearing WAL and starting fresh." << std::endl;
+        logger_->error("Error during WAL recovery: ", e.what());
+        logger_->error("Clearing WAL and starting fresh.");
         wal_->clear();
     }
 }
@@ -106,91 +161,340 @@ std::string LSMTree::generate_sstable_filename(int level, uint64_t id) {
            "/sstable_" + std::to_string(id) + ".sst";
 }
 
+SSTableWriter::Options LSMTree::make_table_options() const {
+    SSTableWriter::Options options(config_.prefix_extractor, bits_per_entry_, config_.range_filter);
+    options.learned_index = config_.learned_index;
+    options.hash_index = config_.hash_index;
+    options.env = env_;
+    return options;
+}
+
 bool LSMTree::put(const std::string& key, const std::string& value) {
+    tracer_.trace_put(key, value.size());
+    OperationLatencies::Timer timer(latencies_, OperationLatencies::PUT);
+    throttle_writes();
     std::lock_guard<std::recursive_mutex> lock(memtable_mutex_);
 
     // 1. Write to Write-Ahead Log for durability
-    if (!wal_->log_put(key, value)) {
-        std::cerr << "Failed to write to WAL" << std::endl;
+    if (wal_ && !timed_wal_write([&] { return wal_->log_put(key, value); })) {
+        logger_->error("Failed to write to WAL");
         return false;
     }
 
     // 2. Add to memtable
-    bool should_flush = !memtable_.put(key, value);
+    PerfTimer insert_timer(&PerfContext::memtable_insert_ns);
+    bool should_flush;
+    {
+        std::unique_lock<std::shared_mutex> data_lock(memtable_data_mutex_);
+        should_flush = !memtable_.put(key, value);
+    }
+    insert_timer.stop();
 
-    // 3. Update statistics
+    // 3. Drop any cached copy, readers that started before this write can't put it back
+    record_write(key);
+
+    // 4. Update statistics
     stats_.total_puts++;
 
-    // 4. Check if we need to flush memtable
+    // 5. Check if we need to flush memtable
     if (should_flush) {
-        flush_memtable();
+        schedule_flush();
     }
 
     return true;
 }
 
 std::optional<std::string> LSMTree::get(const std::string& key) {
+    tracer_.trace_get(key);
+    OperationLatencies::Timer timer(latencies_, OperationLatencies::GET);
+
     // Update statistics
-    stats_.total_gets++;
+    total_gets_.fetch_add(1, std::memory_order_relaxed);
+
+    // 1. Hot keys and repeated misses are answered by the caches alone
+    const uint64_t read_seq = sequence_number_.load();
+    if (row_cache_) {
+        if (auto cached = row_cache_->lookup(key, read_seq)) {
+            perf_count(&PerfContext::row_cache_hits);
+            return cached;
+        }
+        perf_count(&PerfContext::row_cache_misses);
+    }
+    if (negative_cache_) {
+        if (negative_cache_->contains(key, read_seq)) {
+            perf_count(&PerfContext::negative_cache_hits);
+            return std::nullopt;
+        }
+        perf_count(&PerfContext::negative_cache_misses);
+    }
 
-    // 1. First check memtable (most recent data)
+    // 2. Check memtable (most recent data), alongside other readers
     {
-        std::lock_guard<std::recursive_mutex> lock(memtable_mutex_);
+        std::shared_lock<std::shared_mutex> lock(memtable_data_mutex_);
+        PerfTimer memtable_timer(&PerfContext::get_memtable_ns);
         auto memtable_value = memtable_.get(key);
         if (memtable_value) {
+            perf_count(&PerfContext::memtable_hits);
             // Check if it's a tombstone
             if (memtable_.is_deleted(key)) {
                 return std::nullopt;  // Key is deleted
             }
+            if (row_cache_) {
+                row_cache_->insert(key, *memtable_value, read_seq);
+            }
             return memtable_value;
         }
 
         // Also check if key is deleted in memtable
         if (memtable_.is_deleted(key)) {
+            perf_count(&PerfContext::memtable_hits);
             return std::nullopt;
         }
     }
 
-    // 2. If not found in memtable, search SSTables using LevelManager
-    return search_sstables(key);
+    // 3. If not found in memtable, search SSTables using LevelManager
+    auto value = search_sstables(key);
+    if (value && row_cache_) {
+        row_cache_->insert(key, *value, read_seq);
+    }
+    if (!value && negative_cache_) {
+        negative_cache_->insert(key, read_seq);
+    }
+    return value;
+}
+
+std::optional<std::string> LSMTree::get(const std::string& key, const ReadOptions& options) {
+    if (!options.snapshot) {
+        return get(key);
+    }
+
+    tracer_.trace_get(key);
+    total_gets_.fetch_add(1, std::memory_order_relaxed);
+    return get_at(key, *options.snapshot);
+}
+
+std::optional<std::string> LSMTree::get_at(const std::string& key, const Snapshot& snapshot) {
+    OperationLatencies::Timer timer(latencies_, OperationLatencies::GET);
+
+    // Cache entries are dropped by any write to their key, so one cached at or
+    // before the snapshot still holds what the snapshot sees
+    if (row_cache_) {
+        if (auto cached = row_cache_->lookup(key, snapshot.sequence_)) {
+            perf_count(&PerfContext::row_cache_hits);
+            return cached;
+        }
+        perf_count(&PerfContext::row_cache_misses);
+    }
+    if (negative_cache_) {
+        if (negative_cache_->contains(key, snapshot.sequence_)) {
+            perf_count(&PerfContext::negative_cache_hits);
+            return std::nullopt;
+        }
+        perf_count(&PerfContext::negative_cache_misses);
+    }
+
+    PerfTimer memtable_timer(&PerfContext::get_memtable_ns);
+    auto it = snapshot.memtable_->find(key);
+    memtable_timer.stop();
+    if (it != snapshot.memtable_->end()) {
+        perf_count(&PerfContext::memtable_hits);
+        if (it->second.is_deleted) {
+            return std::nullopt;
+        }
+        return it->second.value;
+    }
+
+    return search_sstables(key, snapshot.version_);
+}
+
+std::vector<std::optional<std::string>>
+LSMTree::multi_get(const std::vector<std::string>& keys, const ReadOptions& options) {
+    std::vector<std::optional<std::string>> results;
+    results.reserve(keys.size());
+
+    if (options.snapshot) {
+        for (const auto& key : keys) {
+            results.push_back(get(key, options));
+        }
+        return results;
+    }
+
+    // Writes and flushes wait on the memtable lock, so holding it keeps the batch consistent
+    std::lock_guard<std::recursive_mutex> lock(memtable_mutex_);
+    for (const auto& key : keys) {
+        results.push_back(get(key));
+    }
+    return results;
+}
+
+LSMTree::SnapshotPtr LSMTree::get_snapshot() {
+    auto snapshot = std::make_shared<Snapshot>();
+
+    // A flush moves entries from the memtable into level 0, so both are taken under the memtable lock
+    std::lock_guard<std::recursive_mutex> lock(memtable_mutex_);
+    snapshot->sequence_ = sequence_number_.load();
+    if (!frozen_memtable_ || frozen_sequence_ != snapshot->sequence_) {
+        frozen_memtable_ = std::make_shared<const std::map<std::string, Memtable::Entry>>(
+            memtable_.begin(), memtable_.end());
+        frozen_sequence_ = snapshot->sequence_;
+    }
+    snapshot->memtable_ = frozen_memtable_;
+    snapshot->version_ = level_manager_->current_version();
+
+    std::lock_guard<std::mutex> snapshot_lock(snapshot_mutex_);
+    snapshot->id_ = ++next_snapshot_id_;
+    live_snapshots_[snapshot->id_] = SnapshotInfo{snapshot->sequence_, std::chrono::steady_clock::now()};
+
+    return snapshot;
+}
+
+void LSMTree::release_snapshot(const SnapshotPtr& snapshot) {
+    if (!snapshot) {
+        return;
+    }
+
+    std::lock_guard<std::recursive_mutex> lock(memtable_mutex_);
+    std::lock_guard<std::mutex> snapshot_lock(snapshot_mutex_);
+    live_snapshots_.erase(snapshot->id_);
+
+    // Don't keep a memtable copy around for nobody
+    if (live_snapshots_.empty()) {
+        frozen_memtable_.reset();
+    }
 }
 
 bool LSMTree::remove(const std::string& key) {
+    tracer_.trace_remove(key);
+    OperationLatencies::Timer timer(latencies_, OperationLatencies::DELETE);
+    throttle_writes();
     std::lock_guard<std::recursive_mutex> lock(memtable_mutex_);
 
     // 1. Write delete to WAL
-    if (!wal_->log_delete(key)) {
-        std::cerr << "Failed to write delete to WAL" << std::endl;
+    if (wal_ && !timed_wal_write([&] { return wal_->log_delete(key); })) {
+        logger_->error("Failed to write delete to WAL");
         return false;
     }
 
     // 2. Add tombstone to memtable (using remove method which adds tombstone)
-    bool should_flush = !memtable_.remove(key);
+    PerfTimer insert_timer(&PerfContext::memtable_insert_ns);
+    bool should_flush;
+    {
+        std::unique_lock<std::shared_mutex> data_lock(memtable_data_mutex_);
+        should_flush = !memtable_.remove(key);
+    }
+    insert_timer.stop();
 
-    // 3. Update statistics
+    // 3. Drop any cached copy
+    record_write(key);
+
+    // 4. Update statistics
     stats_.total_deletes++;
 
-    // 4. Check if we need to flush memtable
+    // 5. Check if we need to flush memtable
     if (should_flush) {
-        flush_memtable();
+        schedule_flush();
+    }
+
+    return true;
+}
+
+void LSMTree::record_write(const std::string& key) {
+    const uint64_t seq = ++sequence_number_;
+    if (row_cache_) {
+        row_cache_->invalidate(key, seq);
+    }
+    if (negative_cache_) {
+        negative_cache_->invalidate(key, seq);
+    }
+
+    if (recent_writes_.size() >= MAX_TRACKED_WRITES) {
+        recent_writes_.clear();
+        recent_writes_floor_ = seq - 1;
+    }
+    recent_writes_[key] = seq;
+}
+
+bool LSMTree::write(const WriteBatch& batch) {
+    tracer_.trace_write(batch);
+    throttle_writes();
+    std::lock_guard<std::recursive_mutex> lock(memtable_mutex_);
+    return apply_batch_locked(batch);
+}
+
+bool LSMTree::apply_batch_locked(const WriteBatch& batch) {
+    if (batch.empty()) {
+        return true;
+    }
+    OperationLatencies::Timer timer(latencies_, OperationLatencies::WRITE_BATCH);
+
+    // 1. One WAL append for the whole batch
+    if (wal_ && !timed_wal_write([&] { return wal_->log_batch(batch.ops()); })) {
+        logger_->error("Failed to write batch to WAL");
+        return false;
+    }
+
+    // 2. Apply to memtable, readers wait on the data lock so they see all of it or none
+    bool should_flush = false;
+    PerfTimer insert_timer(&PerfContext::memtable_insert_ns);
+    std::unique_lock<std::shared_mutex> data_lock(memtable_data_mutex_);
+    for (const auto& op : batch.ops()) {
+        if (op.type == WriteAheadLog::OpType::PUT) {
+            should_flush |= !memtable_.put(op.key, op.value);
+            stats_.total_puts++;
+        } else {
+            should_flush |= !memtable_.remove(op.key);
+            stats_.total_deletes++;
+        }
+        record_write(op.key);
+    }
+    data_lock.unlock();
+    insert_timer.stop();
+
+    // 3. Flush once the whole batch is in
+    if (should_flush) {
+        schedule_flush();
     }
 
     return true;
 }
 
+std::unique_ptr<Transaction> LSMTree::begin_transaction() {
+    return std::unique_ptr<Transaction>(new Transaction(*this));
+}
+
+Transaction::Status LSMTree::commit_transaction(const std::unordered_map<std::string, uint64_t>& tracked,
+                                                const WriteBatch& batch) {
+    throttle_writes();
+    std::lock_guard<std::recursive_mutex> lock(memtable_mutex_);
+
+    for (const auto& [key, seen_seq] : tracked) {
+        // History older than the floor is gone, so a key seen before it can't be vouched for
+        auto it = recent_writes_.find(key);
+        if (seen_seq < recent_writes_floor_ || (it != recent_writes_.end() && it->second > seen_seq)) {
+            stats_.transaction_conflicts++;
+            return Transaction::Status::CONFLICT;
+        }
+    }
+
+    if (!apply_batch_locked(batch)) {
+        return Transaction::Status::FAILED;
+    }
+
+    stats_.transactions_committed++;
+    return Transaction::Status::COMMITTED;
+}
+
 std::vector<std::pair<std::string, std::string>>
 LSMTree::scan(const std::string& start_key, const std::string& end_key) {
-    std::vector<std::pair<std::string, std::string>> results;
+    tracer_.trace_scan(start_key, end_key);
+    OperationLatencies::Timer timer(latencies_, OperationLatencies::SCAN);
 
-    // 1. Get from memtable first (most recent)
+    // 1. Get from memtable first (most recent), tombstones included
+    std::vector<std::pair<std::string, Memtable::Entry>> memtable_entries;
     {
-        std::lock_guard<std::recursive_mutex> lock(memtable_mutex_);
-        // We need to get all entries and filter by range
-        auto entries = memtable_.get_all_entries();
-        for (const auto& [key, entry] : entries) {
-            if (key >= start_key && key <= end_key && !entry.is_deleted) {
-                results.emplace_back(key, entry.value);
-            }
+        std::shared_lock<std::shared_mutex> lock(memtable_data_mutex_);
+        for (auto it = memtable_.lower_bound(start_key); it != memtable_.end() && it->first <= end_key; ++it) {
+            memtable_entries.emplace_back(it->first, it->second);
         }
     }
 
@@ -202,19 +506,21 @@ LSMTree::scan(const std::string& start_key, const std::string& end_key) {
     std::map<std::string, std::string> result_map;
 
     // First add SSTable results (older)
-    for (const auto& [key, value] : sstable_results) {
-        if (!is_tombstone(value)) {
-            result_map[key] = value;
-        }
+    for (auto& [key, value] : sstable_results) {
+        result_map[key] = std::move(value);
     }
 
-    // Then override with memtable results (newer)
-    for (const auto& [key, value] : results) {
-        result_map[key] = value;
+    // Then override with memtable results (newer), its tombstones hide older values
+    for (const auto& [key, entry] : memtable_entries) {
+        if (entry.is_deleted) {
+            result_map.erase(key);
+        } else {
+            result_map[key] = entry.value;
+        }
     }
 
     // Convert back to vector
-    results.clear();
+    std::vector<std::pair<std::string, std::string>> results;
     for (const auto& [key, value] : result_map) {
         results.emplace_back(key, value);
     }
@@ -222,6 +528,81 @@ LSMTree::scan(const std::string& start_key, const std::string& end_key) {
     return results;
 }
 
+std::vector<std::pair<std::string, std::string>>
+LSMTree::scan(const std::string& start_key, const std::string& end_key, const ReadOptions& options) {
+    if (!options.snapshot) {
+        return scan(start_key, end_key);
+    }
+    tracer_.trace_scan(start_key, end_key);
+    OperationLatencies::Timer timer(latencies_, OperationLatencies::SCAN);
+    const Snapshot& snapshot = *options.snapshot;
+
+    // SSTables of the pinned version first, then the frozen memtable overrides them
+    std::map<std::string, std::string> result_map;
+    for (auto& [key, value] : scan_sstables(start_key, end_key, snapshot.version_)) {
+        result_map[key] = std::move(value);
+    }
+
+    for (auto it = snapshot.memtable_->lower_bound(start_key);
+         it != snapshot.memtable_->end() && it->first <= end_key; ++it) {
+        if (it->second.is_deleted) {
+            result_map.erase(it->first);
+        } else {
+            result_map[it->first] = it->second.value;
+        }
+    }
+
+    std::vector<std::pair<std::string, std::string>> results;
+    results.reserve(result_map.size());
+    for (auto& [key, value] : result_map) {
+        results.emplace_back(key, std::move(value));
+    }
+
+    return results;
+}
+
+std::vector<std::pair<std::string, std::string>>
+LSMTree::scan_prefix(const std::string& prefix) {
+    tracer_.trace_scan_prefix(prefix);
+    OperationLatencies::Timer timer(latencies_, OperationLatencies::SCAN);
+
+    // 1. Snapshot matching memtable entries first so a concurrent flush can't hide them
+    std::vector<std::pair<std::string, Memtable::Entry>> memtable_entries;
+    {
+        std::shared_lock<std::shared_mutex> lock(memtable_data_mutex_);
+        for (auto it = memtable_.lower_bound(prefix);
+             it != memtable_.end() && it->first.compare(0, prefix.size(), prefix) == 0; ++it) {
+            memtable_entries.emplace_back(it->first, it->second);
+        }
+    }
+
+    // 2. SSTables that pass the range and prefix filter checks
+    // Candidates come newest first, so walking them backwards lets newer entries
+    // (tombstones included) overwrite older ones
+    std::map<std::string, Memtable::Entry> merged;
+    auto candidates = level_manager_->find_sstables_for_prefix(prefix);
+    for (auto it = candidates.rbegin(); it != candidates.rend(); ++it) {
+        for (auto& [key, entry] : (*it)->scan_prefix(prefix)) {
+            merged.insert_or_assign(key, std::move(entry));
+        }
+    }
+
+    // 3. Memtable is newest
+    for (auto& [key, entry] : memtable_entries) {
+        merged.insert_or_assign(key, std::move(entry));
+    }
+
+    std::vector<std::pair<std::string, std::string>> results;
+    results.reserve(merged.size());
+    for (auto& [key, entry] : merged) {
+        if (!entry.is_deleted) {
+            results.emplace_back(key, std::move(entry.value));
+        }
+    }
+
+    return results;
+}
+
 bool LSMTree::should_flush_memtable() const {
     return memtable_.should_flush();
 }
@@ -233,6 +614,8 @@ bool LSMTree::flush_memtable() {
 
     try {
         std::lock_guard<std::recursive_mutex> mem_lock(memtable_mutex_);
+        auto flush_start = std::chrono::steady_clock::now();
+        PerfTimer flush_timer(&PerfContext::flush_ns);
 
         // 1. Get all entries from memtable
         auto entries = memtable_.get_all_entries();
@@ -241,7 +624,21 @@ bool LSMTree::flush_memtable() {
             return true;
         }
 
-        // std::cout << "[DEBUG] Flushing memtable with " << entries.size() << " entries" << std::endl;
+        FlushJobInfo flush_info;
+        if (events_->enabled()) {
+            flush_info.db_path = data_directory_;
+            flush_info.entries = entries.size();
+            events_->notify([flush_info](EventListener& listener) { listener.on_flush_begin(flush_info); });
+        }
+        auto flush_failed = [&]() {
+            is_flushing_ = false;
+            if (events_->enabled()) {
+                events_->notify([flush_info](EventListener& listener) { listener.on_flush_completed(flush_info); });
+            }
+            return false;
+        };
+
+        logger_->debug("Flushing memtable with ", entries.size(), " entries");
 
         // 2. Generate temporary SSTable filename
         uint64_t timestamp = std::chrono::duration_cast<std::chrono::milliseconds>(
@@ -249,72 +646,96 @@ bool LSMTree::flush_memtable() {
         std::string temp_filename = data_directory_ + "/temp_" + std::to_string(timestamp) + ".sst";
 
         // 3. Write to SSTable
-        if (!SSTableWriter::write(temp_filename, entries)) {
-            std::cerr << "Failed to write SSTable: " << temp_filename << std::endl;
-            is_flushing_ = false;
-            return false;
+        if (!SSTableWriter::write(temp_filename, entries, make_table_options())) {
+            logger_->error("Failed to write SSTable: ", temp_filename);
+            return flush_failed();
         }
 
         // 4. Create SSTableReader as shared_ptr
-        auto sstable = std::make_shared<SSTableReader>(temp_filename);
+        auto sstable = std::make_shared<SSTableReader>(temp_filename, env_);
         if (!sstable->is_valid()) {
-            std::cerr << "Failed to load SSTable: " << temp_filename << std::endl;
-            fs::remove(temp_filename);
-            is_flushing_ = false;
-            return false;
+            logger_->error("Failed to load SSTable: ", temp_filename);
+            env_->remove_file(temp_filename);
+            return flush_failed();
         }
 
-        // std::cout << "[DEBUG] Created SSTable with " << sstable->size() << " entries" << std::endl;
 
         // 5. Add to LevelManager
         if (!level_manager_->add_sstable_level0(sstable)) {
-            std::cerr << "Failed to add SSTable to LevelManager" << std::endl;
-            fs::remove(temp_filename);
-            is_flushing_ = false;
-            return false;
+            logger_->error("Failed to add SSTable to LevelManager");
+            env_->remove_file(temp_filename);
+            return flush_failed();
         }
 
-        // std::cout << "[DEBUG] Added SSTable to LevelManager" << std::endl;
 
-        // 6. Clear memtable and WAL
-        memtable_.clear();
-        wal_->clear();
+        // 6. Clear memtable and WAL, readers find the entries in level 0 from here on
+        {
+            std::unique_lock<std::shared_mutex> data_lock(memtable_data_mutex_);
+            memtable_.clear();
+        }
+        if (wal_) {
+            WalRolloverInfo wal_info;
+            if (events_->enabled()) {
+                wal_info.db_path = data_directory_;
+                wal_info.wal_path = wal_->get_filename();
+                wal_info.bytes_dropped = wal_->size();
+            }
+            wal_->clear();
+            if (events_->enabled()) {
+                events_->notify([wal_info](EventListener& listener) { listener.on_wal_rollover(wal_info); });
+            }
+        }
 
-        // 7. Update statistics
+        // 7. Update statistics, compaction below is timed on its own
         stats_.memtable_flushes++;
         stats_.sstables_created = level_manager_->get_total_sstable_count();
+        auto flush_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - flush_start).count();
+        latencies_.record(OperationLatencies::FLUSH, flush_ns);
+        flush_timer.stop();
+
+        if (events_->enabled()) {
+            auto version = level_manager_->current_version();
+            if (!version->levels[0].empty()) {
+                flush_info.file_path = version->levels[0].back()->get_filename();
+                flush_info.file_size = version->levels[0].back()->file_size();
+            }
+            flush_info.duration_us = flush_ns / 1000;
+            flush_info.success = true;
+            events_->notify([flush_info](EventListener& listener) { listener.on_flush_completed(flush_info); });
+        }
 
-        // 8. Check for compaction
-        trigger_compaction();
+        logger_->info("Memtable flushed with ", entries.size(), " entries in ", flush_ns / 1000, " us");
 
-        std::cout << "Memtable flushed with " << entries.size() << " entries" << std::endl;
+        // 8. Check for compaction
+        schedule_compaction();
 
         is_flushing_ = false;
         return true;
 
     } catch (const std::exception& e) {
-        std::cerr << "Error flushing memtable: " << e.what() << std::endl;
+        logger_->error("Error flushing memtable: ", e.what());
         is_flushing_ = false;
         return false;
     }
 }
 
-std::optional<std::string> LSMTree::search_sstables(const std::string& key) const {
+std::optional<std::string> LSMTree::search_sstables(const std::string& key,
+                                                    const LevelManager::VersionPtr& version) const {
     // Use LevelManager to find candidate SSTables
-    auto candidates = level_manager_->find_candidate_sstables(key);
+    PerfTimer find_timer(&PerfContext::find_tables_ns);
+    auto candidates = level_manager_->find_candidate_sstables(key, version);
+    find_timer.stop();
 
     // Search from newest to oldest (candidates are already sorted by LevelManager)
     for (const auto& sstable : candidates) {
-        if (auto value = sstable->get(key)) {
-            if (is_tombstone(*value)) {
-                return std::nullopt;  // Tombstone found
+        perf_count(&PerfContext::tables_probed);
+        // One search answers both whether the key is here and whether it's a tombstone
+        if (auto entry = sstable->get_entry(key)) {
+            if (entry->is_deleted) {
+                return std::nullopt;
             }
-            return value;
-        }
-
-        // Also check if key is deleted
-        if (sstable->is_deleted(key)) {
-            return std::nullopt;
+            return std::move(entry->value);
         }
     }
 
@@ -322,69 +743,197 @@ std::optional<std::string> LSMTree::search_sstables(const std::string& key) cons
 }
 
 std::vector<std::pair<std::string, std::string>>
-LSMTree::scan_sstables(const std::string& start_key, const std::string& end_key) const {
+LSMTree::scan_sstables(const std::string& start_key, const std::string& end_key,
+                       const LevelManager::VersionPtr& version) const {
     std::vector<std::pair<std::string, std::string>> results;
-    std::map<std::string, std::string> merged_results;
+    std::map<std::string, Memtable::Entry> merged_results;
 
-    // Get all SSTables that might contain keys in the range using LevelManager
-    auto candidates = level_manager_->find_sstables_for_range(start_key, end_key);
+    // Get all SSTables that might contain keys in the range using LevelManager, newest first
+    auto candidates = level_manager_->find_sstables_for_range(start_key, end_key, version);
 
-    // Search each SSTable (newest first)
+    // Apply each SSTable oldest first, so newer ones override
     for (auto it = candidates.rbegin(); it != candidates.rend(); ++it) {
         const auto& sstable = *it;
-        auto sstable_results = sstable->scan_range(start_key, end_key);
-
-        // Merge results (newer SSTables override older ones)
-        for (const auto& [key, value] : sstable_results) {
-            if (!is_tombstone(value)) {
-                merged_results[key] = value;
-            } else {
-                // Remove if tombstone
-                merged_results.erase(key);
-            }
+        // Merge results (newer SSTables override older ones, tombstones included)
+        for (auto& [key, entry] : sstable->scan_range_entries(start_key, end_key)) {
+            merged_results.insert_or_assign(key, std::move(entry));
         }
     }
 
     // Convert map to vector
-    for (const auto& [key, value] : merged_results) {
-        results.emplace_back(key, value);
+    for (auto& [key, entry] : merged_results) {
+        if (!entry.is_deleted) {
+            results.emplace_back(key, std::move(entry.value));
+        }
     }
 
     return results;
 }
 
-void LSMTree::trigger_compaction() {
-    if (is_compacting_.exchange(true)) {
+void LSMTree::schedule_flush() {
+    if (!config_.executor || closing_) {
+        flush_memtable();
         return;
     }
 
+    // One queued flush takes everything written until it runs
+    if (!flush_scheduled_.exchange(true)) {
+        run_in_background(ThreadPool::HIGH, [this] {
+            flush_scheduled_ = false;
+            flush_memtable();
+        });
+    }
+}
+
+void LSMTree::schedule_compaction() {
+    if (!config_.executor || closing_) {
+        trigger_compaction();
+        return;
+    }
+
+    // One queued compaction picks up every trigger made before it runs
+    if (!compaction_scheduled_.exchange(true)) {
+        run_in_background(ThreadPool::LOW, [this] {
+            compaction_scheduled_ = false;
+            trigger_compaction(false);
+        });
+    }
+}
+
+void LSMTree::run_in_background(ThreadPool::Priority priority, std::function<void()> job) {
+    {
+        std::lock_guard<std::mutex> lock(background_mutex_);
+        background_jobs_++;
+    }
+    config_.executor->schedule(priority, [this, job = std::move(job)] {
+        try {
+            job();
+        } catch (const std::exception& e) {
+            logger_->error("Background job failed: ", e.what());
+        } catch (...) {
+            logger_->error("Background job failed with an unknown exception");
+        }
+        std::lock_guard<std::mutex> lock(background_mutex_);
+        if (--background_jobs_ == 0) {
+            background_cv_.notify_all();
+        }
+    });
+}
+
+void LSMTree::wait_for_background_jobs() {
+    std::unique_lock<std::mutex> lock(background_mutex_);
+    background_cv_.wait(lock, [this] { return background_jobs_ == 0; });
+}
+
+void LSMTree::trigger_compaction(bool blocking_writers) {
+    // A trigger that arrives while another compaction runs is left for that one, which
+    // checks for it again before it gives up the flag
+    compaction_requested_ = true;
+    bool budget_spent = false;
+    while (compaction_requested_ && !is_compacting_.exchange(true)) {
+        compaction_requested_ = false;
+        budget_spent = run_compactions(blocking_writers);
+        is_compacting_ = false;
+    }
+
+    // In the background nothing waits for the next flush, work left past the budget gets a new job
+    if (budget_spent && !blocking_writers && !closing_ && level_manager_->needs_compaction()) {
+        schedule_compaction();
+    }
+}
+
+bool LSMTree::run_compactions(bool blocking_writers) {
+    // Inline compaction runs under the memtable lock, so writers stop until it finishes
+    bool stalled = false;
+    size_t budget = config_.max_compactions_per_flush;
+    size_t done = 0;
+
     try {
-        // Check for compaction tasks and process them
-        while (auto task = level_manager_->get_compaction_task()) {
-            std::cout << "Compacting level " << task->source_level
-                      << " -> level " << task->target_level
-                      << " (" << task->input_sstables.size() << " SSTables)" << std::endl;
+        // Check for compaction tasks and process them, the rest wait for the next flush once the budget is spent
+        for (; budget == 0 || done < budget; done++) {
+            auto task = level_manager_->get_compaction_task();
+            if (!task) {
+                break;
+            }
+
+            if (blocking_writers && !stalled) {
+                stalled = true;
+                set_write_stall(WriteStallCondition::STOPPED);
+            }
 
             // Perform compaction using LevelManager's compactor
-            level_manager_->perform_compaction(*task);
+            {
+                OperationLatencies::Timer timer(latencies_, OperationLatencies::COMPACTION);
+                PerfTimer perf_timer(&PerfContext::compaction_ns);
+                level_manager_->perform_compaction(*task);
+            }
 
-            stats_.compactions++;
+            {
+                std::lock_guard<std::recursive_mutex> lock(memtable_mutex_);
+                stats_.compactions++;
+            }
 
             // Print level status after compaction
             // level_manager_->print_levels();
         }
 
     } catch (const std::exception& e) {
-        std::cerr << "Error during compaction: " << e.what() << std::endl;
+        logger_->error("Error during compaction: ", e.what());
     }
 
-    is_compacting_ = false;
+    if (stalled) {
+        set_write_stall(WriteStallCondition::NORMAL);
+    }
+    return budget != 0 && done == budget;
 }
 
-bool LSMTree::is_tombstone(const std::string& value) const {
-    // In your Memtable implementation, remove() sets value to empty string
-    // So empty string is a tombstone
-    return value.empty();
+void LSMTree::throttle_writes() {
+    // Without an executor, compaction runs inline and holds writers back by itself
+    if (!config_.executor) {
+        return;
+    }
+
+    auto past = [this](size_t trigger) {
+        return trigger > 0 && level_manager_->get_sstable_count(0) >= trigger;
+    };
+
+    // A flush that can't keep up would otherwise let the memtable grow without bound
+    while (memtable_.size() >= 2 * memtable_max_size_ && (flush_scheduled_ || is_flushing_) && !closing_) {
+        set_write_stall(WriteStallCondition::STOPPED);
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    while (past(config_.level0_stop_writes_trigger) && !closing_) {
+        set_write_stall(WriteStallCondition::STOPPED);
+        schedule_compaction();  // no-op if one is already queued
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    if (past(config_.level0_slowdown_writes_trigger) && !closing_) {
+        set_write_stall(WriteStallCondition::DELAYED);
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        return;
+    }
+    set_write_stall(WriteStallCondition::NORMAL);
+}
+
+void LSMTree::set_write_stall(WriteStallCondition condition) {
+    if (write_stall_.load() == condition) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(stall_mutex_);
+    WriteStallCondition previous = write_stall_.exchange(condition);
+    if (previous == condition) {
+        return;
+    }
+    if (events_->enabled()) {
+        WriteStallInfo info;
+        info.db_path = data_directory_;
+        info.previous = previous;
+        info.current = condition;
+        events_->notify([info](EventListener& listener) { listener.on_stall_conditions_changed(info); });
+    }
 }
 
 std::string LSMTree::create_tombstone() const {
@@ -393,13 +942,15 @@ std::string LSMTree::create_tombstone() const {
 }
 
 LSMTree::Stats LSMTree::get_stats() const {
-    std::lock_guard<std::recursive_mutex> mem_lock(memtable_mutex_);
-
-    Stats result = stats_;
-
-    // Add current state information
-    result.memtable_size = memtable_.size();
-    result.memtable_entry_count = memtable_.entry_count();
+    Stats result;
+    {
+        // Writers wait on this lock, so hold it for the copy only
+        std::lock_guard<std::recursive_mutex> mem_lock(memtable_mutex_);
+        result = stats_;
+        result.total_gets = total_gets_.load(std::memory_order_relaxed);
+        result.memtable_size = memtable_.size();
+        result.memtable_entry_count = memtable_.entry_count();
+    }
 
     // Get LevelManager stats
     if (level_manager_) {
@@ -407,13 +958,149 @@ LSMTree::Stats LSMTree::get_stats() const {
         result.sstable_counts = lm_stats.sstables_per_level;
         result.sstables_created = lm_stats.total_sstables;
         result.sstables_deleted = lm_stats.sstables_deleted;
+        result.prefix_filter_checks = lm_stats.prefix_filter_checks;
+        result.prefix_filter_skips = lm_stats.prefix_filter_skips;
+        result.range_filter_checks = lm_stats.range_filter_checks;
+        result.range_filter_skips = lm_stats.range_filter_skips;
+    }
+
+    if (row_cache_) {
+        auto rc_stats = row_cache_->get_stats();
+        result.row_cache_hits = rc_stats.hits;
+        result.row_cache_misses = rc_stats.misses;
+        result.row_cache_usage = rc_stats.usage;
+    }
+
+    if (negative_cache_) {
+        auto nc_stats = negative_cache_->get_stats();
+        result.negative_cache_hits = nc_stats.hits;
+        result.negative_cache_misses = nc_stats.misses;
+        result.negative_cache_usage = nc_stats.usage;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(snapshot_mutex_);
+        result.live_snapshots = live_snapshots_.size();
+        if (!live_snapshots_.empty()) {
+            // Ids grow with time, so the first live snapshot is the oldest
+            const auto& oldest = live_snapshots_.begin()->second;
+            result.oldest_snapshot_sequence = oldest.sequence;
+            result.oldest_snapshot_age_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::steady_clock::now() - oldest.created).count();
+        }
     }
 
     return result;
 }
 
+Histogram LSMTree::get_latency_histogram(OperationLatencies::Operation op) const {
+    return latencies_.snapshot(op);
+}
+
+CompactionStats LSMTree::get_compaction_stats() const {
+    return level_manager_->get_compaction_stats();
+}
+
+MetricsSnapshot LSMTree::get_metrics() const {
+    MetricsSnapshot metrics;
+    Stats stats = get_stats();
+
+    auto& counters = metrics.counters;
+    counters["puts"] = stats.total_puts;
+    counters["gets"] = stats.total_gets;
+    counters["deletes"] = stats.total_deletes;
+    counters["memtable_flushes"] = stats.memtable_flushes;
+    counters["compactions"] = stats.compactions;
+    counters["sstables_created"] = stats.sstables_created;
+    counters["sstables_deleted"] = stats.sstables_deleted;
+    counters["prefix_filter_checks"] = stats.prefix_filter_checks;
+    counters["prefix_filter_skips"] = stats.prefix_filter_skips;
+    counters["range_filter_checks"] = stats.range_filter_checks;
+    counters["range_filter_skips"] = stats.range_filter_skips;
+    counters["row_cache_hits"] = stats.row_cache_hits;
+    counters["row_cache_misses"] = stats.row_cache_misses;
+    counters["negative_cache_hits"] = stats.negative_cache_hits;
+    counters["negative_cache_misses"] = stats.negative_cache_misses;
+    counters["transactions_committed"] = stats.transactions_committed;
+    counters["transaction_conflicts"] = stats.transaction_conflicts;
+
+    auto& gauges = metrics.gauges;
+    gauges["memtable_bytes"] = static_cast<double>(stats.memtable_size);
+    gauges["memtable_entries"] = static_cast<double>(stats.memtable_entry_count);
+    gauges["memtable_capacity_bytes"] = static_cast<double>(memtable_max_size_);
+    gauges["row_cache_bytes"] = static_cast<double>(stats.row_cache_usage);
+    gauges["negative_cache_bytes"] = static_cast<double>(stats.negative_cache_usage);
+    gauges["live_snapshots"] = static_cast<double>(stats.live_snapshots);
+    gauges["oldest_snapshot_age_ms"] = static_cast<double>(stats.oldest_snapshot_age_ms);
+
+    auto pool = buffer_pool_->get_stats();
+    counters["buffer_pool_hits"] = pool.hits;
+    counters["buffer_pool_misses"] = pool.misses;
+    counters["buffer_pool_evictions"] = pool.evictions;
+    gauges["buffer_pool_pages"] = static_cast<double>(pool.current_size);
+    gauges["buffer_pool_capacity_pages"] = static_cast<double>(pool.capacity);
+    gauges["buffer_pool_hit_rate"] = pool.hits + pool.misses > 0
+        ? static_cast<double>(pool.hits) / static_cast<double>(pool.hits + pool.misses) : 0.0;
+
+    CompactionStats compaction = get_compaction_stats();
+    counters["bytes_flushed"] = compaction.bytes_flushed;
+    for (size_t i = 0; i < compaction.levels.size(); i++) {
+        const auto& level = compaction.levels[i];
+        std::string label = "{level=\"" + std::to_string(i) + "\"}";
+        gauges["level_files" + label] = static_cast<double>(level.files);
+        gauges["level_bytes" + label] = static_cast<double>(level.bytes);
+        counters["compaction_bytes_read" + label] = level.bytes_read;
+        counters["compaction_bytes_written" + label] = level.bytes_written;
+    }
+    gauges["write_amplification"] = compaction.write_amplification;
+    gauges["read_amplification"] = compaction.read_amplification;
+    gauges["space_amplification"] = compaction.space_amplification;
+
+    for (int op = 0; op < OperationLatencies::OPERATION_COUNT; op++) {
+        auto operation = static_cast<OperationLatencies::Operation>(op);
+        Histogram histogram = latencies_.snapshot(operation);
+        if (histogram.count() > 0) {
+            metrics.histograms[std::string("latency_ns{op=\"") + OperationLatencies::name(operation) + "\"}"] = histogram;
+        }
+    }
+
+    // The executor may be shared, so these cover every tree using it
+    if (config_.executor) {
+        for (int p = 0; p < ThreadPool::PRIORITY_COUNT; p++) {
+            auto priority = static_cast<ThreadPool::Priority>(p);
+            auto pool = config_.executor->get_stats(priority);
+            std::string label = std::string("{priority=\"") + ThreadPool::name(priority) + "\"}";
+            gauges["executor_queue_depth" + label] = static_cast<double>(pool.queue_depth);
+            gauges["executor_running" + label] = static_cast<double>(pool.running);
+            counters["executor_jobs_completed" + label] = pool.completed;
+            counters["executor_jobs_stolen" + label] = pool.stolen;
+            if (pool.wait_ns.count() > 0) {
+                metrics.histograms["executor_wait_ns" + label] = pool.wait_ns;
+            }
+        }
+    }
+    return metrics;
+}
+
+bool LSMTree::start_trace(const std::string& path, const Tracer::Options& options) {
+    if (!tracer_.start(path, options)) {
+        logger_->error("Failed to start trace at ", path);
+        return false;
+    }
+    logger_->info("Tracing operations to ", path);
+    return true;
+}
+
+bool LSMTree::end_trace() {
+    if (!tracer_.stop()) {
+        return false;
+    }
+    logger_->info("Trace ended after ", tracer_.records(), " records");
+    return true;
+}
+
 size_t LSMTree::get_memtable_size() const {
-    std::lock_guard<std::recursive_mutex> lock(memtable_mutex_);
+    std::shared_lock<std::shared_mutex> lock(memtable_data_mutex_);
     return memtable_.size();
 }
 
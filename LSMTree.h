@@ -3,36 +3,148 @@
 
 #include "Memtable.h"
 #include "SSTableReader.h"
+#include "SSTableWriter.h"
 #include "WriteAheadLog.h"
 #include "BufferPool.h"
 #include "LevelManager.h"  // Add this line
+#include "PrefixExtractor.h"
+#include "RowCache.h"
+#include "NegativeCache.h"
+#include "WriteBatch.h"
+#include "Transaction.h"
+#include "Histogram.h"
+#include "PerfContext.h"
+#include "EventListener.h"
+#include "Logger.h"
+#include "StatsDumper.h"
+#include "Tracer.h"
+#include "ThreadPool.h"
 #include <vector>
 #include <map>
 #include <memory>
 #include <string>
 #include <atomic>
 #include <mutex>
+#include <shared_mutex>
 #include <optional>
 #include <filesystem>
+#include <chrono>
+#include <unordered_map>
 
 class LSMTree {
 public:
+    // Configuration struct
+    struct Config {
+        size_t memtable_size;
+        size_t buffer_pool_size;
+        size_t bits_per_entry;                                     // Bloom filter bits per key
+        std::shared_ptr<const PrefixExtractor> prefix_extractor;   // nullptr disables prefix filters
+        bool range_filter;                                         // build range filters to prune short scans
+        bool learned_index;                                        // use learned indexes for numeric friendly keys
+        bool hash_index;                                           // hash lookups before searching the key directory
+        size_t row_cache_size;                                     // bytes of hot key-value pairs cached, 0 disables
+        size_t negative_cache_size;                                // bytes of recently missed keys cached, 0 disables
+        LevelManager::Config level_config;
+        bool use_wal = true;                                       // false when an owner such as ColumnFamilyDB logs writes
+        bool sync_wal = true;                                      // fsync every WAL commit, false leaves it to the OS
+        std::vector<std::shared_ptr<EventListener>> listeners;     // told about flushes, compactions and files
+        LogLevel log_level = LogLevel::INFO;                       // for the LOG file in the data directory
+        std::shared_ptr<Logger> logger;                            // shared logger, nullptr opens data_dir/LOG
+        std::chrono::milliseconds stats_dump_period{0};            // metrics written this often, 0 disables
+        std::string stats_dump_path;                               // empty writes data_dir/metrics.prom or .jsonl
+        MetricsFormat stats_dump_format = MetricsFormat::PROMETHEUS;
+        std::shared_ptr<Env> env;                                  // file system for every file, nullptr for Env::default_env()
+        std::shared_ptr<BufferPool> buffer_pool;                   // pool shared with other trees, nullptr creates one of buffer_pool_size
+        size_t max_compactions_per_flush = 0;                      // compactions run after one flush, 0 runs until none is needed
+        std::shared_ptr<ThreadPool> executor;                      // runs flushes and compactions in the background, nullptr runs them inline
+        size_t level0_slowdown_writes_trigger = 8;                 // with an executor, level 0 tables that delay each write, 0 disables
+        size_t level0_stop_writes_trigger = 12;                    // with an executor, level 0 tables that stop writes, 0 disables
+
+        explicit Config(
+            size_t memtable_size_ = 1024 * 1024,         // 1MB
+            size_t buffer_pool_size_ = 10 * 1024 * 1024, // 10MB
+            size_t bits_per_entry_ = 8,
+            std::shared_ptr<const PrefixExtractor> prefix_extractor_ = nullptr,
+            bool range_filter_ = false,
+            bool learned_index_ = false,
+            bool hash_index_ = false,
+            size_t row_cache_size_ = 0,
+            size_t negative_cache_size_ = 0
+        )
+            : memtable_size(memtable_size_),
+              buffer_pool_size(buffer_pool_size_),
+              bits_per_entry(bits_per_entry_),
+              prefix_extractor(std::move(prefix_extractor_)),
+              range_filter(range_filter_),
+              learned_index(learned_index_),
+              hash_index(hash_index_),
+              row_cache_size(row_cache_size_),
+              negative_cache_size(negative_cache_size_)
+        {}
+    };
+
     // Constructor with configuration
     LSMTree(const std::string& data_dir = "./data",
             size_t memtable_size = 1024 * 1024,      // 1MB
             size_t buffer_pool_size = 10 * 1024 * 1024, // 10MB
-            size_t bits_per_entry = 8);              // For filters (future use)
+            size_t bits_per_entry = 8);              // Bloom filter bits per key
+
+    LSMTree(const std::string& data_dir, const Config& config);
 
     ~LSMTree();
 
+    // Point-in-time view of the tree. Holds a frozen copy of the memtable and the level
+    // layout at creation, so flushes and compactions can't change what it reads
+    class Snapshot {
+    public:
+        uint64_t sequence() const { return sequence_; }
+
+    private:
+        friend class LSMTree;
+
+        uint64_t id_ = 0;
+        uint64_t sequence_ = 0;  // writes up to and including this one are visible
+        std::shared_ptr<const std::map<std::string, Memtable::Entry>> memtable_;
+        LevelManager::VersionPtr version_;
+    };
+    using SnapshotPtr = std::shared_ptr<const Snapshot>;
+
+    // Read options, a null snapshot reads the latest state
+    struct ReadOptions {
+        SnapshotPtr snapshot;
+    };
+
+    // Pin the current state until release_snapshot
+    SnapshotPtr get_snapshot();
+    void release_snapshot(const SnapshotPtr& snapshot);
+
     // Public API
     bool put(const std::string& key, const std::string& value);
     std::optional<std::string> get(const std::string& key);
+    std::optional<std::string> get(const std::string& key, const ReadOptions& options);
     bool remove(const std::string& key);
 
+    // Apply every operation in the batch, atomically for readers and WAL recovery
+    bool write(const WriteBatch& batch);
+
+    // Start an optimistic transaction, see Transaction
+    std::unique_ptr<Transaction> begin_transaction();
+
+    // Look up several keys against one consistent state
+    std::vector<std::optional<std::string>>
+        multi_get(const std::vector<std::string>& keys, const ReadOptions& options = ReadOptions());
+
     // Range scan (returns key-value pairs in range)
+    // SSTables whose range filter rules out the range are skipped
     std::vector<std::pair<std::string, std::string>>
         scan(const std::string& start_key, const std::string& end_key);
+    std::vector<std::pair<std::string, std::string>>
+        scan(const std::string& start_key, const std::string& end_key, const ReadOptions& options);
+
+    // Prefix scan (returns all key-value pairs whose key starts with prefix)
+    // SSTables whose prefix bloom filter rules out the prefix are skipped
+    std::vector<std::pair<std::string, std::string>>
+        scan_prefix(const std::string& prefix);
 
     // Statistics
     struct Stats {
@@ -46,10 +158,38 @@ public:
         size_t memtable_size = 0;
         size_t memtable_entry_count = 0;
         std::vector<size_t> sstable_counts;
+        size_t prefix_filter_checks = 0;
+        size_t prefix_filter_skips = 0;
+        size_t range_filter_checks = 0;
+        size_t range_filter_skips = 0;
+        size_t row_cache_hits = 0;
+        size_t row_cache_misses = 0;
+        size_t row_cache_usage = 0;
+        size_t negative_cache_hits = 0;
+        size_t negative_cache_misses = 0;
+        size_t negative_cache_usage = 0;
+        size_t transactions_committed = 0;
+        size_t transaction_conflicts = 0;
+        size_t live_snapshots = 0;
+        uint64_t oldest_snapshot_sequence = 0;
+        size_t oldest_snapshot_age_ms = 0;  // how long the oldest live snapshot has been held
     };
 
     Stats get_stats() const;
 
+    // Latency distribution of one operation type in nanoseconds, since the tree was opened
+    Histogram get_latency_histogram(OperationLatencies::Operation op) const;
+
+    // Flush and compaction work per level since the tree was opened, with amplification
+    CompactionStats get_compaction_stats() const;
+
+    // Counters, latencies, level sizes and cache usage in one snapshot, as dumped to the metrics file
+    MetricsSnapshot get_metrics() const;
+
+    // Record every put, get, remove, scan and write call to a trace file until end_trace()
+    bool start_trace(const std::string& path, const Tracer::Options& options = Tracer::Options());
+    bool end_trace();
+
     // For testing/debugging
     size_t get_memtable_size() const;
     size_t get_sstable_count() const;
@@ -60,30 +200,67 @@ public:
 
     bool flush_memtable();
 
+    // Block until the flushes and compactions this tree queued on its executor are done
+    void wait_for_background_jobs();
+
 private:
+    // Declared first so the directory stays locked until everything else is torn down
+    std::shared_ptr<Env> env_;
+    std::unique_ptr<FileLock> db_lock_;            // data_dir/LOCK, held while open
+
     // Core components
     Memtable memtable_;
-    std::unique_ptr<WriteAheadLog> wal_;
+    std::unique_ptr<WriteAheadLog> wal_;           // nullptr when config_.use_wal is false
     std::shared_ptr<BufferPool> buffer_pool_;
     std::unique_ptr<LevelManager> level_manager_;  // Replace old levels_ with LevelManager
+    std::unique_ptr<RowCache> row_cache_;          // nullptr when disabled
+    std::unique_ptr<NegativeCache> negative_cache_;  // nullptr when disabled
+    std::shared_ptr<EventNotifier> events_;        // shared with level_manager_
+    std::shared_ptr<Logger> logger_;               // shared with level_manager_
+    std::unique_ptr<StatsDumper> stats_dumper_;    // nullptr unless config_.stats_dump_period is set
+    Tracer tracer_;                                // idle until start_trace()
 
     // Configuration
     std::string data_directory_;
     size_t memtable_max_size_;
     size_t buffer_pool_size_;
     size_t bits_per_entry_;
+    Config config_;
 
     // State
-    std::atomic<uint64_t> sequence_number_{0};
+    std::atomic<uint64_t> sequence_number_{0};     // bumped by every put and remove
     std::atomic<bool> is_flushing_{false};
     std::atomic<bool> is_compacting_{false};
 
     // Mutexes for thread safety
     mutable std::recursive_mutex memtable_mutex_;  // Changed to recursive_mutex
+    // Guards memtable_ contents: writers hold memtable_mutex_ and take this exclusively
+    // only to mutate, readers take it shared and never wait on each other
+    mutable std::shared_mutex memtable_data_mutex_;
     mutable std::recursive_mutex level_mutex_;     // Changed to recursive_mutex
 
+    // Live snapshots by id, with their sequence number and creation time
+    struct SnapshotInfo {
+        uint64_t sequence;
+        std::chrono::steady_clock::time_point created;
+    };
+    std::map<uint64_t, SnapshotInfo> live_snapshots_;
+    uint64_t next_snapshot_id_ = 0;
+    mutable std::mutex snapshot_mutex_;
+
+    // Memtable copy shared by snapshots taken with no write in between
+    std::shared_ptr<const std::map<std::string, Memtable::Entry>> frozen_memtable_;
+    uint64_t frozen_sequence_ = 0;
+
+    // Last write sequence per key, for transaction validation. Cleared when it grows too
+    // big, writes at or below the floor are forgotten
+    std::unordered_map<std::string, uint64_t> recent_writes_;
+    uint64_t recent_writes_floor_ = 0;
+
     // Statistics
     Stats stats_;
+    std::atomic<size_t> total_gets_{0};  // bumped by readers outside memtable_mutex_
+    OperationLatencies latencies_;
 
     // Private methods
     void initialize_directories();
@@ -93,19 +270,62 @@ private:
 
     bool should_flush_memtable() const;
 
-    // Compaction operations
-    void trigger_compaction();
+    // Compaction operations, blocking_writers when run inline under memtable_mutex_
+    void trigger_compaction(bool blocking_writers = true);
+
+    // Compact until no task is left or the per flush budget is spent, true if it was spent
+    bool run_compactions(bool blocking_writers);
+
+    // Hold a writer back while a background flush lags behind the memtable or compaction
+    // lags behind level 0, called before taking memtable_mutex_
+    void throttle_writes();
+
+    // Record the stall condition and tell listeners when it changed
+    void set_write_stall(WriteStallCondition condition);
+    std::mutex stall_mutex_;
+    std::atomic<WriteStallCondition> write_stall_{WriteStallCondition::NORMAL};  // changed under stall_mutex_
+
+    // Queue work on config_.executor, or run it inline without one or once the tree is closing
+    void schedule_flush();
+    void schedule_compaction();
+    void run_in_background(ThreadPool::Priority priority, std::function<void()> job);
+
+    std::atomic<bool> flush_scheduled_{false};
+    std::atomic<bool> compaction_scheduled_{false};
+    std::atomic<bool> compaction_requested_{false};  // a trigger not yet seen by a compaction run
+    std::atomic<bool> closing_{false};
+    std::mutex background_mutex_;
+    std::condition_variable background_cv_;
+    size_t background_jobs_ = 0;  // queued or running on the executor, under background_mutex_
 
     // Helper methods
     std::string generate_sstable_filename(int level, uint64_t id);
+    SSTableWriter::Options make_table_options() const;
 
     // Search methods
-    std::optional<std::string> search_sstables(const std::string& key) const;
+    std::optional<std::string> search_sstables(const std::string& key,
+                                               const LevelManager::VersionPtr& version = nullptr) const;
     std::vector<std::pair<std::string, std::string>>
-        scan_sstables(const std::string& start_key, const std::string& end_key) const;
+        scan_sstables(const std::string& start_key, const std::string& end_key,
+                      const LevelManager::VersionPtr& version = nullptr) const;
+    std::optional<std::string> get_at(const std::string& key, const Snapshot& snapshot);
+
+    // Write helpers, caller holds memtable_mutex_
+    template <typename WalWrite>
+    bool timed_wal_write(WalWrite&& write) {
+        OperationLatencies::Timer timer(latencies_, OperationLatencies::WAL_WRITE);
+        PerfTimer perf_timer(&PerfContext::wal_write_ns);
+        return write();
+    }
+    void record_write(const std::string& key);
+    bool apply_batch_locked(const WriteBatch& batch);
+
+    // Validate a transaction's tracked keys and apply its batch
+    friend class Transaction;
+    Transaction::Status commit_transaction(const std::unordered_map<std::string, uint64_t>& tracked,
+                                           const WriteBatch& batch);
 
     // Tombstone handling
-    bool is_tombstone(const std::string& value) const;
     std::string create_tombstone() const;
 
     // WAL helpers
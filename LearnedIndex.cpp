@@ -0,0 +1,237 @@
+#include "LearnedIndex.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+namespace {
+    constexpr size_t KEY_BYTES = sizeof(uint64_t);
+    constexpr size_t MAX_DECIMAL_DIGITS = 19;  // always fits in uint64_t
+    constexpr size_t SEGMENT_SIZE = sizeof(uint64_t) + sizeof(double) + sizeof(uint32_t);
+
+    size_t shared_prefix_length(const std::vector<std::string>& sorted_keys) {
+        // In sorted order the first and last key share the least
+        const std::string& first = sorted_keys.front();
+        const std::string& last = sorted_keys.back();
+        const size_t n = std::min(first.size(), last.size());
+        size_t i = 0;
+        while (i < n && first[i] == last[i]) ++i;
+        return i;
+    }
+
+    template <typename T>
+    void append(std::string& out, const T& value) {
+        out.append(reinterpret_cast<const char*>(&value), sizeof(value));
+    }
+
+    template <typename T>
+    bool read(const std::string& data, size_t& pos, T& value) {
+        if (data.size() - pos < sizeof(value)) return false;
+        std::memcpy(&value, data.data() + pos, sizeof(value));
+        pos += sizeof(value);
+        return true;
+    }
+}
+
+std::optional<uint64_t> LearnedIndex::key_to_x(const std::string& key) const {
+    if (key.compare(0, shared_prefix_.size(), shared_prefix_) != 0) {
+        return std::nullopt;
+    }
+
+    if (mode_ == KeyMode::DECIMAL) {
+        const size_t digits = key.size() - shared_prefix_.size();
+        if (digits == 0 || digits > MAX_DECIMAL_DIGITS) {
+            return std::nullopt;
+        }
+
+        uint64_t x = 0;
+        for (size_t pos = shared_prefix_.size(); pos < key.size(); ++pos) {
+            if (key[pos] < '0' || key[pos] > '9') {
+                return std::nullopt;
+            }
+            x = x * 10 + static_cast<uint64_t>(key[pos] - '0');
+        }
+        return x;
+    }
+
+    // Big endian so integer order follows byte order, short keys are padded with zeros
+    uint64_t x = 0;
+    for (size_t i = 0; i < KEY_BYTES; ++i) {
+        const size_t pos = shared_prefix_.size() + i;
+        const uint64_t byte = pos < key.size() ? static_cast<uint8_t>(key[pos]) : 0;
+        x = (x << 8) | byte;
+    }
+    return x;
+}
+
+std::optional<LearnedIndex> LearnedIndex::build(const std::vector<std::string>& sorted_keys, uint32_t epsilon) {
+    if (sorted_keys.size() < MIN_KEYS_PER_SEGMENT * (static_cast<size_t>(epsilon) + 1) ||
+        sorted_keys.size() > std::numeric_limits<uint32_t>::max()) {
+        return std::nullopt;
+    }
+
+    LearnedIndex index;
+    index.epsilon_ = epsilon;
+    index.key_count_ = static_cast<uint32_t>(sorted_keys.size());
+    index.shared_prefix_ = sorted_keys.front().substr(0, shared_prefix_length(sorted_keys));
+
+    // 1. Map keys, giving up on a mode if a key can't be mapped or two keys map to the same integer
+    auto map_keys = [&index, &sorted_keys](KeyMode mode, std::vector<uint64_t>& xs) {
+        index.mode_ = mode;
+        xs.clear();
+        xs.reserve(sorted_keys.size());
+        for (const auto& key : sorted_keys) {
+            auto x = index.key_to_x(key);
+            if (!x || (!xs.empty() && *x <= xs.back())) {
+                return false;
+            }
+            xs.push_back(*x);
+        }
+        return true;
+    };
+
+    std::vector<uint64_t> xs;
+    if (!map_keys(KeyMode::DECIMAL, xs) && !map_keys(KeyMode::BYTES, xs)) {
+        return std::nullopt;
+    }
+
+    // 2. Greedy shrinking cone: extend a segment while some slope keeps every point within epsilon
+    const auto eps = static_cast<double>(epsilon);
+    size_t start = 0;
+    double slope_low = -std::numeric_limits<double>::infinity();
+    double slope_high = std::numeric_limits<double>::infinity();
+
+    auto close_segment = [&](size_t end) {
+        double slope = 0.0;
+        if (end - start > 1) {
+            slope = (slope_low + slope_high) / 2.0;
+        }
+        index.segments_.push_back({xs[start], slope, static_cast<uint32_t>(start)});
+    };
+
+    for (size_t i = 1; i < xs.size(); ++i) {
+        const auto dx = static_cast<double>(xs[i] - xs[start]);
+        const auto dy = static_cast<double>(i - start);
+        const double low = std::max(slope_low, (dy - eps) / dx);
+        const double high = std::min(slope_high, (dy + eps) / dx);
+
+        if (low > high) {
+            close_segment(i);
+            start = i;
+            slope_low = -std::numeric_limits<double>::infinity();
+            slope_high = std::numeric_limits<double>::infinity();
+        } else {
+            slope_low = low;
+            slope_high = high;
+        }
+    }
+    close_segment(xs.size());
+
+    if (index.segments_.size() * MIN_KEYS_PER_SEGMENT > sorted_keys.size()) {
+        return std::nullopt;
+    }
+
+    // 3. Rounding must never push a key outside its search range
+    for (size_t i = 0; i < sorted_keys.size(); ++i) {
+        auto range = index.search_range(sorted_keys[i]);
+        if (!range || i < range->begin || i >= range->end) {
+            return std::nullopt;
+        }
+    }
+
+    return index;
+}
+
+size_t LearnedIndex::predict(uint64_t x) const {
+    // Last segment starting at or before x
+    auto it = std::upper_bound(segments_.begin(), segments_.end(), x,
+        [](uint64_t value, const Segment& segment) {
+            return value < segment.first_x;
+        });
+    if (it == segments_.begin()) {
+        return 0;
+    }
+    --it;
+
+    const double predicted = static_cast<double>(it->first_y) +
+                             it->slope * static_cast<double>(x - it->first_x);
+    if (predicted <= 0.0) {
+        return 0;
+    }
+    return std::min(static_cast<size_t>(std::llround(predicted)), static_cast<size_t>(key_count_) - 1);
+}
+
+std::optional<LearnedIndex::SearchRange> LearnedIndex::search_range(const std::string& key) const {
+    auto x = key_to_x(key);
+    if (!x || key_count_ == 0) {
+        return std::nullopt;
+    }
+
+    // One extra slot on each side absorbs rounding of the prediction
+    const size_t position = predict(*x);
+    const size_t reach = static_cast<size_t>(epsilon_) + 1;
+    SearchRange range{};
+    range.begin = position > reach ? position - reach : 0;
+    range.end = std::min(position + reach + 1, static_cast<size_t>(key_count_));
+    return range;
+}
+
+std::string LearnedIndex::serialize() const {
+    std::string out;
+    append(out, epsilon_);
+    append(out, static_cast<uint32_t>(mode_));
+    append(out, key_count_);
+    append(out, static_cast<uint32_t>(shared_prefix_.size()));
+    out += shared_prefix_;
+    append(out, static_cast<uint32_t>(segments_.size()));
+    for (const auto& segment : segments_) {
+        append(out, segment.first_x);
+        append(out, segment.slope);
+        append(out, segment.first_y);
+    }
+    return out;
+}
+
+std::optional<LearnedIndex> LearnedIndex::deserialize(const std::string& data) {
+    LearnedIndex index;
+    size_t pos = 0;
+
+    uint32_t mode = 0;
+    uint32_t prefix_len = 0;
+    if (!read(data, pos, index.epsilon_) || !read(data, pos, mode) || !read(data, pos, index.key_count_) ||
+        !read(data, pos, prefix_len) || data.size() - pos < prefix_len) {
+        return std::nullopt;
+    }
+    if (mode != static_cast<uint32_t>(KeyMode::DECIMAL) && mode != static_cast<uint32_t>(KeyMode::BYTES)) {
+        return std::nullopt;
+    }
+    index.mode_ = static_cast<KeyMode>(mode);
+    index.shared_prefix_ = data.substr(pos, prefix_len);
+    pos += prefix_len;
+
+    uint32_t segment_count = 0;
+    if (!read(data, pos, segment_count) || segment_count == 0 ||
+        (data.size() - pos) != static_cast<size_t>(segment_count) * SEGMENT_SIZE) {
+        return std::nullopt;
+    }
+
+    index.segments_.reserve(segment_count);
+    for (uint32_t i = 0; i < segment_count; ++i) {
+        Segment segment{};
+        read(data, pos, segment.first_x);
+        read(data, pos, segment.slope);
+        read(data, pos, segment.first_y);
+
+        if (segment.first_y >= index.key_count_ || !std::isfinite(segment.slope) ||
+            (!index.segments_.empty() && segment.first_x <= index.segments_.back().first_x)) {
+            return std::nullopt;
+        }
+        index.segments_.push_back(segment);
+    }
+
+    return index;
+}
+
+size_t LearnedIndex::memory_usage() const {
+    return sizeof(LearnedIndex) + shared_prefix_.capacity() + segments_.capacity() * sizeof(Segment);
+}
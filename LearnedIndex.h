@@ -0,0 +1,114 @@
+#ifndef KVDB_LEARNEDINDEX_H
+#define KVDB_LEARNEDINDEX_H
+
+#include <string>
+#include <vector>
+#include <optional>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * Learned index over a sorted key directory (single level PGM style)
+ *
+ * Keys are mapped to integers by dropping the prefix every key shares and either parsing
+ * the rest as a decimal number (IDs like "order000123") or reading the next 8 bytes big
+ * endian. A piecewise linear model is fit over (integer, position) so
+ * that every prediction is within epsilon of the real position, and lookups finish with
+ * a binary search over that small window. Keys that don't map to strictly increasing
+ * integers, or need too many segments to be worth it, don't get a model, and neither
+ * do tables so small that the search window covers a good part of them.
+ *
+ * Serialized format:
+ * - Epsilon (uint32_t)
+ * - Key mode (uint32_t): see KeyMode
+ * - Key count (uint32_t)
+ * - Shared prefix length (uint32_t), shared prefix
+ * - Segment count (uint32_t)
+ * Array of:
+ *  - First key as integer (uint64_t)
+ *  - Slope (double)
+ *  - Position of first key (uint32_t)
+ */
+class LearnedIndex
+{
+public:
+    /**
+     * Half-open range of directory positions that must hold the key if it's present
+     */
+    struct SearchRange
+    {
+        size_t begin;
+        size_t end;
+    };
+
+    /**
+     * Fit a model over a key directory, decimal keys are tried before raw bytes
+     * @param sorted_keys keys in ascending order
+     * @param epsilon maximum distance between predicted and real position
+     * @return empty optional if the keys aren't a good fit for a learned index
+     */
+    static std::optional<LearnedIndex> build(const std::vector<std::string>& sorted_keys, uint32_t epsilon);
+
+    /**
+     * Predict where a key lives
+     * @return empty optional if the key can't be in the directory at all
+     */
+    [[nodiscard]] std::optional<SearchRange> search_range(const std::string& key) const;
+
+    /**
+     * Serialize model for storage in an SSTable
+     */
+    [[nodiscard]] std::string serialize() const;
+
+    /**
+     * Rebuild a model from serialized bytes
+     * @return empty optional if data is malformed
+     */
+    static std::optional<LearnedIndex> deserialize(const std::string& data);
+
+    /**
+     * Get approximate memory usage in bytes
+     */
+    [[nodiscard]] size_t memory_usage() const;
+
+    [[nodiscard]] size_t segment_count() const { return segments_.size(); }
+    [[nodiscard]] uint32_t epsilon() const { return epsilon_; }
+    [[nodiscard]] size_t key_count() const { return key_count_; }
+
+    // Fewer keys per segment than this and binary search is just as good,
+    // tables also need this many keys per slot of the search window
+    static constexpr size_t MIN_KEYS_PER_SEGMENT = 8;
+
+private:
+    enum class KeyMode : uint32_t {
+        DECIMAL = 0,  // rest of the key is up to 19 decimal digits
+        BYTES = 1     // next 8 bytes of the key, big endian
+    };
+
+    struct Segment
+    {
+        uint64_t first_x;
+        double slope;
+        uint32_t first_y;
+    };
+
+    LearnedIndex() = default;
+
+    uint32_t epsilon_ = 0;
+    KeyMode mode_ = KeyMode::BYTES;
+    uint32_t key_count_ = 0;
+    std::string shared_prefix_;
+    std::vector<Segment> segments_;
+
+    /**
+     * Map a key to its integer, keys without the shared prefix can't be mapped
+     */
+    [[nodiscard]] std::optional<uint64_t> key_to_x(const std::string& key) const;
+
+    /**
+     * Predicted position, clamped to the directory
+     */
+    [[nodiscard]] size_t predict(uint64_t x) const;
+};
+
+#endif //KVDB_LEARNEDINDEX_H
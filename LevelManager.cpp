@@ -1,5 +1,6 @@
 #include "LevelManager.h"
 #include "SSTableWriter.h"
+#include "PerfContext.h"
 #include <filesystem>
 #include <fstream>
 #include <algorithm>
@@ -10,23 +11,65 @@
 
 namespace fs = std::filesystem;
 
+namespace {
+    // Most tables whose [min_key, max_key] ranges share a key, so a point lookup may probe them all
+    size_t max_key_overlap(const std::vector<LevelManager::SSTablePtr>& sstables) {
+        std::vector<std::pair<std::string, int>> bounds;  // +1 opens a range, -1 closes it
+        bounds.reserve(sstables.size() * 2);
+        for (const auto& sstable : sstables) {
+            bounds.emplace_back(sstable->min_key(), 1);
+            bounds.emplace_back(sstable->max_key(), -1);
+        }
+
+        // Ranges are inclusive, so at equal keys opens sort ahead of closes
+        std::sort(bounds.begin(), bounds.end(), [](const auto& a, const auto& b) {
+            return a.first != b.first ? a.first < b.first : a.second > b.second;
+        });
+
+        size_t open = 0;
+        size_t max_open = 0;
+        for (const auto& [key, delta] : bounds) {
+            if (delta > 0) {
+                max_open = std::max(max_open, ++open);
+            } else {
+                open--;
+            }
+        }
+        return max_open;
+    }
+}
+
 LevelManager::LevelManager(const std::string& data_dir,
                          std::shared_ptr<BufferPool> buffer_pool,
                          const Config& config)
     : data_directory_(data_dir),
       buffer_pool_(buffer_pool),
-      config_(config) {
+      config_(config),
+      logger_(config.logger ? config.logger : Logger::stderr_logger()),
+      env_(config.env ? config.env : Env::default_env()) {
+
+    // Tables are written and read through the same env as the directories
+    config_.table_options.env = env_;
 
     // Initialize directories
     for (int i = 0; i < static_cast<int>(config_.max_levels); i++) {
         std::string level_dir = data_directory_ + "/level_" + std::to_string(i);
-        fs::create_directories(level_dir);
+        env_->create_dirs(level_dir);
     }
 
     // Initialize compactor configuration
     compactor_config_.buffer_size = 4096; // 4KB buffer as per assignment
     compactor_config_.max_merge_fan_in = 10;
     compactor_config_.remove_tombstones = true;
+    compactor_config_.table_options = config_.table_options;
+    compactor_config_.logger = logger_;
+    compactor_config_.target_file_size = config_.target_sstable_size;
+
+    // Outputs are written straight into their level's directory under the level's next sequence
+    compactor_config_.output_filename = [this](int level) {
+        std::lock_guard<std::recursive_mutex> lock(levels_mutex_);
+        return generate_sstable_filename(level, levels_[level].next_sstable_id++);
+    };
 
     // Initialize compactor
     compactor_ = std::make_unique<Compactor>(buffer_pool, compactor_config_);
@@ -37,11 +80,12 @@ LevelManager::LevelManager(const std::string& data_dir,
     // Load existing SSTables
     load_existing_sstables();
 
-    std::cout << "LevelManager initialized with " << levels_.size() << " levels" << std::endl;
+    logger_->info("LevelManager initialized with ", levels_.size(), " levels");
 }
 
 void LevelManager::initialize_levels() {
     levels_.resize(config_.max_levels);
+    level_compaction_stats_.resize(config_.max_levels);
 
     for (int i = 0; i < static_cast<int>(levels_.size()); i++) {
         levels_[i].level_id = i;
@@ -60,11 +104,12 @@ void LevelManager::initialize_levels() {
 
         // Initialize next SSTable ID by scanning directory
         std::string level_dir = data_directory_ + "/level_" + std::to_string(i);
-        if (fs::exists(level_dir)) {
+        std::vector<std::string> children;
+        if (env_->get_children(level_dir, children)) {
             uint64_t max_id = 0;
-            for (const auto& entry : fs::directory_iterator(level_dir)) {
-                if (entry.is_regular_file() && entry.path().extension() == ".sst") {
-                    uint64_t seq = parse_sequence_from_filename(entry.path().string());
+            for (const auto& name : children) {
+                if (fs::path(name).extension() == ".sst") {
+                    uint64_t seq = parse_sequence_from_filename(name);
                     if (seq > max_id) {
                         max_id = seq;
                     }
@@ -81,15 +126,16 @@ void LevelManager::load_existing_sstables() {
     for (int level = 0; level < static_cast<int>(levels_.size()); level++) {
         std::string level_dir = data_directory_ + "/level_" + std::to_string(level);
 
-        if (!fs::exists(level_dir)) {
+        std::vector<std::string> children;
+        if (!env_->get_children(level_dir, children)) {
             continue;
         }
 
         // Collect all SST files
         std::vector<std::string> sst_files;
-        for (const auto& entry : fs::directory_iterator(level_dir)) {
-            if (entry.is_regular_file() && entry.path().extension() == ".sst") {
-                sst_files.push_back(entry.path().string());
+        for (const auto& name : children) {
+            if (fs::path(name).extension() == ".sst") {
+                sst_files.push_back(level_dir + "/" + name);
             }
         }
 
@@ -101,7 +147,7 @@ void LevelManager::load_existing_sstables() {
 
         // Load each SSTable
         for (const auto& filename : sst_files) {
-            auto sstable = std::make_shared<SSTableReader>(filename);
+            auto sstable = std::make_shared<SSTableReader>(filename, env_);
             if (sstable->is_valid()) {
                 levels_[level].sstables.push_back(sstable);
                 stats_.sstables_created++;
@@ -109,8 +155,34 @@ void LevelManager::load_existing_sstables() {
         }
     }
 
+    install_version();
     stats_dirty_ = true;
-    std::cout << "Loaded " << get_total_sstable_count() << " existing SSTables" << std::endl;
+    logger_->info("Loaded ", get_total_sstable_count(), " existing SSTables");
+}
+
+void LevelManager::install_version() {
+    auto version = std::make_shared<Version>();
+    version->levels.resize(levels_.size());
+
+    for (int level = 0; level < static_cast<int>(levels_.size()); level++) {
+        auto& tables = version->levels[level];
+
+        // Compaction inputs are older than anything added to their level since
+        auto pending = compacting_.find(level);
+        if (pending != compacting_.end()) {
+            tables = pending->second;
+        }
+        tables.insert(tables.end(), levels_[level].sstables.begin(), levels_[level].sstables.end());
+
+        if (level > 0 && pending != compacting_.end()) {
+            std::sort(tables.begin(), tables.end(),
+                      [](const SSTablePtr& a, const SSTablePtr& b) {
+                          return a->min_key() < b->min_key();
+                      });
+        }
+    }
+
+    current_.store(std::move(version), std::memory_order_release);
 }
 
 bool LevelManager::add_sstable_level0(SSTablePtr sstable) {
@@ -121,29 +193,46 @@ bool LevelManager::add_sstable_level0(SSTablePtr sstable) {
     std::string new_filename = generate_sstable_filename(0, seq);
 
     // Rename the SSTable file to our naming convention
-    try {
-        fs::rename(sstable->get_filename(), new_filename);
-    } catch (const fs::filesystem_error& e) {
-        std::cerr << "Failed to rename SSTable: " << e.what() << std::endl;
+    if (!env_->rename_file(sstable->get_filename(), new_filename)) {
+        logger_->error("Failed to rename SSTable: ", sstable->get_filename(), " to ", new_filename);
         return false;
     }
 
     // Create new SSTableReader with new filename
-    auto new_sstable = std::make_shared<SSTableReader>(new_filename);
+    auto new_sstable = std::make_shared<SSTableReader>(new_filename, env_);
     if (!new_sstable->is_valid()) {
-        std::cerr << "Failed to reload SSTable with new name: " << new_filename << std::endl;
+        logger_->error("Failed to reload SSTable with new name: ", new_filename);
         return false;
     }
 
     // Add to level 0
     levels_[0].sstables.push_back(new_sstable);
+    install_version();
 
     // Update stats
     stats_.sstables_created++;
     stats_dirty_ = true;
 
-    std::cout << "Added SSTable to level 0: " << new_filename
-              << " (total in level 0: " << levels_[0].sstables.size() << ")" << std::endl;
+    auto& flushes = level_compaction_stats_[0];
+    flushes.compactions++;
+    flushes.files_out++;
+    flushes.bytes_written += new_sstable->file_size();
+    flushes.keys_in += new_sstable->size();
+    flushes.keys_out += new_sstable->size();
+    bytes_flushed_ += new_sstable->file_size();
+
+    logger_->debug("Added SSTable to level 0: ", new_filename, " (total in level 0: ", levels_[0].sstables.size(), ")");
+
+    if (events_enabled()) {
+        TableFileCreationInfo info;
+        info.db_path = data_directory_;
+        info.file_path = new_filename;
+        info.level = 0;
+        info.file_size = new_sstable->file_size();
+        info.entries = new_sstable->size();
+        info.reason = TableFileReason::FLUSH;
+        config_.events->notify([info](EventListener& listener) { listener.on_table_file_created(info); });
+    }
 
     return true;
 }
@@ -157,11 +246,15 @@ std::optional<LevelManager::CompactionTask> LevelManager::get_compaction_task()
         task.source_level = 0;
         task.target_level = 1;
 
-        // Move all SSTables from level 0 to the task
+        // Move all SSTables from level 0 to the task, readers keep seeing them until
+        // replace_sstables installs the output
         task.input_sstables = std::move(levels_[0].sstables);
         levels_[0].sstables.clear(); // Clear after moving
+        auto& pending = compacting_[0];
+        pending.insert(pending.end(), task.input_sstables.begin(), task.input_sstables.end());
 
         if (!task.input_sstables.empty()) {
+            take_target_sstables(task);
             stats_.compactions_triggered++;
             return task;
         }
@@ -179,8 +272,11 @@ std::optional<LevelManager::CompactionTask> LevelManager::get_compaction_task()
                 // Move SSTables to task
                 task.input_sstables = std::move(levels_[level].sstables);
                 levels_[level].sstables.clear(); // Clear after moving
+                auto& pending = compacting_[level];
+                pending.insert(pending.end(), task.input_sstables.begin(), task.input_sstables.end());
 
                 if (!task.input_sstables.empty()) {
+                    take_target_sstables(task);
                     stats_.compactions_triggered++;
                     return task;
                 }
@@ -197,7 +293,7 @@ void LevelManager::replace_sstables(int source_level,
     std::lock_guard<std::recursive_mutex> lock(levels_mutex_);
 
     if (source_level < 0 || source_level >= static_cast<int>(levels_.size())) {
-        std::cerr << "Invalid source level: " << source_level << std::endl;
+        logger_->error("Invalid source level: ", source_level);
         return;
     }
 
@@ -218,75 +314,91 @@ void LevelManager::replace_sstables(int source_level,
                   });
     }
 
-    // Delete old SSTable files
+    // Readers that loaded the previous version keep the old readers alive until they finish
+    auto is_old = [&old_sstables](const SSTablePtr& sst) {
+        return std::find(old_sstables.begin(), old_sstables.end(), sst) != old_sstables.end();
+    };
+    std::vector<SSTablePtr> old_target_sstables;
+    for (int level : {source_level, target_level}) {
+        auto pending = compacting_.find(level);
+        if (pending == compacting_.end()) {
+            continue;
+        }
+        auto& tables = pending->second;
+        if (level == target_level) {
+            std::copy_if(tables.begin(), tables.end(), std::back_inserter(old_target_sstables), is_old);
+        }
+        tables.erase(std::remove_if(tables.begin(), tables.end(), is_old), tables.end());
+        if (tables.empty()) {
+            compacting_.erase(pending);
+        }
+    }
+    install_version();
+
+    // Compaction outputs that aren't inputs moved down unchanged are new files
+    if (events_enabled()) {
+        for (const auto& new_sstable : new_sstables) {
+            if (std::find(old_sstables.begin(), old_sstables.end(), new_sstable) != old_sstables.end()) {
+                continue;
+            }
+            TableFileCreationInfo info;
+            info.db_path = data_directory_;
+            info.file_path = new_sstable->get_filename();
+            info.level = target_level;
+            info.file_size = new_sstable->file_size();
+            info.entries = new_sstable->size();
+            info.reason = TableFileReason::COMPACTION;
+            config_.events->notify([info](EventListener& listener) { listener.on_table_file_created(info); });
+        }
+    }
+
+    // Delete old SSTable files, except those that moved down unchanged
     for (const auto& old_sstable : old_sstables) {
-        try {
-            if (fs::exists(old_sstable->get_filename())) {
-                fs::remove(old_sstable->get_filename());
+        bool kept = std::any_of(new_sstables.begin(), new_sstables.end(), [&old_sstable](const SSTablePtr& sst) {
+            return sst->get_filename() == old_sstable->get_filename();
+        });
+        if (!kept && env_->file_exists(old_sstable->get_filename())) {
+            if (env_->remove_file(old_sstable->get_filename())) {
                 stats_.sstables_deleted++;
+
+                if (events_enabled()) {
+                    TableFileDeletionInfo info;
+                    info.db_path = data_directory_;
+                    info.file_path = old_sstable->get_filename();
+                    bool from_target = std::find(old_target_sstables.begin(), old_target_sstables.end(),
+                                                 old_sstable) != old_target_sstables.end();
+                    info.level = from_target ? target_level : source_level;
+                    config_.events->notify([info](EventListener& listener) { listener.on_table_file_deleted(info); });
+                }
+            } else {
+                logger_->error("Failed to delete SSTable: ", old_sstable->get_filename());
             }
-        } catch (const fs::filesystem_error& e) {
-            std::cerr << "Failed to delete SSTable: " << old_sstable->get_filename()
-                      << " - " << e.what() << std::endl;
         }
     }
 
     stats_dirty_ = true;
 
-    std::cout << "Replaced " << old_sstables.size() << " SSTables from level " << source_level
-              << " with " << new_sstables.size() << " SSTables in level " << target_level << std::endl;
+    logger_->debug("Replaced ", old_sstables.size(), " SSTables from level ", source_level,
+                   " with ", new_sstables.size(), " SSTables in level ", target_level);
 }
 
-std::vector<LevelManager::SSTablePtr> LevelManager::find_candidate_sstables(const std::string& key) {
+std::vector<LevelManager::SSTablePtr> LevelManager::find_candidate_sstables(const std::string& key,
+                                                                          const VersionPtr& pinned) {
     std::vector<SSTablePtr> candidates;
-    std::lock_guard<std::recursive_mutex> lock(levels_mutex_);
-
-    // For debugging
-    // std::cout << "\n[DEBUG] === find_candidate_sstables for key: '" << key << "' ===" << std::endl;
-
-    // Print all levels for debugging
-    for (int level = 0; level < static_cast<int>(levels_.size()); level++) {
-        const auto& sstables = levels_[level].sstables;
-        if (sstables.empty()) continue;
-
-        // std::cout << "[DEBUG] Level " << level << " has " << sstables.size() << " SSTables:" << std::endl;
-        for (size_t i = 0; i < sstables.size(); i++) {
-            const auto& sst = sstables[i];
-            // std::cout << "[DEBUG]   SSTable " << i << ": [" << sst->min_key()
-            //           << " - " << sst->max_key() << "] entries: " << sst->size() << std::endl;
-        }
-    }
+    VersionPtr version = pinned ? pinned : current_version();
 
     // Search from level 0 (newest) to highest level (oldest)
-    for (int level = 0; level < static_cast<int>(levels_.size()); level++) {
-        const auto& sstables = levels_[level].sstables;
+    for (int level = 0; level < static_cast<int>(version->levels.size()); level++) {
+        const auto& sstables = version->levels[level];
         if (sstables.empty()) continue;
 
-        // std::cout << "[DEBUG] Searching level " << level << "..." << std::endl;
-
-        bool found_in_level = false;
-
         if (level == 0) {
             // Level 0: Check all SSTables (they can have overlapping ranges)
             // Check in reverse order (newest first)
             for (auto it = sstables.rbegin(); it != sstables.rend(); ++it) {
                 const auto& sstable = *it;
-
-                // More precise check: first compare with min_key, then with max_key
-                bool ge_min = (key.compare(sstable->min_key()) >= 0);
-                bool le_max = (key.compare(sstable->max_key()) <= 0);
-
-                // std::cout << "[DEBUG]   Checking SSTable: [" << sstable->min_key()
-                //           << " - " << sstable->max_key() << "]" << std::endl;
-                // std::cout << "[DEBUG]     key.compare(min) >= 0: " << ge_min
-                //           << ", key.compare(max) <= 0: " << le_max << std::endl;
-
-                if (ge_min && le_max) {
-                    // std::cout << "[DEBUG]     ✓ Key is in range! Adding to candidates" << std::endl;
+                if (key.compare(sstable->min_key()) >= 0 && key.compare(sstable->max_key()) <= 0) {
                     candidates.push_back(sstable);
-                    found_in_level = true;
-                } else {
-                    // std::cout << "[DEBUG]     ✗ Key is NOT in range" << std::endl;
                 }
             }
         } else {
@@ -294,8 +406,6 @@ std::vector<LevelManager::SSTablePtr> LevelManager::find_candidate_sstables(cons
             // First, check if key is within the overall range of this level
             if (key.compare(sstables.front()->min_key()) < 0 ||
                 key.compare(sstables.back()->max_key()) > 0) {
-                // std::cout << "[DEBUG]   Key is outside level " << level << " overall range ["
-                          // << sstables.front()->min_key() << " - " << sstables.back()->max_key() << "]" << std::endl;
                 continue;
             }
 
@@ -305,59 +415,60 @@ std::vector<LevelManager::SSTablePtr> LevelManager::find_candidate_sstables(cons
                 size_t mid = low + (high - low) / 2;
                 const auto& sstable = sstables[mid];
 
-                // std::cout << "[DEBUG]   Binary search: checking SSTable " << mid
-                          // << " [" << sstable->min_key() << " - " << sstable->max_key() << "]" << std::endl;
-
                 if (key.compare(sstable->max_key()) > 0) {
                     // Key is greater than this SSTable's max, search right
-                    // std::cout << "[DEBUG]     key > max, searching right" << std::endl;
                     low = mid + 1;
                 } else if (key.compare(sstable->min_key()) < 0) {
                     // Key is less than this SSTable's min, search left
-                    // std::cout << "[DEBUG]     key < min, searching left" << std::endl;
                     high = mid - 1;
                 } else {
                     // Key is within this SSTable's range
-                    // std::cout << "[DEBUG]     ✓ Found containing SSTable!" << std::endl;
                     candidates.push_back(sstable);
-                    found_in_level = true;
                     break;
                 }
             }
         }
 
-        // LSM tree semantics: stop at the first level where we find a candidate
-        // (newer data overrides older data)
-        if (found_in_level) {
-            // std::cout << "[DEBUG] Found candidates in level " << level << ", stopping search" << std::endl;
-            break;
-        }
-    }
-
-    // std::cout << "[DEBUG] Returning " << candidates.size() << " candidates" << std::endl;
-    for (size_t i = 0; i < candidates.size(); i++) {
-        // std::cout << "[DEBUG]   Candidate " << i << ": [" << candidates[i]->min_key()
-                  // << " - " << candidates[i]->max_key() << "]" << std::endl;
+        // A table whose range covers the key may still not hold it, so deeper levels stay
+        // candidates, the caller stops at the first table that has the key
     }
-    // std::cout << "[DEBUG] === End find_candidate_sstables ===\n" << std::endl;
 
     return candidates;
 }
 
 std::vector<LevelManager::SSTablePtr> LevelManager::find_sstables_for_range(const std::string& start_key,
-                                                                           const std::string& end_key) {
+                                                                           const std::string& end_key,
+                                                                           const VersionPtr& pinned) {
     std::vector<SSTablePtr> candidates;
-    std::lock_guard<std::recursive_mutex> lock(levels_mutex_);
+    VersionPtr version = pinned ? pinned : current_version();
+
+    // Min/max overlap says little for short ranges over wide tables, the range filter
+    // can still rule them out when no key falls between start_key and end_key
+    auto passes_filter = [this, &start_key, &end_key](const SSTablePtr& sst) {
+        if (!sst->has_range_filter()) {
+            return true;
+        }
+        range_filter_checks_++;
+        perf_count(&PerfContext::range_filter_checks);
+        if (!sst->may_contain_range(start_key, end_key)) {
+            range_filter_skips_++;
+            perf_count(&PerfContext::range_filter_negatives);
+            return false;
+        }
+        return true;
+    };
 
     // For range queries, we need to check all levels
-    for (int level = 0; level < static_cast<int>(levels_.size()); level++) {
-        const auto& sstables = levels_[level].sstables;
+    for (int level = 0; level < static_cast<int>(version->levels.size()); level++) {
+        const auto& sstables = version->levels[level];
 
         if (level == 0) {
-            // Level 0: Check all SSTables for overlap
-            for (const auto& sstable : sstables) {
+            // Level 0: Check all SSTables for overlap, newest first
+            for (auto it = sstables.rbegin(); it != sstables.rend(); ++it) {
+                const auto& sstable = *it;
                 // Check if ranges overlap: [sstable.min, sstable.max] intersects [start_key, end_key]
-                if (!(sstable->max_key() < start_key || sstable->min_key() > end_key)) {
+                if (!(sstable->max_key() < start_key || sstable->min_key() > end_key) &&
+                    passes_filter(sstable)) {
                     candidates.push_back(sstable);
                 }
             }
@@ -371,7 +482,9 @@ std::vector<LevelManager::SSTablePtr> LevelManager::find_sstables_for_range(cons
 
             // Check consecutive SSTables until we pass the end_key
             while (it != sstables.end() && (*it)->min_key() <= end_key) {
-                candidates.push_back(*it);
+                if (passes_filter(*it)) {
+                    candidates.push_back(*it);
+                }
                 ++it;
             }
         }
@@ -380,6 +493,45 @@ std::vector<LevelManager::SSTablePtr> LevelManager::find_sstables_for_range(cons
     return candidates;
 }
 
+std::vector<LevelManager::SSTablePtr> LevelManager::find_sstables_for_prefix(const std::string& prefix) {
+    std::vector<SSTablePtr> candidates;
+    VersionPtr version = current_version();
+
+    const auto& extractor = config_.table_options.prefix_extractor;
+
+    // Keys starting with prefix sort at or after prefix, and an SSTable can only hold
+    // some of them if its min key doesn't sort past every string starting with prefix
+    auto overlaps_prefix = [&prefix](const SSTablePtr& sst) {
+        return sst->max_key() >= prefix && sst->min_key().compare(0, prefix.size(), prefix) <= 0;
+    };
+
+    auto passes_filter = [this, &prefix, &extractor](const SSTablePtr& sst) {
+        if (!extractor || !sst->has_prefix_filter()) {
+            return true;
+        }
+        prefix_filter_checks_++;
+        perf_count(&PerfContext::prefix_filter_checks);
+        if (!sst->may_contain_prefix(prefix, *extractor)) {
+            prefix_filter_skips_++;
+            perf_count(&PerfContext::prefix_filter_negatives);
+            return false;
+        }
+        return true;
+    };
+
+    // Newest first: level by level, and within level 0 the most recently added SSTable first.
+    // Higher levels are disjoint, but the prefix range is cheap to check against every table
+    for (const auto& level : version->levels) {
+        for (auto it = level.rbegin(); it != level.rend(); ++it) {
+            if (overlaps_prefix(*it) && passes_filter(*it)) {
+                candidates.push_back(*it);
+            }
+        }
+    }
+
+    return candidates;
+}
+
 LevelManager::Stats LevelManager::get_stats() const {
     std::lock_guard<std::recursive_mutex> lock(levels_mutex_);
 
@@ -387,6 +539,10 @@ LevelManager::Stats LevelManager::get_stats() const {
         update_stats();
     }
 
+    stats_.prefix_filter_checks = prefix_filter_checks_.load();
+    stats_.prefix_filter_skips = prefix_filter_skips_.load();
+    stats_.range_filter_checks = range_filter_checks_.load();
+    stats_.range_filter_skips = range_filter_skips_.load();
     return stats_;
 }
 
@@ -401,8 +557,7 @@ void LevelManager::update_stats() const {
         size_t level_bytes = 0;
 
         for (const auto& sstable : level.sstables) {
-            // Estimate file size (could use fs::file_size for accuracy)
-            level_bytes += sstable->memory_usage(); // Rough estimate
+            level_bytes += sstable->file_size();
         }
 
         stats_.sstables_per_level.push_back(level_sstables);
@@ -415,21 +570,21 @@ void LevelManager::update_stats() const {
 }
 
 size_t LevelManager::get_sstable_count(int level) const {
-    std::lock_guard<std::recursive_mutex> lock(levels_mutex_);
+    VersionPtr version = current_version();
 
-    if (level < 0 || level >= static_cast<int>(levels_.size())) {
+    if (level < 0 || level >= static_cast<int>(version->levels.size())) {
         return 0;
     }
 
-    return levels_[level].sstables.size();
+    return version->levels[level].size();
 }
 
 size_t LevelManager::get_total_sstable_count() const {
-    std::lock_guard<std::recursive_mutex> lock(levels_mutex_);
+    VersionPtr version = current_version();
 
     size_t total = 0;
-    for (const auto& level : levels_) {
-        total += level.sstables.size();
+    for (const auto& level : version->levels) {
+        total += level.size();
     }
 
     return total;
@@ -497,6 +652,7 @@ void LevelManager::add_sstable_to_level(int level, SSTablePtr sstable) {
     }
 
     levels_[level].sstables.push_back(sstable);
+    install_version();
     stats_.sstables_created++;
     stats_dirty_ = true;
 }
@@ -514,11 +670,25 @@ void LevelManager::remove_sstable_from_level(int level, const std::string& filen
             }),
         sstables.end()
     );
+    install_version();
 
     stats_.sstables_deleted++;
     stats_dirty_ = true;
 }
 
+bool LevelManager::needs_compaction() const {
+    std::lock_guard<std::recursive_mutex> lock(levels_mutex_);
+    if (should_compact_level0() && !levels_[0].sstables.empty()) {
+        return true;
+    }
+    for (int level = 1; level < static_cast<int>(levels_.size()) - 1; level++) {
+        if (should_compact_level(level)) {
+            return true;
+        }
+    }
+    return false;
+}
+
 bool LevelManager::should_compact_level0() const {
     return levels_[0].sstables.size() >= config_.level0_max_sstables;
 }
@@ -547,37 +717,216 @@ size_t LevelManager::calculate_level_capacity(int level) const {
 
 void LevelManager::perform_compaction(const CompactionTask& task) {
     if (task.input_sstables.empty()) {
-        std::cerr << "Compaction task has no input SSTables" << std::endl;
+        logger_->error("Compaction task has no input SSTables");
         return;
     }
 
-    std::cout << "Starting compaction: level " << task.source_level
-              << " -> level " << task.target_level
-              << " (" << task.input_sstables.size() << " SSTables)" << std::endl;
+    // Target level tables are older than anything coming down from the source level
+    std::vector<SSTablePtr> inputs = task.target_sstables;
+    inputs.insert(inputs.end(), task.input_sstables.begin(), task.input_sstables.end());
+
+    CompactionRecord record;
+    record.source_level = task.source_level;
+    record.target_level = task.target_level;
+    record.input_files = inputs.size();
+    for (const auto& sstable : inputs) {
+        record.input_bytes += sstable->file_size();
+    }
+
+    CompactionJobInfo info;
+    if (events_enabled()) {
+        info.db_path = data_directory_;
+        info.stats = record;
+        for (const auto& sstable : inputs) {
+            info.input_files.push_back(sstable->get_filename());
+        }
+        config_.events->notify([info](EventListener& listener) { listener.on_compaction_begin(info); });
+    }
 
-    // Check if this is the largest level
-    bool is_largest_level = (task.target_level >= static_cast<int>(levels_.size()) - 1);
+    auto start = std::chrono::steady_clock::now();
+
+    // Tombstones have nothing left to shadow once no level below holds data
+    bool is_largest_level = task.bottommost || (task.target_level >= static_cast<int>(levels_.size()) - 1);
 
     // Perform compaction using the compactor
-    auto new_sstables = compactor_->compact(task.input_sstables,
-                                           task.target_level,
-                                           is_largest_level);
+    Compactor::Stats job;
+    std::vector<SSTablePtr> new_sstables;
+    try {
+        new_sstables = compactor_->compact(inputs, task.target_level, is_largest_level, &job);
+    } catch (const std::exception& e) {
+        logger_->error("Compaction failed: ", e.what());
+    }
+
+    // A single table moved down unchanged is renamed into the target level
+    if (new_sstables.size() == 1 && inputs.size() == 1 && new_sstables[0] == inputs[0]) {
+        auto moved = move_sstable(inputs[0], task.target_level);
+        new_sstables.clear();
+        if (moved) {
+            new_sstables.push_back(moved);
+        }
+    }
 
     if (new_sstables.empty()) {
-        std::cerr << "Compaction failed, no SSTables produced" << std::endl;
+        logger_->error("Compaction failed, no SSTables produced");
+
+        // Put the inputs back so their data stays reachable
+        std::lock_guard<std::recursive_mutex> lock(levels_mutex_);
+        auto& sstables = levels_[task.source_level].sstables;
+        sstables.insert(sstables.begin(), task.input_sstables.begin(), task.input_sstables.end());
+        compacting_.erase(task.source_level);
+        if (!task.target_sstables.empty()) {
+            auto& targets = levels_[task.target_level].sstables;
+            targets.insert(targets.end(), task.target_sstables.begin(), task.target_sstables.end());
+            std::sort(targets.begin(), targets.end(), [](const SSTablePtr& a, const SSTablePtr& b) {
+                return a->min_key() < b->min_key();
+            });
+            compacting_.erase(task.target_level);
+        }
+        install_version();
+
+        if (events_enabled()) {
+            config_.events->notify([info](EventListener& listener) { listener.on_compaction_completed(info); });
+        }
         return;
     }
 
+    // Everything may have cancelled out, an empty table has no key range to place it by
+    new_sstables.erase(std::remove_if(new_sstables.begin(), new_sstables.end(), [this](const SSTablePtr& sst) {
+        if (sst->size() > 0) {
+            return false;
+        }
+        env_->remove_file(sst->get_filename());
+        return true;
+    }), new_sstables.end());
+
     // Replace old SSTables with new ones
-    replace_sstables(task.source_level, task.input_sstables, new_sstables);
+    replace_sstables(task.source_level, inputs, new_sstables);
+
+    record.output_files = new_sstables.size();
+    for (const auto& sstable : new_sstables) {
+        record.output_bytes += sstable->file_size();
+    }
+    record.keys_in = job.entries_read;
+    record.keys_out = job.entries_written;
+    record.tombstones_dropped = job.tombstones_removed;
+    record.duplicates_dropped = job.duplicates_removed;
+    record.duration_us = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - start).count();
 
     // Update statistics
-    stats_.compactions_performed++;
-    stats_dirty_ = true;
+    {
+        std::lock_guard<std::recursive_mutex> lock(levels_mutex_);
+        stats_.compactions_performed++;
+        stats_dirty_ = true;
+
+        auto& level = level_compaction_stats_[task.target_level];
+        level.compactions++;
+        level.files_in += record.input_files;
+        level.files_out += record.output_files;
+        level.bytes_read += record.input_bytes;
+        level.bytes_written += record.output_bytes;
+        level.keys_in += record.keys_in;
+        level.keys_out += record.keys_out;
+        level.tombstones_dropped += record.tombstones_dropped;
+        level.duplicates_dropped += record.duplicates_dropped;
+        level.duration_us += record.duration_us;
+
+        compaction_records_.push_back(record);
+        if (compaction_records_.size() > MAX_COMPACTION_RECORDS) {
+            compaction_records_.pop_front();
+        }
+    }
+
+    logger_->info("Compacted level ", record.source_level, " -> ", record.target_level, ": ",
+                  record.input_files, " files (", record.input_bytes, " bytes) -> ",
+                  record.output_files, " files (", record.output_bytes, " bytes), keys ",
+                  record.keys_in, " -> ", record.keys_out, ", ", record.tombstones_dropped, " tombstones and ",
+                  record.duplicates_dropped, " duplicates dropped in ", record.duration_us, " us");
+
+    if (events_enabled()) {
+        info.stats = record;
+        for (const auto& sstable : new_sstables) {
+            info.output_files.push_back(sstable->get_filename());
+        }
+        info.success = true;
+        config_.events->notify([info](EventListener& listener) { listener.on_compaction_completed(info); });
+    }
+}
+
+void LevelManager::take_target_sstables(CompactionTask& task) {
+    auto by_min_key = [](const SSTablePtr& a, const SSTablePtr& b) { return a->min_key() < b->min_key(); };
+    auto by_max_key = [](const SSTablePtr& a, const SSTablePtr& b) { return a->max_key() < b->max_key(); };
+    std::string min_key = (*std::min_element(task.input_sstables.begin(), task.input_sstables.end(), by_min_key))->min_key();
+    std::string max_key = (*std::max_element(task.input_sstables.begin(), task.input_sstables.end(), by_max_key))->max_key();
+
+    // Leaving overlapping tables behind would break the disjoint ranges lookups binary search on
+    auto& sstables = levels_[task.target_level].sstables;
+    auto overlaps = [&min_key, &max_key](const SSTablePtr& sst) {
+        return !(sst->max_key() < min_key || sst->min_key() > max_key);
+    };
+    std::copy_if(sstables.begin(), sstables.end(), std::back_inserter(task.target_sstables), overlaps);
+    sstables.erase(std::remove_if(sstables.begin(), sstables.end(), overlaps), sstables.end());
+
+    if (!task.target_sstables.empty()) {
+        auto& pending = compacting_[task.target_level];
+        pending.insert(pending.end(), task.target_sstables.begin(), task.target_sstables.end());
+    }
+    task.bottommost = is_bottommost(task.target_level);
+}
+
+bool LevelManager::is_bottommost(int level) const {
+    for (int deeper = level + 1; deeper < static_cast<int>(levels_.size()); deeper++) {
+        if (!levels_[deeper].sstables.empty() || compacting_.count(deeper) > 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+LevelManager::SSTablePtr LevelManager::move_sstable(const SSTablePtr& sstable, int target_level) {
+    std::string new_filename;
+    {
+        std::lock_guard<std::recursive_mutex> lock(levels_mutex_);
+        new_filename = generate_sstable_filename(target_level, levels_[target_level].next_sstable_id++);
+    }
+
+    // Readers hold the table in memory, so renaming under them is safe
+    if (!env_->rename_file(sstable->get_filename(), new_filename)) {
+        logger_->error("Failed to move SSTable: ", sstable->get_filename(), " to ", new_filename);
+        return nullptr;
+    }
+
+    auto moved = std::make_shared<SSTableReader>(new_filename, env_);
+    if (!moved->is_valid()) {
+        logger_->error("Failed to reload moved SSTable: ", new_filename);
+        env_->rename_file(new_filename, sstable->get_filename());
+        return nullptr;
+    }
+    return moved;
+}
+
+CompactionStats LevelManager::get_compaction_stats() const {
+    CompactionStats stats;
+    {
+        // Only copy under the lock, flushes and compactions wait on it
+        std::lock_guard<std::recursive_mutex> lock(levels_mutex_);
+        stats.levels = level_compaction_stats_;
+        stats.recent.assign(compaction_records_.begin(), compaction_records_.end());
+        stats.bytes_flushed = bytes_flushed_;
+    }
+
+    // Tables being compacted are still published, so readers may probe them
+    VersionPtr version = current_version();
+    for (size_t i = 0; i < version->levels.size() && i < stats.levels.size(); i++) {
+        auto& level = stats.levels[i];
+        level.files = version->levels[i].size();
+        level.bytes = 0;
+        for (const auto& sstable : version->levels[i]) {
+            level.bytes += sstable->file_size();
+        }
+        level.max_overlap = max_key_overlap(version->levels[i]);
+    }
 
-    // Get compaction stats
-    auto compactor_stats = compactor_->get_stats();
-    std::cout << "Compaction completed: " << compactor_stats.entries_written
-              << " entries written, " << compactor_stats.tombstones_removed
-              << " tombstones removed" << std::endl;
+    stats.update_amplification();
+    return stats;
 }
\ No newline at end of file
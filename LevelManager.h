@@ -2,12 +2,17 @@
 #define LEVEL_MANAGER_H
 
 #include "SSTableReader.h"
+#include "SSTableWriter.h"
 #include "BufferPool.h"
 #include "Compactor.h"  // Add this include
+#include "CompactionStats.h"
+#include "EventListener.h"
+#include "Logger.h"
 #include <vector>
 #include <string>
 #include <memory>
 #include <map>
+#include <deque>
 #include <mutex>
 #include <atomic>
 
@@ -23,6 +28,10 @@ public:
         size_t size_ratio;
         size_t target_sstable_size;
         bool tiering;
+        SSTableWriter::Options table_options;  // meta blocks for SSTables produced by compaction
+        std::shared_ptr<EventNotifier> events;  // table file and compaction events, nullptr sends none
+        std::shared_ptr<Logger> logger;         // nullptr logs warnings and errors to stderr
+        std::shared_ptr<Env> env;               // where level directories live, nullptr for Env::default_env()
 
         Config(
             size_t max_levels_ = 7,
@@ -39,6 +48,13 @@ public:
         {}
     };
 
+    // Immutable snapshot of the level layout. Readers hold one without taking a lock,
+    // writers build a new one and swap it in, so neither waits for the other
+    struct Version {
+        std::vector<std::vector<SSTablePtr>> levels;  // Level 0 oldest first, higher levels sorted by min key
+    };
+    using VersionPtr = std::shared_ptr<const Version>;
+
     // Constructor
     LevelManager(const std::string& data_dir,
                  std::shared_ptr<BufferPool> buffer_pool,
@@ -52,11 +68,16 @@ public:
         int source_level;
         std::vector<SSTablePtr> input_sstables;
         int target_level;
+        std::vector<SSTablePtr> target_sstables;  // Target level tables overlapping the inputs, merged with them
+        bool bottommost = false;                  // Nothing below the target level, tombstones can be dropped
     };
 
     std::optional<CompactionTask> get_compaction_task();
 
-    // Replace SSTables after compaction
+    // Whether get_compaction_task() would return a task, without claiming its inputs
+    bool needs_compaction() const;
+
+    // Replace SSTables after compaction, old_sstables may include the task's target level tables
     void replace_sstables(int source_level,
                          const std::vector<SSTablePtr>& old_sstables,
                          const std::vector<SSTablePtr>& new_sstables);
@@ -64,12 +85,22 @@ public:
     // Perform compaction on a given task (new method)
     void perform_compaction(const CompactionTask& task);
 
-    // Find SSTables that might contain a key (for get operations)
-    std::vector<SSTablePtr> find_candidate_sstables(const std::string& key);
+    // Current level layout, a single atomic load
+    VersionPtr current_version() const { return current_.load(std::memory_order_acquire); }
+
+    // Find SSTables that might contain a key (for get operations), newest first
+    // Searches the pinned version, or the current one when pinned is nullptr
+    std::vector<SSTablePtr> find_candidate_sstables(const std::string& key,
+                                                    const VersionPtr& pinned = nullptr);
 
-    // Find SSTables for range queries
+    // Find SSTables for range queries, newest first
     std::vector<SSTablePtr> find_sstables_for_range(const std::string& start_key,
-                                                   const std::string& end_key);
+                                                   const std::string& end_key,
+                                                   const VersionPtr& pinned = nullptr);
+
+    // Find SSTables for prefix scans, skipping those whose prefix bloom filter rules the prefix out
+    // Returned newest first
+    std::vector<SSTablePtr> find_sstables_for_prefix(const std::string& prefix);
 
     // Statistics
     struct Stats {
@@ -81,10 +112,20 @@ public:
         size_t compactions_performed = 0;  // New stat
         size_t sstables_created = 0;
         size_t sstables_deleted = 0;
+        size_t prefix_filter_checks = 0;   // SSTables whose prefix filter was consulted
+        size_t prefix_filter_skips = 0;    // SSTables skipped because the filter ruled the prefix out
+        size_t range_filter_checks = 0;    // SSTables whose range filter was consulted
+        size_t range_filter_skips = 0;     // SSTables skipped because the filter ruled the range out
     };
 
     Stats get_stats() const;
 
+    // Per level flush and compaction totals, recent compactions and amplification
+    CompactionStats get_compaction_stats() const;
+
+    // Compactions kept for get_compaction_stats().recent
+    static constexpr size_t MAX_COMPACTION_RECORDS = 64;
+
     // Get level information
     size_t get_level_count() const { return levels_.size(); }
     size_t get_sstable_count(int level) const;
@@ -109,22 +150,35 @@ private:
     std::string data_directory_;
     std::shared_ptr<BufferPool> buffer_pool_;
     Config config_;
+    std::shared_ptr<Logger> logger_;
+    std::shared_ptr<Env> env_;
 
     // Compactor and its configuration (new members)
     std::unique_ptr<Compactor> compactor_;
     Compactor::Config compactor_config_;
 
-    // Levels
+    // Levels, only touched by writers under levels_mutex_
     std::vector<Level> levels_;
 
+    // Inputs of running compactions by level, still published until their output is installed
+    std::map<int, std::vector<SSTablePtr>> compacting_;
+
+    // Layout published to readers
+    std::atomic<VersionPtr> current_;
+
     // State
-    mutable std::recursive_mutex levels_mutex_;
+    mutable std::recursive_mutex levels_mutex_;  // serialises writers, readers never take it
     std::atomic<uint64_t> global_sequence_{0};
 
     // Private methods
     void initialize_levels();
     void load_existing_sstables();
 
+    // Publish levels_ and compacting_ as a new Version, caller holds levels_mutex_
+    void install_version();
+
+    bool events_enabled() const { return config_.events && config_.events->enabled(); }
+
     // File management
     std::string generate_sstable_filename(int level, uint64_t sequence);
     uint64_t parse_sequence_from_filename(const std::string& filename);
@@ -139,17 +193,32 @@ private:
 
     // Helper methods
     size_t calculate_level_capacity(int level) const;
-    std::vector<SSTablePtr> get_overlapping_sstables(int level,
-                                                   const SSTablePtr& new_sstable);
+    // Move the target level tables overlapping the task's inputs into the task, caller holds levels_mutex_
+    void take_target_sstables(CompactionTask& task);
+    bool is_bottommost(int level) const;
+
+    // Give a table moved down unchanged a file in the target level's directory
+    SSTablePtr move_sstable(const SSTablePtr& sstable, int target_level);
 
     // Tiering support (for bonus)
     void add_sstable_to_tier(int level, SSTablePtr sstable);
     std::optional<CompactionTask> get_tiering_compaction_task(int level);
 
+    // Filter counters, bumped by lock-free readers
+    std::atomic<size_t> prefix_filter_checks_{0};
+    std::atomic<size_t> prefix_filter_skips_{0};
+    std::atomic<size_t> range_filter_checks_{0};
+    std::atomic<size_t> range_filter_skips_{0};
+
     // Statistics
     mutable Stats stats_;
     mutable bool stats_dirty_ = true;
     void update_stats() const;
+
+    // Flush and compaction work by output level, and the latest compactions, under levels_mutex_
+    std::vector<LevelCompactionStats> level_compaction_stats_;
+    std::deque<CompactionRecord> compaction_records_;
+    uint64_t bytes_flushed_ = 0;
 };
 
 #endif // LEVEL_MANAGER_H
\ No newline at end of file
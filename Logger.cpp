@@ -0,0 +1,194 @@
+#include "Logger.h"
+#include <chrono>
+#include <ctime>
+#include <iomanip>
+#include <iostream>
+
+Logger::Logger(std::string path, const Options& options, std::shared_ptr<Env> env)
+    : path_(std::move(path)), options_(options), env_(env ? std::move(env) : Env::default_env()),
+      level_(options.level) {
+    size_t slots = 1;
+    while (slots < std::max<size_t>(options_.ring_slots, 2)) {
+        slots <<= 1;
+    }
+    slots_ = std::make_unique<Slot[]>(slots);
+    for (size_t i = 0; i < slots; i++) {
+        slots_[i].sequence.store(i, std::memory_order_relaxed);
+    }
+    mask_ = slots - 1;
+
+    if (!path_.empty()) {
+        uint64_t size = 0;
+        if (env_->get_file_size(path_, size) && size > 0) {
+            rotate();
+        } else {
+            open_file();
+        }
+    }
+
+    thread_ = std::thread(&Logger::run, this);
+}
+
+Logger::~Logger() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    work_cv_.notify_one();
+    thread_.join();
+}
+
+std::shared_ptr<Logger> Logger::stderr_logger() {
+    static auto logger = [] {
+        Options options;
+        options.level = LogLevel::WARN;
+        return std::make_shared<Logger>("", options);
+    }();
+    return logger;
+}
+
+const char* Logger::level_name(LogLevel level) {
+    switch (level) {
+        case LogLevel::DEBUG: return "DEBUG";
+        case LogLevel::INFO:  return "INFO";
+        case LogLevel::WARN:  return "WARN";
+        case LogLevel::ERROR: return "ERROR";
+        case LogLevel::NONE:  break;
+    }
+    return "NONE";
+}
+
+void Logger::submit(LogLevel level, const std::string& message) {
+    auto now = std::chrono::system_clock::now();
+    std::time_t seconds = std::chrono::system_clock::to_time_t(now);
+    auto micros = std::chrono::duration_cast<std::chrono::microseconds>(now.time_since_epoch()).count() % 1000000;
+    std::tm local{};
+    localtime_r(&seconds, &local);
+
+    std::ostringstream line;
+    line << std::put_time(&local, "%Y/%m/%d-%H:%M:%S") << '.' << std::setw(6) << std::setfill('0') << micros
+         << ' ' << std::this_thread::get_id() << ' ' << level_name(level) << ' ' << message << '\n';
+
+    if (try_push(line.str())) {
+        work_cv_.notify_one();
+    } else {
+        dropped_.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+bool Logger::try_push(std::string&& line) {
+    uint64_t pos = push_pos_.load(std::memory_order_relaxed);
+    Slot* slot;
+    while (true) {
+        slot = &slots_[pos & mask_];
+        uint64_t sequence = slot->sequence.load(std::memory_order_acquire);
+        auto diff = static_cast<int64_t>(sequence) - static_cast<int64_t>(pos);
+        if (diff == 0) {
+            // Free slot at our position, claim it
+            if (push_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                break;
+            }
+        } else if (diff < 0) {
+            return false;  // the writer hasn't freed this slot yet, ring is full
+        } else {
+            pos = push_pos_.load(std::memory_order_relaxed);  // another producer took it
+        }
+    }
+
+    slot->line = std::move(line);
+    slot->sequence.store(pos + 1, std::memory_order_release);
+    return true;
+}
+
+bool Logger::try_pop(std::string& line) {
+    Slot& slot = slots_[pop_pos_ & mask_];
+    if (slot.sequence.load(std::memory_order_acquire) != pop_pos_ + 1) {
+        return false;  // empty, or claimed but not filled in yet
+    }
+
+    line = std::move(slot.line);
+    slot.line.clear();
+    slot.sequence.store(pop_pos_ + mask_ + 1, std::memory_order_release);
+    pop_pos_++;
+    return true;
+}
+
+void Logger::run() {
+    std::string line;
+    while (true) {
+        bool wrote = false;
+        while (try_pop(line)) {
+            write_line(line);
+            written_.fetch_add(1, std::memory_order_release);
+            wrote = true;
+        }
+
+        uint64_t dropped = dropped_.load(std::memory_order_relaxed);
+        if (dropped != dropped_reported_) {
+            std::ostringstream note;
+            note << "Logger dropped " << dropped - dropped_reported_ << " lines, ring full\n";
+            write_line(note.str());
+            dropped_reported_ = dropped;
+            wrote = true;
+        }
+
+        if (wrote) {
+            if (path_.empty()) {
+                std::cerr.flush();
+            } else if (file_) {
+                file_->flush();
+            }
+        }
+
+        std::unique_lock<std::mutex> lock(mutex_);
+        flushed_cv_.notify_all();
+        if (stopping_ && !wrote) {
+            return;
+        }
+        // Producers notify without the lock, so a wakeup can be missed, the timeout bounds the delay
+        work_cv_.wait_for(lock, std::chrono::milliseconds(100));
+    }
+}
+
+void Logger::flush() {
+    uint64_t target = push_pos_.load(std::memory_order_acquire);
+    std::unique_lock<std::mutex> lock(mutex_);
+    work_cv_.notify_one();
+    flushed_cv_.wait(lock, [&] { return written_.load(std::memory_order_acquire) >= target; });
+}
+
+void Logger::write_line(const std::string& line) {
+    if (path_.empty()) {
+        std::cerr << line;
+        return;
+    }
+
+    if (options_.max_file_size > 0 && file_size_ + line.size() > options_.max_file_size && file_size_ > 0) {
+        rotate();
+    }
+    if (file_) {
+        file_->append(line);
+    }
+    file_size_ += line.size();
+}
+
+void Logger::open_file() {
+    file_ = env_->new_writable_file(path_);
+    file_size_ = 0;
+}
+
+void Logger::rotate() {
+    file_.reset();
+
+    if (options_.keep_files == 0) {
+        env_->remove_file(path_);
+    } else {
+        env_->remove_file(path_ + "." + std::to_string(options_.keep_files));
+        for (size_t i = options_.keep_files - 1; i >= 1; i--) {
+            env_->rename_file(path_ + "." + std::to_string(i), path_ + "." + std::to_string(i + 1));
+        }
+        env_->rename_file(path_, path_ + ".1");
+    }
+
+    open_file();
+}
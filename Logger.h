@@ -0,0 +1,143 @@
+#ifndef KVDB_LOGGER_H
+#define KVDB_LOGGER_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include "Env.h"
+
+enum class LogLevel {
+    DEBUG,
+    INFO,
+    WARN,
+    ERROR,
+    NONE   // log nothing
+};
+
+/**
+ * Leveled logger that keeps file I/O off the calling thread.
+ *
+ * log() formats the line on the caller and pushes it into a fixed size lock-free ring,
+ * a background thread writes the ring out to the log file and rotates it once it gets
+ * too big: LOG becomes LOG.1, LOG.1 becomes LOG.2, and so on up to keep_files. A full
+ * ring drops the line instead of blocking, the writer notes how many were lost.
+ *
+ * Messages below the configured level cost a single atomic load, arguments are only
+ * formatted once the level check passes:
+ *
+ *     logger->info("Memtable flushed with ", entries.size(), " entries");
+ */
+class Logger {
+public:
+    struct Options {
+        LogLevel level;
+        size_t max_file_size;  // rotate past this, 0 never rotates
+        size_t keep_files;     // rotated files kept besides the live one
+        size_t ring_slots;     // rounded up to a power of two
+
+        Options(
+            LogLevel level_ = LogLevel::INFO,
+            size_t max_file_size_ = 16 * 1024 * 1024,
+            size_t keep_files_ = 4,
+            size_t ring_slots_ = 4096
+        )
+            : level(level_),
+              max_file_size(max_file_size_),
+              keep_files(keep_files_),
+              ring_slots(ring_slots_)
+        {}
+    };
+
+    /**
+     * Log to path, an existing file is rotated away first
+     * @param path log file, empty logs to stderr and never rotates
+     * @param env where the log file lives, nullptr for Env::default_env()
+     */
+    explicit Logger(std::string path, const Options& options = Options(), std::shared_ptr<Env> env = nullptr);
+
+    // Writes out everything still in the ring
+    ~Logger();
+
+    // Shared stderr logger at WARN, for components used without their owner's logger
+    static std::shared_ptr<Logger> stderr_logger();
+
+    bool enabled(LogLevel level) const {
+        return level >= level_.load(std::memory_order_relaxed) && level != LogLevel::NONE;
+    }
+
+    void set_level(LogLevel level) { level_.store(level, std::memory_order_relaxed); }
+    LogLevel get_level() const { return level_.load(std::memory_order_relaxed); }
+
+    // Concatenate args into one line at level
+    template <typename... Args>
+    void log(LogLevel level, const Args&... args) {
+        if (!enabled(level)) {
+            return;
+        }
+        std::ostringstream message;
+        (message << ... << args);
+        submit(level, message.str());
+    }
+
+    template <typename... Args> void debug(const Args&... args) { log(LogLevel::DEBUG, args...); }
+    template <typename... Args> void info(const Args&... args) { log(LogLevel::INFO, args...); }
+    template <typename... Args> void warn(const Args&... args) { log(LogLevel::WARN, args...); }
+    template <typename... Args> void error(const Args&... args) { log(LogLevel::ERROR, args...); }
+
+    // Block until every line logged so far is written and flushed
+    void flush();
+
+    // Lines lost to a full ring since the logger was created
+    uint64_t dropped() const { return dropped_.load(std::memory_order_relaxed); }
+
+    const std::string& path() const { return path_; }
+
+    static const char* level_name(LogLevel level);
+
+    Logger(const Logger&) = delete;
+    Logger& operator=(const Logger&) = delete;
+
+private:
+    struct Slot {
+        std::atomic<uint64_t> sequence{0};  // equals the push position when free, position + 1 when full
+        std::string line;
+    };
+
+    std::string path_;
+    Options options_;
+    std::shared_ptr<Env> env_;
+    std::atomic<LogLevel> level_;
+
+    // Ring, many producers and the writer thread as the only consumer
+    std::unique_ptr<Slot[]> slots_;
+    uint64_t mask_ = 0;
+    std::atomic<uint64_t> push_pos_{0};
+    uint64_t pop_pos_ = 0;
+    std::atomic<uint64_t> written_{0};  // lines popped and written
+    std::atomic<uint64_t> dropped_{0};
+    uint64_t dropped_reported_ = 0;
+
+    // Writer thread
+    std::unique_ptr<WritableFile> file_;
+    uint64_t file_size_ = 0;
+    std::atomic<bool> stopping_{false};
+    std::mutex mutex_;
+    std::condition_variable work_cv_;
+    std::condition_variable flushed_cv_;
+    std::thread thread_;
+
+    void submit(LogLevel level, const std::string& message);
+    bool try_push(std::string&& line);
+    bool try_pop(std::string& line);
+    void run();
+    void write_line(const std::string& line);
+    void open_file();
+    void rotate();
+};
+
+#endif // KVDB_LOGGER_H
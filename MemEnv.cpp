@@ -0,0 +1,342 @@
+#include "MemEnv.h"
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <thread>
+
+namespace {
+    std::string normalize(const std::string& path) {
+        std::string normal = std::filesystem::path(path).lexically_normal().generic_string();
+        while (normal.size() > 1 && normal.back() == '/') {
+            normal.pop_back();
+        }
+        return normal;
+    }
+
+    std::string parent_of(const std::string& path) {
+        auto slash = path.rfind('/');
+        if (slash == std::string::npos) return ".";
+        return slash == 0 ? "/" : path.substr(0, slash);
+    }
+
+    uint64_t now_nanos() {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count());
+    }
+
+    void delay(const std::atomic<int64_t>& micros) {
+        int64_t us = micros.load(std::memory_order_relaxed);
+        if (us > 0) {
+            std::this_thread::sleep_for(std::chrono::microseconds(us));
+        }
+    }
+
+    using File = MemEnv::File;
+    using Latency = MemEnv::Latency;
+
+    bool read_at(File& file, uint64_t offset, size_t n, char* scratch, size_t& bytes_read) {
+        std::lock_guard<std::mutex> lock(file.mutex);
+        if (offset >= file.data.size()) {
+            bytes_read = 0;
+            return true;
+        }
+        bytes_read = std::min<size_t>(n, file.data.size() - offset);
+        std::memcpy(scratch, file.data.data() + offset, bytes_read);
+        return true;
+    }
+
+    class MemSequentialFile : public SequentialFile {
+    public:
+        MemSequentialFile(std::shared_ptr<File> file, std::shared_ptr<Latency> latency)
+            : file_(std::move(file)), latency_(std::move(latency)) {}
+
+        bool read(size_t n, char* scratch, size_t& bytes_read) override {
+            delay(latency_->read_us);
+            read_at(*file_, position_, n, scratch, bytes_read);
+            position_ += bytes_read;
+            return true;
+        }
+
+        bool skip(uint64_t n) override {
+            position_ += n;
+            return true;
+        }
+
+    private:
+        std::shared_ptr<File> file_;
+        std::shared_ptr<Latency> latency_;
+        uint64_t position_ = 0;
+    };
+
+    class MemRandomAccessFile : public RandomAccessFile {
+    public:
+        MemRandomAccessFile(std::shared_ptr<File> file, std::shared_ptr<Latency> latency)
+            : file_(std::move(file)), latency_(std::move(latency)) {}
+
+        bool read(uint64_t offset, size_t n, char* scratch, size_t& bytes_read) const override {
+            delay(latency_->read_us);
+            return read_at(*file_, offset, n, scratch, bytes_read);
+        }
+
+        uint64_t size() const override {
+            std::lock_guard<std::mutex> lock(file_->mutex);
+            return file_->data.size();
+        }
+
+    private:
+        std::shared_ptr<File> file_;
+        std::shared_ptr<Latency> latency_;
+    };
+
+    class MemWritableFile : public WritableFile {
+    public:
+        MemWritableFile(std::shared_ptr<File> file, std::shared_ptr<Latency> latency)
+            : file_(std::move(file)), latency_(std::move(latency)) {}
+
+        bool append(const char* data, size_t n) override {
+            if (closed_) return false;
+            delay(latency_->write_us);
+            std::lock_guard<std::mutex> lock(file_->mutex);
+            file_->data.append(data, n);
+            file_->mtime = now_nanos();
+            return true;
+        }
+
+        bool flush() override { return !closed_; }
+
+        bool sync() override {
+            if (closed_) return false;
+            delay(latency_->sync_us);
+            return true;
+        }
+
+        bool close() override {
+            closed_ = true;
+            return true;
+        }
+
+        uint64_t size() const override {
+            std::lock_guard<std::mutex> lock(file_->mutex);
+            return file_->data.size();
+        }
+
+    private:
+        std::shared_ptr<File> file_;
+        std::shared_ptr<Latency> latency_;
+        bool closed_ = false;
+    };
+
+    class MemRandomRWFile : public RandomRWFile {
+    public:
+        MemRandomRWFile(std::shared_ptr<File> file, std::shared_ptr<Latency> latency)
+            : file_(std::move(file)), latency_(std::move(latency)) {}
+
+        bool write(uint64_t offset, const char* data, size_t n) override {
+            delay(latency_->write_us);
+            std::lock_guard<std::mutex> lock(file_->mutex);
+            if (file_->data.size() < offset + n) {
+                file_->data.resize(offset + n);
+            }
+            std::memcpy(file_->data.data() + offset, data, n);
+            file_->mtime = now_nanos();
+            return true;
+        }
+
+        bool read(uint64_t offset, size_t n, char* scratch, size_t& bytes_read) const override {
+            delay(latency_->read_us);
+            return read_at(*file_, offset, n, scratch, bytes_read);
+        }
+
+        bool sync() override {
+            delay(latency_->sync_us);
+            return true;
+        }
+
+        uint64_t size() const override {
+            std::lock_guard<std::mutex> lock(file_->mutex);
+            return file_->data.size();
+        }
+
+    private:
+        std::shared_ptr<File> file_;
+        std::shared_ptr<Latency> latency_;
+    };
+
+    class MemFileLock : public FileLock {
+    public:
+        MemFileLock(std::shared_ptr<MemEnv::LockTable> table, std::string path)
+            : table_(std::move(table)), path_(std::move(path)) {}
+
+        ~MemFileLock() override {
+            std::lock_guard<std::mutex> lock(table_->mutex);
+            table_->held.erase(path_);
+        }
+
+    private:
+        std::shared_ptr<MemEnv::LockTable> table_;
+        std::string path_;
+    };
+}
+
+MemEnv::MemEnv(const Options& options)
+    : locks_(std::make_shared<LockTable>()),
+      latency_(std::make_shared<Latency>()) {
+    set_latency(options);
+}
+
+void MemEnv::set_latency(const Options& options) {
+    latency_->read_us.store(options.read_latency.count(), std::memory_order_relaxed);
+    latency_->write_us.store(options.write_latency.count(), std::memory_order_relaxed);
+    latency_->sync_us.store(options.sync_latency.count(), std::memory_order_relaxed);
+}
+
+std::shared_ptr<MemEnv::File> MemEnv::find(const std::string& path) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = files_.find(normalize(path));
+    return it == files_.end() ? nullptr : it->second;
+}
+
+std::shared_ptr<MemEnv::File> MemEnv::open_for_write(const std::string& path, bool truncate) {
+    std::string name = normalize(path);
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto& file = files_[name];
+    if (!file || truncate) {
+        // A fresh File leaves readers of the old contents untouched
+        file = std::make_shared<File>();
+        file->mtime = now_nanos();
+    }
+    return file;
+}
+
+std::unique_ptr<SequentialFile> MemEnv::new_sequential_file(const std::string& path) {
+    auto file = find(path);
+    if (!file) return nullptr;
+    return std::make_unique<MemSequentialFile>(std::move(file), latency_);
+}
+
+std::unique_ptr<RandomAccessFile> MemEnv::new_random_access_file(const std::string& path) {
+    auto file = find(path);
+    if (!file) return nullptr;
+    return std::make_unique<MemRandomAccessFile>(std::move(file), latency_);
+}
+
+std::unique_ptr<WritableFile> MemEnv::new_writable_file(const std::string& path) {
+    return std::make_unique<MemWritableFile>(open_for_write(path, true), latency_);
+}
+
+std::unique_ptr<WritableFile> MemEnv::new_appendable_file(const std::string& path) {
+    return std::make_unique<MemWritableFile>(open_for_write(path, false), latency_);
+}
+
+std::unique_ptr<RandomRWFile> MemEnv::new_random_rw_file(const std::string& path) {
+    return std::make_unique<MemRandomRWFile>(open_for_write(path, false), latency_);
+}
+
+bool MemEnv::file_exists(const std::string& path) {
+    std::string name = normalize(path);
+    std::lock_guard<std::mutex> lock(mutex_);
+    return files_.count(name) > 0 || dirs_.count(name) > 0;
+}
+
+bool MemEnv::get_file_size(const std::string& path, uint64_t& size) {
+    auto file = find(path);
+    if (!file) return false;
+    std::lock_guard<std::mutex> lock(file->mutex);
+    size = file->data.size();
+    return true;
+}
+
+bool MemEnv::get_modification_time(const std::string& path, uint64_t& nanos) {
+    auto file = find(path);
+    if (!file) return false;
+    std::lock_guard<std::mutex> lock(file->mutex);
+    nanos = file->mtime;
+    return true;
+}
+
+bool MemEnv::get_children(const std::string& dir, std::vector<std::string>& names) {
+    names.clear();
+    std::string name = normalize(dir);
+    std::lock_guard<std::mutex> lock(mutex_);
+    bool found = dirs_.count(name) > 0;
+    auto collect = [&](const std::string& path) {
+        if (parent_of(path) == name) {
+            names.push_back(path.substr(path.rfind('/') + 1));
+            found = true;
+        }
+    };
+    for (const auto& [path, file] : files_) {
+        collect(path);
+    }
+    for (const auto& path : dirs_) {
+        collect(path);
+    }
+    return found;
+}
+
+bool MemEnv::create_dirs(const std::string& dir) {
+    std::string name = normalize(dir);
+    std::lock_guard<std::mutex> lock(mutex_);
+    while (name != "." && name != "/" && !name.empty()) {
+        if (files_.count(name) > 0) {
+            return false;
+        }
+        dirs_.insert(name);
+        name = parent_of(name);
+    }
+    return true;
+}
+
+bool MemEnv::remove_file(const std::string& path) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return files_.erase(normalize(path)) > 0;
+}
+
+bool MemEnv::remove_dir_all(const std::string& dir) {
+    std::string prefix = normalize(dir) + "/";
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto under = [&](const std::string& path) {
+        return path.compare(0, prefix.size(), prefix) == 0;
+    };
+    for (auto it = files_.begin(); it != files_.end();) {
+        it = under(it->first) ? files_.erase(it) : std::next(it);
+    }
+    for (auto it = dirs_.begin(); it != dirs_.end();) {
+        it = under(*it) ? dirs_.erase(it) : std::next(it);
+    }
+    dirs_.erase(normalize(dir));
+    return true;
+}
+
+bool MemEnv::rename_file(const std::string& from, const std::string& to) {
+    std::string source = normalize(from);
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = files_.find(source);
+    if (it == files_.end()) {
+        return false;
+    }
+    auto file = it->second;
+    files_.erase(it);
+    files_[normalize(to)] = std::move(file);
+    return true;
+}
+
+std::unique_ptr<FileLock> MemEnv::lock_file(const std::string& path) {
+    std::string name = normalize(path);
+    open_for_write(name, false);
+    std::lock_guard<std::mutex> lock(locks_->mutex);
+    if (!locks_->held.insert(name).second) {
+        return nullptr;
+    }
+    return std::make_unique<MemFileLock>(locks_, name);
+}
+
+uint64_t MemEnv::total_size() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    uint64_t total = 0;
+    for (const auto& [path, file] : files_) {
+        std::lock_guard<std::mutex> file_lock(file->mutex);
+        total += file->data.size();
+    }
+    return total;
+}
@@ -0,0 +1,90 @@
+#ifndef KVDB_MEMENV_H
+#define KVDB_MEMENV_H
+
+#include "Env.h"
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <set>
+
+/**
+ * Env that keeps every file in memory, for tests and for measuring the engine without a disk.
+ *
+ * Paths are normalized, so "db/./x" and "db/x" are the same file. A file that is removed or
+ * renamed over stays readable through handles opened before, like an unlinked POSIX file.
+ * Injected latency is slept on every read, append and sync call to model a slower device.
+ */
+class MemEnv : public Env {
+public:
+    struct Options {
+        std::chrono::microseconds read_latency;
+        std::chrono::microseconds write_latency;
+        std::chrono::microseconds sync_latency;
+
+        explicit Options(std::chrono::microseconds read_latency_ = std::chrono::microseconds(0),
+                         std::chrono::microseconds write_latency_ = std::chrono::microseconds(0),
+                         std::chrono::microseconds sync_latency_ = std::chrono::microseconds(0))
+            : read_latency(read_latency_),
+              write_latency(write_latency_),
+              sync_latency(sync_latency_)
+        {}
+    };
+
+    explicit MemEnv(const Options& options = Options());
+
+    // Change the injected latency while files are open
+    void set_latency(const Options& options);
+
+    std::unique_ptr<SequentialFile> new_sequential_file(const std::string& path) override;
+    std::unique_ptr<RandomAccessFile> new_random_access_file(const std::string& path) override;
+    std::unique_ptr<WritableFile> new_writable_file(const std::string& path) override;
+    std::unique_ptr<WritableFile> new_appendable_file(const std::string& path) override;
+    std::unique_ptr<RandomRWFile> new_random_rw_file(const std::string& path) override;
+
+    bool file_exists(const std::string& path) override;
+    bool get_file_size(const std::string& path, uint64_t& size) override;
+    bool get_modification_time(const std::string& path, uint64_t& nanos) override;
+    bool get_children(const std::string& dir, std::vector<std::string>& names) override;
+
+    bool create_dirs(const std::string& dir) override;
+    bool remove_file(const std::string& path) override;
+    bool remove_dir_all(const std::string& dir) override;
+    bool rename_file(const std::string& from, const std::string& to) override;
+
+    std::unique_ptr<FileLock> lock_file(const std::string& path) override;
+
+    // Total bytes held by all files
+    uint64_t total_size() const;
+
+    struct File {
+        std::mutex mutex;
+        std::string data;
+        uint64_t mtime = 0;  // nanoseconds since the epoch
+    };
+
+    struct LockTable {
+        std::mutex mutex;
+        std::set<std::string> held;
+    };
+
+    struct Latency {
+        std::atomic<int64_t> read_us{0};
+        std::atomic<int64_t> write_us{0};
+        std::atomic<int64_t> sync_us{0};
+    };
+
+private:
+    mutable std::mutex mutex_;
+    std::map<std::string, std::shared_ptr<File>> files_;
+    std::set<std::string> dirs_;
+    std::shared_ptr<LockTable> locks_;
+    std::shared_ptr<Latency> latency_;
+
+    std::shared_ptr<File> find(const std::string& path) const;
+
+    // Create or, if truncate, empty the file at path
+    std::shared_ptr<File> open_for_write(const std::string& path, bool truncate);
+};
+
+#endif // KVDB_MEMENV_H
@@ -7,7 +7,7 @@
 
 // Constructor
 Memtable::Memtable(const size_t memtable_size)
-    : current_size_(0), max_size_(memtable_size), stats_({}) {}
+    : current_size_(0), max_size_(memtable_size) {}
 
 // Calculate memory usage of a key value pair
 size_t Memtable::calculate_entry_size(const std::string& key, const std::string& value)
@@ -49,8 +49,8 @@ bool Memtable::put(const std::string& key, const std::string& value)
     }
 
     // Update stats
-    stats_.puts++;
-    stats_.operations++;
+    stats_.puts.fetch_add(1, std::memory_order_relaxed);
+    stats_.operations.fetch_add(1, std::memory_order_relaxed);
 
     return !should_flush();
 }
@@ -78,8 +78,8 @@ bool Memtable::remove(const std::string& key)
         table_[key] = Entry("", true);
     }
 
-    stats_.deletes++;
-    stats_.operations++;
+    stats_.deletes.fetch_add(1, std::memory_order_relaxed);
+    stats_.operations.fetch_add(1, std::memory_order_relaxed);
 
     return !should_flush();
 }
@@ -89,8 +89,8 @@ std::optional<std::string> Memtable::get(const std::string& key) const
 {
     const auto it = table_.find(key);
 
-    stats_.gets++;
-    stats_.operations++;
+    stats_.gets.fetch_add(1, std::memory_order_relaxed);
+    stats_.operations.fetch_add(1, std::memory_order_relaxed);
 
     if (it != table_.end() && !it->second.is_deleted)
     {
@@ -137,8 +137,8 @@ void Memtable::clear()
 {
     current_size_ = 0;
     table_.clear();
-    stats_.flushes++;
-    stats_.operations++;
+    stats_.flushes.fetch_add(1, std::memory_order_relaxed);
+    stats_.operations.fetch_add(1, std::memory_order_relaxed);
 }
 
 // Get all entries and in sorted order for flushing
@@ -168,6 +168,12 @@ std::map<std::string, Memtable::Entry>::const_iterator Memtable::end() const
     return table_.end();
 }
 
+// Send iterator to first key >= key
+std::map<std::string, Memtable::Entry>::const_iterator Memtable::lower_bound(const std::string& key) const
+{
+    return table_.lower_bound(key);
+}
+
 // Get approximate memory usage breakdown
 std::map<std::string, size_t> Memtable::get_memory_usage() const
 {
@@ -228,11 +234,21 @@ size_t Memtable::get_memtable_size() const
 
 Memtable::Stats Memtable::get_stats() const
 {
-    return stats_;
+    Stats stats;
+    stats.puts = stats_.puts.load(std::memory_order_relaxed);
+    stats.deletes = stats_.deletes.load(std::memory_order_relaxed);
+    stats.gets = stats_.gets.load(std::memory_order_relaxed);
+    stats.flushes = stats_.flushes.load(std::memory_order_relaxed);
+    stats.operations = stats_.operations.load(std::memory_order_relaxed);
+    return stats;
 }
 
 // Reset stats
 void Memtable::reset_stats() const
 {
-    stats_ = {};
+    stats_.puts = 0;
+    stats_.deletes = 0;
+    stats_.gets = 0;
+    stats_.flushes = 0;
+    stats_.operations = 0;
 }
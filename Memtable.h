@@ -7,6 +7,7 @@
 
 // Allowed to use std::map since this project is completed solo.
 #include <map>
+#include <atomic>
 #include <string>
 #include <utility>
 #include <vector>
@@ -113,6 +114,11 @@ public:
      */
     [[nodiscard]] std::map<std::string, Entry>::const_iterator end() const;
 
+    /**
+     * Get iterator to first key >= key for range and prefix scans
+     */
+    [[nodiscard]] std::map<std::string, Entry>::const_iterator lower_bound(const std::string& key) const;
+
     /**
      * Get approximate memory usage
      * @return Map with breakdown of memory usage
@@ -146,7 +152,16 @@ public:
     void reset_stats() const;
 
 private:
-    mutable Stats stats_;
+    // Readers sharing the table bump gets concurrently
+    struct Counters
+    {
+        std::atomic<uint64_t> puts{0};
+        std::atomic<uint64_t> deletes{0};
+        std::atomic<uint64_t> gets{0};
+        std::atomic<uint64_t> flushes{0};
+        std::atomic<uint64_t> operations{0};
+    };
+    mutable Counters stats_;
 
 };
 
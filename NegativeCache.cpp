@@ -0,0 +1,34 @@
+#include "NegativeCache.h"
+
+namespace {
+    // Rough cost of the list node, hash map slot and string header behind each entry
+    constexpr size_t ENTRY_OVERHEAD = 96;
+}
+
+NegativeCache::NegativeCache(size_t capacity_bytes, size_t shard_count)
+    : cache_(capacity_bytes, shard_count) {
+}
+
+size_t NegativeCache::charge(const std::string& key) {
+    return key.size() + ENTRY_OVERHEAD;
+}
+
+bool NegativeCache::contains(const std::string& key, uint64_t snapshot_seq) {
+    return cache_.lookup(key, snapshot_seq).has_value();
+}
+
+bool NegativeCache::insert(const std::string& key, uint64_t read_seq) {
+    return cache_.insert(key, Absent{}, read_seq, charge(key));
+}
+
+void NegativeCache::invalidate(const std::string& key, uint64_t write_seq) {
+    cache_.invalidate(key, write_seq);
+}
+
+void NegativeCache::clear() {
+    cache_.clear();
+}
+
+NegativeCache::Stats NegativeCache::get_stats() const {
+    return cache_.get_stats();
+}
@@ -0,0 +1,71 @@
+#ifndef KVDB_NEGATIVECACHE_H
+#define KVDB_NEGATIVECACHE_H
+
+#include "ShardedLRUCache.h"
+#include <string>
+#include <cstdint>
+
+/**
+ * Sharded LRU set of keys that recently missed, so repeated gets for absent keys
+ * skip the memtable and every candidate SSTable.
+ *
+ * Entries are tagged with the sequence number the miss was observed at, and follow the
+ * same invalidation rules as RowCache: a write to the key drops it, and a miss recorded
+ * by a read that started before a write to the shard is not cached. Invalidation is per
+ * key only. Flushes and compactions install new versions but never make an absent key
+ * appear, so they leave the cache alone.
+ */
+class NegativeCache {
+public:
+    // A cached miss carries no payload
+    struct Absent {};
+
+    /**
+     * @param capacity_bytes Byte budget shared evenly between shards
+     * @param shard_count Number of independently locked shards
+     */
+    explicit NegativeCache(size_t capacity_bytes, size_t shard_count = 16);
+
+    // No copying
+    NegativeCache(const NegativeCache&) = delete;
+    NegativeCache& operator=(const NegativeCache&) = delete;
+
+    /**
+     * Check whether a key is known to be absent
+     * @param snapshot_seq Sequence number the read is done at
+     * @return true if a miss valid at snapshot_seq is cached
+     */
+    bool contains(const std::string& key, uint64_t snapshot_seq);
+
+    /**
+     * Remember a miss
+     * @param read_seq Sequence number observed before the read started
+     * @return true if cached, false if a newer write or the budget got in the way
+     */
+    bool insert(const std::string& key, uint64_t read_seq);
+
+    /**
+     * Forget a key after a write to it
+     * @param write_seq Sequence number of the write
+     */
+    void invalidate(const std::string& key, uint64_t write_seq);
+
+    /**
+     * Drop everything
+     */
+    void clear();
+
+    /**
+     * Bytes charged for an entry
+     */
+    static size_t charge(const std::string& key);
+
+    using Stats = ShardedLRUCache<Absent>::Stats;
+
+    Stats get_stats() const;
+
+private:
+    ShardedLRUCache<Absent> cache_;
+};
+
+#endif // KVDB_NEGATIVECACHE_H
@@ -0,0 +1,53 @@
+#include "PerfContext.h"
+#include <sstream>
+
+void set_perf_level(PerfLevel level) {
+    perf_internal::level = level;
+}
+
+PerfLevel get_perf_level() {
+    return perf_internal::level;
+}
+
+PerfContext& get_perf_context() {
+    return perf_internal::context;
+}
+
+std::string PerfContext::to_string(bool exclude_zero) const {
+    std::ostringstream out;
+    bool first = true;
+
+    auto field = [&](const char* name, uint64_t value) {
+        if (exclude_zero && value == 0) {
+            return;
+        }
+        out << (first ? "" : ", ") << name << " = " << value;
+        first = false;
+    };
+
+    field("get_memtable_ns", get_memtable_ns);
+    field("find_tables_ns", find_tables_ns);
+    field("table_search_ns", table_search_ns);
+    field("value_copy_ns", value_copy_ns);
+    field("memtable_hits", memtable_hits);
+    field("tables_probed", tables_probed);
+    field("index_checks", index_checks);
+    field("index_negatives", index_negatives);
+    field("range_filter_checks", range_filter_checks);
+    field("range_filter_negatives", range_filter_negatives);
+    field("prefix_filter_checks", prefix_filter_checks);
+    field("prefix_filter_negatives", prefix_filter_negatives);
+    field("row_cache_hits", row_cache_hits);
+    field("row_cache_misses", row_cache_misses);
+    field("negative_cache_hits", negative_cache_hits);
+    field("negative_cache_misses", negative_cache_misses);
+    field("bytes_read", bytes_read);
+    field("memtable_insert_ns", memtable_insert_ns);
+    field("wal_write_ns", wal_write_ns);
+    field("wal_sync_ns", wal_sync_ns);
+    field("wal_bytes", wal_bytes);
+    field("flush_ns", flush_ns);
+    field("compaction_ns", compaction_ns);
+
+    return out.str();
+}
@@ -0,0 +1,119 @@
+#ifndef KVDB_PERFCONTEXT_H
+#define KVDB_PERFCONTEXT_H
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+/**
+ * Per thread breakdown of where one operation spent its time.
+ *
+ * Off by default. With PerfLevel::COUNTS the read and write paths bump counters in the
+ * calling thread's PerfContext, TIMING also adds nanoseconds per stage. Typical use:
+ *
+ *     set_perf_level(PerfLevel::TIMING);
+ *     get_perf_context().reset();
+ *     tree.get(key);
+ *     std::cout << get_perf_context().to_string();
+ *
+ * When disabled every probe is a single thread local compare, nothing is read or written.
+ * Stages nest (a get's table search includes its value copy), so times don't add up to
+ * a total.
+ */
+enum class PerfLevel {
+    DISABLED,
+    COUNTS,  // counters only
+    TIMING   // counters and stage timings, two clock reads per stage
+};
+
+struct PerfContext {
+    // Read path, nanoseconds
+    uint64_t get_memtable_ns = 0;         // memtable lookup
+    uint64_t find_tables_ns = 0;          // choosing candidate SSTables
+    uint64_t table_search_ns = 0;         // searching SSTable key directories, index included
+    uint64_t value_copy_ns = 0;           // copying values out of SSTables
+
+    // Read path, counters
+    uint64_t memtable_hits = 0;           // lookups answered by the memtable, tombstones included
+    uint64_t tables_probed = 0;           // SSTables searched by point lookups
+    uint64_t index_checks = 0;            // hash and learned index lookups
+    uint64_t index_negatives = 0;         // ... that ruled the key out without a search
+    uint64_t range_filter_checks = 0;
+    uint64_t range_filter_negatives = 0;
+    uint64_t prefix_filter_checks = 0;
+    uint64_t prefix_filter_negatives = 0;
+    uint64_t row_cache_hits = 0;
+    uint64_t row_cache_misses = 0;
+    uint64_t negative_cache_hits = 0;
+    uint64_t negative_cache_misses = 0;
+    uint64_t bytes_read = 0;              // value bytes copied out of SSTables
+
+    // Write path
+    uint64_t memtable_insert_ns = 0;
+    uint64_t wal_write_ns = 0;            // whole WAL append
+    uint64_t wal_sync_ns = 0;             // waiting for WAL commits to reach the disk, part of wal_write_ns
+    uint64_t wal_bytes = 0;
+    uint64_t flush_ns = 0;                // memtable flushes run by this thread
+    uint64_t compaction_ns = 0;           // compactions run by this thread
+
+    void reset() { *this = PerfContext(); }
+
+    /**
+     * "name = value" pairs, comma separated
+     * @param exclude_zero Leave out counters that are still zero
+     */
+    std::string to_string(bool exclude_zero = true) const;
+};
+
+void set_perf_level(PerfLevel level);
+PerfLevel get_perf_level();
+
+// The calling thread's context
+PerfContext& get_perf_context();
+
+namespace perf_internal {
+    inline thread_local PerfLevel level = PerfLevel::DISABLED;
+    inline thread_local PerfContext context;
+}
+
+/**
+ * Add to a counter of the calling thread's context, if perf is enabled
+ */
+inline void perf_count(uint64_t PerfContext::*counter, uint64_t value = 1) {
+    if (perf_internal::level != PerfLevel::DISABLED) {
+        perf_internal::context.*counter += value;
+    }
+}
+
+/**
+ * Adds the lifetime of the scope it's declared in to a timing, at PerfLevel::TIMING
+ */
+class PerfTimer {
+public:
+    explicit PerfTimer(uint64_t PerfContext::*timing)
+        : timing_(perf_internal::level == PerfLevel::TIMING ? timing : nullptr) {
+        if (timing_) {
+            start_ = std::chrono::steady_clock::now();
+        }
+    }
+
+    ~PerfTimer() { stop(); }
+
+    // Stop early, later calls do nothing
+    void stop() {
+        if (timing_) {
+            perf_internal::context.*timing_ += static_cast<uint64_t>(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start_).count());
+            timing_ = nullptr;
+        }
+    }
+
+    PerfTimer(const PerfTimer&) = delete;
+    PerfTimer& operator=(const PerfTimer&) = delete;
+
+private:
+    uint64_t PerfContext::*timing_;
+    std::chrono::steady_clock::time_point start_;
+};
+
+#endif // KVDB_PERFCONTEXT_H
@@ -0,0 +1,60 @@
+#include "PrefixExtractor.h"
+
+namespace {
+    const std::string FIXED_PREFIX = "fixed:";
+    const std::string DELIMITER_PREFIX = "delimiter:";
+}
+
+PrefixExtractor::PrefixExtractor(Type type, size_t length, char delimiter)
+    : type_(type), length_(length), delimiter_(delimiter) {
+    if (type_ == Type::FIXED_LENGTH) {
+        name_ = FIXED_PREFIX + std::to_string(length_);
+    } else {
+        // store delimiter as its byte value so any character survives the round trip
+        name_ = DELIMITER_PREFIX + std::to_string(static_cast<unsigned char>(delimiter_));
+    }
+}
+
+std::shared_ptr<const PrefixExtractor> PrefixExtractor::fixed_length(size_t length) {
+    if (length == 0) {
+        return nullptr;
+    }
+    return std::shared_ptr<const PrefixExtractor>(new PrefixExtractor(Type::FIXED_LENGTH, length, '\0'));
+}
+
+std::shared_ptr<const PrefixExtractor> PrefixExtractor::delimiter(char delimiter) {
+    return std::shared_ptr<const PrefixExtractor>(new PrefixExtractor(Type::DELIMITER, 0, delimiter));
+}
+
+std::shared_ptr<const PrefixExtractor> PrefixExtractor::from_name(const std::string& name) {
+    try {
+        if (name.rfind(FIXED_PREFIX, 0) == 0) {
+            return fixed_length(std::stoull(name.substr(FIXED_PREFIX.size())));
+        }
+        if (name.rfind(DELIMITER_PREFIX, 0) == 0) {
+            auto value = std::stoul(name.substr(DELIMITER_PREFIX.size()));
+            if (value > 255) {
+                return nullptr;
+            }
+            return delimiter(static_cast<char>(value));
+        }
+    } catch (...) {
+        // fall through, unknown or malformed name
+    }
+    return nullptr;
+}
+
+bool PrefixExtractor::in_domain(const std::string& key) const {
+    if (type_ == Type::FIXED_LENGTH) {
+        return key.size() >= length_;
+    }
+    return key.find(delimiter_) != std::string::npos;
+}
+
+std::string PrefixExtractor::transform(const std::string& key) const {
+    if (type_ == Type::FIXED_LENGTH) {
+        return key.substr(0, length_);
+    }
+    const size_t pos = key.find(delimiter_);
+    return pos == std::string::npos ? key : key.substr(0, pos + 1);
+}
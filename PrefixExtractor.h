@@ -0,0 +1,63 @@
+#ifndef KVDB_PREFIXEXTRACTOR_H
+#define KVDB_PREFIXEXTRACTOR_H
+
+#include <string>
+#include <memory>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * Maps a key to the prefix used by prefix bloom filters and prefix scans.
+ * The extractor name is persisted with each SSTable filter so a table built
+ * with a different extractor is never consulted with the wrong prefixes.
+ */
+class PrefixExtractor
+{
+public:
+    enum class Type : uint8_t {
+        FIXED_LENGTH = 0,  // first N bytes of the key
+        DELIMITER = 1      // key up to and including the first delimiter
+    };
+
+    /**
+     * Prefix is the first `length` bytes, keys shorter than that have no prefix
+     */
+    static std::shared_ptr<const PrefixExtractor> fixed_length(size_t length);
+
+    /**
+     * Prefix runs up to and including the first `delimiter`, e.g. "user:" for ':'
+     */
+    static std::shared_ptr<const PrefixExtractor> delimiter(char delimiter);
+
+    /**
+     * Recreate an extractor from name(), returns nullptr if unknown
+     */
+    static std::shared_ptr<const PrefixExtractor> from_name(const std::string& name);
+
+    /**
+     * Check if a key has a prefix under this extractor
+     */
+    [[nodiscard]] bool in_domain(const std::string& key) const;
+
+    /**
+     * Extract the prefix of a key, caller must check in_domain() first
+     */
+    [[nodiscard]] std::string transform(const std::string& key) const;
+
+    /**
+     * Stable identifier stored in SSTables, e.g. "fixed:4"
+     */
+    [[nodiscard]] const std::string& name() const { return name_; }
+
+    [[nodiscard]] Type type() const { return type_; }
+
+private:
+    PrefixExtractor(Type type, size_t length, char delimiter);
+
+    Type type_;
+    size_t length_;
+    char delimiter_;
+    std::string name_;
+};
+
+#endif // KVDB_PREFIXEXTRACTOR_H
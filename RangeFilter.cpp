@@ -0,0 +1,295 @@
+#include "RangeFilter.h"
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <deque>
+
+namespace {
+    size_t common_prefix_length(const std::string& a, const std::string& b) {
+        const size_t n = std::min(a.size(), b.size());
+        size_t i = 0;
+        while (i < n && a[i] == b[i]) ++i;
+        return i;
+    }
+
+    void append_words(std::string& out, const std::vector<uint64_t>& words) {
+        if (words.empty()) return;
+        const size_t offset = out.size();
+        out.resize(offset + words.size() * sizeof(uint64_t));
+        std::memcpy(out.data() + offset, words.data(), words.size() * sizeof(uint64_t));
+    }
+
+    bool read_words(const std::string& data, size_t& pos, size_t bits, std::vector<uint64_t>& words) {
+        words.assign((bits + 63) / 64, 0);
+        const size_t bytes = words.size() * sizeof(uint64_t);
+        if (data.size() - pos < bytes) return false;
+        if (bytes > 0) {
+            std::memcpy(words.data(), data.data() + pos, bytes);
+        }
+        pos += bytes;
+        return true;
+    }
+}
+
+void RangeFilter::BitVector::build_rank() {
+    rank_before.resize(words.size());
+    uint32_t total = 0;
+    for (size_t i = 0; i < words.size(); ++i) {
+        rank_before[i] = total;
+        total += static_cast<uint32_t>(std::popcount(words[i]));
+    }
+}
+
+size_t RangeFilter::BitVector::rank1(size_t i) const {
+    const size_t word = i / 64;
+    const size_t bit = i % 64;
+    if (word >= words.size()) {
+        return words.empty() ? 0 : rank_before.back() + std::popcount(words.back());
+    }
+    size_t rank = rank_before[word];
+    if (bit > 0) {
+        rank += std::popcount(words[word] & ((1ULL << bit) - 1));
+    }
+    return rank;
+}
+
+size_t RangeFilter::BitVector::select1(size_t k) const {
+    // Last word whose preceding count is <= k holds the k-th one, if any word does
+    auto it = std::upper_bound(rank_before.begin(), rank_before.end(), static_cast<uint32_t>(k));
+    if (it == rank_before.begin()) {
+        return words.size() * 64;
+    }
+    size_t word = static_cast<size_t>(it - rank_before.begin()) - 1;
+    size_t remaining = k - rank_before[word];
+
+    uint64_t w = words[word];
+    if (static_cast<size_t>(std::popcount(w)) <= remaining) {
+        return words.size() * 64;
+    }
+    for (size_t i = 0; i < remaining; ++i) {
+        w &= w - 1;  // drop lowest set bit
+    }
+    return word * 64 + std::countr_zero(w);
+}
+
+RangeFilter::RangeFilter(const std::vector<std::string>& sorted_keys, size_t suffix_bytes) {
+    // 1. Truncate each key to one byte past the longest prefix it shares with a neighbour,
+    //    plus the requested suffix bytes
+    std::vector<std::string> keys;
+    keys.reserve(sorted_keys.size());
+    for (size_t i = 0; i < sorted_keys.size(); ++i) {
+        if (i > 0 && sorted_keys[i] == sorted_keys[i - 1]) continue;
+
+        size_t shared = 0;
+        if (i > 0) {
+            shared = common_prefix_length(sorted_keys[i], sorted_keys[i - 1]);
+        }
+        if (i + 1 < sorted_keys.size()) {
+            shared = std::max(shared, common_prefix_length(sorted_keys[i], sorted_keys[i + 1]));
+        }
+        keys.push_back(sorted_keys[i].substr(0, std::min(shared + 1 + suffix_bytes, sorted_keys[i].size())));
+    }
+
+    if (keys.empty()) {
+        has_child_.build_rank();
+        louds_.build_rank();
+        is_prefix_key_.build_rank();
+        return;
+    }
+
+    // 2. Breadth first over ranges of keys sharing a prefix, so nodes come out level by level
+    struct PendingNode { size_t begin; size_t end; size_t depth; };
+    std::deque<PendingNode> queue;
+    queue.push_back({0, keys.size(), 0});
+
+    std::vector<bool> has_child;
+    std::vector<bool> louds;
+    std::vector<bool> prefix_keys;
+
+    while (!queue.empty()) {
+        auto [begin, end, depth] = queue.front();
+        queue.pop_front();
+
+        // Sorted order puts a key that ends here first
+        size_t i = begin;
+        bool ends_here = keys[i].size() == depth;
+        prefix_keys.push_back(ends_here);
+        if (ends_here) ++i;
+
+        bool first_edge = true;
+        while (i < end) {
+            const auto label = static_cast<uint8_t>(keys[i][depth]);
+            size_t j = i + 1;
+            while (j < end && static_cast<uint8_t>(keys[j][depth]) == label) ++j;
+
+            bool leaf = (j - i == 1) && keys[i].size() == depth + 1;
+            labels_.push_back(label);
+            has_child.push_back(!leaf);
+            louds.push_back(first_edge);
+            first_edge = false;
+
+            if (!leaf) {
+                queue.push_back({i, j, depth + 1});
+            }
+            i = j;
+        }
+    }
+
+    node_count_ = static_cast<uint32_t>(prefix_keys.size());
+
+    has_child_.resize(labels_.size());
+    louds_.resize(labels_.size());
+    for (size_t e = 0; e < labels_.size(); ++e) {
+        if (has_child[e]) has_child_.set(e);
+        if (louds[e]) louds_.set(e);
+    }
+    is_prefix_key_.resize(node_count_);
+    for (size_t n = 0; n < node_count_; ++n) {
+        if (prefix_keys[n]) is_prefix_key_.set(n);
+    }
+
+    has_child_.build_rank();
+    louds_.build_rank();
+    is_prefix_key_.build_rank();
+}
+
+size_t RangeFilter::edges_begin(size_t node) const {
+    // Only a root holding just the empty key has no edges
+    if (labels_.empty()) return 0;
+    return std::min(louds_.select1(node), labels_.size());
+}
+
+size_t RangeFilter::edges_end(size_t node) const {
+    if (labels_.empty()) return 0;
+    return std::min(louds_.select1(node + 1), labels_.size());
+}
+
+bool RangeFilter::seek(size_t node, size_t depth, const std::string& key, std::string& path) const {
+    // A stored key ending here is a prefix of key
+    if (is_prefix_key_.get(node)) {
+        return true;
+    }
+
+    // Everything below sorts after key
+    if (depth == key.size()) {
+        leftmost(node, path);
+        return true;
+    }
+
+    const size_t begin = edges_begin(node);
+    const size_t end = edges_end(node);
+    const auto target = static_cast<uint8_t>(key[depth]);
+
+    size_t pos = static_cast<size_t>(
+        std::lower_bound(labels_.begin() + begin, labels_.begin() + end, target) - labels_.begin());
+
+    if (pos < end && labels_[pos] == target) {
+        path.push_back(static_cast<char>(target));
+        if (!has_child_.get(pos)) {
+            return true;
+        }
+        if (seek(child(pos), depth + 1, key, path)) {
+            return true;
+        }
+        path.pop_back();
+        ++pos;
+    }
+
+    if (pos < end) {
+        path.push_back(static_cast<char>(labels_[pos]));
+        if (has_child_.get(pos)) {
+            leftmost(child(pos), path);
+        }
+        return true;
+    }
+
+    return false;
+}
+
+void RangeFilter::leftmost(size_t node, std::string& path) const {
+    while (!is_prefix_key_.get(node)) {
+        const size_t edge = edges_begin(node);
+        path.push_back(static_cast<char>(labels_[edge]));
+        if (!has_child_.get(edge)) {
+            return;
+        }
+        node = child(edge);
+    }
+}
+
+bool RangeFilter::may_contain_range(const std::string& low, const std::string& high) const {
+    if (node_count_ == 0 || high < low) {
+        return false;
+    }
+
+    std::string stored;
+    if (!seek(0, 0, low, stored)) {
+        return false;
+    }
+
+    // A stored prefix of low may stand for keys just above low
+    if (low.compare(0, stored.size(), stored) == 0) {
+        return true;
+    }
+
+    // Otherwise every key it stands for is at least stored
+    return stored <= high;
+}
+
+std::string RangeFilter::serialize() const {
+    std::string out;
+    const auto edge_count = static_cast<uint32_t>(labels_.size());
+    out.append(reinterpret_cast<const char*>(&node_count_), sizeof(node_count_));
+    out.append(reinterpret_cast<const char*>(&edge_count), sizeof(edge_count));
+    out.append(reinterpret_cast<const char*>(labels_.data()), labels_.size());
+    append_words(out, has_child_.words);
+    append_words(out, louds_.words);
+    append_words(out, is_prefix_key_.words);
+    return out;
+}
+
+std::optional<RangeFilter> RangeFilter::deserialize(const std::string& data) {
+    if (data.size() < 2 * sizeof(uint32_t)) {
+        return std::nullopt;
+    }
+
+    RangeFilter filter;
+    uint32_t edge_count = 0;
+    std::memcpy(&filter.node_count_, data.data(), sizeof(uint32_t));
+    std::memcpy(&edge_count, data.data() + sizeof(uint32_t), sizeof(uint32_t));
+    size_t pos = 2 * sizeof(uint32_t);
+
+    // Every node but an edgeless root is reached through exactly one edge
+    if (filter.node_count_ > static_cast<uint64_t>(edge_count) + 1 || data.size() - pos < edge_count) {
+        return std::nullopt;
+    }
+    filter.labels_.assign(data.begin() + static_cast<std::ptrdiff_t>(pos),
+                          data.begin() + static_cast<std::ptrdiff_t>(pos + edge_count));
+    pos += edge_count;
+
+    if (!read_words(data, pos, edge_count, filter.has_child_.words) ||
+        !read_words(data, pos, edge_count, filter.louds_.words) ||
+        !read_words(data, pos, filter.node_count_, filter.is_prefix_key_.words) ||
+        pos != data.size()) {
+        return std::nullopt;
+    }
+
+    filter.has_child_.build_rank();
+    filter.louds_.build_rank();
+    filter.is_prefix_key_.build_rank();
+
+    // Each child pointer and each node's edge list must stay in bounds
+    if (filter.has_child_.rank1(edge_count) + 1 != filter.node_count_ && filter.node_count_ != 0) {
+        return std::nullopt;
+    }
+    if (edge_count > 0 && filter.louds_.rank1(edge_count) != filter.node_count_) {
+        return std::nullopt;
+    }
+
+    return filter;
+}
+
+size_t RangeFilter::memory_usage() const {
+    return sizeof(RangeFilter) + labels_.capacity() +
+           has_child_.memory_usage() + louds_.memory_usage() + is_prefix_key_.memory_usage();
+}
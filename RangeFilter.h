@@ -0,0 +1,122 @@
+#ifndef KVDB_RANGEFILTER_H
+#define KVDB_RANGEFILTER_H
+
+#include <string>
+#include <vector>
+#include <optional>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * Succinct range filter (SuRF-Base style)
+ *
+ * Keys are truncated to the shortest prefix that still tells them apart from their
+ * neighbours, plus an optional number of real suffix bytes that make range checks
+ * more precise, and the truncated keys are stored as a trie in LOUDS-Sparse encoding:
+ * nodes are laid out level by level and every edge costs one label byte plus two bits.
+ * A stored prefix p stands for every key starting with p, so the filter can answer
+ * "might any key fall in [low, high]" with false positives but never false negatives.
+ *
+ * Serialized format:
+ * - Node count (uint32_t)
+ * - Edge count (uint32_t)
+ * - Labels (edge count bytes), sorted within each node
+ * - Has-child bits (uint64_t words): edge leads to another node rather than ending a key
+ * - LOUDS bits (uint64_t words): edge is the first edge of its node
+ * - Prefix-key bits (uint64_t words): a stored key ends at this node
+ */
+class RangeFilter
+{
+public:
+    /**
+     * Build a filter over keys
+     * @param sorted_keys keys in ascending order, duplicates allowed
+     * @param suffix_bytes key bytes kept past the distinguishing prefix
+     */
+    explicit RangeFilter(const std::vector<std::string>& sorted_keys, size_t suffix_bytes = 0);
+
+    /**
+     * Check if any key might fall in the range
+     * @param low inclusive
+     * @param high inclusive
+     * @return false if no key was ever added in [low, high]
+     */
+    [[nodiscard]] bool may_contain_range(const std::string& low, const std::string& high) const;
+
+    /**
+     * Check a single key, truncation means this is only as precise as the trie depth
+     */
+    [[nodiscard]] bool may_contain(const std::string& key) const { return may_contain_range(key, key); }
+
+    /**
+     * Serialize filter for storage in an SSTable
+     */
+    [[nodiscard]] std::string serialize() const;
+
+    /**
+     * Rebuild a filter from serialized bytes
+     * @return empty optional if data is malformed
+     */
+    static std::optional<RangeFilter> deserialize(const std::string& data);
+
+    /**
+     * Get approximate memory usage in bytes
+     */
+    [[nodiscard]] size_t memory_usage() const;
+
+    [[nodiscard]] size_t node_count() const { return node_count_; }
+    [[nodiscard]] size_t edge_count() const { return labels_.size(); }
+
+private:
+    /**
+     * Plain bit vector with a rank directory, one cumulative count per 64-bit word
+     */
+    struct BitVector
+    {
+        std::vector<uint64_t> words;
+        std::vector<uint32_t> rank_before;  // ones in all words before this one
+
+        void resize(size_t bits) { words.assign((bits + 63) / 64, 0); }
+        void set(size_t i) { words[i / 64] |= (1ULL << (i % 64)); }
+        [[nodiscard]] bool get(size_t i) const { return (words[i / 64] >> (i % 64)) & 1; }
+
+        void build_rank();
+
+        // Number of ones in [0, i)
+        [[nodiscard]] size_t rank1(size_t i) const;
+
+        // Position of the k-th one (0-based), size of the vector if there is none
+        [[nodiscard]] size_t select1(size_t k) const;
+
+        [[nodiscard]] size_t memory_usage() const {
+            return words.capacity() * sizeof(uint64_t) + rank_before.capacity() * sizeof(uint32_t);
+        }
+    };
+
+    RangeFilter() = default;
+
+    uint32_t node_count_ = 0;
+    std::vector<uint8_t> labels_;
+    BitVector has_child_;
+    BitVector louds_;
+    BitVector is_prefix_key_;
+
+    // Edge positions [begin, end) of a node
+    [[nodiscard]] size_t edges_begin(size_t node) const;
+    [[nodiscard]] size_t edges_end(size_t node) const;
+
+    // Node reached through an edge that has a child
+    [[nodiscard]] size_t child(size_t edge) const { return has_child_.rank1(edge + 1); }
+
+    /**
+     * Find the smallest stored prefix that is a prefix of key or sorts at or after it
+     * @param path receives the stored prefix
+     * @return false if every stored prefix sorts before key
+     */
+    bool seek(size_t node, size_t depth, const std::string& key, std::string& path) const;
+
+    // Append the smallest stored prefix under node to path
+    void leftmost(size_t node, std::string& path) const;
+};
+
+#endif //KVDB_RANGEFILTER_H
@@ -0,0 +1,34 @@
+#include "RowCache.h"
+
+namespace {
+    // Rough cost of the list node, hash map slot and string headers behind each entry
+    constexpr size_t ENTRY_OVERHEAD = 128;
+}
+
+RowCache::RowCache(size_t capacity_bytes, size_t shard_count)
+    : cache_(capacity_bytes, shard_count) {
+}
+
+size_t RowCache::charge(const std::string& key, const std::string& value) {
+    return key.size() + value.size() + ENTRY_OVERHEAD;
+}
+
+std::optional<std::string> RowCache::lookup(const std::string& key, uint64_t snapshot_seq) {
+    return cache_.lookup(key, snapshot_seq);
+}
+
+bool RowCache::insert(const std::string& key, const std::string& value, uint64_t read_seq) {
+    return cache_.insert(key, value, read_seq, charge(key, value));
+}
+
+void RowCache::invalidate(const std::string& key, uint64_t write_seq) {
+    cache_.invalidate(key, write_seq);
+}
+
+void RowCache::clear() {
+    cache_.clear();
+}
+
+RowCache::Stats RowCache::get_stats() const {
+    return cache_.get_stats();
+}
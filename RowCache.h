@@ -0,0 +1,66 @@
+#ifndef KVDB_ROWCACHE_H
+#define KVDB_ROWCACHE_H
+
+#include "ShardedLRUCache.h"
+#include <string>
+#include <optional>
+#include <cstdint>
+
+/**
+ * Sharded LRU cache of final key-value pairs, sitting in front of the whole read path.
+ *
+ * Entries follow ShardedLRUCache's sequence number rules: valid from the sequence number
+ * they were read at until a write to the key, and not cached at all if a write reached
+ * the shard while the read was running.
+ */
+class RowCache {
+public:
+    /**
+     * @param capacity_bytes Byte budget shared evenly between shards
+     * @param shard_count Number of independently locked shards
+     */
+    explicit RowCache(size_t capacity_bytes, size_t shard_count = 16);
+
+    // No copying
+    RowCache(const RowCache&) = delete;
+    RowCache& operator=(const RowCache&) = delete;
+
+    /**
+     * Look a key up
+     * @param snapshot_seq Sequence number the read is done at
+     * @return Cached value if one valid at snapshot_seq exists
+     */
+    std::optional<std::string> lookup(const std::string& key, uint64_t snapshot_seq);
+
+    /**
+     * Cache a value read from the tree
+     * @param read_seq Sequence number observed before the read started
+     * @return true if cached, false if a newer write or the budget got in the way
+     */
+    bool insert(const std::string& key, const std::string& value, uint64_t read_seq);
+
+    /**
+     * Drop a key after a write to it
+     * @param write_seq Sequence number of the write
+     */
+    void invalidate(const std::string& key, uint64_t write_seq);
+
+    /**
+     * Drop everything
+     */
+    void clear();
+
+    /**
+     * Bytes charged for an entry
+     */
+    static size_t charge(const std::string& key, const std::string& value);
+
+    using Stats = ShardedLRUCache<std::string>::Stats;
+
+    Stats get_stats() const;
+
+private:
+    ShardedLRUCache<std::string> cache_;
+};
+
+#endif // KVDB_ROWCACHE_H
@@ -3,22 +3,32 @@
 //
 
 #include "SSTableReader.h"
-#include <fstream>
+#include "PerfContext.h"
 #include <iostream>
 #include <stdexcept>
 #include <algorithm>
 #include <utility>
+#include <cstring>
 
 // Constants matching SSTableWriter format
 namespace {
     constexpr uint64_t EXPECTED_MAGIC = 0x4B5644425F535354ULL;  // "KVDB_SST"
-    constexpr uint32_t EXPECTED_VERSION = 1;
+    constexpr uint32_t MIN_VERSION = 1;
+    constexpr uint32_t MAX_VERSION = 2;
+    constexpr uint32_t FIRST_VERSION_WITH_META = 2;
     constexpr size_t HEADER_SIZE = 24;  // magic(8) + version(4) + entry_count(4) + data_offset(8)
+    constexpr size_t FOOTER_SIZE = 16;  // meta_offset(8) + magic(8)
+
+    // Meta block type ids, see SSTableWriter::MetaBlockType
+    constexpr uint32_t META_PREFIX_BLOOM = 1;
+    constexpr uint32_t META_RANGE_FILTER = 2;
+    constexpr uint32_t META_LEARNED_INDEX = 3;
+    constexpr uint32_t META_HASH_INDEX = 4;
 }
 
-SSTableReader::SSTableReader(std::string  filename)
-    : filename_(std::move(filename)), value_data_size_(0), valid_(false) {
-    valid_ = load();
+SSTableReader::SSTableReader(std::string  filename, const std::shared_ptr<Env>& env)
+    : filename_(std::move(filename)), value_data_size_(0), file_size_(0), data_offset_(0), valid_(false), version_(0) {
+    valid_ = load(env ? *env : *Env::default_env());
 }
 
 // Destructor
@@ -30,7 +40,15 @@ SSTableReader::SSTableReader(SSTableReader&& other) noexcept
       key_entries_(std::move(other.key_entries_)),
       value_data_(std::move(other.value_data_)),
       value_data_size_(other.value_data_size_),
-      valid_(other.valid_) {
+      file_size_(other.file_size_),
+      data_offset_(other.data_offset_),
+      valid_(other.valid_),
+      version_(other.version_),
+      prefix_filter_(std::move(other.prefix_filter_)),
+      prefix_extractor_name_(std::move(other.prefix_extractor_name_)),
+      range_filter_(std::move(other.range_filter_)),
+      learned_index_(std::move(other.learned_index_)),
+      hash_index_(std::move(other.hash_index_)) {
     other.valid_ = false;
     other.value_data_size_ = 0;
 }
@@ -42,7 +60,15 @@ SSTableReader& SSTableReader::operator=(SSTableReader&& other) noexcept {
         key_entries_ = std::move(other.key_entries_);
         value_data_ = std::move(other.value_data_);
         value_data_size_ = other.value_data_size_;
+        file_size_ = other.file_size_;
+        data_offset_ = other.data_offset_;
         valid_ = other.valid_;
+        version_ = other.version_;
+        prefix_filter_ = std::move(other.prefix_filter_);
+        prefix_extractor_name_ = std::move(other.prefix_extractor_name_);
+        range_filter_ = std::move(other.range_filter_);
+        learned_index_ = std::move(other.learned_index_);
+        hash_index_ = std::move(other.hash_index_);
 
         other.valid_ = false;
         other.value_data_size_ = 0;
@@ -51,9 +77,9 @@ SSTableReader& SSTableReader::operator=(SSTableReader&& other) noexcept {
 }
 
 // Load SSTable
-bool SSTableReader::load()
+bool SSTableReader::load(Env& env)
 {
-    std::ifstream file(filename_, std::ios::binary | std::ios::ate);
+    EnvInputStream file(env.new_random_access_file(filename_));
     if (!file)
     {
         std::cerr << "Cannot open SSTable file: " << filename_ << std::endl;
@@ -63,8 +89,10 @@ bool SSTableReader::load()
     try
     {
         // Get file size
+        file.seekg(0, std::ios::end);
         std::streamsize file_size = file.tellg();
         file.seekg(0);
+        file_size_ = static_cast<uint64_t>(file_size);
 
         if (file_size < HEADER_SIZE)
         {
@@ -89,12 +117,13 @@ bool SSTableReader::load()
             return false;
         }
 
-        if (version != EXPECTED_VERSION)
+        if (version < MIN_VERSION || version > MAX_VERSION)
         {
             std::cerr << "Unsupported SSTable version in " << filename_
-                      << ": expected " << EXPECTED_VERSION << ", got " << version << std::endl;
+                      << ": expected " << MIN_VERSION << "-" << MAX_VERSION << ", got " << version << std::endl;
             return false;
         }
+        version_ = version;
 
         if (data_offset > static_cast<uint64_t>(file_size))
         {
@@ -103,6 +132,38 @@ bool SSTableReader::load()
             return false;
         }
 
+        // Value data ends at the meta section in version 2+, at end of file before that
+        uint64_t value_end = static_cast<uint64_t>(file_size);
+        if (version >= FIRST_VERSION_WITH_META)
+        {
+            if (static_cast<uint64_t>(file_size) < HEADER_SIZE + FOOTER_SIZE)
+            {
+                std::cerr << "File too small for SSTable footer: " << filename_ << std::endl;
+                return false;
+            }
+
+            uint64_t meta_offset;
+            uint64_t footer_magic;
+            file.seekg(file_size - static_cast<std::streamoff>(FOOTER_SIZE));
+            file.read(reinterpret_cast<char*>(&meta_offset), sizeof(meta_offset));
+            file.read(reinterpret_cast<char*>(&footer_magic), sizeof(footer_magic));
+
+            if (!file || footer_magic != EXPECTED_MAGIC)
+            {
+                std::cerr << "Invalid footer in SSTable: " << filename_ << std::endl;
+                return false;
+            }
+
+            if (meta_offset < data_offset || meta_offset > static_cast<uint64_t>(file_size) - FOOTER_SIZE)
+            {
+                std::cerr << "Invalid meta offset in " << filename_ << ": " << meta_offset << std::endl;
+                return false;
+            }
+
+            value_end = meta_offset;
+            file.seekg(HEADER_SIZE);
+        }
+
         // Reserve space for key entries
         key_entries_.reserve(entry_count);
 
@@ -162,11 +223,11 @@ bool SSTableReader::load()
             current_pos += sizeof(tombstone);
 
             // Verify value offset is within file
-            if (entry.value_offset + entry.value_length > static_cast<uint64_t>(file_size)) {
+            if (entry.value_offset + entry.value_length > value_end) {
                 std::cerr << "Value offset/length out of bounds at entry " << i
                           << ": offset=" << entry.value_offset
                           << ", length=" << entry.value_length
-                          << ", file_size=" << file_size << std::endl;
+                          << ", data_end=" << value_end << std::endl;
                 return false;
             }
 
@@ -183,7 +244,8 @@ bool SSTableReader::load()
 
         // load data section into memory
         // Load data section into memory
-        value_data_size_ = file_size - data_offset;
+        value_data_size_ = value_end - data_offset;
+        data_offset_ = data_offset;
         value_data_ = std::make_unique<char[]>(value_data_size_);
 
         if (!file.read(value_data_.get(), value_data_size_)) {
@@ -191,6 +253,19 @@ bool SSTableReader::load()
             return false;
         }
 
+        // Load meta blocks (filters etc.)
+        if (version >= FIRST_VERSION_WITH_META &&
+            !load_meta_blocks(file, value_end, static_cast<uint64_t>(file_size) - FOOTER_SIZE)) {
+            std::cerr << "Failed to read meta section in " << filename_ << std::endl;
+            return false;
+        }
+
+        // A model built for a different directory would send lookups to the wrong window
+        if (learned_index_ && learned_index_->key_count() != key_entries_.size()) {
+            std::cerr << "Learned index does not match key directory in " << filename_ << std::endl;
+            learned_index_.reset();
+        }
+
         // Verify index is sorted (should be from SSTableWriter)
         for (size_t i = 1; i < key_entries_.size(); ++i) {
             if (key_entries_[i - 1].key >= key_entries_[i].key) {
@@ -209,16 +284,88 @@ bool SSTableReader::load()
     }
 }
 
+bool SSTableReader::load_meta_blocks(std::istream& file, uint64_t meta_offset, uint64_t meta_end)
+{
+    file.seekg(static_cast<std::streamoff>(meta_offset));
+
+    uint32_t block_count = 0;
+    if (!file.read(reinterpret_cast<char*>(&block_count), sizeof(block_count))) {
+        return false;
+    }
+
+    uint64_t pos = meta_offset + sizeof(block_count);
+    for (uint32_t i = 0; i < block_count; ++i) {
+        uint32_t type = 0;
+        uint32_t length = 0;
+        if (!file.read(reinterpret_cast<char*>(&type), sizeof(type)) ||
+            !file.read(reinterpret_cast<char*>(&length), sizeof(length))) {
+            return false;
+        }
+        pos += sizeof(type) + sizeof(length);
+
+        if (pos + length > meta_end) {
+            std::cerr << "Meta block " << i << " out of bounds in " << filename_ << std::endl;
+            return false;
+        }
+
+        std::string payload(length, '\0');
+        if (length > 0 && !file.read(payload.data(), length)) {
+            return false;
+        }
+        pos += length;
+
+        switch (type) {
+            case META_PREFIX_BLOOM: {
+                uint32_t name_len = 0;
+                if (payload.size() < sizeof(name_len)) return false;
+                std::memcpy(&name_len, payload.data(), sizeof(name_len));
+                if (payload.size() < sizeof(name_len) + name_len) return false;
+
+                prefix_extractor_name_ = payload.substr(sizeof(name_len), name_len);
+                prefix_filter_ = BloomFilter::deserialize(payload.substr(sizeof(name_len) + name_len));
+                if (!prefix_filter_) return false;
+                break;
+            }
+            case META_RANGE_FILTER: {
+                range_filter_ = RangeFilter::deserialize(payload);
+                if (!range_filter_) return false;
+                break;
+            }
+            case META_LEARNED_INDEX: {
+                learned_index_ = LearnedIndex::deserialize(payload);
+                if (!learned_index_) return false;
+                break;
+            }
+            case META_HASH_INDEX: {
+                hash_index_ = HashIndex::deserialize(payload, key_entries_.size());
+                if (!hash_index_) return false;
+                break;
+            }
+            default:
+                // Unknown block from a newer writer, safe to ignore
+                break;
+        }
+    }
+
+    return true;
+}
+
 // Binary search implementation
 int SSTableReader::binary_search(const std::string& key) const
 {
-    if (key_entries_.empty())
+    return binary_search(key, 0, key_entries_.size());
+}
+
+int SSTableReader::binary_search(const std::string& key, size_t begin, size_t end) const
+{
+    end = std::min(end, key_entries_.size());
+    if (begin >= end)
     {
         return -1;
     }
 
-    int left = 0;
-    int right = static_cast<int>(key_entries_.size()) - 1;
+    int left = static_cast<int>(begin);
+    int right = static_cast<int>(end) - 1;
 
     while (left <= right) {
         int mid = left + (right - left) / 2;
@@ -236,13 +383,50 @@ int SSTableReader::binary_search(const std::string& key) const
     return -1;  // Not found
 }
 
+int SSTableReader::find_entry(const std::string& key) const
+{
+    PerfTimer timer(&PerfContext::table_search_ns);
+
+    if (hash_index_)
+    {
+        auto result = hash_index_->lookup(key);
+        perf_count(&PerfContext::index_checks);
+        if (result.probe == HashIndex::Probe::ABSENT)
+        {
+            perf_count(&PerfContext::index_negatives);
+            return -1;
+        }
+        if (result.probe == HashIndex::Probe::CANDIDATE)
+        {
+            // The key is either at this position or nowhere in the table
+            return key_entries_[result.position].key == key ? static_cast<int>(result.position) : -1;
+        }
+        // Shared bucket, search the directory
+    }
+
+    if (!learned_index_)
+    {
+        return binary_search(key);
+    }
+
+    // The model bounds where the key can be, only that window is searched
+    auto range = learned_index_->search_range(key);
+    perf_count(&PerfContext::index_checks);
+    if (!range)
+    {
+        perf_count(&PerfContext::index_negatives);
+        return -1;
+    }
+    return binary_search(key, range->begin, range->end);
+}
+
 // Get value for key
 std::optional<std::string> SSTableReader::get(const std::string& key) const {
     if (!valid_) {
         return std::nullopt;
     }
 
-    int idx = binary_search(key);
+    int idx = find_entry(key);
     if (idx == -1) {
         return std::nullopt;  // Key not found
     }
@@ -259,7 +443,7 @@ std::optional<std::string> SSTableReader::get(const std::string& key) const {
 bool SSTableReader::contains(const std::string& key) const {
     if (!valid_) return false;
 
-    int idx = binary_search(key);
+    int idx = find_entry(key);
     return idx != -1 && !key_entries_[idx].is_deleted;
 }
 
@@ -267,10 +451,25 @@ bool SSTableReader::contains(const std::string& key) const {
 bool SSTableReader::is_deleted(const std::string& key) const {
     if (!valid_) return false;
 
-    int idx = binary_search(key);
+    int idx = find_entry(key);
     return idx != -1 && key_entries_[idx].is_deleted;
 }
 
+std::optional<Memtable::Entry> SSTableReader::get_entry(const std::string& key) const {
+    if (!valid_) return std::nullopt;
+
+    int idx = find_entry(key);
+    if (idx == -1) {
+        return std::nullopt;
+    }
+
+    const auto& entry = key_entries_[idx];
+    if (entry.is_deleted) {
+        return Memtable::Entry("", true);
+    }
+    return Memtable::Entry(read_value(entry));
+}
+
 // Get number of entries
 size_t SSTableReader::size() const {
     return key_entries_.size();
@@ -295,6 +494,20 @@ size_t SSTableReader::memory_usage() const {
         total += sizeof(KeyEntry) + entry.key.capacity();
     }
 
+    // Filters
+    if (prefix_filter_) {
+        total += prefix_filter_->memory_usage();
+    }
+    if (range_filter_) {
+        total += range_filter_->memory_usage();
+    }
+    if (learned_index_) {
+        total += learned_index_->memory_usage();
+    }
+    if (hash_index_) {
+        total += hash_index_->memory_usage();
+    }
+
     // Value data memory
     total += value_data_size_;
 
@@ -377,23 +590,112 @@ SSTableReader::scan_range(const std::string& start_key, const std::string& end_k
     return results;
 }
 
+// range scan of keys, tombstones included
+std::vector<std::pair<std::string, Memtable::Entry>>
+SSTableReader::scan_range_entries(const std::string& start_key, const std::string& end_key) const {
+    std::vector<std::pair<std::string, Memtable::Entry>> results;
+
+    if (!valid_ || key_entries_.empty()) return results;
+
+    for (size_t i = lower_bound_index(start_key); i < key_entries_.size(); ++i) {
+        const auto& entry = key_entries_[i];
+        if (entry.key > end_key) {
+            break;
+        }
+
+        if (entry.is_deleted) {
+            results.emplace_back(entry.key, Memtable::Entry("", true));
+        } else {
+            results.emplace_back(entry.key, Memtable::Entry(read_value(entry), false));
+        }
+    }
+
+    return results;
+}
+
+size_t SSTableReader::lower_bound_index(const std::string& key) const {
+    auto it = std::lower_bound(key_entries_.begin(), key_entries_.end(), key);
+    return static_cast<size_t>(it - key_entries_.begin());
+}
+
+// prefix scan of keys, tombstones included
+std::vector<std::pair<std::string, Memtable::Entry>>
+SSTableReader::scan_prefix(const std::string& prefix) const {
+    std::vector<std::pair<std::string, Memtable::Entry>> results;
+
+    if (!valid_ || key_entries_.empty()) return results;
+
+    for (size_t i = lower_bound_index(prefix); i < key_entries_.size(); ++i) {
+        const auto& entry = key_entries_[i];
+
+        // Keys are sorted, so the first key without the prefix ends the scan
+        if (entry.key.compare(0, prefix.size(), prefix) != 0) {
+            break;
+        }
+
+        if (entry.is_deleted) {
+            results.emplace_back(entry.key, Memtable::Entry("", true));
+        } else {
+            results.emplace_back(entry.key, Memtable::Entry(read_value(entry), false));
+        }
+    }
+
+    return results;
+}
+
+bool SSTableReader::may_contain_prefix(const std::string& prefix, const PrefixExtractor& extractor) const {
+    if (!valid_) return false;
+
+    // Without a compatible filter we have to assume the prefix may be present
+    if (!prefix_filter_ || prefix_extractor_name_ != extractor.name() || !extractor.in_domain(prefix)) {
+        return true;
+    }
+
+    return prefix_filter_->may_contain(extractor.transform(prefix));
+}
+
+bool SSTableReader::has_prefix_filter() const {
+    return prefix_filter_.has_value();
+}
+
+bool SSTableReader::may_contain_range(const std::string& start_key, const std::string& end_key) const {
+    if (!valid_) return false;
+
+    if (!range_filter_) {
+        return true;
+    }
+
+    return range_filter_->may_contain_range(start_key, end_key);
+}
+
+bool SSTableReader::has_range_filter() const {
+    return range_filter_.has_value();
+}
+
+bool SSTableReader::has_learned_index() const {
+    return learned_index_.has_value();
+}
+
+bool SSTableReader::has_hash_index() const {
+    return hash_index_.has_value();
+}
+
+uint64_t SSTableReader::file_size() const {
+    return file_size_;
+}
+
+uint32_t SSTableReader::get_version() const {
+    return version_;
+}
+
 std::string SSTableReader::read_value(const KeyEntry& entry) const
 {
     if (!value_data_ || key_entries_.empty()) {
         throw std::runtime_error("SSTable data not properly loaded");
     }
 
-    // Find the minimum value offset (should be data_offset)
-    // We need this to compute buffer-relative offset
-    uint64_t min_offset = key_entries_[0].value_offset;
-    for (const auto& e : key_entries_) {
-        if (e.value_offset < min_offset) {
-            min_offset = e.value_offset;
-        }
-    }
-
     // Compute buffer offset: absolute file offset - start of data section
-    uint64_t buffer_offset = entry.value_offset - min_offset;
+    uint64_t buffer_offset = entry.value_offset - data_offset_;
 
     // Validate bounds
     if (buffer_offset + entry.value_length > value_data_size_) {
@@ -405,6 +707,8 @@ std::string SSTableReader::read_value(const KeyEntry& entry) const
     }
 
     // Extract value from buffer
+    PerfTimer timer(&PerfContext::value_copy_ns);
+    perf_count(&PerfContext::bytes_read, entry.value_length);
     return std::string(value_data_.get() + buffer_offset, entry.value_length);
 }
 
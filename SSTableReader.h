@@ -10,11 +10,19 @@
 #include <optional>
 #include <memory>
 #include "BufferPool.h"
+#include "BloomFilter.h"
+#include "RangeFilter.h"
+#include "LearnedIndex.h"
+#include "HashIndex.h"
+#include "Memtable.h"
+#include "PrefixExtractor.h"
+#include "Env.h"
 
 class SSTableReader
 {
 public:
-    explicit SSTableReader(std::string  filename);
+    // Reads the whole table through env, nullptr for Env::default_env()
+    explicit SSTableReader(std::string  filename, const std::shared_ptr<Env>& env = nullptr);
     ~SSTableReader();
 
     // no copying
@@ -41,6 +49,12 @@ public:
      */
     [[nodiscard]] bool is_deleted(const std::string& key) const;
 
+    /**
+     * Value or tombstone for a key, from a single search
+     * @return Entry with is_deleted set for a tombstone, empty optional if the key isn't here
+     */
+    [[nodiscard]] std::optional<Memtable::Entry> get_entry(const std::string& key) const;
+
     /**
      * Get number of entries in SSTable
      */
@@ -61,6 +75,11 @@ public:
      */
     [[nodiscard]] size_t memory_usage() const;
 
+    /**
+     * Get the size of the file as loaded, in bytes
+     */
+    [[nodiscard]] uint64_t file_size() const;
+
     /**
      * Get all keys for debugging or testing
      */
@@ -84,6 +103,64 @@ public:
      */
     [[nodiscard]] std::vector<std::pair<std::string, std::string>> scan_range(const std::string& start_key, const std::string& end_key) const;
 
+    /**
+     * Collects every entry with a key in the range
+     * Tombstones are included so callers can let them shadow older tables
+     * @param start_key inclusive
+     * @param end_key inclusive
+     * @return vector of matching entries in key order
+     */
+    [[nodiscard]] std::vector<std::pair<std::string, Memtable::Entry>> scan_range_entries(const std::string& start_key, const std::string& end_key) const;
+
+    /**
+     * Collects every entry whose key starts with prefix
+     * Tombstones are included so callers can let them shadow older tables
+     * @param prefix key prefix, empty matches everything
+     * @return vector of matching entries in key order
+     */
+    [[nodiscard]] std::vector<std::pair<std::string, Memtable::Entry>> scan_prefix(const std::string& prefix) const;
+
+    /**
+     * Check the prefix bloom filter before scanning for a prefix
+     * @param prefix scan prefix
+     * @param extractor extractor the caller would use for the prefix
+     * @return false only if the table definitely has no key starting with prefix
+     */
+    [[nodiscard]] bool may_contain_prefix(const std::string& prefix, const PrefixExtractor& extractor) const;
+
+    /**
+     * Check if the table was written with a prefix bloom filter
+     */
+    [[nodiscard]] bool has_prefix_filter() const;
+
+    /**
+     * Check the range filter before scanning a range
+     * @param start_key inclusive
+     * @param end_key inclusive
+     * @return false only if the table definitely has no key in the range
+     */
+    [[nodiscard]] bool may_contain_range(const std::string& start_key, const std::string& end_key) const;
+
+    /**
+     * Check if the table was written with a range filter
+     */
+    [[nodiscard]] bool has_range_filter() const;
+
+    /**
+     * Check if point lookups use a learned index instead of a full binary search
+     */
+    [[nodiscard]] bool has_learned_index() const;
+
+    /**
+     * Check if point lookups try a hash index before searching the key directory
+     */
+    [[nodiscard]] bool has_hash_index() const;
+
+    /**
+     * Get the on-disk format version of the table
+     */
+    [[nodiscard]] uint32_t get_version() const;
+
     /**
      * Set a shared buffer pool
      */
@@ -114,17 +191,47 @@ private:
     std::vector<KeyEntry> key_entries_;  // sorted for binary search
     std::unique_ptr<char[]> value_data_;  // memory mapped or loaded values
     size_t value_data_size_;
+    uint64_t file_size_;
+    uint64_t data_offset_;  // file offset of value_data_[0]
     bool valid_;
+    uint32_t version_;
+
+    // Meta blocks (version 2+)
+    std::optional<BloomFilter> prefix_filter_;
+    std::string prefix_extractor_name_;  // extractor the filter was built with
+    std::optional<RangeFilter> range_filter_;
+    std::optional<LearnedIndex> learned_index_;
+    std::optional<HashIndex> hash_index_;
 
     /**
      * Binary search for key in key entries
      */
     [[nodiscard]] int binary_search(const std::string& key) const;
 
+    /**
+     * Binary search for key in key entries [begin, end)
+     */
+    [[nodiscard]] int binary_search(const std::string& key, size_t begin, size_t end) const;
+
+    /**
+     * Locate key in key entries, through the hash or learned index when there is one
+     */
+    [[nodiscard]] int find_entry(const std::string& key) const;
+
+    /**
+     * Index of the first key >= key, key_entries_.size() if none
+     */
+    [[nodiscard]] size_t lower_bound_index(const std::string& key) const;
+
     /**
      * Load SSTable file
      */
-    bool load();
+    bool load(Env& env);
+
+    /**
+     * Parse the meta section of a version 2+ file
+     */
+    bool load_meta_blocks(std::istream& file, uint64_t meta_offset, uint64_t meta_end);
 
     [[nodiscard]] std::string read_value(const KeyEntry& entry) const;
 
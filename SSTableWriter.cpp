@@ -3,7 +3,10 @@
 //
 
 #include "SSTableWriter.h"
-#include <fstream>
+#include "BloomFilter.h"
+#include "RangeFilter.h"
+#include "LearnedIndex.h"
+#include "HashIndex.h"
 #include <iostream>
 #include <vector>
 #include <string>
@@ -14,7 +17,7 @@
  * SSTable Format is the following:
  * [Header]
  * - Magic number (8 bytes): "KVDB_SST\0"
- * - Version (uint32_t): 1
+ * - Version (uint32_t): 2 (version 1 files have no meta section or footer)
  * - Entry count (uint32_t): Number of key-value pairs
  * - Data offset (uint64_t): Where key-value data starts
  *
@@ -28,6 +31,12 @@
  *
  * [Value Data Section]
  * Sequential storage of all values
+ *
+ * [Meta Section] - count (uint32_t), then (type, length, payload) blocks
+ *
+ * [Footer]
+ * - Meta offset (uint64_t)
+ * - Magic number (8 bytes)
  */
 
 // File format consts
@@ -37,12 +46,98 @@ namespace
     constexpr size_t HEADER_SIZE = sizeof(uint64_t) + sizeof(uint32_t) + sizeof(uint32_t) + sizeof(uint64_t);
     // should be 17
     constexpr size_t KEY_ENTRY_HEADER_SIZE = sizeof(uint32_t) + sizeof(uint64_t) + sizeof(uint32_t) + sizeof(uint8_t);
+
+    // Bloom filter over the distinct prefixes of all keys, tombstones included so that
+    // a table holding only deletes for a prefix is still visited by prefix scans
+    std::string build_prefix_bloom_block(const std::vector<std::pair<std::string, Memtable::Entry>>& entries,
+                                         const SSTableWriter::Options& options)
+    {
+        const auto& extractor = *options.prefix_extractor;
+
+        std::vector<std::string> prefixes;
+        for (const auto& [key, entry] : entries)
+        {
+            if (!extractor.in_domain(key)) continue;
+
+            std::string prefix = extractor.transform(key);
+            // keys are sorted so equal prefixes are adjacent
+            if (prefixes.empty() || prefixes.back() != prefix)
+            {
+                prefixes.push_back(std::move(prefix));
+            }
+        }
+
+        BloomFilter filter(prefixes.size(), options.prefix_bloom_bits_per_key);
+        for (const auto& prefix : prefixes)
+        {
+            filter.add(prefix);
+        }
+
+        const std::string& name = extractor.name();
+        const auto name_len = static_cast<uint32_t>(name.size());
+
+        std::string block(reinterpret_cast<const char*>(&name_len), sizeof(name_len));
+        block += name;
+        block += filter.serialize();
+        return block;
+    }
+
+    // Range filter over every key, tombstones included so range scans still see deletes
+    std::string build_range_filter_block(const std::vector<std::pair<std::string, Memtable::Entry>>& entries,
+                                         const SSTableWriter::Options& options)
+    {
+        std::vector<std::string> keys;
+        keys.reserve(entries.size());
+        for (const auto& [key, entry] : entries)
+        {
+            keys.push_back(key);
+        }
+
+        return RangeFilter(keys, options.range_filter_suffix_bytes).serialize();
+    }
+
+    // Learned index over key directory positions, empty if the keys aren't numeric friendly
+    std::string build_learned_index_block(const std::vector<std::pair<std::string, Memtable::Entry>>& entries,
+                                          const SSTableWriter::Options& options)
+    {
+        std::vector<std::string> keys;
+        keys.reserve(entries.size());
+        for (const auto& [key, entry] : entries)
+        {
+            keys.push_back(key);
+        }
+
+        auto index = LearnedIndex::build(keys, options.learned_index_epsilon);
+        return index ? index->serialize() : std::string();
+    }
+
+    // Hash index over every key, tombstones included so deletes are found without a search
+    std::string build_hash_index_block(const std::vector<std::pair<std::string, Memtable::Entry>>& entries,
+                                       const SSTableWriter::Options& options)
+    {
+        std::vector<std::string> keys;
+        keys.reserve(entries.size());
+        for (const auto& [key, entry] : entries)
+        {
+            keys.push_back(key);
+        }
+
+        return HashIndex(keys, options.hash_index_util_ratio).serialize();
+    }
 }
 
 bool SSTableWriter::write(const std::string& filename,
     const std::vector<std::pair<std::string, Memtable::Entry>>& entries)
 {
-    std::ofstream file(filename, std::ios::binary | std::ios::trunc);
+    return write(filename, entries, Options());
+}
+
+bool SSTableWriter::write(const std::string& filename,
+    const std::vector<std::pair<std::string, Memtable::Entry>>& entries,
+    const Options& options)
+{
+    Env& env = options.env ? *options.env : *Env::default_env();
+    EnvOutputStream file(env.new_writable_file(filename));
     if (!file)
     {
         std::cerr << "Failed to open file for writing: " << filename << std::endl;
@@ -99,8 +194,51 @@ bool SSTableWriter::write(const std::string& filename,
             file.write(value.data(), value.size());
         }
 
-        // verify file is in good state
-        if (!file)
+        // build meta blocks
+        std::vector<std::pair<MetaBlockType, std::string>> meta_blocks;
+        if (options.prefix_extractor)
+        {
+            meta_blocks.emplace_back(MetaBlockType::PREFIX_BLOOM, build_prefix_bloom_block(entries, options));
+        }
+        if (options.range_filter)
+        {
+            meta_blocks.emplace_back(MetaBlockType::RANGE_FILTER, build_range_filter_block(entries, options));
+        }
+        if (options.learned_index)
+        {
+            // Readers fall back to binary search when the block is missing
+            std::string block = build_learned_index_block(entries, options);
+            if (!block.empty())
+            {
+                meta_blocks.emplace_back(MetaBlockType::LEARNED_INDEX, std::move(block));
+            }
+        }
+        if (options.hash_index)
+        {
+            meta_blocks.emplace_back(MetaBlockType::HASH_INDEX, build_hash_index_block(entries, options));
+        }
+
+        // write meta section, values were written back to back so current_value_offset is its start
+        const uint64_t meta_offset = current_value_offset;
+        const auto meta_count = static_cast<uint32_t>(meta_blocks.size());
+        file.write(reinterpret_cast<const char*>(&meta_count), sizeof(meta_count));
+
+        for (const auto& [type, payload] : meta_blocks)
+        {
+            const auto type_id = static_cast<uint32_t>(type);
+            const auto payload_len = static_cast<uint32_t>(payload.size());
+            file.write(reinterpret_cast<const char*>(&type_id), sizeof(type_id));
+            file.write(reinterpret_cast<const char*>(&payload_len), sizeof(payload_len));
+            file.write(payload.data(), payload.size());
+        }
+
+        // write footer
+        file.write(reinterpret_cast<const char*>(&meta_offset), sizeof(meta_offset));
+        file.write(reinterpret_cast<const char*>(&SSTableWriter::MAGIC), sizeof(SSTableWriter::MAGIC));
+
+        // Synced before the caller adds the table to a level or drops what it replaces, such
+        // as the WAL after a flush or the inputs of a compaction
+        if (!file.sync() || !file.close())
         {
             throw std::runtime_error("Failed to write to file");
         }
@@ -121,7 +259,7 @@ bool SSTableWriter::write_from_memtable(const std::string& filename, const Memta
 
 uint64_t SSTableWriter::calculate_total_size(const std::vector<std::pair<std::string, Memtable::Entry>>& entries)
 {
-    uint64_t total_size = HEADER_SIZE;
+    uint64_t total_size = HEADER_SIZE + sizeof(uint32_t) + FOOTER_SIZE;
     for (const auto& [key, entry] : entries)
     {
         total_size += KEY_ENTRY_HEADER_SIZE + key.size() + entry.value.size();
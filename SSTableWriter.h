@@ -8,13 +8,16 @@
 #include <string>
 #include <vector>
 #include <cstdint>
+#include <memory>
 #include "Memtable.h"
+#include "PrefixExtractor.h"
+#include "Env.h"
 
 /**
  * SSTable Format is the following:
  * [Header]
  * - Magic number (8 bytes): "KVDB_SST\0"
- * - Version (uint32_t): 1
+ * - Version (uint32_t): 2 (version 1 files have no meta section or footer)
  * - Entry count (uint32_t): Number of key-value pairs
  * - Data offset (uint64_t): Where key-value data starts
  *
@@ -28,11 +31,69 @@
  *
  * [Value Data Section]
  * Sequential storage of all values
+ *
+ * [Meta Section] - Version 2+, optional per-table structures
+ * - Block count (uint32_t)
+ * Array of:
+ *  - Block type (uint32_t): see MetaBlockType
+ *  - Block length (uint32_t)
+ *  - Block payload (variable)
+ *
+ * [Footer] - Version 2+
+ * - Meta offset (uint64_t): Where the meta section starts (= end of value data)
+ * - Magic number (8 bytes): repeated so truncated files are detected
  */
 
 class SSTableWriter
 {
 public:
+    /**
+     * Optional per-table structures written to the meta section
+     */
+    struct Options
+    {
+        std::shared_ptr<const PrefixExtractor> prefix_extractor;  // nullptr disables the prefix bloom filter
+        size_t prefix_bloom_bits_per_key;
+        bool range_filter;                                        // succinct trie for pruning range scans
+        size_t range_filter_suffix_bytes;                         // key bytes kept past the distinguishing prefix
+        bool learned_index;                                       // fit a model over the key directory if keys allow
+        uint32_t learned_index_epsilon;                           // max model error in directory positions
+        bool hash_index;                                          // hash map from key to directory position
+        double hash_index_util_ratio;                             // keys per hash bucket
+        std::shared_ptr<Env> env;                                 // where the file goes, nullptr for Env::default_env()
+
+        explicit Options(
+            std::shared_ptr<const PrefixExtractor> prefix_extractor_ = nullptr,
+            size_t prefix_bloom_bits_per_key_ = 10,
+            bool range_filter_ = false,
+            size_t range_filter_suffix_bytes_ = 1,
+            bool learned_index_ = false,
+            uint32_t learned_index_epsilon_ = 16,
+            bool hash_index_ = false,
+            double hash_index_util_ratio_ = 0.75
+        )
+            : prefix_extractor(std::move(prefix_extractor_)),
+              prefix_bloom_bits_per_key(prefix_bloom_bits_per_key_),
+              range_filter(range_filter_),
+              range_filter_suffix_bytes(range_filter_suffix_bytes_),
+              learned_index(learned_index_),
+              learned_index_epsilon(learned_index_epsilon_),
+              hash_index(hash_index_),
+              hash_index_util_ratio(hash_index_util_ratio_)
+        {}
+    };
+
+    enum class MetaBlockType : uint32_t {
+        // Extractor name length (uint32_t), extractor name, serialized BloomFilter of key prefixes
+        PREFIX_BLOOM = 1,
+        // Serialized RangeFilter over all keys, tombstones included
+        RANGE_FILTER = 2,
+        // Serialized LearnedIndex over the key directory, omitted when the keys don't fit a model
+        LEARNED_INDEX = 3,
+        // Serialized HashIndex from key hash to key directory position
+        HASH_INDEX = 4
+    };
+
     /**
      * Write Memtable contents to an SStable file
      * @param filename Output filename
@@ -42,6 +103,17 @@ public:
     static bool write(const std::string& filename,
         const std::vector<std::pair<std::string, Memtable::Entry>>& entries);
 
+    /**
+     * Write Memtable contents to an SSTable file with optional meta blocks
+     * @param filename Output filename
+     * @param entries Sorted entries from Memtable
+     * @param options Which meta blocks to build
+     * @return true if successful, false otherwise
+     */
+    static bool write(const std::string& filename,
+        const std::vector<std::pair<std::string, Memtable::Entry>>& entries,
+        const Options& options);
+
     /**
      * Write a single SSTable from a Memtable
      * @param filename Output filename
@@ -52,7 +124,9 @@ public:
 
     // Constants
     static constexpr uint64_t MAGIC = 0x4B5644425F535354;  // "KVDB_SST" in hexcode
-    static constexpr uint32_t VERSION = 1;
+    static constexpr uint32_t VERSION = 2;
+    static constexpr uint32_t MIN_SUPPORTED_VERSION = 1;
+    static constexpr size_t FOOTER_SIZE = sizeof(uint64_t) + sizeof(uint64_t);
 
 private:
     /**
@@ -0,0 +1,204 @@
+#ifndef KVDB_SHARDEDLRUCACHE_H
+#define KVDB_SHARDEDLRUCACHE_H
+
+#include "Hash.h"
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <list>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <atomic>
+#include <algorithm>
+#include <cstdint>
+
+/**
+ * Sharded, byte-bounded LRU map from keys to Value, the machinery behind RowCache and
+ * NegativeCache.
+ *
+ * Each entry remembers the sequence number it was read at, and stays valid for every
+ * later sequence number until a write to the key invalidates it. Inserts carry the
+ * sequence number the read started at, and are dropped if a write reached the shard
+ * since then, so a slow reader can't put back an entry a write just made stale.
+ */
+template <typename Value>
+class ShardedLRUCache {
+public:
+    struct Stats {
+        size_t hits = 0;
+        size_t misses = 0;
+        size_t inserts = 0;
+        size_t rejected_inserts = 0;  // raced with a write or larger than a shard
+        size_t invalidations = 0;
+        size_t evictions = 0;
+        size_t usage = 0;             // bytes charged right now
+        size_t capacity = 0;
+        size_t entry_count = 0;
+    };
+
+    /**
+     * @param capacity_bytes Byte budget shared evenly between shards
+     * @param shard_count Number of independently locked shards
+     */
+    ShardedLRUCache(size_t capacity_bytes, size_t shard_count) : capacity_(capacity_bytes) {
+        shard_count = std::max<size_t>(1, shard_count);
+        shard_capacity_ = capacity_bytes / shard_count;
+
+        shards_.reserve(shard_count);
+        for (size_t i = 0; i < shard_count; ++i) {
+            shards_.push_back(std::make_unique<Shard>());
+        }
+    }
+
+    // No copying
+    ShardedLRUCache(const ShardedLRUCache&) = delete;
+    ShardedLRUCache& operator=(const ShardedLRUCache&) = delete;
+
+    /**
+     * Copy of the value cached for key if it is valid at snapshot_seq
+     */
+    std::optional<Value> lookup(const std::string& key, uint64_t snapshot_seq) {
+        Shard& shard = shard_for(key);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+
+        auto it = shard.index.find(key);
+        if (it == shard.index.end() || it->second->seq > snapshot_seq) {
+            misses_++;
+            return std::nullopt;
+        }
+
+        // Move to front of LRU
+        shard.lru.splice(shard.lru.begin(), shard.lru, it->second);
+        hits_++;
+        return it->second->value;
+    }
+
+    /**
+     * Cache a value, replacing any entry for the key
+     * @param read_seq Sequence number observed before the read started
+     * @param charge Bytes the entry counts against the budget
+     * @return true if cached, false if a newer write or the budget got in the way
+     */
+    bool insert(const std::string& key, Value value, uint64_t read_seq, size_t charge) {
+        Shard& shard = shard_for(key);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+
+        if (shard.last_write_seq > read_seq || charge > shard_capacity_) {
+            rejected_inserts_++;
+            return false;
+        }
+
+        auto it = shard.index.find(key);
+        if (it != shard.index.end()) {
+            shard.usage -= it->second->charge;
+            shard.lru.erase(it->second);
+            shard.index.erase(it);
+        }
+
+        shard.lru.push_front(Entry{key, std::move(value), read_seq, charge});
+        shard.index.emplace(shard.lru.front().key, shard.lru.begin());
+        shard.usage += charge;
+        inserts_++;
+
+        evict(shard);
+        return true;
+    }
+
+    /**
+     * Drop a key after a write to it
+     * @param write_seq Sequence number of the write
+     */
+    void invalidate(const std::string& key, uint64_t write_seq) {
+        Shard& shard = shard_for(key);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+
+        shard.last_write_seq = std::max(shard.last_write_seq, write_seq);
+
+        auto it = shard.index.find(key);
+        if (it == shard.index.end()) {
+            return;
+        }
+
+        shard.usage -= it->second->charge;
+        shard.lru.erase(it->second);
+        shard.index.erase(it);
+        invalidations_++;
+    }
+
+    /**
+     * Drop everything
+     */
+    void clear() {
+        for (auto& shard : shards_) {
+            std::lock_guard<std::mutex> lock(shard->mutex);
+            shard->index.clear();
+            shard->lru.clear();
+            shard->usage = 0;
+        }
+    }
+
+    Stats get_stats() const {
+        Stats stats;
+        stats.hits = hits_.load();
+        stats.misses = misses_.load();
+        stats.inserts = inserts_.load();
+        stats.rejected_inserts = rejected_inserts_.load();
+        stats.invalidations = invalidations_.load();
+        stats.evictions = evictions_.load();
+        stats.capacity = capacity_;
+
+        for (const auto& shard : shards_) {
+            std::lock_guard<std::mutex> lock(shard->mutex);
+            stats.usage += shard->usage;
+            stats.entry_count += shard->lru.size();
+        }
+
+        return stats;
+    }
+
+private:
+    struct Entry {
+        std::string key;
+        Value value;
+        uint64_t seq;
+        size_t charge;
+    };
+
+    struct Shard {
+        mutable std::mutex mutex;
+        std::list<Entry> lru;  // Front = most recent, Back = least recent
+        std::unordered_map<std::string_view, typename std::list<Entry>::iterator> index;  // views into lru keys
+        size_t usage = 0;
+        uint64_t last_write_seq = 0;
+    };
+
+    Shard& shard_for(const std::string& key) {
+        return *shards_[hash64(key) % shards_.size()];
+    }
+
+    // Evict until the shard fits its budget, caller holds the shard lock
+    void evict(Shard& shard) {
+        while (shard.usage > shard_capacity_ && !shard.lru.empty()) {
+            const Entry& victim = shard.lru.back();
+            shard.usage -= victim.charge;
+            shard.index.erase(victim.key);
+            shard.lru.pop_back();
+            evictions_++;
+        }
+    }
+
+    std::vector<std::unique_ptr<Shard>> shards_;
+    size_t capacity_;
+    size_t shard_capacity_;
+
+    std::atomic<size_t> hits_{0};
+    std::atomic<size_t> misses_{0};
+    std::atomic<size_t> inserts_{0};
+    std::atomic<size_t> rejected_inserts_{0};
+    std::atomic<size_t> invalidations_{0};
+    std::atomic<size_t> evictions_{0};
+};
+
+#endif // KVDB_SHARDEDLRUCACHE_H
@@ -0,0 +1,293 @@
+#include "ShardedStore.h"
+#include "BufferPool.h"
+#include "Hash.h"
+#include <algorithm>
+#include <queue>
+#include <stdexcept>
+#include <string>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace {
+    // Not the seed bloom filters use, so shard routing and filter bits stay independent
+    const uint64_t SHARD_HASH_SEED = 0x5348415244ULL;
+
+    void pin_to_core(std::thread& thread, size_t core, Logger& logger) {
+#ifdef __linux__
+        cpu_set_t cpus;
+        CPU_ZERO(&cpus);
+        CPU_SET(core, &cpus);
+        if (pthread_setaffinity_np(thread.native_handle(), sizeof(cpus), &cpus) != 0) {
+            logger.warn("Failed to pin shard worker to core ", core);
+        }
+#else
+        (void)thread;
+        (void)core;
+        (void)logger;
+#endif
+    }
+}
+
+ShardedStore::ShardedStore(const std::string& db_dir, const Config& config)
+    : db_dir_(db_dir),
+      env_(config.shard_config.env ? config.shard_config.env : Env::default_env()) {
+    env_->create_dirs(db_dir_);
+    logger_ = config.shard_config.logger;
+    if (!logger_) {
+        Logger::Options log_options;
+        log_options.level = config.shard_config.log_level;
+        logger_ = std::make_shared<Logger>(db_dir_ + "/LOG", log_options, env_);
+    }
+
+    // Keys were routed with the stored count, so it wins over the configured one
+    size_t count = load_shard_count();
+    if (count == 0) {
+        count = std::max<size_t>(1, config.num_shards);
+        if (!env_->write_file_atomic(db_dir_ + "/SHARDS", std::to_string(count) + "\n")) {
+            throw std::runtime_error("Failed to write shard count to " + db_dir_);
+        }
+    } else if (count != config.num_shards) {
+        logger_->warn("Store at ", db_dir_, " has ", count, " shards, ignoring the configured ", config.num_shards);
+    }
+
+    LSMTree::Config shard_config = config.shard_config;
+    shard_config.env = env_;
+    if (config.share_buffer_pool && !shard_config.buffer_pool) {
+        shard_config.buffer_pool = std::make_shared<BufferPool>(shard_config.buffer_pool_size);
+    }
+
+    // Open every tree before starting workers, so a tree that fails to open leaves no thread behind
+    for (size_t i = 0; i < count; i++) {
+        auto shard = std::make_unique<Shard>();
+        shard->tree = std::make_unique<LSMTree>(db_dir_ + "/shard_" + std::to_string(i), shard_config);
+        shards_.push_back(std::move(shard));
+    }
+
+    size_t cores = std::max(1u, std::thread::hardware_concurrency());
+    for (size_t i = 0; i < shards_.size(); i++) {
+        Shard& shard = *shards_[i];
+        shard.worker = std::thread([this, &shard] { worker_loop(shard); });
+        if (config.pin_workers) {
+            pin_to_core(shard.worker, i % cores, *logger_);
+        }
+    }
+}
+
+ShardedStore::~ShardedStore() {
+    for (auto& shard : shards_) {
+        {
+            std::lock_guard<std::mutex> lock(shard->mutex);
+            shard->stop = true;
+        }
+        shard->cv.notify_one();
+    }
+    for (auto& shard : shards_) {
+        if (shard->worker.joinable()) {
+            shard->worker.join();
+        }
+    }
+
+    // Trees flush their memtables when destroyed
+    shards_.clear();
+}
+
+size_t ShardedStore::load_shard_count() const {
+    std::string contents;
+    if (!env_->read_file(db_dir_ + "/SHARDS", contents)) {
+        return 0;
+    }
+    try {
+        return std::stoul(contents);
+    } catch (const std::exception&) {
+        throw std::runtime_error("Corrupt shard count in " + db_dir_ + "/SHARDS");
+    }
+}
+
+size_t ShardedStore::shard_of(const std::string& key) const {
+    return hash64(key, SHARD_HASH_SEED) % shards_.size();
+}
+
+void ShardedStore::worker_loop(Shard& shard) {
+    while (true) {
+        std::function<void()> job;
+        {
+            std::unique_lock<std::mutex> lock(shard.mutex);
+            shard.cv.wait(lock, [&] { return shard.stop || !shard.jobs.empty(); });
+            if (shard.jobs.empty()) {
+                return;  // stopped with nothing left to run
+            }
+            job = std::move(shard.jobs.front());
+            shard.jobs.pop_front();
+        }
+        job();
+    }
+}
+
+void ShardedStore::run_on_shards(std::vector<std::pair<size_t, std::function<void()>>>& jobs) {
+    // A single job gains nothing from a thread hop
+    if (jobs.size() == 1) {
+        jobs[0].second();
+        return;
+    }
+
+    std::mutex done_mutex;
+    std::condition_variable done_cv;
+    size_t pending = jobs.size();
+
+    for (auto& [index, work] : jobs) {
+        Shard& shard = *shards_[index];
+        {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            shard.jobs.push_back([&, work = std::move(work)] {
+                try {
+                    work();
+                } catch (const std::exception& e) {
+                    logger_->error("Shard job failed: ", e.what());
+                }
+                std::lock_guard<std::mutex> done_lock(done_mutex);
+                if (--pending == 0) {
+                    done_cv.notify_one();
+                }
+            });
+        }
+        shard.cv.notify_one();
+    }
+
+    std::unique_lock<std::mutex> lock(done_mutex);
+    done_cv.wait(lock, [&] { return pending == 0; });
+}
+
+bool ShardedStore::put(const std::string& key, const std::string& value) {
+    return shards_[shard_of(key)]->tree->put(key, value);
+}
+
+std::optional<std::string> ShardedStore::get(const std::string& key) {
+    return shards_[shard_of(key)]->tree->get(key);
+}
+
+bool ShardedStore::remove(const std::string& key) {
+    return shards_[shard_of(key)]->tree->remove(key);
+}
+
+bool ShardedStore::write(const WriteBatch& batch) {
+    // Split by shard, keeping the batch order within each
+    std::vector<WriteBatch> parts(shards_.size());
+    for (const auto& op : batch.ops()) {
+        auto& part = parts[shard_of(op.key)];
+        if (op.type == WriteAheadLog::OpType::PUT) {
+            part.put(op.key, op.value);
+        } else {
+            part.remove(op.key);
+        }
+    }
+
+    std::vector<char> ok(shards_.size(), 0);
+    std::vector<std::pair<size_t, std::function<void()>>> jobs;
+    for (size_t i = 0; i < parts.size(); i++) {
+        if (parts[i].empty()) {
+            ok[i] = 1;
+            continue;
+        }
+        jobs.emplace_back(i, [this, i, &parts, &ok] { ok[i] = shards_[i]->tree->write(parts[i]); });
+    }
+    if (!jobs.empty()) {
+        run_on_shards(jobs);
+    }
+
+    return std::all_of(ok.begin(), ok.end(), [](char shard_ok) { return shard_ok != 0; });
+}
+
+std::vector<std::optional<std::string>> ShardedStore::multi_get(const std::vector<std::string>& keys) {
+    // Positions of each shard's keys in the request
+    std::vector<std::vector<size_t>> positions(shards_.size());
+    for (size_t i = 0; i < keys.size(); i++) {
+        positions[shard_of(keys[i])].push_back(i);
+    }
+
+    std::vector<std::optional<std::string>> results(keys.size());
+    std::vector<std::pair<size_t, std::function<void()>>> jobs;
+    for (size_t s = 0; s < shards_.size(); s++) {
+        if (positions[s].empty()) {
+            continue;
+        }
+        jobs.emplace_back(s, [this, s, &keys, &positions, &results] {
+            std::vector<std::string> shard_keys;
+            shard_keys.reserve(positions[s].size());
+            for (size_t position : positions[s]) {
+                shard_keys.push_back(keys[position]);
+            }
+            auto values = shards_[s]->tree->multi_get(shard_keys);
+            for (size_t i = 0; i < values.size(); i++) {
+                results[positions[s][i]] = std::move(values[i]);
+            }
+        });
+    }
+    if (!jobs.empty()) {
+        run_on_shards(jobs);
+    }
+
+    return results;
+}
+
+std::vector<std::pair<std::string, std::string>>
+ShardedStore::scan(const std::string& start_key, const std::string& end_key) {
+    std::vector<std::vector<std::pair<std::string, std::string>>> shard_results(shards_.size());
+    std::vector<std::pair<size_t, std::function<void()>>> jobs;
+    for (size_t s = 0; s < shards_.size(); s++) {
+        jobs.emplace_back(s, [this, s, &start_key, &end_key, &shard_results] {
+            shard_results[s] = shards_[s]->tree->scan(start_key, end_key);
+        });
+    }
+    run_on_shards(jobs);
+
+    // K-way merge, every shard's result is sorted and a key lives in one shard only
+    struct Cursor {
+        size_t shard;
+        size_t position;
+    };
+    auto after = [&](const Cursor& a, const Cursor& b) {
+        return shard_results[a.shard][a.position].first > shard_results[b.shard][b.position].first;
+    };
+    std::priority_queue<Cursor, std::vector<Cursor>, decltype(after)> heap(after);
+
+    size_t total = 0;
+    for (size_t s = 0; s < shard_results.size(); s++) {
+        total += shard_results[s].size();
+        if (!shard_results[s].empty()) {
+            heap.push(Cursor{s, 0});
+        }
+    }
+
+    std::vector<std::pair<std::string, std::string>> results;
+    results.reserve(total);
+    while (!heap.empty()) {
+        Cursor cursor = heap.top();
+        heap.pop();
+        results.push_back(std::move(shard_results[cursor.shard][cursor.position]));
+        if (++cursor.position < shard_results[cursor.shard].size()) {
+            heap.push(cursor);
+        }
+    }
+
+    return results;
+}
+
+void ShardedStore::flush() {
+    std::vector<std::pair<size_t, std::function<void()>>> jobs;
+    for (size_t s = 0; s < shards_.size(); s++) {
+        jobs.emplace_back(s, [this, s] { shards_[s]->tree->flush_memtable(); });
+    }
+    run_on_shards(jobs);
+}
+
+std::vector<LSMTree::Stats> ShardedStore::get_shard_stats() const {
+    std::vector<LSMTree::Stats> stats;
+    stats.reserve(shards_.size());
+    for (const auto& shard : shards_) {
+        stats.push_back(shard->tree->get_stats());
+    }
+    return stats;
+}
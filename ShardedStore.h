@@ -0,0 +1,119 @@
+#ifndef KVDB_SHARDEDSTORE_H
+#define KVDB_SHARDEDSTORE_H
+
+#include "LSMTree.h"
+#include "WriteBatch.h"
+#include <string>
+#include <vector>
+#include <deque>
+#include <memory>
+#include <optional>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+/**
+ * Keys partitioned by hash over several independent LSM trees (shards).
+ *
+ * Every shard lives in <db_dir>/shard_<i> with its own WAL, memtable, flushes and compactions,
+ * so writers to different shards never wait on each other. Each shard also has a worker
+ * thread, optionally pinned to a core, that applies its part of a multi-shard write and
+ * answers its part of multi_get and scan in parallel with the other shards.
+ *
+ * The shard count is stored in <db_dir>/SHARDS when the store is created and reused on every
+ * reopen, since changing it would route existing keys to the wrong shard. A WriteBatch is
+ * atomic within each shard but not across shards. Store level messages go to <db_dir>/LOG,
+ * or to shard_config.logger when one is shared.
+ */
+class ShardedStore {
+public:
+    struct Config {
+        size_t num_shards;
+        LSMTree::Config shard_config;  // memtable, WAL, compaction budget and env of every shard
+        bool share_buffer_pool;        // one pool of shard_config.buffer_pool_size for all shards
+        bool pin_workers;              // pin shard i's worker to core i % cores, Linux only
+
+        explicit Config(size_t num_shards_ = 4,
+                        const LSMTree::Config& shard_config_ = LSMTree::Config(),
+                        bool share_buffer_pool_ = true,
+                        bool pin_workers_ = false)
+            : num_shards(num_shards_),
+              shard_config(shard_config_),
+              share_buffer_pool(share_buffer_pool_),
+              pin_workers(pin_workers_)
+        {}
+    };
+
+    explicit ShardedStore(const std::string& db_dir, const Config& config = Config());
+
+    ~ShardedStore();
+
+    // No copying
+    ShardedStore(const ShardedStore&) = delete;
+    ShardedStore& operator=(const ShardedStore&) = delete;
+
+    bool put(const std::string& key, const std::string& value);
+    std::optional<std::string> get(const std::string& key);
+    bool remove(const std::string& key);
+
+    /**
+     * Split the batch by shard and apply the parts in parallel
+     * @return false if any shard failed, the other parts stay applied
+     */
+    bool write(const WriteBatch& batch);
+
+    /**
+     * Look up several keys, each shard answers its own keys against one consistent state
+     */
+    std::vector<std::optional<std::string>> multi_get(const std::vector<std::string>& keys);
+
+    /**
+     * Range scan over every shard, merged back into key order
+     */
+    std::vector<std::pair<std::string, std::string>>
+        scan(const std::string& start_key, const std::string& end_key);
+
+    /**
+     * Flush every shard's memtable
+     */
+    void flush();
+
+    /**
+     * Statistics of every shard, by shard index
+     */
+    std::vector<LSMTree::Stats> get_shard_stats() const;
+
+    size_t num_shards() const { return shards_.size(); }
+
+    /**
+     * Index of the shard that holds key
+     */
+    size_t shard_of(const std::string& key) const;
+
+private:
+    // One tree and the worker thread that runs jobs on it
+    struct Shard {
+        std::unique_ptr<LSMTree> tree;
+        std::thread worker;
+        std::mutex mutex;
+        std::condition_variable cv;
+        std::deque<std::function<void()>> jobs;
+        bool stop = false;
+    };
+
+    std::string db_dir_;
+    std::shared_ptr<Env> env_;
+    std::shared_ptr<Logger> logger_;
+    std::vector<std::unique_ptr<Shard>> shards_;
+
+    // Shard count from <db_dir>/SHARDS, or 0 for a new store
+    size_t load_shard_count() const;
+
+    void worker_loop(Shard& shard);
+
+    // Run each job on its shard's worker and wait for all of them, jobs are (shard, work)
+    void run_on_shards(std::vector<std::pair<size_t, std::function<void()>>>& jobs);
+};
+
+#endif // KVDB_SHARDEDSTORE_H
@@ -0,0 +1,258 @@
+#include "StatsDumper.h"
+#include <cmath>
+#include <map>
+#include <sstream>
+#include <vector>
+
+namespace {
+    constexpr const char* PREFIX = "kvdb_";
+
+    // Quantiles exported for every histogram, with their Prometheus label
+    constexpr std::pair<double, const char*> QUANTILES[] = {
+        {50.0, "0.5"}, {90.0, "0.9"}, {99.0, "0.99"}, {99.9, "0.999"}
+    };
+
+    // Split name{labels} into name and the labels without braces
+    std::pair<std::string, std::string> split_name(const std::string& name) {
+        auto brace = name.find('{');
+        if (brace == std::string::npos) {
+            return {name, ""};
+        }
+        return {name.substr(0, brace), name.substr(brace + 1, name.size() - brace - 2)};
+    }
+
+    // kvdb_ + base + suffix, with the labels and one extra label joined
+    std::string series(const std::string& base, const std::string& suffix,
+                       const std::string& labels, const std::string& extra = "") {
+        std::string out = PREFIX + base + suffix;
+        if (labels.empty() && extra.empty()) {
+            return out;
+        }
+        out += '{';
+        out += labels;
+        if (!labels.empty() && !extra.empty()) {
+            out += ',';
+        }
+        out += extra;
+        out += '}';
+        return out;
+    }
+
+    uint64_t counter_delta(uint64_t current, const std::map<std::string, uint64_t>& previous, const std::string& name) {
+        auto it = previous.find(name);
+        // A counter that went backwards was reset, everything since counts
+        return it == previous.end() || it->second > current ? current : current - it->second;
+    }
+
+    Histogram histogram_delta(const Histogram& current, const std::map<std::string, Histogram>& previous,
+                              const std::string& name) {
+        Histogram delta = current;
+        auto it = previous.find(name);
+        if (it != previous.end() && it->second.count() <= current.count()) {
+            delta.subtract(it->second);
+        }
+        return delta;
+    }
+
+    int64_t epoch_ms(std::chrono::system_clock::time_point time) {
+        return std::chrono::duration_cast<std::chrono::milliseconds>(time.time_since_epoch()).count();
+    }
+
+    void write_prometheus_summary(std::ostringstream& out, const std::string& base, const std::string& suffix,
+                                  const std::string& labels, const Histogram& histogram) {
+        for (const auto& [p, quantile] : QUANTILES) {
+            out << series(base, suffix, labels, std::string("quantile=\"") + quantile + "\"") << ' '
+                << histogram.percentile(p) << '\n';
+        }
+        out << series(base, suffix + "_sum", labels) << ' ' << histogram.sum() << '\n';
+        out << series(base, suffix + "_count", labels) << ' ' << histogram.count() << '\n';
+    }
+
+    std::string json_string(const std::string& text) {
+        std::string out = "\"";
+        for (char c : text) {
+            if (c == '"' || c == '\\') {
+                out += '\\';
+            }
+            out += c;
+        }
+        out += '"';
+        return out;
+    }
+
+    void write_json_histogram(std::ostringstream& out, const Histogram& histogram) {
+        out << "\"count\":" << histogram.count() << ",\"sum\":" << histogram.sum()
+            << ",\"mean\":" << histogram.mean();
+        for (const auto& [p, quantile] : QUANTILES) {
+            std::string key = std::string("p") + quantile;
+            key.erase(key.find('.'), 1);  // p0.99 -> p099
+            out << ",\"" << key << "\":" << histogram.percentile(p);
+        }
+        out << ",\"max\":" << histogram.max();
+    }
+}
+
+StatsDumper::StatsDumper(Collector collector, std::string path, std::chrono::milliseconds period,
+                         MetricsFormat format, std::shared_ptr<Env> env)
+    : collector_(std::move(collector)), path_(std::move(path)), period_(period), format_(format),
+      env_(env ? std::move(env) : Env::default_env()) {
+    if (period_.count() > 0) {
+        thread_ = std::thread(&StatsDumper::run, this);
+    }
+}
+
+StatsDumper::~StatsDumper() {
+    if (!thread_.joinable()) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    stop_cv_.notify_one();
+    thread_.join();
+
+    // Short lived engines still leave their final numbers behind
+    dump_now();
+}
+
+void StatsDumper::run() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (!stop_cv_.wait_for(lock, period_, [this] { return stopping_; })) {
+        lock.unlock();
+        dump_now();
+        lock.lock();
+    }
+}
+
+bool StatsDumper::dump_now() {
+    std::lock_guard<std::mutex> lock(dump_mutex_);
+    MetricsSnapshot current = collector_();
+
+    std::string text = format_ == MetricsFormat::PROMETHEUS
+        ? to_prometheus(current, previous_)
+        : to_json_line(current, previous_);
+    if (!write(text)) {
+        return false;
+    }
+
+    previous_ = std::move(current);
+    dumps_++;
+    return true;
+}
+
+uint64_t StatsDumper::dumps() const {
+    std::lock_guard<std::mutex> lock(dump_mutex_);
+    return dumps_;
+}
+
+bool StatsDumper::write(const std::string& text) {
+    if (format_ == MetricsFormat::JSON_LINES) {
+        auto file = env_->new_appendable_file(path_);
+        return file && file->append(text) && file->close();
+    }
+
+    // Replace the file in one rename, so a scraper never reads half a snapshot
+    return env_->write_file_atomic(path_, text);
+}
+
+std::string StatsDumper::to_prometheus(const MetricsSnapshot& current, const std::optional<MetricsSnapshot>& previous) {
+    // Series are grouped by family before printing, so every family gets exactly one TYPE
+    // line even when its series don't sort next to each other, such as x{...} and x_y
+    struct Family {
+        const char* type;
+        std::ostringstream series;
+    };
+    std::vector<std::string> order;
+    std::map<std::string, Family> families;
+    auto family = [&](const std::string& name, const char* type) -> std::ostringstream& {
+        auto [it, added] = families.try_emplace(name);
+        if (added) {
+            it->second.type = type;
+            it->second.series.precision(15);
+            order.push_back(name);
+        }
+        return it->second.series;
+    };
+
+    family("timestamp_seconds", "gauge") << PREFIX << "timestamp_seconds " << epoch_ms(current.time) / 1000.0 << '\n';
+    if (previous) {
+        family("interval_seconds", "gauge")
+            << PREFIX << "interval_seconds " << (epoch_ms(current.time) - epoch_ms(previous->time)) / 1000.0 << '\n';
+    }
+
+    // Classic text format: the TYPE line names the family exactly as its samples do
+    for (const auto& [name, value] : current.counters) {
+        auto [base, labels] = split_name(name);
+        family(base + "_total", "counter") << series(base, "_total", labels) << ' ' << value << '\n';
+    }
+    if (previous) {
+        for (const auto& [name, value] : current.counters) {
+            auto [base, labels] = split_name(name);
+            family(base + "_interval", "gauge") << series(base, "_interval", labels) << ' '
+                                                << counter_delta(value, previous->counters, name) << '\n';
+        }
+    }
+
+    for (const auto& [name, value] : current.gauges) {
+        auto [base, labels] = split_name(name);
+        family(base, "gauge") << series(base, "", labels) << ' ' << value << '\n';
+    }
+
+    for (const auto& [name, histogram] : current.histograms) {
+        auto [base, labels] = split_name(name);
+        write_prometheus_summary(family(base, "summary"), base, "", labels, histogram);
+    }
+    if (previous) {
+        for (const auto& [name, histogram] : current.histograms) {
+            auto [base, labels] = split_name(name);
+            write_prometheus_summary(family(base + "_interval", "summary"), base, "_interval", labels,
+                                     histogram_delta(histogram, previous->histograms, name));
+        }
+    }
+
+    std::string out;
+    for (const auto& name : order) {
+        const Family& f = families.at(name);
+        out += "# TYPE ";
+        out += PREFIX + name + ' ' + f.type + '\n';
+        out += f.series.str();
+    }
+    return out;
+}
+
+std::string StatsDumper::to_json_line(const MetricsSnapshot& current, const std::optional<MetricsSnapshot>& previous) {
+    std::ostringstream out;
+    out.precision(15);
+    out << "{\"timestamp_ms\":" << epoch_ms(current.time)
+        << ",\"interval_ms\":" << (previous ? epoch_ms(current.time) - epoch_ms(previous->time) : 0);
+
+    out << ",\"counters\":{";
+    bool first = true;
+    for (const auto& [name, value] : current.counters) {
+        out << (first ? "" : ",") << json_string(name) << ":{\"total\":" << value
+            << ",\"interval\":" << (previous ? counter_delta(value, previous->counters, name) : value) << '}';
+        first = false;
+    }
+
+    out << "},\"gauges\":{";
+    first = true;
+    for (const auto& [name, value] : current.gauges) {
+        // JSON has no infinity or NaN
+        out << (first ? "" : ",") << json_string(name) << ':' << (std::isfinite(value) ? value : 0.0);
+        first = false;
+    }
+
+    out << "},\"histograms\":{";
+    first = true;
+    for (const auto& [name, histogram] : current.histograms) {
+        out << (first ? "" : ",") << json_string(name) << ":{";
+        write_json_histogram(out, histogram);
+        out << ",\"interval\":{";
+        write_json_histogram(out, previous ? histogram_delta(histogram, previous->histograms, name) : histogram);
+        out << "}}";
+        first = false;
+    }
+    out << "}}\n";
+    return out.str();
+}
@@ -0,0 +1,91 @@
+#ifndef KVDB_STATSDUMPER_H
+#define KVDB_STATSDUMPER_H
+
+#include "Histogram.h"
+#include "Env.h"
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+
+/**
+ * Named values collected from an engine at one instant.
+ *
+ * Names may carry Prometheus style labels, e.g. level_files{level="1"}. Counters only grow,
+ * so the difference between two snapshots is the activity in between. Gauges are point in
+ * time readings
+ */
+struct MetricsSnapshot {
+    std::chrono::system_clock::time_point time = std::chrono::system_clock::now();
+    std::map<std::string, uint64_t> counters;
+    std::map<std::string, double> gauges;
+    std::map<std::string, Histogram> histograms;
+};
+
+enum class MetricsFormat {
+    PROMETHEUS,  // text exposition, the file is replaced by the latest snapshot
+    JSON_LINES   // one object per dump appended to the file
+};
+
+/**
+ * Writes a snapshot of an engine's metrics to a file every period, on its own thread.
+ *
+ * Each dump has cumulative values and the change since the previous dump: counter deltas
+ * and histograms of just the values recorded in between. The collector runs on the dumper
+ * thread and should only copy counters out under the engine's locks
+ */
+class StatsDumper {
+public:
+    using Collector = std::function<MetricsSnapshot()>;
+
+    /**
+     * @param period time between dumps, zero dumps only when asked through dump_now()
+     * @param env where path lives, nullptr for Env::default_env()
+     */
+    StatsDumper(Collector collector, std::string path, std::chrono::milliseconds period,
+                MetricsFormat format = MetricsFormat::PROMETHEUS, std::shared_ptr<Env> env = nullptr);
+
+    // Stops the thread after one last dump
+    ~StatsDumper();
+
+    // Collect and write a snapshot on the calling thread
+    bool dump_now();
+
+    // Dumps written so far
+    uint64_t dumps() const;
+
+    const std::string& path() const { return path_; }
+
+    // Render a snapshot, previous gives the interval values and may be empty
+    static std::string to_prometheus(const MetricsSnapshot& current, const std::optional<MetricsSnapshot>& previous);
+    static std::string to_json_line(const MetricsSnapshot& current, const std::optional<MetricsSnapshot>& previous);
+
+    StatsDumper(const StatsDumper&) = delete;
+    StatsDumper& operator=(const StatsDumper&) = delete;
+
+private:
+    Collector collector_;
+    std::string path_;
+    std::chrono::milliseconds period_;
+    MetricsFormat format_;
+    std::shared_ptr<Env> env_;
+
+    std::optional<MetricsSnapshot> previous_;
+    uint64_t dumps_ = 0;
+    mutable std::mutex dump_mutex_;  // one dump at a time, guards previous_ and dumps_
+
+    bool stopping_ = false;
+    std::mutex mutex_;
+    std::condition_variable stop_cv_;
+    std::thread thread_;
+
+    void run();
+    bool write(const std::string& text);
+};
+
+#endif // KVDB_STATSDUMPER_H
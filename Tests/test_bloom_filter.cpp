@@ -0,0 +1,193 @@
+#include "test_bloom_filter.h"
+#include "../BloomFilter.h"
+#include "../PrefixExtractor.h"
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "test_helper.h"
+
+// Test 1: Every added key must be reported as present
+bool test_bloom_no_false_negatives() {
+    BloomFilter filter(1000, 10);
+
+    for (int i = 0; i < 1000; ++i) {
+        filter.add("key_" + std::to_string(i));
+    }
+
+    for (int i = 0; i < 1000; ++i) {
+        if (!filter.may_contain("key_" + std::to_string(i))) {
+            std::cerr << "    False negative for key_" << i << std::endl;
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// Test 2: False positive rate stays close to the theoretical ~1% at 10 bits/key
+bool test_bloom_false_positive_rate() {
+    BloomFilter filter(10000, 10);
+
+    for (int i = 0; i < 10000; ++i) {
+        filter.add("present_" + std::to_string(i));
+    }
+
+    int false_positives = 0;
+    for (int i = 0; i < 10000; ++i) {
+        if (filter.may_contain("absent_" + std::to_string(i))) {
+            false_positives++;
+        }
+    }
+
+    double rate = false_positives / 10000.0;
+    std::cout << "    False positive rate: " << rate * 100 << "%" << std::endl;
+
+    if (rate > 0.03) {
+        std::cerr << "    False positive rate too high" << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+// Test 3: Serialization round trip
+bool test_bloom_serialization() {
+    BloomFilter filter(100, 8);
+    for (int i = 0; i < 100; ++i) {
+        filter.add("k" + std::to_string(i));
+    }
+
+    auto restored = BloomFilter::deserialize(filter.serialize());
+    if (!restored) {
+        std::cerr << "    Failed to deserialize filter" << std::endl;
+        return false;
+    }
+
+    if (restored->bit_count() != filter.bit_count() || restored->probe_count() != filter.probe_count()) {
+        std::cerr << "    Restored filter has different shape" << std::endl;
+        return false;
+    }
+
+    for (int i = 0; i < 100; ++i) {
+        if (!restored->may_contain("k" + std::to_string(i))) {
+            std::cerr << "    Restored filter lost key k" << i << std::endl;
+            return false;
+        }
+    }
+
+    // Malformed input must be rejected
+    if (BloomFilter::deserialize("") || BloomFilter::deserialize(std::string(4, '\0'))) {
+        std::cerr << "    Malformed filter data accepted" << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+// Test 4: Fixed length prefix extractor
+bool test_prefix_extractor_fixed() {
+    auto extractor = PrefixExtractor::fixed_length(4);
+
+    if (!extractor->in_domain("user123") || extractor->transform("user123") != "user") {
+        std::cerr << "    Wrong prefix for user123" << std::endl;
+        return false;
+    }
+
+    if (extractor->in_domain("abc")) {
+        std::cerr << "    Short key should be outside the domain" << std::endl;
+        return false;
+    }
+
+    if (PrefixExtractor::fixed_length(0) != nullptr) {
+        std::cerr << "    Zero length extractor should not be created" << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+// Test 5: Delimiter prefix extractor
+bool test_prefix_extractor_delimiter() {
+    auto extractor = PrefixExtractor::delimiter(':');
+
+    if (!extractor->in_domain("order:42:item") || extractor->transform("order:42:item") != "order:") {
+        std::cerr << "    Wrong prefix for order:42:item" << std::endl;
+        return false;
+    }
+
+    if (extractor->in_domain("nodelimiter")) {
+        std::cerr << "    Key without delimiter should be outside the domain" << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+// Test 6: Extractors survive a name round trip (names are stored in SSTables)
+bool test_prefix_extractor_names() {
+    auto fixed = PrefixExtractor::fixed_length(8);
+    auto delim = PrefixExtractor::delimiter('|');
+
+    auto fixed_copy = PrefixExtractor::from_name(fixed->name());
+    auto delim_copy = PrefixExtractor::from_name(delim->name());
+
+    if (!fixed_copy || fixed_copy->name() != fixed->name() ||
+        fixed_copy->transform("0123456789") != "01234567") {
+        std::cerr << "    Fixed extractor name round trip failed" << std::endl;
+        return false;
+    }
+
+    if (!delim_copy || delim_copy->name() != delim->name() ||
+        delim_copy->transform("a|b|c") != "a|") {
+        std::cerr << "    Delimiter extractor name round trip failed" << std::endl;
+        return false;
+    }
+
+    if (PrefixExtractor::from_name("unknown:1") != nullptr) {
+        std::cerr << "    Unknown extractor name should be rejected" << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+// Main test runner
+int bloom_filter_tests_main() {
+    std::cout << "\n=== Bloom Filter Tests ===" << std::endl;
+    std::cout << "==========================" << std::endl;
+
+    std::vector<std::pair<std::string, bool (*)()>> tests = {
+        {"No False Negatives", test_bloom_no_false_negatives},
+        {"False Positive Rate", test_bloom_false_positive_rate},
+        {"Serialization", test_bloom_serialization},
+        {"Fixed Length Prefix Extractor", test_prefix_extractor_fixed},
+        {"Delimiter Prefix Extractor", test_prefix_extractor_delimiter},
+        {"Prefix Extractor Names", test_prefix_extractor_names}
+    };
+
+    int passed = 0;
+    int total = static_cast<int>(tests.size());
+
+    for (const auto& [name, test_func] : tests) {
+        try {
+            bool result = test_func();
+            print_test_result(name, result);
+            if (result) passed++;
+        } catch (const std::exception& e) {
+            std::cout << "X " << name << " (Exception: " << e.what() << ")" << std::endl;
+        } catch (...) {
+            std::cout << "X " << name << " (Unknown exception)" << std::endl;
+        }
+    }
+
+    std::cout << "\nResults: " << passed << "/" << total << " tests passed" << std::endl;
+
+    if (passed == total) {
+        std::cout << "\nAll Bloom Filter tests passed!" << std::endl;
+        return 0;
+    } else {
+        std::cout << "\nSome Bloom Filter tests failed" << std::endl;
+        return 1;
+    }
+}
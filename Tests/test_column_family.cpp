@@ -0,0 +1,251 @@
+#include "test_column_family.h"
+#include "../ColumnFamilyDB.h"
+#include <iostream>
+#include <string>
+#include <vector>
+#include <filesystem>
+
+#include "test_helper.h"
+
+namespace fs = std::filesystem;
+
+// Test 1: Families keep separate key spaces and configurations
+bool test_column_family_isolation() {
+    std::string db_dir = "test_cf_isolation";
+    fs::remove_all(db_dir);
+
+    bool ok = true;
+    {
+        LSMTree::Config small(4096);
+        ColumnFamilyDB db(db_dir, {{"metadata", small}});
+
+        auto metadata = db.column_family_id("metadata");
+        if (!metadata) {
+            std::cerr << "    Family not created" << std::endl;
+            fs::remove_all(db_dir);
+            return false;
+        }
+
+        db.put(ColumnFamilyDB::DEFAULT_COLUMN_FAMILY, "key", "default value");
+        db.put(*metadata, "key", "metadata value");
+
+        ok = ok && db.get(ColumnFamilyDB::DEFAULT_COLUMN_FAMILY, "key") == "default value";
+        ok = ok && db.get(*metadata, "key") == "metadata value";
+
+        db.remove(*metadata, "key");
+        if (db.get(*metadata, "key") || !db.get(ColumnFamilyDB::DEFAULT_COLUMN_FAMILY, "key")) {
+            std::cerr << "    Delete leaked across families" << std::endl;
+            ok = false;
+        }
+
+        // Only the small family fills its memtable and flushes
+        for (int i = 0; i < 200; ++i) {
+            db.put(*metadata, "key" + std::to_string(100 + i), std::string(50, 'm'));
+        }
+        if (db.get_stats(*metadata)->memtable_flushes == 0 ||
+            db.get_stats(ColumnFamilyDB::DEFAULT_COLUMN_FAMILY)->memtable_flushes != 0) {
+            std::cerr << "    Families didn't flush independently" << std::endl;
+            ok = false;
+        }
+
+        // Unknown families and duplicate names are refused
+        if (db.put(42, "key", "value") || db.create_column_family({"metadata", small})) {
+            std::cerr << "    Invalid family accepted" << std::endl;
+            ok = false;
+        }
+        ok = ok && db.list_column_families().size() == 2;
+    }
+
+    fs::remove_all(db_dir);
+    return ok;
+}
+
+// Test 2: A batch over several families is refused whole if one family is unknown
+bool test_column_family_batch() {
+    std::string db_dir = "test_cf_batch";
+    fs::remove_all(db_dir);
+
+    bool ok = true;
+    {
+        ColumnFamilyDB db(db_dir, {{"index", LSMTree::Config()}});
+        uint32_t index = *db.column_family_id("index");
+
+        WriteBatch batch;
+        batch.put("user1", "alice");
+        batch.put(index, "alice", "user1");
+        if (!db.write(batch)) {
+            std::cerr << "    Batch rejected" << std::endl;
+            ok = false;
+        }
+        ok = ok && db.get(ColumnFamilyDB::DEFAULT_COLUMN_FAMILY, "user1") == "alice";
+        ok = ok && db.get(index, "alice") == "user1";
+
+        WriteBatch bad;
+        bad.put("user2", "bob");
+        bad.put(99, "bob", "user2");
+        if (db.write(bad) || db.get(ColumnFamilyDB::DEFAULT_COLUMN_FAMILY, "user2")) {
+            std::cerr << "    Partial batch applied" << std::endl;
+            ok = false;
+        }
+    }
+
+    fs::remove_all(db_dir);
+    return ok;
+}
+
+// Test 3: Unflushed writes of every family come back from the shared WAL
+bool test_column_family_recovery() {
+    std::string db_dir = "test_cf_recovery";
+    fs::remove_all(db_dir);
+
+    bool ok = true;
+    {
+        auto db = std::make_unique<ColumnFamilyDB>(db_dir);
+        auto logs = db->create_column_family({"logs", LSMTree::Config()});
+        if (!logs) {
+            std::cerr << "    Family not created" << std::endl;
+            fs::remove_all(db_dir);
+            return false;
+        }
+
+        WriteBatch batch;
+        batch.put("a", "1");
+        batch.put(*logs, "a", "log 1");
+        batch.remove(*logs, "missing");
+        db->write(batch);
+
+        // Simulate a crash, leaving the WAL and memtables unflushed
+        fs::copy(db_dir, db_dir + "_crash", fs::copy_options::recursive);
+    }
+
+    {
+        // Families created at runtime are listed in the manifest
+        ColumnFamilyDB db(db_dir + "_crash");
+        auto logs = db.column_family_id("logs");
+        if (!logs) {
+            std::cerr << "    Family lost on reopen" << std::endl;
+            ok = false;
+        } else if (db.get(*logs, "a") != "log 1" || db.get(ColumnFamilyDB::DEFAULT_COLUMN_FAMILY, "a") != "1") {
+            std::cerr << "    Writes lost on recovery" << std::endl;
+            ok = false;
+        }
+    }
+
+    fs::remove_all(db_dir);
+    fs::remove_all(db_dir + "_crash");
+    return ok;
+}
+
+// Test 4: The shared WAL is cleared once no family depends on it
+bool test_column_family_wal_truncation() {
+    std::string db_dir = "test_cf_truncation";
+    fs::remove_all(db_dir);
+
+    // Enough level 0 room that the flushes here don't compact
+    LSMTree::Config config;
+    config.level_config.level0_max_sstables = 4;
+    std::vector<ColumnFamilyDB::ColumnFamilyDescriptor> families = {{"default", config}, {"cold", config}};
+
+    bool ok = true;
+    {
+        ColumnFamilyDB db(db_dir, families, 100);
+        uint32_t cold = *db.column_family_id("cold");
+
+        // One write to a rarely used family would pin the WAL, the limit forces it out
+        db.put(cold, "only", "write");
+        for (int i = 0; i < 150; ++i) {
+            db.put(ColumnFamilyDB::DEFAULT_COLUMN_FAMILY, "key" + std::to_string(i), "value");
+        }
+
+        if (db.get_wal_entry_count() >= 100) {
+            std::cerr << "    WAL not truncated" << std::endl;
+            ok = false;
+        }
+        if (db.get(cold, "only") != "write" || db.get_stats(cold)->memtable_flushes != 1) {
+            std::cerr << "    Cold family not flushed" << std::endl;
+            ok = false;
+        }
+    }
+
+    {
+        // Values written before and after the truncation survive a reopen
+        ColumnFamilyDB db(db_dir, families, 100);
+        ok = ok && db.get(*db.column_family_id("cold"), "only") == "write";
+        ok = ok && db.get(ColumnFamilyDB::DEFAULT_COLUMN_FAMILY, "key149") == "value";
+    }
+
+    fs::remove_all(db_dir);
+    return ok;
+}
+
+bool test_column_family_invalid_names() {
+    std::string db_dir = "test_cf_names";
+    fs::remove_all(db_dir);
+
+    bool ok = true;
+    {
+        // Invalid names passed at open are skipped
+        ColumnFamilyDB db(db_dir, {{"..", LSMTree::Config()}, {"good", LSMTree::Config()}});
+        ok = ok && db.column_family_id("..").has_value() == false && db.column_family_id("good").has_value();
+
+        for (const std::string name : {"", ".", "..", "../outside", "a/b", "two words", "tab\tname",
+                                       "LOG", "LOG.1", "wal.log", "column_families", "column_families.tmp"}) {
+            if (db.create_column_family({name, LSMTree::Config()})) {
+                std::cerr << "    Accepted invalid name '" << name << "'" << std::endl;
+                ok = false;
+            }
+        }
+        ok = ok && db.create_column_family({"logs-2024_v1.0", LSMTree::Config()}).has_value();
+        db.put(ColumnFamilyDB::DEFAULT_COLUMN_FAMILY, "key", "value");
+    }
+
+    {
+        // The manifest still reads back, and nothing was created outside the database
+        ColumnFamilyDB db(db_dir);
+        ok = ok && db.list_column_families().size() == 3 && db.column_family_id("logs-2024_v1.0").has_value();
+        ok = ok && db.get(ColumnFamilyDB::DEFAULT_COLUMN_FAMILY, "key") == "value";
+        ok = ok && !fs::exists("outside");
+    }
+
+    fs::remove_all(db_dir);
+    return ok;
+}
+
+// Main test runner
+int column_family_tests_main() {
+    std::cout << "\n=== Column Family Tests ===" << std::endl;
+    std::cout << "===========================" << std::endl;
+
+    std::vector<std::pair<std::string, bool (*)()>> tests = {
+        {"Family Isolation", test_column_family_isolation},
+        {"Cross Family Batch", test_column_family_batch},
+        {"Shared WAL Recovery", test_column_family_recovery},
+        {"WAL Truncation", test_column_family_wal_truncation},
+        {"Invalid Names", test_column_family_invalid_names}
+    };
+
+    int passed = 0;
+    int total = static_cast<int>(tests.size());
+
+    for (const auto& [name, test_func] : tests) {
+        try {
+            bool result = test_func();
+            print_test_result(name, result);
+            if (result) passed++;
+        } catch (const std::exception& e) {
+            std::cout << "X " << name << " (Exception: " << e.what() << ")" << std::endl;
+        } catch (...) {
+            std::cout << "X " << name << " (Unknown exception)" << std::endl;
+        }
+    }
+
+    std::cout << "\nResults: " << passed << "/" << total << " tests passed" << std::endl;
+
+    if (passed == total) {
+        std::cout << "\nAll Column Family tests passed!" << std::endl;
+        return 0;
+    } else {
+        std::cout << "\nSome Column Family tests failed" << std::endl;
+        return 1;
+    }
+}
@@ -0,0 +1,6 @@
+#ifndef KVDB_TEST_COLUMN_FAMILY_H
+#define KVDB_TEST_COLUMN_FAMILY_H
+
+int column_family_tests_main();
+
+#endif // KVDB_TEST_COLUMN_FAMILY_H
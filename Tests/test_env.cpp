@@ -0,0 +1,322 @@
+#include "test_env.h"
+#include "../Env.h"
+#include "../MemEnv.h"
+#include "../LSMTree.h"
+#include "../ColumnFamilyDB.h"
+#include <iostream>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+
+#include "test_helper.h"
+
+namespace fs = std::filesystem;
+using namespace std::chrono;
+
+namespace {
+    std::string read_all(Env& env, const std::string& path) {
+        std::string contents;
+        env.read_file(path, contents);
+        return contents;
+    }
+
+    bool has_child(Env& env, const std::string& dir, const std::string& name) {
+        std::vector<std::string> children;
+        env.get_children(dir, children);
+        return std::find(children.begin(), children.end(), name) != children.end();
+    }
+}
+
+// Test 1: MemEnv files behave like files, including readers outliving a removal
+bool test_mem_env_files() {
+    MemEnv env;
+    if (!env.create_dirs("db/level_0")) {
+        return false;
+    }
+
+    auto file = env.new_writable_file("db/a.txt");
+    file->append("hello ");
+    file->append(std::string("world"));
+    file->close();
+    if (read_all(env, "db/./a.txt") != "hello world" || file->append("x", 1)) {
+        std::cerr << "    Written contents wrong" << std::endl;
+        return false;
+    }
+
+    auto appender = env.new_appendable_file("db/a.txt");
+    appender->append("!");
+    auto rw = env.new_random_rw_file("db/a.txt");
+    rw->write(0, "J", 1);
+    if (read_all(env, "db/a.txt") != "Jello world!" || appender->size() != 12) {
+        std::cerr << "    Append or overwrite wrong: " << read_all(env, "db/a.txt") << std::endl;
+        return false;
+    }
+
+    // Stream reads, seeks back and forth and reads past the end
+    EnvInputStream in(env.new_random_access_file("db/a.txt"));
+    std::string word(5, '\0');
+    in.seekg(6);
+    in.read(word.data(), 5);
+    in.seekg(0);
+    char first = 0;
+    in.get(first);
+    if (word != "world" || first != 'J' || EnvInputStream(env.new_random_access_file("missing"))) {
+        std::cerr << "    Input stream wrong" << std::endl;
+        return false;
+    }
+
+    auto reader = env.new_random_access_file("db/a.txt");
+    if (!env.rename_file("db/a.txt", "db/b.txt") || env.file_exists("db/a.txt") ||
+        !has_child(env, "db", "b.txt") || !has_child(env, "db", "level_0")) {
+        std::cerr << "    Rename or listing wrong" << std::endl;
+        return false;
+    }
+    env.remove_file("db/b.txt");
+    char buffer[16];
+    size_t bytes_read = 0;
+    reader->read(0, sizeof(buffer), buffer, bytes_read);
+    if (env.file_exists("db/b.txt") || std::string(buffer, bytes_read) != "Jello world!") {
+        std::cerr << "    Open reader lost a removed file" << std::endl;
+        return false;
+    }
+
+    {
+        auto lock = env.lock_file("db/LOCK");
+        if (!lock || env.lock_file("db/LOCK")) {
+            std::cerr << "    Lock not exclusive" << std::endl;
+            return false;
+        }
+    }
+    if (!env.lock_file("db/LOCK")) {
+        std::cerr << "    Lock not released" << std::endl;
+        return false;
+    }
+
+    env.remove_dir_all("db");
+    return !env.file_exists("db/LOCK") && !env.file_exists("db/level_0") && env.total_size() == 0;
+}
+
+// Test 2: Injected latency slows every call and can be changed while files are open
+bool test_mem_env_latency() {
+    MemEnv env(MemEnv::Options(microseconds(0), microseconds(2000), microseconds(5000)));
+    auto file = env.new_writable_file("slow");
+
+    auto start = steady_clock::now();
+    for (int i = 0; i < 10; i++) {
+        file->append("x", 1);
+    }
+    file->sync();
+    double slow_ms = duration<double, std::milli>(steady_clock::now() - start).count();
+
+    env.set_latency(MemEnv::Options());
+    start = steady_clock::now();
+    for (int i = 0; i < 10; i++) {
+        file->append("x", 1);
+    }
+    file->sync();
+    double fast_ms = duration<double, std::milli>(steady_clock::now() - start).count();
+
+    std::cout << "    Slow " << slow_ms << " ms, fast " << fast_ms << " ms" << std::endl;
+    return slow_ms >= 25.0 && fast_ms < 5.0;
+}
+
+// Test 3: A whole LSMTree runs on a MemEnv, nothing touches the disk, and it reopens from it
+bool test_lsm_on_mem_env() {
+    std::string data_dir = "test_env_lsm";
+    fs::remove_all(data_dir);
+    auto env = std::make_shared<MemEnv>();
+
+    LSMTree::Config config(1024 * 1024);
+    config.level_config.level0_max_sstables = 4;  // both flushes stay in level 0
+    config.env = env;
+    {
+        LSMTree lsm(data_dir, config);
+        for (int i = 0; i < 100; i++) {
+            lsm.put("key" + std::to_string(i), "value" + std::to_string(i));
+        }
+        lsm.flush_memtable();
+        for (int i = 100; i < 150; i++) {
+            lsm.put("key" + std::to_string(i), "value" + std::to_string(i));
+        }
+        lsm.remove("key7");
+
+        bool locked_out = false;
+        try {
+            LSMTree second(data_dir, config);
+        } catch (const std::exception&) {
+            locked_out = true;
+        }
+        if (!locked_out) {
+            std::cerr << "    Second tree opened a locked directory" << std::endl;
+            return false;
+        }
+    }
+
+    if (fs::exists(data_dir)) {
+        std::cerr << "    Files created on disk" << std::endl;
+        fs::remove_all(data_dir);
+        return false;
+    }
+    std::vector<std::string> tables;
+    env->get_children(data_dir + "/level_0", tables);
+    if (tables.empty() || !env->file_exists(data_dir + "/LOG")) {
+        std::cerr << "    No tables or log in the env" << std::endl;
+        return false;
+    }
+
+    // Reopen, the flushed table and the destructor's flush come back
+    LSMTree lsm(data_dir, config);
+    for (int i = 0; i < 150; i++) {
+        auto value = lsm.get("key" + std::to_string(i));
+        bool expected = i != 7;
+        if (value.has_value() != expected || (expected && *value != "value" + std::to_string(i))) {
+            std::cerr << "    key" << i << " wrong after reopen" << std::endl;
+            return false;
+        }
+    }
+    return !fs::exists(data_dir);
+}
+
+// Test 4: The POSIX env reads, writes, lists and locks real files
+bool test_posix_env() {
+    std::string dir = "test_env_posix";
+    fs::remove_all(dir);
+    auto env = Env::default_env();
+
+    if (!env->create_dirs(dir + "/sub") || !env->write_file_atomic(dir + "/a", "first")) {
+        return false;
+    }
+    auto appender = env->new_appendable_file(dir + "/a");
+    appender->append(" second");
+    appender->sync();
+    appender.reset();
+
+    {
+        EnvOutputStream out(env->new_writable_file(dir + "/big"));
+        for (int i = 0; i < 100000; i++) {
+            out << static_cast<char>('a' + i % 26);
+        }
+        out.close();
+    }
+    EnvInputStream in(env->new_random_access_file(dir + "/big"));
+    in.seekg(99999);
+    char last = 0;
+    in.get(last);
+
+    uint64_t size = 0;
+    uint64_t mtime = 0;
+    bool ok = read_all(*env, dir + "/a") == "first second" &&
+              env->get_file_size(dir + "/big", size) && size == 100000 &&
+              env->get_modification_time(dir + "/a", mtime) && mtime > 0 &&
+              last == 'a' + 99999 % 26 &&
+              has_child(*env, dir, "sub") && !has_child(*env, dir, "a.tmp");
+    if (!ok) {
+        std::cerr << "    File contents or metadata wrong" << std::endl;
+    }
+
+    {
+        auto lock = env->lock_file(dir + "/LOCK");
+        if (!lock || env->lock_file(dir + "/LOCK")) {
+            std::cerr << "    Lock not exclusive" << std::endl;
+            ok = false;
+        }
+    }
+    if (!env->lock_file(dir + "/LOCK")) {
+        std::cerr << "    Lock not released" << std::endl;
+        ok = false;
+    }
+
+    ok = ok && env->rename_file(dir + "/a", dir + "/b") && env->remove_file(dir + "/b") &&
+         !env->file_exists(dir + "/b") && !env->new_random_access_file(dir + "/b");
+    env->remove_dir_all(dir);
+    return ok && !fs::exists(dir);
+}
+
+// Test 5: Column families share one MemEnv for their WAL, manifest and trees
+bool test_column_families_on_mem_env() {
+    std::string db_dir = "test_env_cf";
+    auto env = std::make_shared<MemEnv>();
+    std::vector<ColumnFamilyDB::ColumnFamilyDescriptor> families = {{"users", LSMTree::Config()}};
+    {
+        ColumnFamilyDB db(db_dir, families, 100000, env);
+        auto users = db.column_family_id("users");
+        db.put(*users, "alice", "1");
+        db.put(ColumnFamilyDB::DEFAULT_COLUMN_FAMILY, "config", "on");
+    }
+    ColumnFamilyDB db(db_dir, families, 100000, env);
+    auto users = db.column_family_id("users");
+    return users && db.get(*users, "alice") == std::optional<std::string>("1") &&
+           db.get(ColumnFamilyDB::DEFAULT_COLUMN_FAMILY, "config") == std::optional<std::string>("on") &&
+           env->file_exists(db_dir + "/column_families") && !fs::exists(db_dir);
+}
+
+// Test 6: WAL commits and flushed tables wait for the env's sync, unless the WAL sync is turned off
+bool test_engine_syncs() {
+    auto env = std::make_shared<MemEnv>(MemEnv::Options(microseconds(0), microseconds(0), microseconds(2000)));
+    LSMTree::Config config(1024 * 1024);
+    config.env = env;
+
+    auto time_puts = [&](const std::string& data_dir) {
+        LSMTree lsm(data_dir, config);
+        auto start = steady_clock::now();
+        for (int i = 0; i < 10; i++) {
+            lsm.put("key" + std::to_string(i), "value");
+        }
+        double put_ms = duration<double, std::milli>(steady_clock::now() - start).count();
+
+        start = steady_clock::now();
+        lsm.flush_memtable();
+        double flush_ms = duration<double, std::milli>(steady_clock::now() - start).count();
+        return std::make_pair(put_ms, flush_ms);
+    };
+
+    auto [synced_ms, synced_flush_ms] = time_puts("test_env_sync");
+    config.sync_wal = false;
+    auto [unsynced_ms, unsynced_flush_ms] = time_puts("test_env_nosync");
+
+    std::cout << "    10 puts: " << synced_ms << " ms synced, " << unsynced_ms << " ms unsynced, flush "
+              << synced_flush_ms << " / " << unsynced_flush_ms << " ms" << std::endl;
+    return synced_ms >= 20.0 && unsynced_ms < 20.0 && synced_flush_ms >= 2.0 && unsynced_flush_ms >= 2.0;
+}
+
+// Main test runner
+int env_tests_main() {
+    std::cout << "\n=== Env Tests ===" << std::endl;
+    std::cout << "=================" << std::endl;
+
+    std::vector<std::pair<std::string, bool (*)()>> tests = {
+        {"MemEnv Files", test_mem_env_files},
+        {"MemEnv Latency", test_mem_env_latency},
+        {"LSMTree On MemEnv", test_lsm_on_mem_env},
+        {"PosixEnv Files", test_posix_env},
+        {"Column Families On MemEnv", test_column_families_on_mem_env},
+        {"Engine Syncs", test_engine_syncs}
+    };
+
+    int passed = 0;
+    int total = static_cast<int>(tests.size());
+
+    for (const auto& [name, test_func] : tests) {
+        try {
+            bool result = test_func();
+            print_test_result(name, result);
+            if (result) passed++;
+        } catch (const std::exception& e) {
+            std::cout << "X " << name << " (Exception: " << e.what() << ")" << std::endl;
+        } catch (...) {
+            std::cout << "X " << name << " (Unknown exception)" << std::endl;
+        }
+    }
+
+    std::cout << "\nResults: " << passed << "/" << total << " tests passed" << std::endl;
+
+    if (passed == total) {
+        std::cout << "\nAll Env tests passed!" << std::endl;
+        return 0;
+    } else {
+        std::cout << "\nSome Env tests failed" << std::endl;
+        return 1;
+    }
+}
@@ -0,0 +1,6 @@
+#ifndef KVDB_TEST_ENV_H
+#define KVDB_TEST_ENV_H
+
+int env_tests_main();
+
+#endif // KVDB_TEST_ENV_H
@@ -0,0 +1,248 @@
+#include "test_event_listener.h"
+#include "../EventListener.h"
+#include "../LSMTree.h"
+#include <iostream>
+#include <sstream>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+#include <thread>
+#include <chrono>
+#include <filesystem>
+#include <stdexcept>
+
+#include "test_helper.h"
+
+namespace fs = std::filesystem;
+using namespace std::chrono;
+
+namespace {
+    // Records every callback as one line, in delivery order
+    class RecordingListener : public EventListener {
+    public:
+        std::vector<std::string> events;
+        std::vector<FlushJobInfo> flushes;
+        std::vector<CompactionJobInfo> compactions;
+        size_t flush_files = 0;
+        size_t compaction_files = 0;
+        size_t deleted_files = 0;
+
+        void on_flush_begin(const FlushJobInfo&) override { events.push_back("flush_begin"); }
+        void on_flush_completed(const FlushJobInfo& info) override {
+            events.push_back("flush_completed");
+            flushes.push_back(info);
+        }
+        void on_compaction_begin(const CompactionJobInfo&) override { events.push_back("compaction_begin"); }
+        void on_compaction_completed(const CompactionJobInfo& info) override {
+            events.push_back("compaction_completed");
+            compactions.push_back(info);
+        }
+        void on_stall_conditions_changed(const WriteStallInfo& info) override {
+            events.push_back(info.current == WriteStallCondition::STOPPED ? "stall_stopped" : "stall_normal");
+        }
+        void on_table_file_created(const TableFileCreationInfo& info) override {
+            events.push_back("file_created");
+            (info.reason == TableFileReason::FLUSH ? flush_files : compaction_files)++;
+        }
+        void on_table_file_deleted(const TableFileDeletionInfo&) override {
+            events.push_back("file_deleted");
+            deleted_files++;
+        }
+        void on_wal_rollover(const WalRolloverInfo&) override { events.push_back("wal_rollover"); }
+
+        size_t count(const std::string& name) const {
+            size_t n = 0;
+            for (const auto& event : events) {
+                n += event == name;
+            }
+            return n;
+        }
+
+        size_t index_of(const std::string& name, size_t from = 0) const {
+            for (size_t i = from; i < events.size(); i++) {
+                if (events[i] == name) {
+                    return i;
+                }
+            }
+            return events.size();
+        }
+    };
+
+    void write_keys(LSMTree& lsm, int count) {
+        for (int i = 0; i < count; ++i) {
+            lsm.put("key" + std::to_string(1000 + i), std::string(40, 'v'));
+        }
+    }
+}
+
+// Test 1: Flushes, compactions, stalls, files and WAL rollovers all reach the listener
+bool test_event_listener_lifecycle() {
+    std::string data_dir = "test_event_listener_lifecycle";
+    fs::remove_all(data_dir);
+
+    auto listener = std::make_shared<RecordingListener>();
+    {
+        LSMTree::Config config(4096, 1024 * 1024, 10);
+        config.level_config.level0_max_sstables = 2;
+        config.listeners.push_back(listener);
+        LSMTree lsm(data_dir, config);
+        write_keys(lsm, 300);
+    }
+    // Closing the tree delivers everything still queued
+
+    bool ok = true;
+    const size_t flushes = listener->count("flush_completed");
+    if (flushes < 2 || listener->count("flush_begin") != flushes || listener->count("wal_rollover") != flushes
+        || listener->flush_files != flushes) {
+        std::cerr << "    Flush events don't match: " << flushes << " flushes" << std::endl;
+        ok = false;
+    }
+    for (const auto& info : listener->flushes) {
+        if (!info.success || info.file_path.empty() || info.file_size == 0 || info.entries == 0) {
+            std::cerr << "    Incomplete flush info" << std::endl;
+            ok = false;
+            break;
+        }
+    }
+
+    const size_t compactions = listener->count("compaction_completed");
+    if (compactions < 1 || listener->count("compaction_begin") != compactions
+        || listener->compaction_files < 1 || listener->deleted_files < 2) {
+        std::cerr << "    Compaction events don't match: " << compactions << " compactions" << std::endl;
+        ok = false;
+    }
+    for (const auto& info : listener->compactions) {
+        if (!info.success || info.input_files.size() != info.stats.input_files
+            || info.output_files.size() != info.stats.output_files || info.stats.keys_in == 0) {
+            std::cerr << "    Incomplete compaction info" << std::endl;
+            ok = false;
+            break;
+        }
+    }
+
+    // Writers stop around each inline compaction
+    size_t stop = listener->index_of("stall_stopped");
+    size_t begin = listener->index_of("compaction_begin");
+    size_t end = listener->index_of("compaction_completed");
+    size_t resume = listener->index_of("stall_normal");
+    if (!(stop < begin && begin < end && end < resume && resume < listener->events.size())
+        || listener->count("stall_stopped") != listener->count("stall_normal")) {
+        std::cerr << "    Stall events out of order" << std::endl;
+        ok = false;
+    }
+
+    fs::remove_all(data_dir);
+    return ok;
+}
+
+// Test 2: Flushing and compacting print nothing
+bool test_event_listener_quiet_writes() {
+    std::string data_dir = "test_event_listener_quiet";
+    fs::remove_all(data_dir);
+
+    std::ostringstream captured;
+    {
+        LSMTree::Config config(4096, 1024 * 1024, 10);
+        config.level_config.level0_max_sstables = 2;
+        LSMTree lsm(data_dir, config);
+
+        auto* original = std::cout.rdbuf(captured.rdbuf());
+        write_keys(lsm, 300);
+        lsm.flush_memtable();
+        std::cout.rdbuf(original);
+    }
+
+    fs::remove_all(data_dir);
+    if (!captured.str().empty()) {
+        std::cerr << "    Write path printed: " << captured.str().substr(0, 80) << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// Test 3: Slow or throwing listeners hold up neither writers nor other listeners
+bool test_event_listener_isolation() {
+    std::string data_dir = "test_event_listener_isolation";
+    fs::remove_all(data_dir);
+
+    class SlowThrowingListener : public EventListener {
+    public:
+        void on_flush_begin(const FlushJobInfo&) override {
+            std::this_thread::sleep_for(milliseconds(200));
+            throw std::runtime_error("listener failure");
+        }
+    };
+
+    auto recorder = std::make_shared<RecordingListener>();
+    double flush_ms = 0.0;
+    {
+        LSMTree::Config config(64 * 1024, 1024 * 1024, 10);
+        config.listeners.push_back(std::make_shared<SlowThrowingListener>());
+        config.listeners.push_back(recorder);
+        LSMTree lsm(data_dir, config);
+
+        write_keys(lsm, 50);
+        auto start = steady_clock::now();
+        lsm.flush_memtable();
+        flush_ms = duration_cast<microseconds>(steady_clock::now() - start).count() / 1000.0;
+    }
+
+    // The failure lands in the tree's own log
+    std::ifstream log_file(data_dir + "/LOG");
+    std::string log((std::istreambuf_iterator<char>(log_file)), std::istreambuf_iterator<char>());
+    log_file.close();
+    fs::remove_all(data_dir);
+    std::cout << "    Flush took " << flush_ms << " ms with a 200 ms listener" << std::endl;
+
+    if (flush_ms >= 200.0) {
+        std::cerr << "    Flush waited for the listener" << std::endl;
+        return false;
+    }
+    if (recorder->count("flush_begin") != 1 || recorder->count("flush_completed") != 1) {
+        std::cerr << "    Second listener missed events" << std::endl;
+        return false;
+    }
+    if (log.find("Event listener threw: listener failure") == std::string::npos) {
+        std::cerr << "    Listener failure not logged" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// Main test runner
+int event_listener_tests_main() {
+    std::cout << "\n=== Event Listener Tests ===" << std::endl;
+    std::cout << "============================" << std::endl;
+
+    std::vector<std::pair<std::string, bool (*)()>> tests = {
+        {"Lifecycle Events", test_event_listener_lifecycle},
+        {"Quiet Write Path", test_event_listener_quiet_writes},
+        {"Listener Isolation", test_event_listener_isolation}
+    };
+
+    int passed = 0;
+    int total = static_cast<int>(tests.size());
+
+    for (const auto& [name, test_func] : tests) {
+        try {
+            bool result = test_func();
+            print_test_result(name, result);
+            if (result) passed++;
+        } catch (const std::exception& e) {
+            std::cout << "X " << name << " (Exception: " << e.what() << ")" << std::endl;
+        } catch (...) {
+            std::cout << "X " << name << " (Unknown exception)" << std::endl;
+        }
+    }
+
+    std::cout << "\nResults: " << passed << "/" << total << " tests passed" << std::endl;
+
+    if (passed == total) {
+        std::cout << "\nAll Event Listener tests passed!" << std::endl;
+        return 0;
+    } else {
+        std::cout << "\nSome Event Listener tests failed" << std::endl;
+        return 1;
+    }
+}
@@ -0,0 +1,6 @@
+#ifndef KVDB_TEST_EVENT_LISTENER_H
+#define KVDB_TEST_EVENT_LISTENER_H
+
+int event_listener_tests_main();
+
+#endif // KVDB_TEST_EVENT_LISTENER_H
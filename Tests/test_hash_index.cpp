@@ -0,0 +1,279 @@
+#include "test_hash_index.h"
+#include "../HashIndex.h"
+#include "../SSTableWriter.h"
+#include "../SSTableReader.h"
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <random>
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+
+#include "test_helper.h"
+
+namespace fs = std::filesystem;
+using namespace std::chrono;
+
+namespace {
+    std::vector<std::string> make_sorted_keys(size_t count, const std::string& prefix) {
+        std::vector<std::string> keys;
+        keys.reserve(count);
+        for (size_t i = 0; i < count; ++i) {
+            keys.push_back(prefix + std::to_string(1000000 + i));
+        }
+        return keys;
+    }
+}
+
+// Test 1: Every key resolves to its own position or a shared bucket
+bool test_hash_index_lookup() {
+    auto keys = make_sorted_keys(5000, "user");
+    HashIndex index(keys, 0.75);
+
+    size_t candidates = 0;
+    for (size_t i = 0; i < keys.size(); ++i) {
+        auto result = index.lookup(keys[i]);
+        if (result.probe == HashIndex::Probe::ABSENT) {
+            std::cerr << "    Present key reported absent: " << keys[i] << std::endl;
+            return false;
+        }
+        if (result.probe == HashIndex::Probe::CANDIDATE) {
+            if (result.position != i) {
+                std::cerr << "    Wrong position for " << keys[i] << std::endl;
+                return false;
+            }
+            candidates++;
+        }
+    }
+
+    size_t absent = 0;
+    for (size_t i = 0; i < 5000; ++i) {
+        if (index.lookup("missing" + std::to_string(i)).probe == HashIndex::Probe::ABSENT) {
+            absent++;
+        }
+    }
+
+    std::cout << "    " << candidates << "/" << keys.size() << " keys in their own bucket, "
+              << absent << "/5000 missing keys rejected by empty buckets" << std::endl;
+
+    if (index.bucket_width() != 2) {
+        std::cerr << "    Small tables should use 2 byte buckets" << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+// Test 2: Large tables switch to 4 byte buckets
+bool test_hash_index_wide_buckets() {
+    auto keys = make_sorted_keys(70000, "k");
+    HashIndex index(keys, 0.75);
+
+    if (index.bucket_width() != 4) {
+        std::cerr << "    Large tables should use 4 byte buckets" << std::endl;
+        return false;
+    }
+
+    for (size_t i = 0; i < keys.size(); ++i) {
+        auto result = index.lookup(keys[i]);
+        if (result.probe == HashIndex::Probe::ABSENT ||
+            (result.probe == HashIndex::Probe::CANDIDATE && result.position != i)) {
+            std::cerr << "    Bad lookup for " << keys[i] << std::endl;
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// Test 3: Serialization round trip and validation
+bool test_hash_index_serialization() {
+    auto keys = make_sorted_keys(1000, "s");
+    HashIndex index(keys, 0.5);
+
+    auto restored = HashIndex::deserialize(index.serialize(), keys.size());
+    if (!restored || restored->bucket_count() != index.bucket_count()) {
+        std::cerr << "    Failed to restore index" << std::endl;
+        return false;
+    }
+
+    for (const auto& key : keys) {
+        auto a = index.lookup(key);
+        auto b = restored->lookup(key);
+        if (a.probe != b.probe || a.position != b.position) {
+            std::cerr << "    Restored index disagrees on " << key << std::endl;
+            return false;
+        }
+    }
+
+    std::string data = index.serialize();
+    if (HashIndex::deserialize(data.substr(0, data.size() - 1), keys.size()) ||
+        HashIndex::deserialize(data, 10)) {  // positions past the directory
+        std::cerr << "    Malformed index data accepted" << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+// Test 4: SSTable lookups, including tombstones and absent keys
+bool test_hash_index_sstable() {
+    const std::string filename = "test_hash_index.sst";
+    auto keys = make_sorted_keys(3000, "row");
+
+    std::vector<std::pair<std::string, Memtable::Entry>> entries;
+    for (size_t i = 0; i < keys.size(); ++i) {
+        entries.emplace_back(keys[i], Memtable::Entry("value" + std::to_string(i), i % 10 == 0));
+    }
+
+    SSTableWriter::Options options;
+    options.hash_index = true;
+    if (!SSTableWriter::write(filename, entries, options)) {
+        std::cerr << "    Failed to write SSTable" << std::endl;
+        return false;
+    }
+
+    SSTableReader reader(filename);
+    bool ok = reader.is_valid() && reader.has_hash_index();
+    if (!ok) {
+        std::cerr << "    Failed to load hash index" << std::endl;
+    }
+
+    for (size_t i = 0; ok && i < keys.size(); ++i) {
+        bool deleted = i % 10 == 0;
+        auto value = reader.get(keys[i]);
+        if (deleted ? (value.has_value() || !reader.is_deleted(keys[i]))
+                    : (!value || *value != "value" + std::to_string(i))) {
+            std::cerr << "    Wrong lookup result for " << keys[i] << std::endl;
+            ok = false;
+        }
+    }
+
+    for (int i = 0; ok && i < 3000; ++i) {
+        if (reader.contains("absent" + std::to_string(i))) {
+            std::cerr << "    Absent key found" << std::endl;
+            ok = false;
+        }
+    }
+
+    fs::remove(filename);
+    return ok;
+}
+
+// Test 5: Hot lookup CPU against binary search, and the space the index costs
+bool test_hash_index_performance() {
+    const size_t key_count = 100000;
+    const std::string binary_file = "test_hash_binary.sst";
+    const std::string hash_file = "test_hash_indexed.sst";
+
+    // Random-looking keys so no other index could help
+    std::mt19937_64 rng(11);
+    std::vector<std::string> keys;
+    keys.reserve(key_count);
+    for (size_t i = 0; i < key_count; ++i) {
+        keys.push_back("user:" + std::to_string(rng()));
+    }
+    std::sort(keys.begin(), keys.end());
+    keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+
+    std::vector<std::pair<std::string, Memtable::Entry>> entries;
+    for (const auto& key : keys) {
+        entries.emplace_back(key, Memtable::Entry(std::string(100, 'v')));
+    }
+
+    SSTableWriter::Options options;
+    options.hash_index = true;
+    if (!SSTableWriter::write(binary_file, entries) || !SSTableWriter::write(hash_file, entries, options)) {
+        std::cerr << "    Failed to write SSTables" << std::endl;
+        return false;
+    }
+
+    SSTableReader binary_reader(binary_file);
+    SSTableReader hash_reader(hash_file);
+
+    std::vector<std::string> hits;
+    std::vector<std::string> misses;
+    std::uniform_int_distribution<size_t> pick(0, keys.size() - 1);
+    for (int i = 0; i < 200000; ++i) {
+        hits.push_back(keys[pick(rng)]);
+        misses.push_back("user:" + std::to_string(rng()) + "x");
+    }
+
+    auto time_lookups = [](const SSTableReader& reader, const std::vector<std::string>& lookups, size_t& found) {
+        found = 0;
+        auto start = high_resolution_clock::now();
+        for (const auto& key : lookups) {
+            if (reader.contains(key)) found++;
+        }
+        auto end = high_resolution_clock::now();
+        return duration_cast<nanoseconds>(end - start).count() / static_cast<double>(lookups.size());
+    };
+
+    size_t binary_hits = 0, hash_hits = 0, binary_misses = 0, hash_misses = 0;
+    double binary_hit_ns = time_lookups(binary_reader, hits, binary_hits);
+    double hash_hit_ns = time_lookups(hash_reader, hits, hash_hits);
+    double binary_miss_ns = time_lookups(binary_reader, misses, binary_misses);
+    double hash_miss_ns = time_lookups(hash_reader, misses, hash_misses);
+
+    auto binary_size = fs::file_size(binary_file);
+    auto hash_size = fs::file_size(hash_file);
+    auto overhead = hash_size - binary_size;
+
+    std::cout << std::fixed << std::setprecision(1);
+    std::cout << "    Hits:   binary search " << binary_hit_ns << " ns, hash index " << hash_hit_ns << " ns" << std::endl;
+    std::cout << "    Misses: binary search " << binary_miss_ns << " ns, hash index " << hash_miss_ns << " ns" << std::endl;
+    std::cout << "    Space overhead: " << overhead << " bytes ("
+              << static_cast<double>(overhead) / keys.size() << " bytes/key, "
+              << 100.0 * static_cast<double>(overhead) / static_cast<double>(binary_size) << "% of table)" << std::endl;
+
+    fs::remove(binary_file);
+    fs::remove(hash_file);
+
+    if (binary_hits != hits.size() || hash_hits != hits.size() || binary_misses != 0 || hash_misses != 0) {
+        std::cerr << "    Lookup results differ" << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+// Main test runner
+int hash_index_tests_main() {
+    std::cout << "\n=== Hash Index Tests ===" << std::endl;
+    std::cout << "========================" << std::endl;
+
+    std::vector<std::pair<std::string, bool (*)()>> tests = {
+        {"Lookup", test_hash_index_lookup},
+        {"Wide Buckets", test_hash_index_wide_buckets},
+        {"Serialization", test_hash_index_serialization},
+        {"SSTable Lookups", test_hash_index_sstable},
+        {"Lookup CPU and Space", test_hash_index_performance}
+    };
+
+    int passed = 0;
+    int total = static_cast<int>(tests.size());
+
+    for (const auto& [name, test_func] : tests) {
+        try {
+            bool result = test_func();
+            print_test_result(name, result);
+            if (result) passed++;
+        } catch (const std::exception& e) {
+            std::cout << "X " << name << " (Exception: " << e.what() << ")" << std::endl;
+        } catch (...) {
+            std::cout << "X " << name << " (Unknown exception)" << std::endl;
+        }
+    }
+
+    std::cout << "\nResults: " << passed << "/" << total << " tests passed" << std::endl;
+
+    if (passed == total) {
+        std::cout << "\nAll Hash Index tests passed!" << std::endl;
+        return 0;
+    } else {
+        std::cout << "\nSome Hash Index tests failed" << std::endl;
+        return 1;
+    }
+}
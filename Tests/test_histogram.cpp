@@ -0,0 +1,193 @@
+#include "test_histogram.h"
+#include "../Histogram.h"
+#include "../LSMTree.h"
+#include "../KVStore.h"
+#include <iostream>
+#include <string>
+#include <vector>
+#include <random>
+#include <algorithm>
+#include <cmath>
+#include <thread>
+
+#include "test_helper.h"
+
+// Test 1: Every value lands in a bucket whose bounds contain it
+bool test_histogram_buckets() {
+    std::mt19937_64 rng(7);
+    for (int i = 0; i < 100000; ++i) {
+        uint64_t value = rng() >> (rng() % 64);
+        size_t index = Histogram::bucket_index(value);
+        if (index >= Histogram::BUCKET_COUNT) {
+            std::cerr << "    Bucket out of range for " << value << std::endl;
+            return false;
+        }
+
+        uint64_t upper = Histogram::bucket_upper_bound(index);
+        uint64_t lower = index == 0 ? 0 : Histogram::bucket_upper_bound(index - 1) + 1;
+        if (value < lower || value > upper) {
+            std::cerr << "    " << value << " outside bucket [" << lower << ", " << upper << "]" << std::endl;
+            return false;
+        }
+    }
+
+    return Histogram::bucket_index(UINT64_MAX) == Histogram::BUCKET_COUNT - 1;
+}
+
+// Test 2: Percentiles are within the bucket resolution of the exact values
+bool test_histogram_percentiles() {
+    Histogram histogram;
+    std::vector<uint64_t> values;
+    std::mt19937_64 rng(11);
+    std::lognormal_distribution<double> latency(9.0, 1.0);  // around 8 us, long tail
+
+    for (int i = 0; i < 50000; ++i) {
+        uint64_t value = static_cast<uint64_t>(latency(rng));
+        values.push_back(value);
+        histogram.add(value);
+    }
+    std::sort(values.begin(), values.end());
+
+    for (double p : {50.0, 90.0, 99.0, 99.9}) {
+        uint64_t exact = values[static_cast<size_t>(p / 100.0 * values.size()) - 1];
+        uint64_t estimate = histogram.percentile(p);
+        double error = std::abs(static_cast<double>(estimate) - static_cast<double>(exact)) / exact;
+        if (error > 1.0 / Histogram::SUB_BUCKETS) {
+            std::cerr << "    p" << p << " estimate " << estimate << " vs exact " << exact << std::endl;
+            return false;
+        }
+    }
+
+    return histogram.max() == values.back() && histogram.min() == values.front() &&
+           histogram.percentile(100.0) == values.back();
+}
+
+// Test 3: Merging per-thread histograms equals recording everything in one
+bool test_histogram_merge() {
+    Histogram combined, first, second;
+    for (uint64_t value = 1; value <= 2000; ++value) {
+        combined.add(value * 37);
+        (value % 2 ? first : second).add(value * 37);
+    }
+    first.merge(second);
+
+    for (double p : {1.0, 50.0, 99.0, 100.0}) {
+        if (first.percentile(p) != combined.percentile(p)) {
+            std::cerr << "    Merged p" << p << " differs" << std::endl;
+            return false;
+        }
+    }
+
+    Histogram empty;
+    return first.count() == 2000 && first.mean() == combined.mean() &&
+           empty.percentile(99.0) == 0 && empty.min() == 0;
+}
+
+// Test 4: Threads recording at once lose nothing
+bool test_histogram_concurrent() {
+    ConcurrentHistogram histogram;
+    const int threads = 8;
+    const uint64_t per_thread = 50000;
+
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; ++t) {
+        workers.emplace_back([&histogram, t] {
+            for (uint64_t i = 1; i <= per_thread; ++i) {
+                histogram.add(i * (t + 1));
+            }
+        });
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+
+    Histogram merged = histogram.snapshot();
+    if (merged.count() != threads * per_thread || merged.min() != 1 || merged.max() != per_thread * threads) {
+        std::cerr << "    Lost values: " << merged.count() << " recorded" << std::endl;
+        return false;
+    }
+
+    histogram.clear();
+    return histogram.snapshot().count() == 0;
+}
+
+// Test 5: Engines record each operation type
+bool test_histogram_engine_latencies() {
+    std::string data_dir = "test_histogram_engine";
+    fs::remove_all(data_dir);
+
+    bool ok = true;
+    {
+        LSMTree lsm(data_dir + "/lsm", LSMTree::Config(4096));
+        for (int i = 0; i < 100; ++i) {
+            lsm.put("key" + std::to_string(100 + i), std::string(50, 'v'));
+        }
+        lsm.get("key150");
+        lsm.remove("key150");
+        lsm.scan("key100", "key120");
+
+        ok = ok && lsm.get_latency_histogram(OperationLatencies::PUT).count() == 100;
+        ok = ok && lsm.get_latency_histogram(OperationLatencies::GET).count() == 1;
+        ok = ok && lsm.get_latency_histogram(OperationLatencies::DELETE).count() == 1;
+        ok = ok && lsm.get_latency_histogram(OperationLatencies::SCAN).count() == 1;
+        ok = ok && lsm.get_latency_histogram(OperationLatencies::WAL_WRITE).count() == 101;
+        ok = ok && lsm.get_latency_histogram(OperationLatencies::WAL_SYNC).count() >= 101;
+        ok = ok && lsm.get_latency_histogram(OperationLatencies::FLUSH).count() == lsm.get_stats().memtable_flushes;
+        if (!ok) {
+            std::cerr << "    LSMTree latency counts wrong" << std::endl;
+        }
+
+        auto store = KVStore::open(data_dir + "/kvstore");
+        store->put("a", "1");
+        store->get("a");
+        store->flush_memtable();
+        Histogram puts = store->get_latency_histogram(OperationLatencies::PUT);
+        if (puts.count() != 1 || puts.max() == 0 ||
+            store->get_latency_histogram(OperationLatencies::FLUSH).count() != 1) {
+            std::cerr << "    KVStore latency counts wrong" << std::endl;
+            ok = false;
+        }
+    }
+
+    fs::remove_all(data_dir);
+    return ok;
+}
+
+// Main test runner
+int histogram_tests_main() {
+    std::cout << "\n=== Histogram Tests ===" << std::endl;
+    std::cout << "=======================" << std::endl;
+
+    std::vector<std::pair<std::string, bool (*)()>> tests = {
+        {"Bucket Bounds", test_histogram_buckets},
+        {"Percentiles", test_histogram_percentiles},
+        {"Merge", test_histogram_merge},
+        {"Concurrent Recording", test_histogram_concurrent},
+        {"Engine Latencies", test_histogram_engine_latencies}
+    };
+
+    int passed = 0;
+    int total = static_cast<int>(tests.size());
+
+    for (const auto& [name, test_func] : tests) {
+        try {
+            bool result = test_func();
+            print_test_result(name, result);
+            if (result) passed++;
+        } catch (const std::exception& e) {
+            std::cout << "X " << name << " (Exception: " << e.what() << ")" << std::endl;
+        } catch (...) {
+            std::cout << "X " << name << " (Unknown exception)" << std::endl;
+        }
+    }
+
+    std::cout << "\nResults: " << passed << "/" << total << " tests passed" << std::endl;
+
+    if (passed == total) {
+        std::cout << "\nAll Histogram tests passed!" << std::endl;
+        return 0;
+    } else {
+        std::cout << "\nSome Histogram tests failed" << std::endl;
+        return 1;
+    }
+}
@@ -0,0 +1,6 @@
+#ifndef KVDB_TEST_HISTOGRAM_H
+#define KVDB_TEST_HISTOGRAM_H
+
+int histogram_tests_main();
+
+#endif // KVDB_TEST_HISTOGRAM_H
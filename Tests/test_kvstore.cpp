@@ -4,6 +4,8 @@
 
 #include "test_kvstore.h"
 #include "../KVStore.h"
+#include "../SSTableWriter.h"
+#include "../WriteAheadLog.h"
 #include <iostream>
 #include <vector>
 #include <string>
@@ -11,6 +13,7 @@
 #include <filesystem>
 #include <chrono>
 #include <thread>
+#include <atomic>
 #include <functional>
 
 #include "test_helper.h"
@@ -393,7 +396,7 @@ bool test_kvstore_memtable_flushing() {
     // Check that we have SST files
     size_t sst_count = 0;
     try {
-        for (const auto& entry : fs::directory_iterator(db.name())) {
+        for (const auto& entry : fs::recursive_directory_iterator(db.name())) {
             if (entry.path().extension() == ".sst") {
                 sst_count++;
             }
@@ -706,7 +709,7 @@ bool test_kvstore_large_dataset() {
     // Check SST files were created
     size_t sst_count = 0;
     try {
-        for (const auto& entry : fs::directory_iterator(db.name())) {
+        for (const auto& entry : fs::recursive_directory_iterator(db.name())) {
             if (entry.path().extension() == ".sst") {
                 sst_count++;
             }
@@ -825,6 +828,170 @@ bool test_kvstore_edge_cases() {
     return true;
 }
 
+// Test 11: A directory in the flat sst_*.sst layout is migrated into the leveled tree
+bool test_kvstore_legacy_migration() {
+    TestDatabase db(generate_test_db_name("migration"));
+    fs::create_directories(db.name());
+
+    // Two flat tables, the newer one overwrites and deletes, and a WAL newer than both
+    Memtable older(1024 * 1024);
+    older.put("apple", "old");
+    older.put("banana", "yellow");
+    older.put("cherry", "red");
+    Memtable newer(1024 * 1024);
+    newer.put("apple", "new");
+    newer.remove("banana");
+    if (!SSTableWriter::write(db.name() + "/sst_000000_100.sst", older.get_all_entries()) ||
+        !SSTableWriter::write(db.name() + "/sst_000001_200.sst", newer.get_all_entries())) {
+        std::cerr << "  Failed to write legacy SSTables" << std::endl;
+        return false;
+    }
+    {
+        WriteAheadLog wal(db.name() + "/wal.bin");
+        wal.log_put("date", "sweet");
+        wal.log_delete("cherry");
+    }
+
+    for (int session = 0; session < 2; session++) {
+        auto kv_store = KVStore::open(db.name(), 4096);
+        if (!kv_store) {
+            std::cerr << "  Failed to open legacy database" << std::endl;
+            return false;
+        }
+
+        auto results = kv_store->scan("a", "z");
+        std::vector<std::pair<std::string, std::string>> expected = {{"apple", "new"}, {"date", "sweet"}};
+        if (results != expected || kv_store->get("banana") || kv_store->get("cherry")) {
+            std::cerr << "  Migrated contents wrong in session " << session << std::endl;
+            return false;
+        }
+        kv_store->close();
+    }
+
+    for (const auto& entry : fs::directory_iterator(db.name())) {
+        std::string name = entry.path().filename().string();
+        if (name.rfind("sst_", 0) == 0 || name == "wal.bin") {
+            std::cerr << "  Legacy file left behind: " << name << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+// Test 12: Compaction keeps the table count bounded and the newest version of every key
+bool test_kvstore_compaction() {
+    TestDatabase db(generate_test_db_name("compaction"));
+    auto kv_store = KVStore::open(db.name(), 2048);
+    if (!kv_store) {
+        std::cerr << "  Failed to open database" << std::endl;
+        return false;
+    }
+
+    const int NUM_KEYS = 200;
+    for (int round = 0; round < 5; round++) {
+        for (int i = 0; i < NUM_KEYS; i++) {
+            kv_store->put("key" + std::to_string(i), "round" + std::to_string(round));
+        }
+    }
+    for (int i = 0; i < 5; i++) {
+        kv_store->remove("key" + std::to_string(i));
+        kv_store->flush_memtable();
+    }
+    // Put back a key whose tombstone is already flushed
+    kv_store->put("key1", "back");
+    kv_store->flush_memtable();
+
+    for (int i = 0; i < NUM_KEYS; i++) {
+        std::string key = "key" + std::to_string(i);
+        auto value = kv_store->get(key);
+        std::string expected = i == 1 ? "back" : "round4";
+        bool deleted = i == 0 || (i >= 2 && i < 5);
+        if (deleted ? value.has_value() : value != expected) {
+            std::cerr << "  Wrong value for " << key << ": " << value.value_or("<none>") << std::endl;
+            return false;
+        }
+    }
+    if (kv_store->scan("key", "key~").size() != NUM_KEYS - 4) {
+        std::cerr << "  Scan count wrong after compaction" << std::endl;
+        return false;
+    }
+
+    auto stats = kv_store->get_stats();
+    auto compaction = kv_store->get_compaction_stats();
+    size_t compactions = 0;
+    for (size_t level = 1; level < compaction.levels.size(); level++) {
+        compactions += compaction.levels[level].compactions;
+    }
+    std::cout << "  " << stats.memtable_flushes << " flushes, " << compactions << " compactions, "
+              << stats.sst_files << " SSTables" << std::endl;
+    if (compactions == 0 || stats.sst_files >= stats.memtable_flushes) {
+        std::cerr << "  Tables were not compacted" << std::endl;
+        return false;
+    }
+
+    kv_store->close();
+    return true;
+}
+
+bool test_kvstore_parallel_reads() {
+    TestDatabase db(generate_test_db_name("parallel_reads"));
+    auto kv_store = KVStore::open(db.name(), 4096);
+    if (!kv_store) {
+        std::cerr << "  Failed to open database" << std::endl;
+        return false;
+    }
+
+    const int NUM_KEYS = 300;
+    for (int i = 0; i < NUM_KEYS; i++) {
+        kv_store->put("stable" + std::to_string(i), "value" + std::to_string(i));
+    }
+
+    // Readers check keys that never change while a writer keeps filling and flushing the memtable
+    const int NUM_READERS = 4;
+    const int READS_PER_THREAD = 2000;
+    std::atomic<int> written{0};
+    std::atomic<int> wrong{0};
+    std::atomic<bool> stop{false};
+
+    std::thread writer([&] {
+        for (int i = 0; !stop.load(); i++) {
+            kv_store->put("hot" + std::to_string(i), std::string(64, 'x'));
+            written.store(i + 1);
+        }
+    });
+
+    std::vector<std::thread> readers;
+    for (int t = 0; t < NUM_READERS; t++) {
+        readers.emplace_back([&, t] {
+            for (int i = 0; i < READS_PER_THREAD; i++) {
+                int k = (i * 7 + t) % NUM_KEYS;
+                if (kv_store->get("stable" + std::to_string(k)) != "value" + std::to_string(k)) {
+                    wrong++;
+                }
+                // A write that has returned is visible to every reader
+                int hot = written.load();
+                if (hot > 0 && !kv_store->get("hot" + std::to_string(hot - 1))) {
+                    wrong++;
+                }
+            }
+        });
+    }
+    for (auto& reader : readers) {
+        reader.join();
+    }
+    stop.store(true);
+    writer.join();
+
+    auto stats = kv_store->get_stats();
+    std::cout << "  " << written.load() << " writes, " << stats.memtable_flushes << " flushes during "
+              << NUM_READERS * READS_PER_THREAD << " stable reads" << std::endl;
+    if (wrong.load() != 0) {
+        std::cerr << "  " << wrong.load() << " reads returned the wrong value" << std::endl;
+        return false;
+    }
+    return stats.gets >= static_cast<uint64_t>(NUM_READERS * READS_PER_THREAD);
+}
+
 // Main test runner
 int kvstore_tests_main() {
     std::cout << "\n=== KVStore Unit Tests ===" << std::endl;
@@ -840,7 +1007,10 @@ int kvstore_tests_main() {
         {"7. Concurrent simulation", test_kvstore_concurrent_simulation},
         {"8. Statistics", test_kvstore_statistics},
         {"9. Large dataset", test_kvstore_large_dataset},
-        {"10. Edge cases", test_kvstore_edge_cases}
+        {"10. Edge cases", test_kvstore_edge_cases},
+        {"11. Legacy migration", test_kvstore_legacy_migration},
+        {"12. Compaction", test_kvstore_compaction},
+        {"13. Parallel reads", test_kvstore_parallel_reads}
     };
 
     int passed = 0;
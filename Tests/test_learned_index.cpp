@@ -0,0 +1,327 @@
+#include "test_learned_index.h"
+#include "../LearnedIndex.h"
+#include "../SSTableWriter.h"
+#include "../SSTableReader.h"
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <random>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+
+#include "test_helper.h"
+
+namespace fs = std::filesystem;
+using namespace std::chrono;
+
+namespace {
+    std::string id_key(uint64_t id) {
+        char buf[32];
+        std::snprintf(buf, sizeof(buf), "id%012llu", static_cast<unsigned long long>(id));
+        return buf;
+    }
+
+    // Mostly monotonic IDs with small random gaps
+    std::vector<std::string> make_id_keys(size_t count, uint32_t seed) {
+        std::mt19937 rng(seed);
+        std::uniform_int_distribution<int> gap(1, 10);
+
+        std::vector<std::string> keys;
+        keys.reserve(count);
+        uint64_t id = 100000;
+        for (size_t i = 0; i < count; ++i) {
+            id += gap(rng);
+            keys.push_back(id_key(id));
+        }
+        return keys;
+    }
+
+    std::vector<std::pair<std::string, Memtable::Entry>> make_entries(const std::vector<std::string>& keys) {
+        std::vector<std::pair<std::string, Memtable::Entry>> entries;
+        entries.reserve(keys.size());
+        for (const auto& key : keys) {
+            entries.emplace_back(key, Memtable::Entry("value_" + key));
+        }
+        return entries;
+    }
+}
+
+// Test 1: Every key lands inside its predicted search range
+bool test_learned_index_monotonic_ids() {
+    auto keys = make_id_keys(10000, 1);
+
+    auto index = LearnedIndex::build(keys, 16);
+    if (!index) {
+        std::cerr << "    Monotonic IDs should get a learned index" << std::endl;
+        return false;
+    }
+
+    for (size_t i = 0; i < keys.size(); ++i) {
+        auto range = index->search_range(keys[i]);
+        if (!range || i < range->begin || i >= range->end || range->end - range->begin > 2 * 16 + 3) {
+            std::cerr << "    Bad search range for key " << i << std::endl;
+            return false;
+        }
+    }
+
+    std::cout << "    " << keys.size() << " keys fit in " << index->segment_count() << " segments" << std::endl;
+    return true;
+}
+
+// Test 2: Keys that aren't numeric friendly fall back to no index
+bool test_learned_index_fallback() {
+    // Keys differ only after the 8 bytes following their shared prefix
+    std::vector<std::string> colliding;
+    for (int i = 0; i < 100; ++i) {
+        char buf[48];
+        std::snprintf(buf, sizeof(buf), "%c_shared_segment_%04d", 'a' + i / 50, i);
+        colliding.emplace_back(buf);
+    }
+    if (LearnedIndex::build(colliding, 16)) {
+        std::cerr << "    Colliding keys should not get a learned index" << std::endl;
+        return false;
+    }
+
+    // Too few keys to be worth a model
+    if (LearnedIndex::build(make_id_keys(100, 6), 16)) {
+        std::cerr << "    Tiny key sets should not get a learned index" << std::endl;
+        return false;
+    }
+
+    // Very skewed keys need a segment almost every key, also in raw byte mode
+    std::vector<std::string> skewed_bytes;
+    uint64_t value = 1;
+    for (int i = 0; i < 60; ++i) {
+        std::string key = "k";
+        for (int b = 7; b >= 0; --b) {
+            key.push_back(static_cast<char>((value >> (b * 8)) & 0xff));
+        }
+        skewed_bytes.push_back(key);
+        value = value * 2 + 1;
+    }
+    if (LearnedIndex::build(skewed_bytes, 0)) {
+        std::cerr << "    Skewed byte keys with zero error should not get a learned index" << std::endl;
+        return false;
+    }
+
+    std::vector<std::string> skewed;
+    uint64_t id = 1;
+    for (int i = 0; i < 60; ++i) {
+        skewed.push_back(id_key(id));
+        id = id * 2 + 1;
+    }
+    if (LearnedIndex::build(skewed, 0)) {
+        std::cerr << "    Skewed keys with zero error should not get a learned index" << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+// Test 3: Serialization round trip
+bool test_learned_index_serialization() {
+    auto keys = make_id_keys(2000, 2);
+    auto index = LearnedIndex::build(keys, 8);
+    if (!index) {
+        std::cerr << "    Failed to build index" << std::endl;
+        return false;
+    }
+
+    auto restored = LearnedIndex::deserialize(index->serialize());
+    if (!restored || restored->segment_count() != index->segment_count() || restored->epsilon() != 8) {
+        std::cerr << "    Failed to restore index" << std::endl;
+        return false;
+    }
+
+    for (const auto& key : keys) {
+        auto a = index->search_range(key);
+        auto b = restored->search_range(key);
+        if (!a || !b || a->begin != b->begin || a->end != b->end) {
+            std::cerr << "    Restored index disagrees on " << key << std::endl;
+            return false;
+        }
+    }
+
+    std::string data = index->serialize();
+    if (LearnedIndex::deserialize(data.substr(0, data.size() - 1)) || LearnedIndex::deserialize("")) {
+        std::cerr << "    Malformed index data accepted" << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+// Test 4: SSTables use the index when written with it and fall back otherwise
+bool test_learned_index_sstable() {
+    const std::string with_index = "test_learned_index.sst";
+    const std::string fallback = "test_learned_index_fallback.sst";
+
+    auto keys = make_id_keys(5000, 3);
+    SSTableWriter::Options options;
+    options.learned_index = true;
+    if (!SSTableWriter::write(with_index, make_entries(keys), options)) {
+        std::cerr << "    Failed to write SSTable" << std::endl;
+        return false;
+    }
+
+    // Keys differ only after the 8 bytes following their shared prefix
+    std::vector<std::string> words;
+    for (int i = 0; i < 500; ++i) {
+        char buf[48];
+        std::snprintf(buf, sizeof(buf), "%c_shared_segment_%04d", 'a' + i / 250, i);
+        words.emplace_back(buf);
+    }
+    if (!SSTableWriter::write(fallback, make_entries(words), options)) {
+        std::cerr << "    Failed to write fallback SSTable" << std::endl;
+        fs::remove(with_index);
+        return false;
+    }
+
+    SSTableReader reader(with_index);
+    SSTableReader fallback_reader(fallback);
+    bool ok = reader.is_valid() && reader.has_learned_index() &&
+              fallback_reader.is_valid() && !fallback_reader.has_learned_index();
+    if (!ok) {
+        std::cerr << "    Unexpected learned index presence" << std::endl;
+    }
+
+    for (size_t i = 0; ok && i < keys.size(); ++i) {
+        auto value = reader.get(keys[i]);
+        if (!value || *value != "value_" + keys[i]) {
+            std::cerr << "    Lookup failed for " << keys[i] << std::endl;
+            ok = false;
+        }
+    }
+
+    // Absent keys inside, before and after the key range and with a foreign prefix
+    for (const std::string& absent : {id_key(100000), id_key(999999999), std::string("id"), std::string("zz")}) {
+        if (ok && reader.get(absent)) {
+            std::cerr << "    Absent key found: " << absent << std::endl;
+            ok = false;
+        }
+    }
+
+    for (size_t i = 0; ok && i < words.size(); ++i) {
+        if (fallback_reader.get(words[i]) != "value_" + words[i]) {
+            std::cerr << "    Fallback lookup failed for " << words[i] << std::endl;
+            ok = false;
+        }
+    }
+
+    fs::remove(with_index);
+    fs::remove(fallback);
+    return ok;
+}
+
+// Test 5: Index memory and lookup latency against binary search over the same table
+bool test_learned_index_performance() {
+    const size_t key_count = 200000;
+    const std::string binary_file = "test_learned_binary.sst";
+    const std::string learned_file = "test_learned_model.sst";
+
+    auto keys = make_id_keys(key_count, 4);
+    auto entries = make_entries(keys);
+
+    SSTableWriter::Options learned_options;
+    learned_options.learned_index = true;
+    if (!SSTableWriter::write(binary_file, entries) ||
+        !SSTableWriter::write(learned_file, entries, learned_options)) {
+        std::cerr << "    Failed to write SSTables" << std::endl;
+        return false;
+    }
+
+    SSTableReader binary_reader(binary_file);
+    SSTableReader learned_reader(learned_file);
+    if (!binary_reader.is_valid() || !learned_reader.is_valid() || !learned_reader.has_learned_index()) {
+        std::cerr << "    Failed to load SSTables" << std::endl;
+        fs::remove(binary_file);
+        fs::remove(learned_file);
+        return false;
+    }
+
+    std::mt19937 rng(5);
+    std::uniform_int_distribution<size_t> pick(0, key_count - 1);
+    std::vector<std::string> lookups;
+    lookups.reserve(200000);
+    for (int i = 0; i < 200000; ++i) {
+        lookups.push_back(keys[pick(rng)]);
+    }
+
+    auto time_lookups = [&lookups](const SSTableReader& reader, size_t& found) {
+        found = 0;
+        auto start = high_resolution_clock::now();
+        for (const auto& key : lookups) {
+            if (reader.contains(key)) found++;
+        }
+        auto end = high_resolution_clock::now();
+        return duration_cast<nanoseconds>(end - start).count() / static_cast<double>(lookups.size());
+    };
+
+    size_t binary_found = 0;
+    size_t learned_found = 0;
+    double binary_ns = time_lookups(binary_reader, binary_found);
+    double learned_ns = time_lookups(learned_reader, learned_found);
+
+    auto model = LearnedIndex::build(keys, learned_options.learned_index_epsilon);
+    size_t directory_bytes = 0;
+    for (const auto& key : keys) {
+        directory_bytes += key.size() + sizeof(uint64_t) + sizeof(uint32_t) + sizeof(uint8_t);
+    }
+
+    std::cout << "    Key directory: " << directory_bytes / 1024 << " KB, learned model: "
+              << model->memory_usage() << " bytes (" << model->segment_count() << " segments, epsilon "
+              << model->epsilon() << ")" << std::endl;
+    std::cout << "    Lookup latency: binary search " << std::fixed << std::setprecision(1) << binary_ns
+              << " ns, learned index " << learned_ns << " ns" << std::endl;
+
+    fs::remove(binary_file);
+    fs::remove(learned_file);
+
+    if (binary_found != lookups.size() || learned_found != lookups.size()) {
+        std::cerr << "    Lookups missed keys" << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+// Main test runner
+int learned_index_tests_main() {
+    std::cout << "\n=== Learned Index Tests ===" << std::endl;
+    std::cout << "===========================" << std::endl;
+
+    std::vector<std::pair<std::string, bool (*)()>> tests = {
+        {"Monotonic IDs", test_learned_index_monotonic_ids},
+        {"Fallback", test_learned_index_fallback},
+        {"Serialization", test_learned_index_serialization},
+        {"SSTable Lookups", test_learned_index_sstable},
+        {"Memory and Latency", test_learned_index_performance}
+    };
+
+    int passed = 0;
+    int total = static_cast<int>(tests.size());
+
+    for (const auto& [name, test_func] : tests) {
+        try {
+            bool result = test_func();
+            print_test_result(name, result);
+            if (result) passed++;
+        } catch (const std::exception& e) {
+            std::cout << "X " << name << " (Exception: " << e.what() << ")" << std::endl;
+        } catch (...) {
+            std::cout << "X " << name << " (Unknown exception)" << std::endl;
+        }
+    }
+
+    std::cout << "\nResults: " << passed << "/" << total << " tests passed" << std::endl;
+
+    if (passed == total) {
+        std::cout << "\nAll Learned Index tests passed!" << std::endl;
+        return 0;
+    } else {
+        std::cout << "\nSome Learned Index tests failed" << std::endl;
+        return 1;
+    }
+}
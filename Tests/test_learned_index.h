@@ -0,0 +1,6 @@
+#ifndef KVDB_TEST_LEARNED_INDEX_H
+#define KVDB_TEST_LEARNED_INDEX_H
+
+int learned_index_tests_main();
+
+#endif // KVDB_TEST_LEARNED_INDEX_H
@@ -19,6 +19,8 @@
 #include <cstring>
 #include <functional>
 #include <set>
+#include <thread>
+#include <atomic>
 
 #include "test_helper.h"
 
@@ -809,6 +811,134 @@ bool test_integration_compaction(const std::string& test_dir) {
     return true;
 }
 
+// Test 16: Readers work off version snapshots while compaction installs new ones
+bool test_version_snapshots(const std::string& test_dir) {
+    std::string data_dir = make_test_path(test_dir, "version_test");
+    auto buffer_pool = std::make_shared<BufferPool>(100);
+    auto config = create_test_config(4, 2, 2);
+
+    LevelManager manager(data_dir, buffer_pool, config);
+
+    auto add_table = [&](int i) {
+        std::string temp_sst = make_test_path(test_dir, "version_" + std::to_string(i) + ".sst");
+        create_real_sstable(temp_sst, {{"k" + std::to_string(100 + i), "v" + std::to_string(i)}});
+        return manager.add_sstable_level0(std::make_shared<SSTableReader>(temp_sst));
+    };
+
+    add_table(0);
+    auto before = manager.current_version();
+
+    // Readers spin on a key that must stay reachable through every install
+    std::atomic<bool> stop{false};
+    std::atomic<size_t> lookups{0};
+    std::atomic<size_t> lost{0};
+    std::vector<std::thread> readers;
+    for (int t = 0; t < 4; ++t) {
+        readers.emplace_back([&]() {
+            while (!stop.load()) {
+                if (manager.find_candidate_sstables("k100").empty()) {
+                    lost++;
+                }
+                lookups++;
+            }
+        });
+    }
+
+    for (int i = 1; i < 8; ++i) {
+        add_table(i);
+        while (auto task = manager.get_compaction_task()) {
+            manager.perform_compaction(*task);
+        }
+    }
+
+    stop = true;
+    for (auto& reader : readers) {
+        reader.join();
+    }
+
+    std::cout << "  " << lookups.load() << " lock-free lookups during installs" << std::endl;
+
+    if (lost.load() != 0) {
+        std::cerr << "  Key unreachable in " << lost.load() << " lookups" << std::endl;
+        return false;
+    }
+
+    // The old snapshot is untouched and its SSTable is still readable
+    if (before->levels[0].size() != 1 || !before->levels[0][0]->get("k100")) {
+        std::cerr << "  Held version changed" << std::endl;
+        return false;
+    }
+
+    return manager.current_version() != before;
+}
+
+// Test 17: Flushes and compactions are recorded per level with amplification
+bool test_compaction_stats(const std::string& test_dir) {
+    std::string data_dir = make_test_path(test_dir, "compaction_stats_test");
+    auto buffer_pool = std::make_shared<BufferPool>(100);
+    auto config = create_test_config(4, 2, 2);
+
+    LevelManager manager(data_dir, buffer_pool, config);
+
+    // Two overlapping tables sharing five keys
+    for (int t = 0; t < 2; t++) {
+        std::vector<std::pair<std::string, std::string>> data;
+        for (int i = t * 5; i < t * 5 + 10; i++) {
+            data.push_back({"key" + std::to_string(100 + i), "value" + std::to_string(t)});
+        }
+        std::string temp_sst = make_test_path(test_dir, "stats_" + std::to_string(t) + ".sst");
+        create_real_sstable(temp_sst, data);
+        manager.add_sstable_level0(std::make_shared<SSTableReader>(temp_sst));
+    }
+
+    auto before = manager.get_compaction_stats();
+    if (before.levels[0].compactions != 2 || before.bytes_flushed == 0
+        || before.read_amplification != 2.0 || !before.recent.empty()) {
+        std::cerr << "  Flushes not recorded in level 0" << std::endl;
+        return false;
+    }
+
+    auto task = manager.get_compaction_task();
+    if (!task) {
+        std::cerr << "  No compaction task generated" << std::endl;
+        return false;
+    }
+    manager.perform_compaction(*task);
+
+    auto stats = manager.get_compaction_stats();
+    std::cout << stats.to_string();
+
+    if (stats.recent.size() != 1) {
+        std::cerr << "  Expected one compaction record" << std::endl;
+        return false;
+    }
+    const auto& record = stats.recent[0];
+    if (record.source_level != 0 || record.target_level != 1 || record.input_files != 2
+        || record.output_files != 1 || record.keys_in != 20 || record.keys_out != 15
+        || record.duplicates_dropped != 5 || record.input_bytes == 0 || record.output_bytes == 0) {
+        std::cerr << "  Wrong compaction record" << std::endl;
+        return false;
+    }
+
+    const auto& level1 = stats.levels[1];
+    if (level1.compactions != 1 || level1.files != 1 || level1.bytes != record.output_bytes
+        || level1.bytes_written != record.output_bytes || stats.levels[0].files != 0) {
+        std::cerr << "  Wrong level totals" << std::endl;
+        return false;
+    }
+
+    // Flushed bytes were written twice, everything now lives in one table of the last level
+    double expected_write_amp = static_cast<double>(stats.bytes_flushed + record.output_bytes)
+        / static_cast<double>(stats.bytes_flushed);
+    if (stats.write_amplification != expected_write_amp || stats.read_amplification != 1.0
+        || stats.space_amplification != 1.0) {
+        std::cerr << "  Wrong amplification" << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
 // Main test runner
 int level_manager_tests_main() {
     // Create unique test directory
@@ -847,7 +977,9 @@ int level_manager_tests_main() {
         {"11. Concurrent Simulation", test_concurrent_simulation},
         {"12. Error Handling", test_error_handling},
         {"13. SSTable Metadata", test_sstable_metadata},
-        {"14. Integration Compaction", test_integration_compaction}
+        {"14. Integration Compaction", test_integration_compaction},
+        {"15. Version Snapshots", test_version_snapshots},
+        {"16. Compaction Stats", test_compaction_stats}
     };
 
     int passed = 0;
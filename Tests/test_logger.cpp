@@ -0,0 +1,209 @@
+#include "test_logger.h"
+#include "../Logger.h"
+#include "../LSMTree.h"
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <thread>
+#include <filesystem>
+
+#include "test_helper.h"
+
+namespace fs = std::filesystem;
+
+namespace {
+    std::vector<std::string> read_lines(const std::string& path) {
+        std::vector<std::string> lines;
+        std::ifstream in(path);
+        std::string line;
+        while (std::getline(in, line)) {
+            lines.push_back(line);
+        }
+        return lines;
+    }
+
+    size_t count_containing(const std::vector<std::string>& lines, const std::string& text) {
+        size_t count = 0;
+        for (const auto& line : lines) {
+            count += line.find(text) != std::string::npos;
+        }
+        return count;
+    }
+}
+
+// Test 1: Lines below the level are skipped, the rest reach the file in order
+bool test_logger_levels() {
+    std::string dir = "test_logger_levels";
+    fs::remove_all(dir);
+    fs::create_directories(dir);
+    std::string path = dir + "/LOG";
+
+    {
+        Logger logger(path, Logger::Options(LogLevel::INFO));
+        logger.debug("hidden ", 1);
+        logger.info("opened ", 2, " files");
+        logger.warn("slow flush");
+        logger.error("failed ", std::string("write"));
+        logger.flush();
+
+        auto lines = read_lines(path);
+        if (lines.size() != 3 || count_containing(lines, "hidden") != 0
+            || lines[0].find(" INFO opened 2 files") == std::string::npos
+            || lines[1].find(" WARN slow flush") == std::string::npos
+            || lines[2].find(" ERROR failed write") == std::string::npos) {
+            std::cerr << "    Unexpected log contents" << std::endl;
+            return false;
+        }
+
+        logger.set_level(LogLevel::DEBUG);
+        logger.debug("now visible");
+    }
+
+    // Closing writes out what is left
+    bool ok = count_containing(read_lines(path), "DEBUG now visible") == 1;
+    fs::remove_all(dir);
+    return ok;
+}
+
+// Test 2: The file rotates past its size limit, keeping a bounded number of old ones
+bool test_logger_rotation() {
+    std::string dir = "test_logger_rotation";
+    fs::remove_all(dir);
+    fs::create_directories(dir);
+    std::string path = dir + "/LOG";
+
+    {
+        Logger logger(path, Logger::Options(LogLevel::INFO, 1024, 2));
+        for (int i = 0; i < 200; ++i) {
+            logger.info("line ", i, " padding padding padding");
+        }
+    }
+
+    bool ok = fs::exists(path) && fs::exists(path + ".1") && fs::exists(path + ".2") && !fs::exists(path + ".3");
+    if (ok && fs::file_size(path) > 1024) {
+        std::cerr << "    Live file grew past the limit" << std::endl;
+        ok = false;
+    }
+    if (ok && count_containing(read_lines(path), "line 199 ") != 1) {
+        std::cerr << "    Last line missing from the live file" << std::endl;
+        ok = false;
+    }
+
+    // Reopening moves the previous run's file aside
+    {
+        Logger logger(path, Logger::Options(LogLevel::INFO, 1024, 2));
+        logger.info("second run");
+    }
+    if (ok && (read_lines(path).size() != 1 || count_containing(read_lines(path + ".1"), "line 199 ") != 1)) {
+        std::cerr << "    Previous file not rotated on open" << std::endl;
+        ok = false;
+    }
+
+    fs::remove_all(dir);
+    return ok;
+}
+
+// Test 3: Concurrent producers on a tiny ring, every line is written or counted as dropped
+bool test_logger_concurrent() {
+    std::string dir = "test_logger_concurrent";
+    fs::remove_all(dir);
+    fs::create_directories(dir);
+    std::string path = dir + "/LOG";
+
+    const int threads = 4;
+    const int per_thread = 5000;
+    uint64_t dropped = 0;
+    {
+        Logger logger(path, Logger::Options(LogLevel::INFO, 0, 0, 64));
+        std::vector<std::thread> workers;
+        for (int t = 0; t < threads; ++t) {
+            workers.emplace_back([&logger, t] {
+                for (int i = 0; i < per_thread; ++i) {
+                    logger.info("worker ", t, " message ", i);
+                }
+            });
+        }
+        for (auto& worker : workers) {
+            worker.join();
+        }
+        dropped = logger.dropped();
+    }
+
+    auto lines = read_lines(path);
+    size_t written = count_containing(lines, " message ");
+    std::cout << "    " << written << " written, " << dropped << " dropped" << std::endl;
+
+    fs::remove_all(dir);
+    if (written + dropped != static_cast<size_t>(threads * per_thread)) {
+        std::cerr << "    Lines lost without being counted" << std::endl;
+        return false;
+    }
+    if (dropped > 0 && count_containing(lines, "Logger dropped") == 0) {
+        std::cerr << "    Drops not noted in the file" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// Test 4: LSMTree logs flushes and compactions to LOG in its data directory
+bool test_logger_lsm() {
+    std::string data_dir = "test_logger_lsm";
+    fs::remove_all(data_dir);
+
+    {
+        LSMTree::Config config(4096, 1024 * 1024, 10);
+        config.level_config.level0_max_sstables = 2;
+        LSMTree lsm(data_dir, config);
+        for (int i = 0; i < 300; ++i) {
+            lsm.put("key" + std::to_string(1000 + i), std::string(40, 'v'));
+        }
+    }
+
+    auto lines = read_lines(data_dir + "/LOG");
+    fs::remove_all(data_dir);
+
+    if (count_containing(lines, "Memtable flushed with") < 2 || count_containing(lines, "Compacted level 0 -> 1") < 1) {
+        std::cerr << "    Flushes or compactions missing from LOG" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// Main test runner
+int logger_tests_main() {
+    std::cout << "\n=== Logger Tests ===" << std::endl;
+    std::cout << "====================" << std::endl;
+
+    std::vector<std::pair<std::string, bool (*)()>> tests = {
+        {"Levels", test_logger_levels},
+        {"Rotation", test_logger_rotation},
+        {"Concurrent Producers", test_logger_concurrent},
+        {"LSM LOG File", test_logger_lsm}
+    };
+
+    int passed = 0;
+    int total = static_cast<int>(tests.size());
+
+    for (const auto& [name, test_func] : tests) {
+        try {
+            bool result = test_func();
+            print_test_result(name, result);
+            if (result) passed++;
+        } catch (const std::exception& e) {
+            std::cout << "X " << name << " (Exception: " << e.what() << ")" << std::endl;
+        } catch (...) {
+            std::cout << "X " << name << " (Unknown exception)" << std::endl;
+        }
+    }
+
+    std::cout << "\nResults: " << passed << "/" << total << " tests passed" << std::endl;
+
+    if (passed == total) {
+        std::cout << "\nAll Logger tests passed!" << std::endl;
+        return 0;
+    } else {
+        std::cout << "\nSome Logger tests failed" << std::endl;
+        return 1;
+    }
+}
@@ -0,0 +1,6 @@
+#ifndef KVDB_TEST_LOGGER_H
+#define KVDB_TEST_LOGGER_H
+
+int logger_tests_main();
+
+#endif // KVDB_TEST_LOGGER_H
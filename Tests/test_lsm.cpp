@@ -18,6 +18,7 @@
 #include <functional>
 #include <set>
 #include <unordered_set>
+#include <cstdio>
 
 #include "test_helper.h"
 
@@ -979,6 +980,176 @@ bool test_integration_workflow(const std::string& test_dir) {
     return true;
 }
 
+// Test 16: Prefix scan with prefix bloom filters
+bool test_prefix_scan(const std::string& test_dir) {
+    std::string data_dir = make_test_path(test_dir, "prefix_scan_test");
+
+    LSMTree::Config config(4096, 1024 * 1024, 10, PrefixExtractor::delimiter(':'));
+    LSMTree lsm(data_dir, config);
+
+    // Each flush holds every fourth tenant, so key ranges overlap but prefixes don't
+    for (int batch = 0; batch < 4; ++batch) {
+        for (int tenant = batch; tenant < 20; tenant += 4) {
+            for (int i = 0; i < 5; ++i) {
+                std::string key = "tenant" + std::to_string(tenant) + ":row" + std::to_string(i);
+                if (!lsm.put(key, "value_" + std::to_string(i))) {
+                    std::cerr << "  Failed to insert " << key << std::endl;
+                    return false;
+                }
+            }
+        }
+        lsm.flush_memtable();
+    }
+
+    // Overwrite and delete in newer data, some still in the memtable
+    lsm.put("tenant1:row0", "updated");
+    lsm.remove("tenant1:row1");
+    lsm.flush_memtable();
+    lsm.remove("tenant1:row2");
+    lsm.put("tenant1:row9", "fresh");
+
+    auto results = lsm.scan_prefix("tenant1:");
+    std::vector<std::pair<std::string, std::string>> expected = {
+        {"tenant1:row0", "updated"},
+        {"tenant1:row3", "value_3"},
+        {"tenant1:row4", "value_4"},
+        {"tenant1:row9", "fresh"}
+    };
+    if (results != expected) {
+        std::cerr << "  Unexpected scan_prefix result (" << results.size() << " entries)" << std::endl;
+        for (const auto& [key, value] : results) {
+            std::cerr << "    " << key << " = " << value << std::endl;
+        }
+        return false;
+    }
+
+    // "tenant1:" must not match "tenant10:" or "tenant11:"
+    if (lsm.scan_prefix("tenant3:").size() != 5 || !lsm.scan_prefix("tenant99:").empty()) {
+        std::cerr << "  Wrong prefix scan sizes" << std::endl;
+        return false;
+    }
+
+    auto stats = lsm.get_stats();
+    std::cout << "    Prefix filter checks: " << stats.prefix_filter_checks
+              << ", skips: " << stats.prefix_filter_skips << std::endl;
+    if (stats.prefix_filter_skips == 0) {
+        std::cerr << "  Prefix filters never skipped a table" << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+// Test 17: Short range scans with range filters
+bool test_range_filter_scan(const std::string& test_dir) {
+    std::string data_dir = make_test_path(test_dir, "range_filter_test");
+
+    // Only the four explicit flushes, so the flushed tables stay overlapping in level 0
+    LSMTree::Config config(64 * 1024, 1024 * 1024, 10, nullptr, true);
+    config.level_config.level0_max_sstables = 8;
+    LSMTree lsm(data_dir, config);
+
+    // Each flush holds every fourth key, so all tables span the whole key range
+    for (int batch = 0; batch < 4; ++batch) {
+        for (int i = batch; i < 400; i += 4) {
+            char key[16];
+            std::snprintf(key, sizeof(key), "row%05d", i * 100);
+            if (!lsm.put(key, "value_" + std::to_string(i))) {
+                std::cerr << "  Failed to insert " << key << std::endl;
+                return false;
+            }
+        }
+        lsm.flush_memtable();
+    }
+
+    // Short ranges around a single key only need one table
+    auto results = lsm.scan("row01200", "row01250");
+    if (results.size() != 1 || results[0].first != "row01200" || results[0].second != "value_12") {
+        std::cerr << "  Unexpected short scan result (" << results.size() << " entries)" << std::endl;
+        return false;
+    }
+
+    if (!lsm.scan("row01201", "row01299").empty()) {
+        std::cerr << "  Scan between keys should be empty" << std::endl;
+        return false;
+    }
+
+    if (lsm.scan("row00000", "row99999").size() != 400) {
+        std::cerr << "  Full scan returned wrong count" << std::endl;
+        return false;
+    }
+
+    auto stats = lsm.get_stats();
+    std::cout << "    Range filter checks: " << stats.range_filter_checks
+              << ", skips: " << stats.range_filter_skips << std::endl;
+    if (stats.range_filter_skips == 0) {
+        std::cerr << "  Range filters never skipped a table" << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+// Test 18: Snapshot reads stay fixed across writes, flushes and compactions
+bool test_snapshot_reads(const std::string& test_dir) {
+    std::string data_dir = make_test_path(test_dir, "snapshot_test");
+    LSMTree lsm(data_dir, 1024, 100, 10);
+
+    for (int i = 0; i < 50; ++i) {
+        lsm.put("key" + std::to_string(100 + i), "old" + std::to_string(i));
+    }
+
+    auto snapshot = lsm.get_snapshot();
+    LSMTree::ReadOptions at_snapshot{snapshot};
+
+    // Overwrite, delete and add keys, enough to flush and compact several times
+    for (int round = 0; round < 5; ++round) {
+        for (int i = 0; i < 50; ++i) {
+            lsm.put("key" + std::to_string(100 + i), "new" + std::to_string(round));
+        }
+    }
+    lsm.remove("key110");
+    lsm.put("key999", "added");
+    lsm.flush_memtable();
+
+    if (lsm.get("key110").has_value() || lsm.get("key999") != "added") {
+        std::cerr << "  Latest state is wrong" << std::endl;
+        return false;
+    }
+
+    if (lsm.get("key110", at_snapshot) != "old10" || lsm.get("key120", at_snapshot) != "old20" ||
+        lsm.get("key999", at_snapshot).has_value()) {
+        std::cerr << "  Snapshot get saw later writes" << std::endl;
+        return false;
+    }
+
+    auto values = lsm.multi_get({"key100", "key149", "key999"}, at_snapshot);
+    if (values.size() != 3 || values[0] != "old0" || values[1] != "old49" || values[2].has_value()) {
+        std::cerr << "  Snapshot multi_get saw later writes" << std::endl;
+        return false;
+    }
+
+    auto rows = lsm.scan("key100", "key999", at_snapshot);
+    if (rows.size() != 50 || rows[10].second != "old10") {
+        std::cerr << "  Snapshot scan returned " << rows.size() << " rows" << std::endl;
+        return false;
+    }
+
+    auto stats = lsm.get_stats();
+    if (stats.live_snapshots != 1 || stats.oldest_snapshot_sequence != snapshot->sequence()) {
+        std::cerr << "  Snapshot stats wrong" << std::endl;
+        return false;
+    }
+
+    lsm.release_snapshot(snapshot);
+    if (lsm.get_stats().live_snapshots != 0) {
+        std::cerr << "  Released snapshot still counted" << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
 // Main test runner
 int lsm_tests_main() {
     // Create unique test directory
@@ -1018,7 +1189,10 @@ int lsm_tests_main() {
         {"12. Tombstone Cleanup", test_tombstone_cleanup},
         {"13. Multiple Instances", test_multiple_instances},
         {"14. Performance Under Load", test_performance_load},
-        {"15. Integration Workflow", test_integration_workflow}
+        {"15. Integration Workflow", test_integration_workflow},
+        {"16. Prefix Scan", test_prefix_scan},
+        {"17. Range Filter Scan", test_range_filter_scan},
+        {"18. Snapshot Reads", test_snapshot_reads}
     };
 
     int passed = 0;
@@ -0,0 +1,165 @@
+#include "test_negative_cache.h"
+#include "../NegativeCache.h"
+#include "../LSMTree.h"
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <filesystem>
+
+#include "test_helper.h"
+
+namespace fs = std::filesystem;
+using namespace std::chrono;
+
+// Test 1: Recorded misses are found until a write to the key
+bool test_negative_cache_basic() {
+    NegativeCache cache(64 * 1024);
+
+    if (!cache.insert("ghost", 0)) {
+        std::cerr << "    Insert rejected" << std::endl;
+        return false;
+    }
+    if (!cache.contains("ghost", 0) || cache.contains("other", 0)) {
+        std::cerr << "    Wrong membership" << std::endl;
+        return false;
+    }
+
+    cache.invalidate("ghost", 1);
+    if (cache.contains("ghost", 1)) {
+        std::cerr << "    Written key still reported absent" << std::endl;
+        return false;
+    }
+
+    // A miss observed before the write must not come back
+    if (cache.insert("ghost", 0)) {
+        std::cerr << "    Stale miss accepted" << std::endl;
+        return false;
+    }
+
+    auto stats = cache.get_stats();
+    if (stats.hits != 1 || stats.misses != 2 || stats.rejected_inserts != 1) {
+        std::cerr << "    Unexpected stats" << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+// Test 2: Usage stays within the byte budget
+bool test_negative_cache_budget() {
+    const size_t entry_charge = NegativeCache::charge("missing00000");
+    NegativeCache cache(entry_charge * 100, 4);
+
+    for (int i = 0; i < 1000; ++i) {
+        cache.insert("missing" + std::to_string(10000 + i), 0);
+    }
+
+    auto stats = cache.get_stats();
+    if (stats.usage > stats.capacity || stats.entry_count == 0 || stats.evictions == 0) {
+        std::cerr << "    Budget not enforced" << std::endl;
+        return false;
+    }
+
+    // The newest misses survive
+    if (!cache.contains("missing10999", 0)) {
+        std::cerr << "    Most recent miss evicted" << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+// Test 3: LSMTree answers repeated misses from the cache and sees later writes
+bool test_negative_cache_lsm() {
+    std::string data_dir = "test_negative_cache_lsm";
+    fs::remove_all(data_dir);
+
+    bool ok = true;
+    {
+        LSMTree::Config config(4096, 1024 * 1024, 10);
+        config.negative_cache_size = 64 * 1024;
+        LSMTree lsm(data_dir, config);
+
+        for (int i = 0; i < 500; ++i) {
+            lsm.put("key" + std::to_string(1000 + i), "value" + std::to_string(i));
+        }
+        lsm.flush_memtable();
+
+        const int lookups = 10000;
+        auto start = high_resolution_clock::now();
+        for (int i = 0; i < lookups; ++i) {
+            if (lsm.get("absent" + std::to_string(i % 100)).has_value()) {
+                ok = false;
+            }
+        }
+        auto end = high_resolution_clock::now();
+
+        auto stats = lsm.get_stats();
+        double hit_rate = 100.0 * stats.negative_cache_hits /
+            static_cast<double>(stats.negative_cache_hits + stats.negative_cache_misses);
+        std::cout << std::fixed << std::setprecision(1);
+        std::cout << "    Repeated misses: " << hit_rate << "% answered by the cache, "
+                  << duration_cast<nanoseconds>(end - start).count() / static_cast<double>(lookups)
+                  << " ns per get" << std::endl;
+        if (stats.negative_cache_hits != lookups - 100) {
+            std::cerr << "    Expected every repeated miss to hit" << std::endl;
+            ok = false;
+        }
+
+        // A put makes the key visible right away
+        lsm.put("absent7", "present");
+        if (lsm.get("absent7") != "present") {
+            std::cerr << "    Cached miss hid a new key" << std::endl;
+            ok = false;
+        }
+
+        // Deleting it again lets the miss be cached again
+        lsm.remove("absent7");
+        if (lsm.get("absent7").has_value() || lsm.get("absent7").has_value()) {
+            std::cerr << "    Deleted key still readable" << std::endl;
+            ok = false;
+        }
+    }
+
+    fs::remove_all(data_dir);
+    return ok;
+}
+
+// Main test runner
+int negative_cache_tests_main() {
+    std::cout << "\n=== Negative Cache Tests ===" << std::endl;
+    std::cout << "============================" << std::endl;
+
+    std::vector<std::pair<std::string, bool (*)()>> tests = {
+        {"Basic Lookup", test_negative_cache_basic},
+        {"Byte Budget", test_negative_cache_budget},
+        {"LSM Repeated Misses", test_negative_cache_lsm}
+    };
+
+    int passed = 0;
+    int total = static_cast<int>(tests.size());
+
+    for (const auto& [name, test_func] : tests) {
+        try {
+            bool result = test_func();
+            print_test_result(name, result);
+            if (result) passed++;
+        } catch (const std::exception& e) {
+            std::cout << "X " << name << " (Exception: " << e.what() << ")" << std::endl;
+        } catch (...) {
+            std::cout << "X " << name << " (Unknown exception)" << std::endl;
+        }
+    }
+
+    std::cout << "\nResults: " << passed << "/" << total << " tests passed" << std::endl;
+
+    if (passed == total) {
+        std::cout << "\nAll Negative Cache tests passed!" << std::endl;
+        return 0;
+    } else {
+        std::cout << "\nSome Negative Cache tests failed" << std::endl;
+        return 1;
+    }
+}
@@ -0,0 +1,6 @@
+#ifndef KVDB_TEST_NEGATIVE_CACHE_H
+#define KVDB_TEST_NEGATIVE_CACHE_H
+
+int negative_cache_tests_main();
+
+#endif // KVDB_TEST_NEGATIVE_CACHE_H
@@ -0,0 +1,225 @@
+#include "test_perf_context.h"
+#include "../PerfContext.h"
+#include "../LSMTree.h"
+#include <iostream>
+#include <string>
+#include <vector>
+#include <thread>
+#include <filesystem>
+
+#include "test_helper.h"
+
+namespace fs = std::filesystem;
+
+// Test 1: Nothing is recorded while perf is disabled
+bool test_perf_context_disabled() {
+    std::string data_dir = "test_perf_context_disabled";
+    fs::remove_all(data_dir);
+
+    bool ok = true;
+    {
+        LSMTree lsm(data_dir, 4096);
+        set_perf_level(PerfLevel::DISABLED);
+        get_perf_context().reset();
+
+        lsm.put("key1", "value1");
+        lsm.get("key1");
+        lsm.flush_memtable();
+        lsm.get("key1");
+
+        if (!get_perf_context().to_string().empty()) {
+            std::cerr << "    Disabled context recorded: " << get_perf_context().to_string() << std::endl;
+            ok = false;
+        }
+    }
+
+    fs::remove_all(data_dir);
+    return ok;
+}
+
+// Test 2: Counters follow a get through the caches, memtable and SSTables
+bool test_perf_context_counts() {
+    std::string data_dir = "test_perf_context_counts";
+    fs::remove_all(data_dir);
+
+    bool ok = true;
+    {
+        LSMTree::Config config(64 * 1024, 1024 * 1024, 10);
+        config.row_cache_size = 64 * 1024;
+        config.hash_index = true;
+        LSMTree lsm(data_dir, config);
+
+        for (int i = 0; i < 100; ++i) {
+            lsm.put("key" + std::to_string(100 + i), "value" + std::to_string(i));
+        }
+        lsm.flush_memtable();
+        lsm.put("fresh", "in memtable");
+
+        set_perf_level(PerfLevel::COUNTS);
+        auto& ctx = get_perf_context();
+
+        ctx.reset();
+        lsm.get("fresh");
+        if (ctx.memtable_hits != 1 || ctx.tables_probed != 0 || ctx.row_cache_misses != 1) {
+            std::cerr << "    Memtable read: " << ctx.to_string() << std::endl;
+            ok = false;
+        }
+
+        ctx.reset();
+        auto value = lsm.get("key150");
+        if (value != "value50" || ctx.memtable_hits != 0 || ctx.tables_probed != 1 || ctx.bytes_read != 7) {
+            std::cerr << "    SSTable read: " << ctx.to_string() << std::endl;
+            ok = false;
+        }
+
+        ctx.reset();
+        lsm.get("key150");
+        if (ctx.row_cache_hits != 1 || ctx.tables_probed != 0) {
+            std::cerr << "    Cached read: " << ctx.to_string() << std::endl;
+            ok = false;
+        }
+
+        // Every table a deleted key is looked for in is searched once, not once for a value
+        // and again for a tombstone
+        set_perf_level(PerfLevel::DISABLED);
+        lsm.remove("key120");
+        lsm.flush_memtable();
+        set_perf_level(PerfLevel::COUNTS);
+        ctx.reset();
+        if (lsm.get("key120") || ctx.tables_probed == 0 || ctx.index_checks != ctx.tables_probed) {
+            std::cerr << "    Deleted read: " << ctx.to_string() << std::endl;
+            ok = false;
+        }
+
+        // COUNTS leaves the timings alone
+        if (ctx.get_memtable_ns != 0 || ctx.table_search_ns != 0) {
+            std::cerr << "    Timings recorded at COUNTS" << std::endl;
+            ok = false;
+        }
+        set_perf_level(PerfLevel::DISABLED);
+    }
+
+    fs::remove_all(data_dir);
+    return ok;
+}
+
+// Test 3: TIMING fills in stage times on both paths
+bool test_perf_context_timing() {
+    std::string data_dir = "test_perf_context_timing";
+    fs::remove_all(data_dir);
+
+    bool ok = true;
+    {
+        LSMTree lsm(data_dir, 64 * 1024);
+        for (int i = 0; i < 100; ++i) {
+            lsm.put("key" + std::to_string(100 + i), "value" + std::to_string(i));
+        }
+
+        set_perf_level(PerfLevel::TIMING);
+        auto& ctx = get_perf_context();
+        ctx.reset();
+
+        lsm.put("key999", "value999");
+        if (ctx.memtable_insert_ns == 0 || ctx.wal_write_ns == 0 || ctx.wal_sync_ns == 0) {
+            std::cerr << "    Write timings missing: " << ctx.to_string() << std::endl;
+            ok = false;
+        }
+
+        lsm.flush_memtable();
+        if (ctx.flush_ns == 0) {
+            std::cerr << "    Flush not timed" << std::endl;
+            ok = false;
+        }
+
+        ctx.reset();
+        lsm.get("key150");
+        if (ctx.get_memtable_ns == 0 || ctx.find_tables_ns == 0 || ctx.table_search_ns == 0
+            || ctx.value_copy_ns == 0) {
+            std::cerr << "    Read timings missing: " << ctx.to_string() << std::endl;
+            ok = false;
+        }
+        set_perf_level(PerfLevel::DISABLED);
+    }
+
+    fs::remove_all(data_dir);
+    return ok;
+}
+
+// Test 4: WAL bytes match the records written, and contexts are per thread
+bool test_perf_context_wal_bytes() {
+    std::string data_dir = "test_perf_context_wal";
+    fs::remove_all(data_dir);
+
+    bool ok = true;
+    {
+        LSMTree lsm(data_dir, 64 * 1024);
+
+        set_perf_level(PerfLevel::COUNTS);
+        auto& ctx = get_perf_context();
+        ctx.reset();
+
+        // op + key length + key + value length + value, then op + key length + key
+        lsm.put("key", "value");
+        lsm.remove("key");
+        const uint64_t expected = (1 + 4 + 3 + 4 + 5) + (1 + 4 + 3);
+        if (ctx.wal_bytes != expected) {
+            std::cerr << "    Expected " << expected << " WAL bytes, got " << ctx.wal_bytes << std::endl;
+            ok = false;
+        }
+
+        // Another thread has its own level and context
+        std::thread other([&] {
+            lsm.put("other", "value");
+            if (get_perf_level() != PerfLevel::DISABLED || get_perf_context().wal_bytes != 0) {
+                ok = false;
+            }
+        });
+        other.join();
+        if (ctx.wal_bytes != expected) {
+            std::cerr << "    Other thread's write counted here" << std::endl;
+            ok = false;
+        }
+        set_perf_level(PerfLevel::DISABLED);
+    }
+
+    fs::remove_all(data_dir);
+    return ok;
+}
+
+// Main test runner
+int perf_context_tests_main() {
+    std::cout << "\n=== Perf Context Tests ===" << std::endl;
+    std::cout << "==========================" << std::endl;
+
+    std::vector<std::pair<std::string, bool (*)()>> tests = {
+        {"Disabled", test_perf_context_disabled},
+        {"Read Path Counts", test_perf_context_counts},
+        {"Stage Timings", test_perf_context_timing},
+        {"WAL Bytes", test_perf_context_wal_bytes}
+    };
+
+    int passed = 0;
+    int total = static_cast<int>(tests.size());
+
+    for (const auto& [name, test_func] : tests) {
+        try {
+            bool result = test_func();
+            print_test_result(name, result);
+            if (result) passed++;
+        } catch (const std::exception& e) {
+            std::cout << "X " << name << " (Exception: " << e.what() << ")" << std::endl;
+        } catch (...) {
+            std::cout << "X " << name << " (Unknown exception)" << std::endl;
+        }
+    }
+
+    std::cout << "\nResults: " << passed << "/" << total << " tests passed" << std::endl;
+
+    if (passed == total) {
+        std::cout << "\nAll Perf Context tests passed!" << std::endl;
+        return 0;
+    } else {
+        std::cout << "\nSome Perf Context tests failed" << std::endl;
+        return 1;
+    }
+}
@@ -0,0 +1,6 @@
+#ifndef KVDB_TEST_PERF_CONTEXT_H
+#define KVDB_TEST_PERF_CONTEXT_H
+
+int perf_context_tests_main();
+
+#endif // KVDB_TEST_PERF_CONTEXT_H
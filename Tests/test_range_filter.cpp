@@ -0,0 +1,309 @@
+#include "test_range_filter.h"
+#include "../RangeFilter.h"
+#include "../SSTableWriter.h"
+#include "../SSTableReader.h"
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <set>
+#include <random>
+#include <cstdio>
+#include <filesystem>
+
+#include "test_helper.h"
+
+namespace fs = std::filesystem;
+
+namespace {
+    std::string numbered_key(int n) {
+        char buf[16];
+        std::snprintf(buf, sizeof(buf), "key%08d", n);
+        return buf;
+    }
+
+    bool brute_force_range(const std::set<std::string>& keys, const std::string& low, const std::string& high) {
+        auto it = keys.lower_bound(low);
+        return it != keys.end() && *it <= high;
+    }
+}
+
+// Test 1: Ranges between stored keys are pruned, ranges touching them are not
+bool test_range_filter_basic() {
+    RangeFilter filter({"apple", "banana", "cherry"});
+
+    if (!filter.may_contain_range("apple", "apple") ||
+        !filter.may_contain_range("b", "c") ||
+        !filter.may_contain_range("a", "z")) {
+        std::cerr << "    Range holding a key was ruled out" << std::endl;
+        return false;
+    }
+
+    // Nothing stored starts with d..z or sits between "banana" and "cherry" at the first byte
+    if (filter.may_contain_range("d", "zzz") || filter.may_contain_range("0", "9")) {
+        std::cerr << "    Empty range was not ruled out" << std::endl;
+        return false;
+    }
+
+    if (filter.may_contain_range("z", "a")) {
+        std::cerr << "    Inverted range should be empty" << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+// Test 2: Keys that are prefixes of other keys
+bool test_range_filter_prefix_keys() {
+    RangeFilter filter({"a", "ab", "abc", "b"});
+
+    for (const std::string key : {"a", "ab", "abc", "b"}) {
+        if (!filter.may_contain(key)) {
+            std::cerr << "    False negative for " << key << std::endl;
+            return false;
+        }
+    }
+
+    if (!filter.may_contain_range("aa", "ab") || !filter.may_contain_range("abb", "abd")) {
+        std::cerr << "    Range over a prefix key was ruled out" << std::endl;
+        return false;
+    }
+
+    if (filter.may_contain_range("c", "d")) {
+        std::cerr << "    Range past every key was not ruled out" << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+// Test 3: Empty filters, empty keys and high bytes
+bool test_range_filter_edge_cases() {
+    RangeFilter empty(std::vector<std::string>{});
+    if (empty.may_contain_range("", "\xff\xff")) {
+        std::cerr << "    Empty filter should rule out everything" << std::endl;
+        return false;
+    }
+
+    RangeFilter only_empty_key({""});
+    if (!only_empty_key.may_contain_range("", "")) {
+        std::cerr << "    Empty key was ruled out" << std::endl;
+        return false;
+    }
+
+    RangeFilter binary({std::string("\x01\x02", 2), "\x7f", "\xff\xfe"});
+    if (!binary.may_contain_range("\xff", "\xff\xff") ||
+        !binary.may_contain_range(std::string("\x01", 1), std::string("\x01\x03", 2))) {
+        std::cerr << "    High byte keys were ruled out" << std::endl;
+        return false;
+    }
+    if (binary.may_contain_range("\x80", "\xf0")) {
+        std::cerr << "    Range between high byte keys was not ruled out" << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+// Test 4: Random keys and ranges checked against a brute force answer, with and without suffix bytes
+bool test_range_filter_no_false_negatives() {
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<int> key_dist(0, 999999);
+
+    std::set<std::string> keys;
+    while (keys.size() < 2000) {
+        keys.insert(numbered_key(key_dist(rng)));
+    }
+    for (size_t suffix_bytes : {0, 1, 2}) {
+        RangeFilter filter(std::vector<std::string>(keys.begin(), keys.end()), suffix_bytes);
+
+        int false_positives = 0;
+        int empty_ranges = 0;
+        for (int i = 0; i < 20000; ++i) {
+            int start = key_dist(rng);
+            int width = std::uniform_int_distribution<int>(0, 2000)(rng);
+            std::string low = numbered_key(start);
+            std::string high = numbered_key(start + width);
+
+            bool expected = brute_force_range(keys, low, high);
+            bool actual = filter.may_contain_range(low, high);
+
+            if (expected && !actual) {
+                std::cerr << "    False negative for [" << low << ", " << high << "]" << std::endl;
+                return false;
+            }
+            if (!expected) {
+                empty_ranges++;
+                if (actual) false_positives++;
+            }
+        }
+
+        std::cout << "    Suffix bytes " << suffix_bytes << ": " << false_positives << "/" << empty_ranges
+                  << " empty ranges passed" << std::endl;
+    }
+
+    return true;
+}
+
+// Test 5: Serialization round trip
+bool test_range_filter_serialization() {
+    std::vector<std::string> keys;
+    for (int i = 0; i < 500; i += 3) {
+        keys.push_back(numbered_key(i * 37));
+    }
+    RangeFilter filter(keys);
+
+    auto restored = RangeFilter::deserialize(filter.serialize());
+    if (!restored || restored->node_count() != filter.node_count() || restored->edge_count() != filter.edge_count()) {
+        std::cerr << "    Failed to restore filter" << std::endl;
+        return false;
+    }
+
+    for (int i = 0; i < 20000; i += 7) {
+        std::string low = numbered_key(i);
+        std::string high = numbered_key(i + 50);
+        if (restored->may_contain_range(low, high) != filter.may_contain_range(low, high)) {
+            std::cerr << "    Restored filter disagrees on [" << low << ", " << high << "]" << std::endl;
+            return false;
+        }
+    }
+
+    std::string data = filter.serialize();
+    if (RangeFilter::deserialize(data.substr(0, data.size() - 1)) || RangeFilter::deserialize("abc")) {
+        std::cerr << "    Malformed filter data accepted" << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+// Test 6: Pruning rate over overlapping L0-style tables for short and medium ranges
+bool test_range_filter_pruning_rate() {
+    const int table_count = 16;
+    const int keys_per_table = 1000;
+    const int key_space = 1000000;
+
+    std::mt19937 rng(7);
+    std::uniform_int_distribution<int> key_dist(0, key_space - 1);
+
+    // Every table spans nearly the whole key space, so min/max checks can't prune anything
+    std::vector<std::unique_ptr<SSTableReader>> tables;
+    std::vector<std::set<std::string>> table_keys(table_count);
+    std::vector<std::string> filenames;
+
+    for (int t = 0; t < table_count; ++t) {
+        while (table_keys[t].size() < keys_per_table) {
+            table_keys[t].insert(numbered_key(key_dist(rng)));
+        }
+
+        std::vector<std::pair<std::string, Memtable::Entry>> entries;
+        for (const auto& key : table_keys[t]) {
+            entries.emplace_back(key, Memtable::Entry("v"));
+        }
+
+        std::string filename = "test_range_filter_" + std::to_string(t) + ".sst";
+        filenames.push_back(filename);
+        if (!SSTableWriter::write(filename, entries, SSTableWriter::Options(nullptr, 10, true))) {
+            std::cerr << "    Failed to write " << filename << std::endl;
+            return false;
+        }
+        tables.push_back(std::make_unique<SSTableReader>(filename));
+        if (!tables.back()->is_valid() || !tables.back()->has_range_filter()) {
+            std::cerr << "    Failed to load range filter from " << filename << std::endl;
+            return false;
+        }
+    }
+
+    size_t filter_bytes = 0;
+    for (const auto& keys : table_keys) {
+        filter_bytes += RangeFilter(std::vector<std::string>(keys.begin(), keys.end()), 1).serialize().size();
+    }
+
+    bool ok = true;
+    for (const auto& [label, width] : std::vector<std::pair<std::string, int>>{{"short", 100}, {"medium", 1000}}) {
+        int overlapping = 0;   // tables whose min/max overlap the range
+        int pruned = 0;        // ... that the filter skipped
+        int empty = 0;         // ... that really had no key in the range
+
+        for (int q = 0; q < 2000; ++q) {
+            int start = key_dist(rng);
+            std::string low = numbered_key(start);
+            std::string high = numbered_key(start + width - 1);
+
+            for (int t = 0; t < table_count; ++t) {
+                if (tables[t]->max_key() < low || tables[t]->min_key() > high) continue;
+                overlapping++;
+
+                bool has_key = brute_force_range(table_keys[t], low, high);
+                if (!has_key) empty++;
+
+                if (!tables[t]->may_contain_range(low, high)) {
+                    pruned++;
+                    if (has_key) {
+                        std::cerr << "    Pruned a table holding a key in [" << low << ", " << high << "]" << std::endl;
+                        ok = false;
+                    }
+                }
+            }
+        }
+
+        double prune_rate = overlapping ? 100.0 * pruned / overlapping : 0.0;
+        double ideal_rate = overlapping ? 100.0 * empty / overlapping : 0.0;
+        std::cout << "    " << std::left << std::setw(7) << label << "ranges (" << width << " keys wide): pruned "
+                  << std::fixed << std::setprecision(1) << prune_rate << "% of overlapping tables, ideal "
+                  << ideal_rate << "%" << std::endl;
+
+        if (label == "short" && prune_rate < 50.0) {
+            std::cerr << "    Short range pruning rate too low" << std::endl;
+            ok = false;
+        }
+    }
+    std::cout << "    Filter size: " << std::setprecision(2)
+              << static_cast<double>(filter_bytes) / (table_count * keys_per_table) << " bytes per key" << std::endl;
+
+    for (const auto& filename : filenames) {
+        fs::remove(filename);
+    }
+
+    return ok;
+}
+
+// Main test runner
+int range_filter_tests_main() {
+    std::cout << "\n=== Range Filter Tests ===" << std::endl;
+    std::cout << "==========================" << std::endl;
+
+    std::vector<std::pair<std::string, bool (*)()>> tests = {
+        {"Basic Ranges", test_range_filter_basic},
+        {"Prefix Keys", test_range_filter_prefix_keys},
+        {"Edge Cases", test_range_filter_edge_cases},
+        {"No False Negatives", test_range_filter_no_false_negatives},
+        {"Serialization", test_range_filter_serialization},
+        {"Pruning Rate", test_range_filter_pruning_rate}
+    };
+
+    int passed = 0;
+    int total = static_cast<int>(tests.size());
+
+    for (const auto& [name, test_func] : tests) {
+        try {
+            bool result = test_func();
+            print_test_result(name, result);
+            if (result) passed++;
+        } catch (const std::exception& e) {
+            std::cout << "X " << name << " (Exception: " << e.what() << ")" << std::endl;
+        } catch (...) {
+            std::cout << "X " << name << " (Unknown exception)" << std::endl;
+        }
+    }
+
+    std::cout << "\nResults: " << passed << "/" << total << " tests passed" << std::endl;
+
+    if (passed == total) {
+        std::cout << "\nAll Range Filter tests passed!" << std::endl;
+        return 0;
+    } else {
+        std::cout << "\nSome Range Filter tests failed" << std::endl;
+        return 1;
+    }
+}
@@ -0,0 +1,6 @@
+#ifndef KVDB_TEST_RANGE_FILTER_H
+#define KVDB_TEST_RANGE_FILTER_H
+
+int range_filter_tests_main();
+
+#endif // KVDB_TEST_RANGE_FILTER_H
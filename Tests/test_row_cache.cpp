@@ -0,0 +1,276 @@
+#include "test_row_cache.h"
+#include "../RowCache.h"
+#include "../LSMTree.h"
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <random>
+#include <algorithm>
+#include <cmath>
+#include <chrono>
+#include <filesystem>
+
+#include "test_helper.h"
+
+namespace fs = std::filesystem;
+using namespace std::chrono;
+
+// Test 1: Inserted values come back, and writes drop them
+bool test_row_cache_basic() {
+    RowCache cache(64 * 1024);
+
+    if (!cache.insert("apple", "red", 0) || !cache.insert("banana", "yellow", 0)) {
+        std::cerr << "    Insert rejected" << std::endl;
+        return false;
+    }
+
+    auto value = cache.lookup("apple", 0);
+    if (!value || *value != "red") {
+        std::cerr << "    Cached value missing" << std::endl;
+        return false;
+    }
+
+    cache.invalidate("apple", 1);
+    if (cache.lookup("apple", 1)) {
+        std::cerr << "    Invalidated key still cached" << std::endl;
+        return false;
+    }
+
+    if (cache.lookup("cherry", 1)) {
+        std::cerr << "    Uncached key reported present" << std::endl;
+        return false;
+    }
+
+    auto stats = cache.get_stats();
+    if (stats.hits != 1 || stats.misses != 2 || stats.invalidations != 1 || stats.entry_count != 1) {
+        std::cerr << "    Unexpected stats" << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+// Test 2: A read that started before a write can't put the old value back
+bool test_row_cache_stale_insert() {
+    RowCache cache(64 * 1024, 1);
+
+    // Reader observes sequence 5, then a writer bumps the key to 6
+    const uint64_t read_seq = 5;
+    cache.invalidate("key", 6);
+
+    if (cache.insert("key", "old", read_seq)) {
+        std::cerr << "    Stale insert accepted" << std::endl;
+        return false;
+    }
+    if (cache.lookup("key", 6)) {
+        std::cerr << "    Stale value visible" << std::endl;
+        return false;
+    }
+
+    // Reads that start after the write cache normally
+    if (!cache.insert("key", "new", 6)) {
+        std::cerr << "    Fresh insert rejected" << std::endl;
+        return false;
+    }
+
+    // Older snapshots don't see a value cached at a later sequence
+    if (cache.lookup("key", 5)) {
+        std::cerr << "    Older snapshot saw a newer entry" << std::endl;
+        return false;
+    }
+
+    auto value = cache.lookup("key", 7);
+    if (!value || *value != "new") {
+        std::cerr << "    Fresh value missing" << std::endl;
+        return false;
+    }
+
+    return cache.get_stats().rejected_inserts == 1;
+}
+
+// Test 3: Usage stays within the byte budget, least recently used go first
+bool test_row_cache_eviction() {
+    const std::string value(100, 'v');
+    const size_t entry_charge = RowCache::charge("key000", value);
+    RowCache cache(entry_charge * 10, 1);
+
+    for (int i = 0; i < 10; ++i) {
+        cache.insert("key00" + std::to_string(i), value, 0);
+    }
+
+    // Touch key000 so key001 becomes the oldest
+    cache.lookup("key000", 0);
+    cache.insert("key010", value, 0);
+
+    auto stats = cache.get_stats();
+    if (stats.usage > stats.capacity || stats.evictions != 1) {
+        std::cerr << "    Budget exceeded or wrong eviction count" << std::endl;
+        return false;
+    }
+
+    if (!cache.lookup("key000", 0) || cache.lookup("key001", 0) || !cache.lookup("key010", 0)) {
+        std::cerr << "    Wrong entry evicted" << std::endl;
+        return false;
+    }
+
+    // Entries larger than a shard are never cached
+    if (cache.insert("huge", std::string(entry_charge * 20, 'x'), 0)) {
+        std::cerr << "    Oversized entry accepted" << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+// Test 4: LSMTree reads through the cache, writes and deletes invalidate it
+bool test_row_cache_lsm() {
+    std::string data_dir = "test_row_cache_lsm";
+    fs::remove_all(data_dir);
+
+    bool ok = true;
+    {
+        LSMTree::Config config(4096, 1024 * 1024, 10);
+        config.row_cache_size = 1024 * 1024;
+        LSMTree lsm(data_dir, config);
+
+        for (int i = 0; i < 200; ++i) {
+            lsm.put("key" + std::to_string(100 + i), "value" + std::to_string(i));
+        }
+        lsm.flush_memtable();
+
+        // First read misses, the second comes from the cache
+        ok = ok && lsm.get("key107") == "value7";
+        ok = ok && lsm.get("key107") == "value7";
+        auto stats = lsm.get_stats();
+        if (stats.row_cache_hits != 1 || stats.row_cache_usage == 0) {
+            std::cerr << "    Second read missed the cache" << std::endl;
+            ok = false;
+        }
+
+        lsm.put("key107", "updated");
+        if (lsm.get("key107") != "updated") {
+            std::cerr << "    Stale value after put" << std::endl;
+            ok = false;
+        }
+
+        lsm.remove("key107");
+        if (lsm.get("key107").has_value()) {
+            std::cerr << "    Deleted key still readable" << std::endl;
+            ok = false;
+        }
+
+        // Values survive a flush unchanged
+        lsm.put("key108", "flushed");
+        lsm.get("key108");
+        lsm.flush_memtable();
+        if (lsm.get("key108") != "flushed") {
+            std::cerr << "    Wrong value after flush" << std::endl;
+            ok = false;
+        }
+    }
+
+    fs::remove_all(data_dir);
+    return ok;
+}
+
+// Test 5: Zipfian hot-key reads with and without the cache
+bool test_row_cache_performance() {
+    const int key_count = 20000;
+    const int read_count = 200000;
+
+    // Zipfian(0.99) key picks through an inverse CDF table
+    std::vector<double> cdf(key_count);
+    double sum = 0.0;
+    for (int i = 0; i < key_count; ++i) {
+        sum += 1.0 / std::pow(i + 1, 0.99);
+        cdf[i] = sum;
+    }
+    std::mt19937_64 rng(5);
+    std::uniform_real_distribution<double> uniform(0.0, sum);
+    std::vector<std::string> reads;
+    reads.reserve(read_count);
+    for (int i = 0; i < read_count; ++i) {
+        auto rank = std::lower_bound(cdf.begin(), cdf.end(), uniform(rng)) - cdf.begin();
+        reads.push_back("user" + std::to_string(1000000 + rank));
+    }
+
+    auto time_reads = [&](size_t cache_size, double& hit_rate) {
+        std::string data_dir = "test_row_cache_perf";
+        fs::remove_all(data_dir);
+
+        double ns = 0.0;
+        {
+            LSMTree::Config config(64 * 1024, 1024 * 1024, 10);
+            config.row_cache_size = cache_size;
+            LSMTree lsm(data_dir, config);
+            for (int i = 0; i < key_count; ++i) {
+                lsm.put("user" + std::to_string(1000000 + i), std::string(100, 'v'));
+            }
+            lsm.flush_memtable();
+
+            auto start = high_resolution_clock::now();
+            for (const auto& key : reads) {
+                lsm.get(key);
+            }
+            auto end = high_resolution_clock::now();
+            ns = duration_cast<nanoseconds>(end - start).count() / static_cast<double>(reads.size());
+
+            auto stats = lsm.get_stats();
+            hit_rate = stats.row_cache_hits + stats.row_cache_misses == 0 ? 0.0
+                : 100.0 * stats.row_cache_hits / static_cast<double>(stats.row_cache_hits + stats.row_cache_misses);
+        }
+
+        fs::remove_all(data_dir);
+        return ns;
+    };
+
+    double uncached_rate = 0.0, cached_rate = 0.0;
+    double uncached_ns = time_reads(0, uncached_rate);
+    double cached_ns = time_reads(512 * 1024, cached_rate);
+
+    std::cout << std::fixed << std::setprecision(1);
+    std::cout << "    Zipfian gets: no row cache " << uncached_ns << " ns, 512 KB row cache "
+              << cached_ns << " ns (" << cached_rate << "% hits)" << std::endl;
+
+    return cached_rate > 50.0;
+}
+
+// Main test runner
+int row_cache_tests_main() {
+    std::cout << "\n=== Row Cache Tests ===" << std::endl;
+    std::cout << "=======================" << std::endl;
+
+    std::vector<std::pair<std::string, bool (*)()>> tests = {
+        {"Basic Lookup", test_row_cache_basic},
+        {"Stale Insert", test_row_cache_stale_insert},
+        {"Eviction", test_row_cache_eviction},
+        {"LSM Read Path", test_row_cache_lsm},
+        {"Zipfian Reads", test_row_cache_performance}
+    };
+
+    int passed = 0;
+    int total = static_cast<int>(tests.size());
+
+    for (const auto& [name, test_func] : tests) {
+        try {
+            bool result = test_func();
+            print_test_result(name, result);
+            if (result) passed++;
+        } catch (const std::exception& e) {
+            std::cout << "X " << name << " (Exception: " << e.what() << ")" << std::endl;
+        } catch (...) {
+            std::cout << "X " << name << " (Unknown exception)" << std::endl;
+        }
+    }
+
+    std::cout << "\nResults: " << passed << "/" << total << " tests passed" << std::endl;
+
+    if (passed == total) {
+        std::cout << "\nAll Row Cache tests passed!" << std::endl;
+        return 0;
+    } else {
+        std::cout << "\nSome Row Cache tests failed" << std::endl;
+        return 1;
+    }
+}
@@ -0,0 +1,6 @@
+#ifndef KVDB_TEST_ROW_CACHE_H
+#define KVDB_TEST_ROW_CACHE_H
+
+int row_cache_tests_main();
+
+#endif // KVDB_TEST_ROW_CACHE_H
@@ -13,10 +13,31 @@
 #include "test_lsm.h"
 #include "test_compaction.h"
 #include "test_level_manager.h"
+#include "test_bloom_filter.h"
+#include "test_range_filter.h"
+#include "test_learned_index.h"
+#include "test_hash_index.h"
+#include "test_row_cache.h"
+#include "test_negative_cache.h"
+#include "test_transaction.h"
+#include "test_column_family.h"
+#include "test_histogram.h"
+#include "test_perf_context.h"
+#include "test_event_listener.h"
+#include "test_logger.h"
+#include "test_stats_dumper.h"
+#include "test_trace.h"
+#include "test_env.h"
+#include "test_sharded_store.h"
+#include "test_thread_pool.h"
 
 void run_tests()
 {
     memtable_tests_main();
+    bloom_filter_tests_main();
+    range_filter_tests_main();
+    learned_index_tests_main();
+    hash_index_tests_main();
     sstable_writer_tests_main();
     sstable_reader_tests_main();
     wal_tests_main();
@@ -26,4 +47,17 @@ void run_tests()
     compaction_tests_main();
     level_manager_tests_main();
     lsm_tests_main();
+    row_cache_tests_main();
+    negative_cache_tests_main();
+    transaction_tests_main();
+    column_family_tests_main();
+    histogram_tests_main();
+    perf_context_tests_main();
+    event_listener_tests_main();
+    logger_tests_main();
+    stats_dumper_tests_main();
+    trace_tests_main();
+    env_tests_main();
+    sharded_store_tests_main();
+    thread_pool_tests_main();
 }
\ No newline at end of file
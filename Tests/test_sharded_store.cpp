@@ -0,0 +1,222 @@
+#include "test_sharded_store.h"
+#include "../ShardedStore.h"
+#include "../MemEnv.h"
+#include <iostream>
+#include <string>
+#include <vector>
+#include <thread>
+#include <algorithm>
+#include <filesystem>
+
+#include "test_helper.h"
+
+namespace fs = std::filesystem;
+
+namespace {
+    ShardedStore::Config mem_config(size_t shards, std::shared_ptr<Env> env, size_t memtable_size = 1024 * 1024) {
+        LSMTree::Config tree_config(memtable_size);
+        tree_config.env = std::move(env);
+        return ShardedStore::Config(shards, tree_config);
+    }
+
+    std::string key_of(int i) {
+        std::string digits = std::to_string(i);
+        return "key" + std::string(5 - digits.size(), '0') + digits;
+    }
+}
+
+// Test 1: Keys spread over every shard, each key is read back from the shard that holds it
+bool test_sharded_routing() {
+    auto env = std::make_shared<MemEnv>();
+    ShardedStore store("test_sharded_routing", mem_config(4, env));
+
+    for (int i = 0; i < 400; i++) {
+        store.put(key_of(i), "value" + std::to_string(i));
+    }
+    store.remove(key_of(7));
+
+    auto stats = store.get_shard_stats();
+    for (size_t s = 0; s < stats.size(); s++) {
+        if (stats[s].total_puts == 0) {
+            std::cerr << "    Shard " << s << " got no keys" << std::endl;
+            return false;
+        }
+    }
+
+    for (int i = 0; i < 400; i++) {
+        auto value = store.get(key_of(i));
+        bool expected = i != 7;
+        if (value.has_value() != expected || (expected && *value != "value" + std::to_string(i))) {
+            std::cerr << "    " << key_of(i) << " wrong" << std::endl;
+            return false;
+        }
+    }
+    return store.num_shards() == 4 && store.shard_of("a") == store.shard_of("a");
+}
+
+// Test 2: A batch is split over the shards and multi_get answers in request order
+bool test_sharded_batch_and_multi_get() {
+    auto env = std::make_shared<MemEnv>();
+    ShardedStore store("test_sharded_batch", mem_config(3, env));
+
+    store.put(key_of(1), "old");
+    WriteBatch batch;
+    for (int i = 0; i < 50; i++) {
+        batch.put(key_of(i), "batch" + std::to_string(i));
+    }
+    batch.remove(key_of(2));
+    batch.put(key_of(1), "new");
+    if (!store.write(batch)) {
+        std::cerr << "    Batch failed" << std::endl;
+        return false;
+    }
+
+    std::vector<std::string> keys = {key_of(1), "missing", key_of(2), key_of(49), key_of(3)};
+    auto values = store.multi_get(keys);
+    std::vector<std::optional<std::string>> expected = {"new", std::nullopt, std::nullopt, "batch49", "batch3"};
+    if (values != expected) {
+        std::cerr << "    multi_get results wrong or out of order" << std::endl;
+        return false;
+    }
+    return store.multi_get({}).empty();
+}
+
+// Test 3: Scans merge every shard's memtable and tables back into key order
+bool test_sharded_scan() {
+    auto env = std::make_shared<MemEnv>();
+    ShardedStore store("test_sharded_scan", mem_config(4, env));
+
+    for (int i = 0; i < 200; i += 2) {
+        store.put(key_of(i), "even");
+    }
+    store.flush();
+    for (int i = 1; i < 200; i += 2) {
+        store.put(key_of(i), "odd");
+    }
+    store.remove(key_of(10));
+
+    auto results = store.scan(key_of(5), key_of(20));
+    std::vector<std::string> keys;
+    for (const auto& [key, value] : results) {
+        keys.push_back(key);
+        if (value != (std::stoi(key.substr(3)) % 2 == 0 ? "even" : "odd")) {
+            std::cerr << "    Wrong value for " << key << std::endl;
+            return false;
+        }
+    }
+
+    std::vector<std::string> expected;
+    for (int i = 5; i <= 20; i++) {
+        if (i != 10) {
+            expected.push_back(key_of(i));
+        }
+    }
+    if (keys != expected) {
+        std::cerr << "    Scan returned " << keys.size() << " keys, expected " << expected.size() << std::endl;
+        return false;
+    }
+    return store.scan(key_of(500), key_of(600)).empty();
+}
+
+// Test 4: Reopening keeps the stored shard count, so keys are still found
+bool test_sharded_reopen() {
+    auto env = std::make_shared<MemEnv>();
+    {
+        ShardedStore store("test_sharded_reopen", mem_config(3, env));
+        for (int i = 0; i < 100; i++) {
+            store.put(key_of(i), std::to_string(i));
+        }
+    }
+
+    ShardedStore store("test_sharded_reopen", mem_config(5, env));
+    if (store.num_shards() != 3) {
+        std::cerr << "    Reopened with " << store.num_shards() << " shards" << std::endl;
+        return false;
+    }
+    for (int i = 0; i < 100; i++) {
+        if (store.get(key_of(i)) != std::to_string(i)) {
+            std::cerr << "    " << key_of(i) << " lost on reopen" << std::endl;
+            return false;
+        }
+    }
+    return !fs::exists("test_sharded_reopen") && env->file_exists("test_sharded_reopen/SHARDS");
+}
+
+// Test 5: Writers on several threads flush and compact their shards independently
+bool test_sharded_parallel_writers() {
+    auto env = std::make_shared<MemEnv>();
+    auto config = mem_config(4, env, 4096);
+    config.shard_config.max_compactions_per_flush = 1;
+    ShardedStore store("test_sharded_writers", config);
+
+    const int THREADS = 4;
+    const int KEYS_PER_THREAD = 500;
+    std::vector<std::thread> writers;
+    for (int t = 0; t < THREADS; t++) {
+        writers.emplace_back([&store, t] {
+            for (int i = 0; i < KEYS_PER_THREAD; i++) {
+                store.put(key_of(t * KEYS_PER_THREAD + i), std::string(32, 'a' + t));
+            }
+        });
+    }
+    for (auto& writer : writers) {
+        writer.join();
+    }
+
+    size_t flushes = 0;
+    for (const auto& stats : store.get_shard_stats()) {
+        flushes += stats.memtable_flushes;
+    }
+    std::cout << "    " << flushes << " flushes over " << store.num_shards() << " shards" << std::endl;
+
+    auto all = store.scan(key_of(0), key_of(THREADS * KEYS_PER_THREAD));
+    if (all.size() != THREADS * KEYS_PER_THREAD || !std::is_sorted(all.begin(), all.end())) {
+        std::cerr << "    Scan found " << all.size() << " keys" << std::endl;
+        return false;
+    }
+    for (int t = 0; t < THREADS; t++) {
+        if (store.get(key_of(t * KEYS_PER_THREAD + 7)) != std::string(32, 'a' + t)) {
+            return false;
+        }
+    }
+    return flushes > 0;
+}
+
+// Main test runner
+int sharded_store_tests_main() {
+    std::cout << "\n=== Sharded Store Tests ===" << std::endl;
+    std::cout << "===========================" << std::endl;
+
+    std::vector<std::pair<std::string, bool (*)()>> tests = {
+        {"Routing", test_sharded_routing},
+        {"Batch And MultiGet", test_sharded_batch_and_multi_get},
+        {"Merged Scan", test_sharded_scan},
+        {"Reopen Keeps Shard Count", test_sharded_reopen},
+        {"Parallel Writers", test_sharded_parallel_writers}
+    };
+
+    int passed = 0;
+    int total = static_cast<int>(tests.size());
+
+    for (const auto& [name, test_func] : tests) {
+        try {
+            bool result = test_func();
+            print_test_result(name, result);
+            if (result) passed++;
+        } catch (const std::exception& e) {
+            std::cout << "X " << name << " (Exception: " << e.what() << ")" << std::endl;
+        } catch (...) {
+            std::cout << "X " << name << " (Unknown exception)" << std::endl;
+        }
+    }
+
+    std::cout << "\nResults: " << passed << "/" << total << " tests passed" << std::endl;
+
+    if (passed == total) {
+        std::cout << "\nAll Sharded Store tests passed!" << std::endl;
+        return 0;
+    } else {
+        std::cout << "\nSome Sharded Store tests failed" << std::endl;
+        return 1;
+    }
+}
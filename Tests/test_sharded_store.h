@@ -0,0 +1,6 @@
+#ifndef KVDB_TEST_SHARDED_STORE_H
+#define KVDB_TEST_SHARDED_STORE_H
+
+int sharded_store_tests_main();
+
+#endif // KVDB_TEST_SHARDED_STORE_H
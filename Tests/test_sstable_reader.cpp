@@ -6,6 +6,7 @@
 #include "../SSTableReader.h"
 #include "../SSTableWriter.h"
 #include "../Memtable.h"
+#include "../PrefixExtractor.h"
 #include <iostream>
 #include <fstream>
 #include <vector>
@@ -14,6 +15,7 @@
 #include <chrono>
 #include <cstring>
 #include <random>
+#include <algorithm>
 
 #include "test_helper.h"
 
@@ -127,6 +129,13 @@ bool test_reader_tombstones() {
     success = success && !reader.is_deleted("key2");
     success = success && reader.is_deleted("key3");
 
+    // Test get_entry() - tombstones come back marked, missing keys not at all
+    auto entry1 = reader.get_entry("key1");
+    auto entry2 = reader.get_entry("key2");
+    success = success && entry1 && entry1->is_deleted;
+    success = success && entry2 && !entry2->is_deleted && entry2->value == "value2";
+    success = success && !reader.get_entry("key4").has_value();
+
     // Clean up
     if (fs::exists(filename)) fs::remove(filename);
     return success;
@@ -1001,6 +1010,146 @@ bool test_sstable_reader_scan_range_order() {
     return true;
 }
 
+bool test_reader_prefix_filter() {
+    auto extractor = PrefixExtractor::delimiter(':');
+
+    std::vector<std::pair<std::string, Memtable::Entry>> entries;
+    for (int user = 0; user < 50; ++user) {
+        for (int item = 0; item < 4; ++item) {
+            std::string key = "user" + std::to_string(1000 + user) + ":item" + std::to_string(item);
+            entries.emplace_back(key, Memtable::Entry("v" + std::to_string(item), item == 3));
+        }
+    }
+    std::sort(entries.begin(), entries.end(),
+              [](const auto& a, const auto& b) { return a.first < b.first; });
+
+    const std::string filename = "test_prefix_filter.sst";
+    if (!SSTableWriter::write(filename, entries, SSTableWriter::Options(extractor, 10))) {
+        std::cerr << "  Failed to write SSTable" << std::endl;
+        return false;
+    }
+
+    SSTableReader reader(filename);
+    if (!reader.is_valid() || !reader.has_prefix_filter()) {
+        std::cerr << "  Reader should be valid and carry a prefix filter" << std::endl;
+        fs::remove(filename);
+        return false;
+    }
+
+    // Every written prefix must pass the filter
+    for (int user = 0; user < 50; ++user) {
+        std::string prefix = "user" + std::to_string(1000 + user) + ":";
+        if (!reader.may_contain_prefix(prefix, *extractor)) {
+            std::cerr << "  False negative for prefix " << prefix << std::endl;
+            fs::remove(filename);
+            return false;
+        }
+    }
+
+    // Most absent prefixes should be filtered out
+    int passed_filter = 0;
+    for (int user = 0; user < 1000; ++user) {
+        if (reader.may_contain_prefix("user" + std::to_string(5000 + user) + ":", *extractor)) {
+            passed_filter++;
+        }
+    }
+    if (passed_filter > 50) {
+        std::cerr << "  Too many absent prefixes passed the filter: " << passed_filter << std::endl;
+        fs::remove(filename);
+        return false;
+    }
+
+    // A different extractor cannot use this filter and must not rule anything out
+    auto other = PrefixExtractor::fixed_length(4);
+    if (!reader.may_contain_prefix("zzzz", *other)) {
+        std::cerr << "  Incompatible extractor should not filter" << std::endl;
+        fs::remove(filename);
+        return false;
+    }
+
+    // Prefix scan returns all entries for the prefix, tombstones included
+    auto results = reader.scan_prefix("user1007:");
+    if (results.size() != 4 || results[0].first != "user1007:item0" || !results[3].second.is_deleted) {
+        std::cerr << "  Unexpected prefix scan result, size " << results.size() << std::endl;
+        fs::remove(filename);
+        return false;
+    }
+
+    if (!reader.scan_prefix("user9999:").empty()) {
+        std::cerr << "  Prefix scan for absent prefix should be empty" << std::endl;
+        fs::remove(filename);
+        return false;
+    }
+
+    fs::remove(filename);
+    return true;
+}
+
+bool test_reader_version1_compatibility() {
+    // Hand-write a version 1 file (no meta section, no footer)
+    const std::string filename = "test_version1.sst";
+    std::vector<std::pair<std::string, std::string>> kvs = {{"alpha", "1"}, {"beta", "22"}, {"gamma", "333"}};
+
+    {
+        std::ofstream file(filename, std::ios::binary);
+        uint64_t magic = SSTableWriter::MAGIC;
+        uint32_t version = 1;
+        uint32_t entry_count = static_cast<uint32_t>(kvs.size());
+        uint64_t data_offset = 24;
+        for (const auto& [key, value] : kvs) {
+            data_offset += sizeof(uint32_t) + key.size() + sizeof(uint64_t) + sizeof(uint32_t) + sizeof(uint8_t);
+        }
+
+        file.write(reinterpret_cast<const char*>(&magic), sizeof(magic));
+        file.write(reinterpret_cast<const char*>(&version), sizeof(version));
+        file.write(reinterpret_cast<const char*>(&entry_count), sizeof(entry_count));
+        file.write(reinterpret_cast<const char*>(&data_offset), sizeof(data_offset));
+
+        uint64_t value_offset = data_offset;
+        for (const auto& [key, value] : kvs) {
+            uint32_t key_len = static_cast<uint32_t>(key.size());
+            uint32_t value_len = static_cast<uint32_t>(value.size());
+            uint8_t tombstone = 0;
+            file.write(reinterpret_cast<const char*>(&key_len), sizeof(key_len));
+            file.write(key.data(), key_len);
+            file.write(reinterpret_cast<const char*>(&value_offset), sizeof(value_offset));
+            file.write(reinterpret_cast<const char*>(&value_len), sizeof(value_len));
+            file.write(reinterpret_cast<const char*>(&tombstone), sizeof(tombstone));
+            value_offset += value_len;
+        }
+        for (const auto& [key, value] : kvs) {
+            file.write(value.data(), static_cast<std::streamsize>(value.size()));
+        }
+    }
+
+    SSTableReader reader(filename);
+    if (!reader.is_valid() || reader.get_version() != 1 || reader.has_prefix_filter()) {
+        std::cerr << "  Version 1 file not loaded correctly" << std::endl;
+        fs::remove(filename);
+        return false;
+    }
+
+    for (const auto& [key, value] : kvs) {
+        auto result = reader.get(key);
+        if (!result || *result != value) {
+            std::cerr << "  Wrong value for " << key << std::endl;
+            fs::remove(filename);
+            return false;
+        }
+    }
+
+    // Without a filter nothing can be ruled out
+    auto extractor = PrefixExtractor::fixed_length(2);
+    if (!reader.may_contain_prefix("zz", *extractor)) {
+        std::cerr << "  Table without filter should not rule out prefixes" << std::endl;
+        fs::remove(filename);
+        return false;
+    }
+
+    fs::remove(filename);
+    return true;
+}
+
 // Main test runner
 int sstable_reader_tests_main() {
     std::cout << "Running SSTable Reader Tests" << std::endl;
@@ -1021,7 +1170,9 @@ int sstable_reader_tests_main() {
         {"Range Scan with Deletes", test_sstable_reader_scan_range_with_deletes},
         {"Range Scan Edge Cases", test_sstable_reader_scan_range_edge_cases},
         {"Range Scan Performance", test_sstable_reader_scan_range_performance},
-        {"Range Scan Order", test_sstable_reader_scan_range_order}
+        {"Range Scan Order", test_sstable_reader_scan_range_order},
+        {"Prefix Filter", test_reader_prefix_filter},
+        {"Version 1 Compatibility", test_reader_version1_compatibility}
     };
 
     int passed = 0;
@@ -31,6 +31,8 @@ bool test_sstable_reader_scan_range_with_deletes();
 bool test_sstable_reader_scan_range_edge_cases();
 bool test_sstable_reader_scan_range_performance();
 bool test_sstable_reader_scan_range_order();
+bool test_reader_prefix_filter();
+bool test_reader_version1_compatibility();
 
 // Helper functions
 bool validate_reader_memory_usage(const std::string& filename);
@@ -0,0 +1,259 @@
+#include "test_stats_dumper.h"
+#include "../StatsDumper.h"
+#include "../LSMTree.h"
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <thread>
+#include <chrono>
+#include <algorithm>
+#include <filesystem>
+
+#include "test_helper.h"
+
+namespace fs = std::filesystem;
+using namespace std::chrono;
+
+namespace {
+    std::vector<std::string> read_lines(const std::string& path) {
+        std::vector<std::string> lines;
+        std::ifstream in(path);
+        std::string line;
+        while (std::getline(in, line)) {
+            lines.push_back(line);
+        }
+        return lines;
+    }
+
+    bool contains(const std::string& text, const std::string& part) {
+        if (text.find(part) == std::string::npos) {
+            std::cerr << "    Missing: " << part << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+    // Number following "key": in a JSON line, or -1
+    long long json_number(const std::string& line, const std::string& key) {
+        auto pos = line.find(key);
+        if (pos == std::string::npos) {
+            return -1;
+        }
+        return std::stoll(line.substr(pos + key.size()));
+    }
+}
+
+// Test 1: Interval histograms only hold the values recorded since the earlier snapshot
+bool test_stats_dumper_histogram_interval() {
+    Histogram before;
+    for (uint64_t v = 1; v <= 1000; v++) {
+        before.add(v);
+    }
+    Histogram after = before;
+    for (int i = 0; i < 100; i++) {
+        after.add(1000000);
+    }
+
+    Histogram interval = after;
+    interval.subtract(before);
+    if (interval.count() != 100 || interval.sum() != 100 * 1000000ULL) {
+        std::cerr << "    Interval count " << interval.count() << " sum " << interval.sum() << std::endl;
+        return false;
+    }
+    // Bucket bounds are within 1/16 of the value
+    if (interval.min() < 1000000 - 1000000 / 16 || interval.max() != 1000000 || interval.percentile(50.0) < interval.min()) {
+        std::cerr << "    Interval bounds " << interval.min() << " - " << interval.max() << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// Test 2: Both formats carry cumulative and interval values
+bool test_stats_dumper_formats() {
+    MetricsSnapshot previous;
+    previous.time = system_clock::time_point(milliseconds(1000000));
+    previous.counters["puts"] = 6;
+    previous.histograms["latency_ns{op=\"get\"}"].add(100);
+
+    MetricsSnapshot current;
+    current.time = previous.time + milliseconds(1500);
+    current.counters["puts"] = 10;
+    current.gauges["level_files{level=\"0\"}"] = 3;
+    current.gauges["buffer_pool_hit_rate"] = 0.75;
+    current.histograms["latency_ns{op=\"get\"}"] = previous.histograms["latency_ns{op=\"get\"}"];
+    current.histograms["latency_ns{op=\"get\"}"].add(200);
+    current.histograms["latency_ns{op=\"get\"}"].add(200);
+
+    std::string prom = StatsDumper::to_prometheus(current, previous);
+    bool ok = contains(prom, "# TYPE kvdb_puts_total counter\nkvdb_puts_total 10\n")
+        && contains(prom, "kvdb_puts_interval 4\n")
+        && contains(prom, "kvdb_interval_seconds 1.5\n")
+        && contains(prom, "# TYPE kvdb_level_files gauge\nkvdb_level_files{level=\"0\"} 3\n")
+        && contains(prom, "kvdb_buffer_pool_hit_rate 0.75\n")
+        && contains(prom, "# TYPE kvdb_latency_ns summary\n")
+        && contains(prom, "kvdb_latency_ns{op=\"get\",quantile=\"0.99\"} 200\n")
+        && contains(prom, "kvdb_latency_ns_count{op=\"get\"} 3\n")
+        && contains(prom, "kvdb_latency_ns_interval_count{op=\"get\"} 2\n")
+        && contains(prom, "kvdb_latency_ns_interval_sum{op=\"get\"} 400\n");
+
+    std::string json = StatsDumper::to_json_line(current, previous);
+    ok = ok && contains(json, "\"interval_ms\":1500")
+        && contains(json, "\"puts\":{\"total\":10,\"interval\":4}")
+        && contains(json, "\"level_files{level=\\\"0\\\"}\":3")
+        && contains(json, "\"count\":3,")
+        && contains(json, "\"interval\":{\"count\":2,\"sum\":400,")
+        && json.back() == '\n' && std::count(json.begin(), json.end(), '\n') == 1;
+
+    // The first dump has nothing to compare with
+    std::string first = StatsDumper::to_prometheus(current, std::nullopt);
+    if (ok && first.find("_interval") != std::string::npos) {
+        std::cerr << "    Interval values without a previous dump" << std::endl;
+        ok = false;
+    }
+
+    // Series of one family that sort apart still share a single TYPE line
+    MetricsSnapshot split;
+    split.gauges["x"] = 1;
+    split.gauges["x_y"] = 2;
+    split.gauges["x{a=\"1\"}"] = 3;
+    std::string grouped = StatsDumper::to_prometheus(split, std::nullopt);
+    size_t x_types = 0;
+    for (size_t pos = grouped.find("# TYPE kvdb_x gauge\n"); pos != std::string::npos;
+         pos = grouped.find("# TYPE kvdb_x gauge\n", pos + 1)) {
+        x_types++;
+    }
+    if (ok && (x_types != 1 || !contains(grouped, "# TYPE kvdb_x gauge\nkvdb_x 1\nkvdb_x{a=\"1\"} 3\n"))) {
+        std::cerr << "    Family x printed " << x_types << " TYPE lines" << std::endl;
+        ok = false;
+    }
+    return ok;
+}
+
+// Test 3: LSMTree appends a JSON line every period, intervals add up to the totals
+bool test_stats_dumper_lsm_periodic() {
+    std::string data_dir = "test_stats_dumper_periodic";
+    fs::remove_all(data_dir);
+
+    const int writes = 400;
+    {
+        LSMTree::Config config(4096, 1024 * 1024, 10);
+        config.level_config.level0_max_sstables = 2;
+        config.stats_dump_period = milliseconds(20);
+        config.stats_dump_format = MetricsFormat::JSON_LINES;
+        LSMTree lsm(data_dir, config);
+        for (int i = 0; i < writes; ++i) {
+            lsm.put("key" + std::to_string(1000 + i), std::string(40, 'v'));
+            if (i % 100 == 0) {
+                std::this_thread::sleep_for(milliseconds(30));
+            }
+        }
+        lsm.get("key1000");
+    }
+
+    auto lines = read_lines(data_dir + "/metrics.jsonl");
+    fs::remove_all(data_dir);
+
+    if (lines.size() < 3) {
+        std::cerr << "    Only " << lines.size() << " dumps" << std::endl;
+        return false;
+    }
+    long long interval_sum = 0;
+    for (const auto& line : lines) {
+        interval_sum += json_number(line, "\"puts\":{\"total\":" + std::to_string(json_number(line, "\"puts\":{\"total\":"))
+                                    + ",\"interval\":");
+    }
+    const std::string& last = lines.back();
+    if (json_number(last, "\"puts\":{\"total\":") != writes || interval_sum != writes) {
+        std::cerr << "    Puts total " << json_number(last, "\"puts\":{\"total\":") << ", intervals add to "
+                  << interval_sum << std::endl;
+        return false;
+    }
+    return contains(last, "\"level_files{level=\\\"1\\\"}\":")
+        && contains(last, "\"memtable_capacity_bytes\":4096")
+        && contains(last, "\"buffer_pool_hit_rate\":")
+        && contains(last, "\"latency_ns{op=\\\"put\\\"}\":{\"count\":400,");
+}
+
+// Test 4: The Prometheus file is replaced by each dump and readable while writers run
+bool test_stats_dumper_lsm_prometheus() {
+    std::string data_dir = "test_stats_dumper_prometheus";
+    fs::remove_all(data_dir);
+
+    bool ok = true;
+    {
+        LSMTree::Config config(4096, 1024 * 1024, 10);
+        config.stats_dump_period = milliseconds(5);
+        LSMTree lsm(data_dir, config);
+
+        std::vector<std::thread> writers;
+        for (int t = 0; t < 4; ++t) {
+            writers.emplace_back([&lsm, t] {
+                for (int i = 0; i < 500; ++i) {
+                    lsm.put("t" + std::to_string(t) + "_" + std::to_string(i), "value");
+                }
+            });
+        }
+        for (int i = 0; i < 20 && ok; ++i) {
+            std::ifstream in(data_dir + "/metrics.prom");
+            std::stringstream text;
+            text << in.rdbuf();
+            if (!text.str().empty() && text.str().find("kvdb_memtable_entries ") == std::string::npos) {
+                std::cerr << "    Read a partial metrics file" << std::endl;
+                ok = false;
+            }
+            std::this_thread::sleep_for(milliseconds(2));
+        }
+        for (auto& writer : writers) {
+            writer.join();
+        }
+    }
+
+    std::ifstream in(data_dir + "/metrics.prom");
+    std::stringstream text;
+    text << in.rdbuf();
+    fs::remove_all(data_dir);
+
+    return ok && contains(text.str(), "kvdb_puts_total 2000\n")
+        && contains(text.str(), "# TYPE kvdb_puts_interval gauge\n")
+        && contains(text.str(), "kvdb_level_bytes{level=\"0\"} ");
+}
+
+// Main test runner
+int stats_dumper_tests_main() {
+    std::cout << "\n=== Stats Dumper Tests ===" << std::endl;
+    std::cout << "==========================" << std::endl;
+
+    std::vector<std::pair<std::string, bool (*)()>> tests = {
+        {"Histogram Interval", test_stats_dumper_histogram_interval},
+        {"Output Formats", test_stats_dumper_formats},
+        {"LSM Periodic JSON Lines", test_stats_dumper_lsm_periodic},
+        {"LSM Prometheus File", test_stats_dumper_lsm_prometheus}
+    };
+
+    int passed = 0;
+    int total = static_cast<int>(tests.size());
+
+    for (const auto& [name, test_func] : tests) {
+        try {
+            bool result = test_func();
+            print_test_result(name, result);
+            if (result) passed++;
+        } catch (const std::exception& e) {
+            std::cout << "X " << name << " (Exception: " << e.what() << ")" << std::endl;
+        } catch (...) {
+            std::cout << "X " << name << " (Unknown exception)" << std::endl;
+        }
+    }
+
+    std::cout << "\nResults: " << passed << "/" << total << " tests passed" << std::endl;
+
+    if (passed == total) {
+        std::cout << "\nAll Stats Dumper tests passed!" << std::endl;
+        return 0;
+    } else {
+        std::cout << "\nSome Stats Dumper tests failed" << std::endl;
+        return 1;
+    }
+}
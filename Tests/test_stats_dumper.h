@@ -0,0 +1,6 @@
+#ifndef KVDB_TEST_STATS_DUMPER_H
+#define KVDB_TEST_STATS_DUMPER_H
+
+int stats_dumper_tests_main();
+
+#endif // KVDB_TEST_STATS_DUMPER_H
@@ -0,0 +1,315 @@
+#include "test_thread_pool.h"
+#include "../ThreadPool.h"
+#include "../LSMTree.h"
+#include "../MemEnv.h"
+#include "../Logger.h"
+#include <iostream>
+#include <string>
+#include <vector>
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+#include "test_helper.h"
+
+using namespace std::chrono;
+
+namespace {
+    // Spin until flag is set or the timeout passes
+    bool wait_for(const std::atomic<bool>& flag, milliseconds timeout = milliseconds(5000)) {
+        auto deadline = steady_clock::now() + timeout;
+        while (!flag.load()) {
+            if (steady_clock::now() > deadline) {
+                return false;
+            }
+            std::this_thread::sleep_for(milliseconds(1));
+        }
+        return true;
+    }
+}
+
+// Test 1: Every job runs once, wait_idle returns after the last one and a failed job is logged
+bool test_thread_pool_runs_all() {
+    auto env = std::make_shared<MemEnv>();
+    ThreadPool::Options options(2, 3);
+    options.logger = std::make_shared<Logger>("pool_log", Logger::Options(), env);
+
+    bool ok = false;
+    {
+        ThreadPool pool(options);
+        std::atomic<int> high{0};
+        std::atomic<int> low{0};
+        for (int i = 0; i < 200; i++) {
+            pool.schedule(ThreadPool::HIGH, [&high] { high++; });
+            pool.schedule(ThreadPool::LOW, [&low] { low++; });
+        }
+        pool.schedule(ThreadPool::LOW, [] { throw std::runtime_error("expected test failure"); });
+        pool.wait_idle();
+
+        auto high_stats = pool.get_stats(ThreadPool::HIGH);
+        auto low_stats = pool.get_stats(ThreadPool::LOW);
+        ok = high == 200 && low == 200 &&
+             high_stats.completed == 200 && low_stats.completed == 201 &&
+             high_stats.queue_depth == 0 && low_stats.running == 0 &&
+             pool.thread_count(ThreadPool::HIGH) == 2 && pool.thread_count(ThreadPool::LOW) == 3;
+    }
+
+    // The logger writes out its ring when the last owner drops it
+    options.logger.reset();
+    std::string log;
+    env->read_file("pool_log", log);
+    if (log.find("Background job failed: expected test failure") == std::string::npos) {
+        std::cerr << "    Failed job not logged" << std::endl;
+        return false;
+    }
+    return ok;
+}
+
+// Test 2: A flush-like job runs while every low priority worker is busy
+bool test_thread_pool_high_not_blocked_by_low() {
+    ThreadPool pool(ThreadPool::Options(1, 1));
+    std::atomic<bool> release{false};
+    std::atomic<bool> low_started{false};
+    std::atomic<bool> high_done{false};
+
+    pool.schedule(ThreadPool::LOW, [&] {
+        low_started = true;
+        wait_for(release);
+    });
+    wait_for(low_started);
+    pool.schedule(ThreadPool::HIGH, [&] { high_done = true; });
+
+    bool ok = wait_for(high_done, milliseconds(2000));
+    release = true;
+    pool.wait_idle();
+    if (!ok) {
+        std::cerr << "    High priority job waited on a low priority one" << std::endl;
+    }
+    return ok;
+}
+
+// Test 3: Idle workers steal queued jobs, low workers take high priority ones too
+bool test_thread_pool_work_stealing() {
+    ThreadPool pool(ThreadPool::Options(1, 2));
+    std::atomic<bool> release{false};
+    std::atomic<bool> blocked_low{false};
+    std::atomic<bool> blocked_high{false};
+    std::atomic<int> done{0};
+
+    // Low jobs alternate between the two low workers, so the third one lands behind the blocked first
+    pool.schedule(ThreadPool::LOW, [&] {
+        blocked_low = true;
+        wait_for(release);
+    });
+    wait_for(blocked_low);
+    pool.schedule(ThreadPool::LOW, [&] { done++; });
+    pool.schedule(ThreadPool::LOW, [&] { done++; });
+
+    // The only high worker is stuck, the free low worker picks up its queue
+    pool.schedule(ThreadPool::HIGH, [&] {
+        blocked_high = true;
+        wait_for(release);
+    });
+    wait_for(blocked_high);
+    pool.schedule(ThreadPool::HIGH, [&] { done++; });
+
+    auto deadline = steady_clock::now() + milliseconds(5000);
+    while (done < 3 && steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(milliseconds(1));
+    }
+    bool all_done = done == 3;
+    release = true;
+    pool.wait_idle();
+
+    auto high_stats = pool.get_stats(ThreadPool::HIGH);
+    auto low_stats = pool.get_stats(ThreadPool::LOW);
+    std::cout << "    stolen: high " << high_stats.stolen << ", low " << low_stats.stolen << std::endl;
+    return all_done && high_stats.stolen >= 1 && low_stats.stolen >= 1;
+}
+
+// Test 4: Wait times are recorded for every job that ran
+bool test_thread_pool_wait_metrics() {
+    ThreadPool pool(ThreadPool::Options(1, 1));
+    std::atomic<bool> release{false};
+    std::atomic<bool> started{false};
+    pool.schedule(ThreadPool::LOW, [&] {
+        started = true;
+        wait_for(release);
+    });
+    wait_for(started);
+    for (int i = 0; i < 5; i++) {
+        pool.schedule(ThreadPool::LOW, [] {});
+    }
+
+    // The queued jobs wait behind the blocked one, and low workers never leave the pool
+    std::this_thread::sleep_for(milliseconds(20));
+    auto busy = pool.get_stats(ThreadPool::LOW);
+    release = true;
+    pool.wait_idle();
+
+    auto stats = pool.get_stats(ThreadPool::LOW);
+    std::cout << "    queue depth while blocked " << busy.queue_depth << ", max wait "
+              << stats.wait_ns.max() / 1000 << " us" << std::endl;
+    return busy.queue_depth == 5 && busy.running == 1 &&
+           stats.wait_ns.count() == 6 && stats.wait_ns.max() >= 20 * 1000 * 1000;
+}
+
+// Test 5: A tree on an executor flushes and compacts in the background and loses nothing
+bool test_lsm_on_thread_pool() {
+    auto env = std::make_shared<MemEnv>();
+    auto pool = std::make_shared<ThreadPool>(ThreadPool::Options(1, 2));
+
+    LSMTree::Config config(4096);
+    config.env = env;
+    config.executor = pool;
+    const int NUM_KEYS = 2000;
+    {
+        LSMTree lsm("test_thread_pool_lsm", config);
+        for (int i = 0; i < NUM_KEYS; i++) {
+            lsm.put("key" + std::to_string(i), "value" + std::to_string(i));
+            if (i % 3 == 0) {
+                lsm.get("key" + std::to_string(i / 2));
+            }
+        }
+        lsm.wait_for_background_jobs();
+
+        auto stats = lsm.get_stats();
+        auto metrics = lsm.get_metrics();
+        std::cout << "    " << stats.memtable_flushes << " flushes, " << stats.compactions << " compactions in the background"
+                  << std::endl;
+        if (stats.memtable_flushes == 0 || stats.compactions == 0 ||
+            metrics.gauges.count("executor_queue_depth{priority=\"high\"}") == 0 ||
+            metrics.histograms.count("executor_wait_ns{priority=\"low\"}") == 0) {
+            std::cerr << "    Work or metrics missing" << std::endl;
+            return false;
+        }
+        for (int i = 0; i < NUM_KEYS; i += 7) {
+            if (lsm.get("key" + std::to_string(i)) != "value" + std::to_string(i)) {
+                std::cerr << "    key" << i << " lost" << std::endl;
+                return false;
+            }
+        }
+    }
+
+    // Reopen, everything queued before the close made it to disk
+    LSMTree lsm("test_thread_pool_lsm", config);
+    for (int i = 0; i < NUM_KEYS; i += 7) {
+        if (lsm.get("key" + std::to_string(i)) != "value" + std::to_string(i)) {
+            std::cerr << "    key" << i << " lost on reopen" << std::endl;
+            return false;
+        }
+    }
+    return lsm.scan("key", "key~").size() == NUM_KEYS;
+}
+
+// Test 6: Writers stop once level 0 outgrows background compaction, and every queued trigger is honoured
+bool test_lsm_level0_stop() {
+    class StallListener : public EventListener {
+    public:
+        std::atomic<bool> stopped{false};
+        std::atomic<bool> delayed{false};
+        void on_stall_conditions_changed(const WriteStallInfo& info) override {
+            if (info.current == WriteStallCondition::STOPPED) stopped = true;
+            if (info.current == WriteStallCondition::DELAYED) delayed = true;
+        }
+    };
+
+    auto env = std::make_shared<MemEnv>();
+    auto pool = std::make_shared<ThreadPool>(ThreadPool::Options(1, 1));
+    auto listener = std::make_shared<StallListener>();
+
+    LSMTree::Config config(4096);
+    config.env = env;
+    config.executor = pool;
+    config.level0_slowdown_writes_trigger = 3;
+    config.level0_stop_writes_trigger = 4;
+    config.listeners.push_back(listener);
+    LSMTree lsm("test_thread_pool_stall", config);
+
+    // The only low priority worker is busy, so nothing compacts level 0 for now
+    std::atomic<bool> release{false};
+    std::atomic<bool> blocked{false};
+    pool->schedule(ThreadPool::LOW, [&] {
+        blocked = true;
+        wait_for(release);
+    });
+    wait_for(blocked);
+
+    const int NUM_KEYS = 3000;
+    std::atomic<bool> writer_done{false};
+    std::thread writer([&] {
+        for (int i = 0; i < NUM_KEYS; i++) {
+            lsm.put("key" + std::to_string(i), std::string(100, 'v'));
+        }
+        writer_done = true;
+    });
+
+    // Level 0 fills up to the stop trigger, then stays there with the writer waiting
+    auto deadline = steady_clock::now() + milliseconds(5000);
+    while (lsm.get_level_sizes()[0] < 4 && steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(milliseconds(1));
+    }
+    std::this_thread::sleep_for(milliseconds(50));
+    bool stopped = listener->stopped;
+    bool held = !writer_done;
+    size_t level0 = lsm.get_level_sizes()[0];
+    release = true;
+    writer.join();
+    lsm.wait_for_background_jobs();
+    pool->wait_idle();
+
+    auto sizes = lsm.get_level_sizes();
+    std::cout << "    level 0 held at " << level0 << " tables, " << sizes[0] << " left after the release" << std::endl;
+    // A flush queued before the stop may still land on top
+    if (!stopped || !held || !listener->delayed || level0 < 4 || level0 > 5) {
+        std::cerr << "    Writer was not held back" << std::endl;
+        return false;
+    }
+
+    // The triggers queued while compaction was blocked still ran
+    if (sizes[0] >= 2) {
+        std::cerr << "    Compaction trigger lost" << std::endl;
+        return false;
+    }
+    return lsm.get("key" + std::to_string(NUM_KEYS - 1)).has_value() && lsm.get("key0").has_value();
+}
+
+// Main test runner
+int thread_pool_tests_main() {
+    std::cout << "\n=== Thread Pool Tests ===" << std::endl;
+    std::cout << "=========================" << std::endl;
+
+    std::vector<std::pair<std::string, bool (*)()>> tests = {
+        {"Runs All Jobs", test_thread_pool_runs_all},
+        {"High Priority Not Blocked By Low", test_thread_pool_high_not_blocked_by_low},
+        {"Work Stealing", test_thread_pool_work_stealing},
+        {"Wait Metrics", test_thread_pool_wait_metrics},
+        {"LSMTree On Thread Pool", test_lsm_on_thread_pool},
+        {"Level 0 Stops Writers", test_lsm_level0_stop}
+    };
+
+    int passed = 0;
+    int total = static_cast<int>(tests.size());
+
+    for (const auto& [name, test_func] : tests) {
+        try {
+            bool result = test_func();
+            print_test_result(name, result);
+            if (result) passed++;
+        } catch (const std::exception& e) {
+            std::cout << "X " << name << " (Exception: " << e.what() << ")" << std::endl;
+        } catch (...) {
+            std::cout << "X " << name << " (Unknown exception)" << std::endl;
+        }
+    }
+
+    std::cout << "\nResults: " << passed << "/" << total << " tests passed" << std::endl;
+
+    if (passed == total) {
+        std::cout << "\nAll Thread Pool tests passed!" << std::endl;
+        return 0;
+    } else {
+        std::cout << "\nSome Thread Pool tests failed" << std::endl;
+        return 1;
+    }
+}
@@ -0,0 +1,6 @@
+#ifndef KVDB_TEST_THREAD_POOL_H
+#define KVDB_TEST_THREAD_POOL_H
+
+int thread_pool_tests_main();
+
+#endif // KVDB_TEST_THREAD_POOL_H
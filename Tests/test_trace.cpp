@@ -0,0 +1,315 @@
+#include "test_trace.h"
+#include "../Tracer.h"
+#include "../TraceReplayer.h"
+#include "../LSMTree.h"
+#include <iostream>
+#include <string>
+#include <vector>
+#include <map>
+#include <set>
+#include <algorithm>
+#include <thread>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+
+#include "test_helper.h"
+
+namespace fs = std::filesystem;
+using namespace std::chrono;
+
+namespace {
+    // Every live key with the size of its value
+    std::map<std::string, size_t> contents(LSMTree& lsm) {
+        std::map<std::string, size_t> result;
+        for (const auto& [key, value] : lsm.scan("", "~")) {
+            result[key] = value.size();
+        }
+        return result;
+    }
+}
+
+// Test 1: Every traced call comes back from the file with its arguments
+bool test_trace_round_trip() {
+    std::string data_dir = "test_trace_round_trip";
+    fs::remove_all(data_dir);
+    fs::create_directories(data_dir);
+    std::string trace_path = data_dir + "/ops.trace";
+
+    {
+        LSMTree lsm(data_dir + "/db", LSMTree::Config(64 * 1024));
+        lsm.put("untraced", "value");
+        if (!lsm.start_trace(trace_path) || lsm.start_trace(trace_path)) {
+            std::cerr << "    A second trace started" << std::endl;
+            return false;
+        }
+
+        lsm.put("apple", std::string(300, 'a'));
+        lsm.get("apple");
+        lsm.scan("a", "b");
+        WriteBatch batch;
+        batch.put("banana", std::string(7, 'b'));
+        batch.remove("apple");
+        lsm.write(batch);
+        lsm.remove("banana");
+        lsm.scan_prefix("ban");
+        lsm.end_trace();
+        lsm.get("after");
+    }
+
+    auto records = TraceReader::read_all(trace_path);
+    fs::remove_all(data_dir);
+
+    if (records.size() != 6) {
+        std::cerr << "    Read " << records.size() << " records" << std::endl;
+        return false;
+    }
+    const auto& put = records[0];
+    const auto& batch = records[3];
+    bool ok = put.op == TraceOp::PUT && put.key == "apple" && put.value_size == 300
+        && records[1].op == TraceOp::GET && records[1].key == "apple"
+        && records[2].op == TraceOp::SCAN && records[2].key == "a" && records[2].end_key == "b"
+        && batch.op == TraceOp::WRITE_BATCH && batch.batch.size() == 2
+        && batch.batch[0].op == TraceOp::PUT && batch.batch[0].key == "banana" && batch.batch[0].value_size == 7
+        && batch.batch[1].op == TraceOp::REMOVE && batch.batch[1].key == "apple"
+        && records[4].op == TraceOp::REMOVE && records[4].key == "banana"
+        && records[5].op == TraceOp::SCAN_PREFIX && records[5].key == "ban";
+    for (size_t i = 1; i < records.size(); i++) {
+        ok = ok && records[i].timestamp_us >= records[i - 1].timestamp_us;
+    }
+    if (!ok) {
+        std::cerr << "    Records don't match the calls" << std::endl;
+    }
+    return ok;
+}
+
+// Test 2: Concurrent callers are all traced, each thread's calls in its own order
+bool test_trace_threads() {
+    std::string data_dir = "test_trace_threads";
+    fs::remove_all(data_dir);
+    fs::create_directories(data_dir);
+    std::string trace_path = data_dir + "/ops.trace";
+
+    const int threads = 4;
+    const int per_thread = 500;
+    {
+        LSMTree lsm(data_dir + "/db", LSMTree::Config(64 * 1024));
+        lsm.start_trace(trace_path);
+        std::vector<std::thread> workers;
+        for (int t = 0; t < threads; ++t) {
+            workers.emplace_back([&lsm, t] {
+                for (int i = 0; i < per_thread; ++i) {
+                    lsm.put("t" + std::to_string(t) + "_" + std::to_string(10000 + i), "value");
+                }
+            });
+        }
+        for (auto& worker : workers) {
+            worker.join();
+        }
+    }
+    // Closing the tree ends the trace
+
+    auto records = TraceReader::read_all(trace_path);
+    fs::remove_all(data_dir);
+
+    std::map<uint32_t, std::vector<std::string>> by_thread;
+    for (const auto& record : records) {
+        by_thread[record.thread].push_back(record.key);
+    }
+    if (records.size() != threads * per_thread || by_thread.size() != threads) {
+        std::cerr << "    " << records.size() << " records from " << by_thread.size() << " threads" << std::endl;
+        return false;
+    }
+    for (const auto& [thread, keys] : by_thread) {
+        if (!std::is_sorted(keys.begin(), keys.end()) || keys.front().substr(0, 2) != keys.back().substr(0, 2)) {
+            std::cerr << "    Thread " << thread << " calls out of order" << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+// Test 3: Replaying a trace into a fresh tree rebuilds the same keys and value sizes.
+// The memtable holds everything, so the comparison doesn't depend on flush timing
+bool test_trace_replay() {
+    std::string data_dir = "test_trace_replay";
+    fs::remove_all(data_dir);
+    fs::create_directories(data_dir);
+    std::string trace_path = data_dir + "/ops.trace";
+
+    std::map<std::string, size_t> expected;
+    {
+        LSMTree lsm(data_dir + "/source", LSMTree::Config(1024 * 1024));
+        lsm.start_trace(trace_path);
+        std::vector<std::thread> workers;
+        for (int t = 0; t < 3; ++t) {
+            workers.emplace_back([&lsm, t] {
+                for (int i = 0; i < 300; ++i) {
+                    std::string key = "t" + std::to_string(t) + "_" + std::to_string(1000 + i);
+                    lsm.put(key, std::string(static_cast<size_t>(10 + i % 50), 'x'));
+                    if (i % 7 == 0) {
+                        lsm.remove(key);
+                    }
+                    if (i % 11 == 0) {
+                        lsm.get(key);
+                        WriteBatch batch;
+                        batch.put(key + "_b", std::string(static_cast<size_t>(i), 'y'));
+                        lsm.write(batch);
+                    }
+                }
+            });
+        }
+        for (auto& worker : workers) {
+            worker.join();
+        }
+        lsm.end_trace();
+        expected = contents(lsm);
+    }
+
+    auto records = TraceReader::read_all(trace_path);
+    bool ok = !records.empty();
+    for (int threads : {1, 4}) {
+        std::string replay_dir = data_dir + "/replay" + std::to_string(threads);
+        LSMTree lsm(replay_dir, LSMTree::Config(1024 * 1024));
+        auto result = TraceReplayer(lsm).replay(records, TraceReplayer::Options(threads, 0.0));
+        std::cout << "    " << threads << " threads: " << result.ops << " calls in "
+                  << static_cast<int>(result.seconds * 1000) << " ms" << std::endl;
+
+        if (result.ops != records.size() || result.failed != 0
+            || result.latency[static_cast<size_t>(TraceOp::PUT)].count() != 900
+            || contents(lsm) != expected) {
+            std::cerr << "    Replay with " << threads << " threads diverged" << std::endl;
+            ok = false;
+        }
+    }
+
+    fs::remove_all(data_dir);
+    return ok;
+}
+
+// Test 4: Replays keep the traced pace unless sped up, and traces stop at their size limit
+bool test_trace_timing_and_limit() {
+    std::string data_dir = "test_trace_timing";
+    fs::remove_all(data_dir);
+    fs::create_directories(data_dir);
+    std::string trace_path = data_dir + "/ops.trace";
+    std::string limited_path = data_dir + "/limited.trace";
+
+    uint64_t limited_records = 0;
+    {
+        LSMTree lsm(data_dir + "/source", LSMTree::Config(64 * 1024));
+        lsm.start_trace(trace_path);
+        lsm.put("first", "value");
+        std::this_thread::sleep_for(milliseconds(100));
+        lsm.put("second", "value");
+        lsm.end_trace();
+
+        lsm.start_trace(limited_path, Tracer::Options(256));
+        for (int i = 0; i < 100; ++i) {
+            lsm.get("key" + std::to_string(i));
+        }
+        lsm.end_trace();
+        limited_records = TraceReader::read_all(limited_path).size();
+    }
+
+    auto records = TraceReader::read_all(trace_path);
+    double traced_pace = 0;
+    double fast_pace = 0;
+    {
+        LSMTree lsm(data_dir + "/paced", LSMTree::Config(64 * 1024));
+        traced_pace = TraceReplayer(lsm).replay(records, TraceReplayer::Options(1, 1.0)).seconds;
+    }
+    {
+        LSMTree lsm(data_dir + "/fast", LSMTree::Config(64 * 1024));
+        fast_pace = TraceReplayer(lsm).replay(records, TraceReplayer::Options(1, 0.0)).seconds;
+    }
+    fs::remove_all(data_dir);
+
+    std::cout << "    Traced pace " << traced_pace * 1000 << " ms, unpaced " << fast_pace * 1000 << " ms" << std::endl;
+    if (traced_pace < 0.095 || fast_pace > 0.05) {
+        std::cerr << "    Replay timing off" << std::endl;
+        return false;
+    }
+    if (limited_records == 0 || limited_records >= 100) {
+        std::cerr << "    Size limit kept " << limited_records << " records" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// Test 5: A record claiming a key longer than the file is rejected, not allocated
+bool test_trace_corrupt_length() {
+    std::string data_dir = "test_trace_corrupt";
+    fs::remove_all(data_dir);
+    fs::create_directories(data_dir);
+    std::string trace_path = data_dir + "/ops.trace";
+
+    {
+        LSMTree lsm(data_dir + "/db", LSMTree::Config(64 * 1024));
+        lsm.start_trace(trace_path);
+        lsm.get("key");
+        lsm.end_trace();
+    }
+
+    // GET, thread 0, time 0, then a key length of 2^62
+    {
+        std::ofstream file(trace_path, std::ios::binary | std::ios::app);
+        file.put(static_cast<char>(TraceOp::GET));
+        file.put(0);
+        file.put(0);
+        for (int i = 0; i < 8; ++i) {
+            file.put(static_cast<char>(0x80));
+        }
+        file.put(0x40);
+    }
+
+    bool ok = true;
+    try {
+        auto records = TraceReader::read_all(trace_path);
+        ok = records.size() == 1 && records[0].key == "key";
+    } catch (const std::exception& e) {
+        std::cerr << "    Reader threw: " << e.what() << std::endl;
+        ok = false;
+    }
+    fs::remove_all(data_dir);
+    return ok;
+}
+
+// Main test runner
+int trace_tests_main() {
+    std::cout << "\n=== Trace Tests ===" << std::endl;
+    std::cout << "===================" << std::endl;
+
+    std::vector<std::pair<std::string, bool (*)()>> tests = {
+        {"Round Trip", test_trace_round_trip},
+        {"Concurrent Callers", test_trace_threads},
+        {"Replay Rebuilds Data", test_trace_replay},
+        {"Replay Timing And Size Limit", test_trace_timing_and_limit},
+        {"Corrupt Key Length", test_trace_corrupt_length}
+    };
+
+    int passed = 0;
+    int total = static_cast<int>(tests.size());
+
+    for (const auto& [name, test_func] : tests) {
+        try {
+            bool result = test_func();
+            print_test_result(name, result);
+            if (result) passed++;
+        } catch (const std::exception& e) {
+            std::cout << "X " << name << " (Exception: " << e.what() << ")" << std::endl;
+        } catch (...) {
+            std::cout << "X " << name << " (Unknown exception)" << std::endl;
+        }
+    }
+
+    std::cout << "\nResults: " << passed << "/" << total << " tests passed" << std::endl;
+
+    if (passed == total) {
+        std::cout << "\nAll Trace tests passed!" << std::endl;
+        return 0;
+    } else {
+        std::cout << "\nSome Trace tests failed" << std::endl;
+        return 1;
+    }
+}
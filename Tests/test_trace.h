@@ -0,0 +1,6 @@
+#ifndef KVDB_TEST_TRACE_H
+#define KVDB_TEST_TRACE_H
+
+int trace_tests_main();
+
+#endif // KVDB_TEST_TRACE_H
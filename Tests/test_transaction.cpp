@@ -0,0 +1,258 @@
+#include "test_transaction.h"
+#include "../LSMTree.h"
+#include "../Transaction.h"
+#include "../WriteBatch.h"
+#include <iostream>
+#include <string>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+
+#include "test_helper.h"
+
+namespace fs = std::filesystem;
+using namespace std::chrono;
+
+// Test 1: Batches apply as a unit and come back whole from the WAL
+bool test_write_batch_recovery() {
+    std::string data_dir = "test_txn_batch";
+    fs::remove_all(data_dir);
+
+    bool ok = true;
+    {
+        LSMTree lsm(data_dir, 1024 * 1024, 100, 10);
+        lsm.put("gone", "soon");
+
+        WriteBatch batch;
+        batch.put("a", "1");
+        batch.put("b", "2");
+        batch.remove("gone");
+        batch.put("a", "3");  // later ops in the batch win
+        if (!lsm.write(batch)) {
+            std::cerr << "    Batch write failed" << std::endl;
+            ok = false;
+        }
+
+        if (lsm.get("a") != "3" || lsm.get("b") != "2" || lsm.get("gone").has_value()) {
+            std::cerr << "    Batch not applied" << std::endl;
+            ok = false;
+        }
+
+        // Simulate a crash: recover from the WAL without the destructor's flush
+        WriteAheadLog wal(data_dir + "/wal.log");
+        auto entries = wal.read_all_entries();
+        if (entries.size() != 5) {
+            std::cerr << "    WAL holds " << entries.size() << " entries, expected 5" << std::endl;
+            ok = false;
+        }
+    }
+
+    fs::remove_all(data_dir);
+    return ok;
+}
+
+// Test 2: Transactions read their own writes and apply them on commit
+bool test_transaction_commit() {
+    std::string data_dir = "test_txn_commit";
+    fs::remove_all(data_dir);
+
+    bool ok = true;
+    {
+        LSMTree lsm(data_dir, 1024 * 1024, 100, 10);
+        lsm.put("stock", "10");
+
+        auto txn = lsm.begin_transaction();
+        int stock = std::stoi(txn->get("stock").value_or("0"));
+        txn->put("stock", std::to_string(stock - 1));
+        txn->put("order:1", "widget");
+
+        if (txn->get("stock") != "9") {
+            std::cerr << "    Transaction didn't see its own write" << std::endl;
+            ok = false;
+        }
+        if (lsm.get("order:1").has_value()) {
+            std::cerr << "    Uncommitted write visible" << std::endl;
+            ok = false;
+        }
+
+        if (txn->commit() != Transaction::Status::COMMITTED) {
+            std::cerr << "    Commit failed" << std::endl;
+            ok = false;
+        }
+        if (lsm.get("stock") != "9" || lsm.get("order:1") != "widget") {
+            std::cerr << "    Committed writes missing" << std::endl;
+            ok = false;
+        }
+
+        // Rolled back transactions leave nothing behind
+        auto aborted = lsm.begin_transaction();
+        aborted->put("stock", "0");
+        aborted->rollback();
+        if (lsm.get("stock") != "9" || aborted->commit() != Transaction::Status::FAILED) {
+            std::cerr << "    Rollback leaked writes" << std::endl;
+            ok = false;
+        }
+    }
+
+    fs::remove_all(data_dir);
+    return ok;
+}
+
+// Test 3: A write to a tracked key between read and commit is a conflict
+bool test_transaction_conflict() {
+    std::string data_dir = "test_txn_conflict";
+    fs::remove_all(data_dir);
+
+    bool ok = true;
+    {
+        LSMTree lsm(data_dir, 1024 * 1024, 100, 10);
+        lsm.put("balance", "100");
+
+        auto first = lsm.begin_transaction();
+        auto second = lsm.begin_transaction();
+        first->get("balance");
+        second->get("balance");
+
+        first->put("balance", "90");
+        second->put("balance", "80");
+
+        if (first->commit() != Transaction::Status::COMMITTED) {
+            std::cerr << "    First commit failed" << std::endl;
+            ok = false;
+        }
+        if (second->commit() != Transaction::Status::CONFLICT) {
+            std::cerr << "    Lost update not detected" << std::endl;
+            ok = false;
+        }
+        if (lsm.get("balance") != "90") {
+            std::cerr << "    Conflicting transaction applied" << std::endl;
+            ok = false;
+        }
+
+        // Plain writes conflict too, and untouched keys don't
+        auto third = lsm.begin_transaction();
+        third->get("balance");
+        third->get("other");
+        lsm.put("unrelated", "x");
+        third->put("other", "y");
+        if (third->commit() != Transaction::Status::COMMITTED) {
+            std::cerr << "    Unrelated write caused a conflict" << std::endl;
+            ok = false;
+        }
+
+        auto fourth = lsm.begin_transaction();
+        fourth->get("balance");
+        lsm.put("balance", "70");
+        fourth->put("balance", "60");
+        if (fourth->commit() != Transaction::Status::CONFLICT) {
+            std::cerr << "    Conflict with a plain put not detected" << std::endl;
+            ok = false;
+        }
+
+        auto stats = lsm.get_stats();
+        if (stats.transactions_committed != 2 || stats.transaction_conflicts != 2) {
+            std::cerr << "    Unexpected transaction stats" << std::endl;
+            ok = false;
+        }
+    }
+
+    fs::remove_all(data_dir);
+    return ok;
+}
+
+// Test 4: Threads incrementing counters lose no updates, retrying on conflict
+bool test_transaction_parallel() {
+    std::string data_dir = "test_txn_parallel";
+    fs::remove_all(data_dir);
+
+    const int thread_count = 4;
+    const int increments = 200;
+
+    bool ok = true;
+    {
+        LSMTree lsm(data_dir, 1024 * 1024, 100, 10);
+        std::atomic<int> retries{0};
+
+        auto increment = [&](const std::string& key) {
+            while (true) {
+                auto txn = lsm.begin_transaction();
+                int value = std::stoi(txn->get(key).value_or("0"));
+                txn->put(key, std::to_string(value + 1));
+                if (txn->commit() == Transaction::Status::COMMITTED) {
+                    return;
+                }
+                retries++;
+            }
+        };
+
+        std::vector<std::thread> threads;
+        for (int t = 0; t < thread_count; ++t) {
+            threads.emplace_back([&, t]() {
+                for (int i = 0; i < increments; ++i) {
+                    increment("own" + std::to_string(t));  // never contended
+                    increment("shared");                   // contended by every thread
+                }
+            });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+
+        std::cout << "    " << retries.load() << " retries for "
+                  << thread_count * increments * 2 << " transactions" << std::endl;
+
+        if (lsm.get("shared") != std::to_string(thread_count * increments)) {
+            std::cerr << "    Shared counter lost updates: " << lsm.get("shared").value_or("-") << std::endl;
+            ok = false;
+        }
+        for (int t = 0; t < thread_count; ++t) {
+            if (lsm.get("own" + std::to_string(t)) != std::to_string(increments)) {
+                std::cerr << "    Private counter " << t << " wrong" << std::endl;
+                ok = false;
+            }
+        }
+    }
+
+    fs::remove_all(data_dir);
+    return ok;
+}
+
+// Main test runner
+int transaction_tests_main() {
+    std::cout << "\n=== Transaction Tests ===" << std::endl;
+    std::cout << "=========================" << std::endl;
+
+    std::vector<std::pair<std::string, bool (*)()>> tests = {
+        {"Write Batch Recovery", test_write_batch_recovery},
+        {"Commit", test_transaction_commit},
+        {"Conflict Detection", test_transaction_conflict},
+        {"Parallel Counters", test_transaction_parallel}
+    };
+
+    int passed = 0;
+    int total = static_cast<int>(tests.size());
+
+    for (const auto& [name, test_func] : tests) {
+        try {
+            bool result = test_func();
+            print_test_result(name, result);
+            if (result) passed++;
+        } catch (const std::exception& e) {
+            std::cout << "X " << name << " (Exception: " << e.what() << ")" << std::endl;
+        } catch (...) {
+            std::cout << "X " << name << " (Unknown exception)" << std::endl;
+        }
+    }
+
+    std::cout << "\nResults: " << passed << "/" << total << " tests passed" << std::endl;
+
+    if (passed == total) {
+        std::cout << "\nAll Transaction tests passed!" << std::endl;
+        return 0;
+    } else {
+        std::cout << "\nSome Transaction tests failed" << std::endl;
+        return 1;
+    }
+}
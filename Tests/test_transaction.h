@@ -0,0 +1,6 @@
+#ifndef KVDB_TEST_TRANSACTION_H
+#define KVDB_TEST_TRANSACTION_H
+
+int transaction_tests_main();
+
+#endif // KVDB_TEST_TRANSACTION_H
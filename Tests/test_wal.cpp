@@ -584,6 +584,46 @@ bool test_wal_move_semantics(const std::string& test_dir) {
     return true;
 }
 
+// Test 16: A torn batch left by a crash is overwritten by the next write, not replayed
+bool test_wal_torn_tail(const std::string& test_dir) {
+    std::string filename = make_test_path(test_dir, "torn.bin");
+
+    {
+        WriteAheadLog wal(filename);
+        if (!wal.log_put("a", "1") || !wal.log_put("b", "2")) return false;
+    }
+
+    // A whole record the header never counted, as if the crash hit before the header update
+    {
+        std::ofstream file(filename, std::ios::binary | std::ios::app);
+        uint8_t op_type = static_cast<uint8_t>(WriteAheadLog::OpType::PUT);
+        uint32_t key_len = 4;
+        uint32_t value_len = 3;
+        file.write(reinterpret_cast<const char*>(&op_type), sizeof(op_type));
+        file.write(reinterpret_cast<const char*>(&key_len), sizeof(key_len));
+        file.write("torn", key_len);
+        file.write(reinterpret_cast<const char*>(&value_len), sizeof(value_len));
+        file.write("bad", value_len);
+    }
+
+    {
+        WriteAheadLog wal(filename);
+        if (!wal.log_put("c", "3")) return false;
+    }
+
+    WriteAheadLog wal(filename);
+    auto entries = wal.read_all_entries();
+    if (entries.size() != 3 || entries[2].key != "c" || entries[2].value != "3") {
+        std::cerr << "  Expected a, b, c after the torn tail, got " << entries.size() << " entries";
+        if (entries.size() == 3) {
+            std::cerr << " ending in " << entries[2].key << "=" << entries[2].value;
+        }
+        std::cerr << std::endl;
+        return false;
+    }
+    return entries[0].key == "a" && entries[1].key == "b";
+}
+
 // Main test runner
 int wal_tests_main() {
     // Create unique test directory
@@ -623,7 +663,8 @@ int wal_tests_main() {
         {"12. Memory Safety", test_wal_memory_safety},
         {"13. Header Integrity", test_wal_header_integrity},
         {"14. Sequential Consistency", test_wal_sequential_consistency},
-        {"15. Move Semantics", test_wal_move_semantics}
+        {"15. Move Semantics", test_wal_move_semantics},
+        {"16. Torn Tail", test_wal_torn_tail}
     };
 
     int passed = 0;
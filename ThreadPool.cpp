@@ -0,0 +1,232 @@
+#include "ThreadPool.h"
+#include <algorithm>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace {
+    uint64_t nanos_since(std::chrono::steady_clock::time_point start) {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - start).count());
+    }
+
+#ifdef __linux__
+    // From linux/ioprio.h, which not every libc ships
+    const int IOPRIO_WHO_PROCESS = 1;
+    const int IOPRIO_CLASS_IDLE = 3;
+    const int IOPRIO_CLASS_SHIFT = 13;
+#endif
+}
+
+const char* ThreadPool::name(Priority priority) {
+    switch (priority) {
+        case HIGH: return "high";
+        case LOW: return "low";
+        default: return "unknown";
+    }
+}
+
+ThreadPool::ThreadPool(const Options& options)
+    : options_(options),
+      logger_(options.logger ? options.logger : Logger::stderr_logger()) {
+    options_.high_threads = std::max<size_t>(1, options_.high_threads);
+    options_.low_threads = std::max<size_t>(1, options_.low_threads);
+
+    // Every worker exists before any starts, stealing walks the other workers' queues
+    for (int p = 0; p < PRIORITY_COUNT; p++) {
+        auto priority = static_cast<Priority>(p);
+        next_worker_[p].store(0);
+        size_t count = priority == HIGH ? options_.high_threads : options_.low_threads;
+        for (size_t i = 0; i < count; i++) {
+            auto worker = std::make_unique<Worker>();
+            worker->priority = priority;
+            worker->index = i;
+            workers_[p].push_back(std::move(worker));
+        }
+    }
+    for (auto& pool : workers_) {
+        for (auto& worker : pool) {
+            Worker& w = *worker;
+            w.thread = std::thread([this, &w] { worker_loop(w); });
+        }
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    work_cv_.notify_all();
+    for (auto& pool : workers_) {
+        for (auto& worker : pool) {
+            worker->thread.join();
+        }
+    }
+}
+
+void ThreadPool::schedule(Priority priority, std::function<void()> job) {
+    auto& pool = workers_[priority];
+    Worker& worker = *pool[next_worker_[priority].fetch_add(1, std::memory_order_relaxed) % pool.size()];
+
+    // Counted first, so the count never drops below the jobs actually queued
+    counters_[priority].queued.fetch_add(1);
+    {
+        std::lock_guard<std::mutex> lock(worker.mutex);
+        worker.jobs.push_back(Job{std::move(job), priority, std::chrono::steady_clock::now()});
+    }
+
+    // Any idle worker may take it, not just the one whose queue it went to
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+    }
+    work_cv_.notify_all();
+}
+
+void ThreadPool::wait_idle() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    idle_cv_.wait(lock, [this] { return idle(); });
+}
+
+size_t ThreadPool::thread_count(Priority priority) const {
+    return workers_[priority].size();
+}
+
+ThreadPool::Stats ThreadPool::get_stats(Priority priority) const {
+    const Counters& counters = counters_[priority];
+    Stats stats;
+    stats.queue_depth = counters.queued.load();
+    stats.running = counters.running.load();
+    stats.completed = counters.completed.load();
+    stats.stolen = counters.stolen.load();
+    stats.wait_ns = counters.wait_ns.snapshot();
+    return stats;
+}
+
+bool ThreadPool::has_work_for(const Worker& worker) const {
+    return counters_[HIGH].queued.load() > 0 || (worker.priority == LOW && counters_[LOW].queued.load() > 0);
+}
+
+bool ThreadPool::idle() const {
+    for (const auto& counters : counters_) {
+        if (counters.queued.load() > 0 || counters.running.load() > 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool ThreadPool::steal(Priority pool, const Worker& thief, Job& job) {
+    auto& workers = workers_[pool];
+    for (size_t i = 1; i <= workers.size(); i++) {
+        // Start after the thief's index so victims are picked in turn
+        Worker& victim = *workers[(thief.index + i) % workers.size()];
+        if (&victim != &thief) {
+            std::lock_guard<std::mutex> lock(victim.mutex);
+            if (!victim.jobs.empty()) {
+                job = std::move(victim.jobs.back());
+                victim.jobs.pop_back();
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+bool ThreadPool::take_job(Worker& worker, Job& job) {
+    bool found = false;
+    bool stolen = false;
+    {
+        std::lock_guard<std::mutex> lock(worker.mutex);
+        if (!worker.jobs.empty()) {
+            job = std::move(worker.jobs.front());
+            worker.jobs.pop_front();
+            found = true;
+        }
+    }
+
+    // Pending flushes come before this worker's own pool mates' compactions
+    if (!found && worker.priority == LOW) {
+        found = stolen = steal(HIGH, worker, job);
+    }
+    if (!found) {
+        found = stolen = steal(worker.priority, worker, job);
+    }
+    if (!found) {
+        return false;
+    }
+
+    Counters& counters = counters_[job.priority];
+    counters.running.fetch_add(1);
+    counters.queued.fetch_sub(1);
+    counters.wait_ns.add(nanos_since(job.queued_at));
+    if (stolen) {
+        counters.stolen.fetch_add(1, std::memory_order_relaxed);
+    }
+    return true;
+}
+
+void ThreadPool::worker_loop(Worker& worker) {
+    apply_thread_settings(worker);
+
+    while (true) {
+        Job job;
+        if (take_job(worker, job)) {
+            try {
+                job.fn();
+            } catch (const std::exception& e) {
+                logger_->error("Background job failed: ", e.what());
+            } catch (...) {
+                logger_->error("Background job failed with an unknown exception");
+            }
+            job.fn = nullptr;  // release captures before reporting the job done
+
+            Counters& counters = counters_[job.priority];
+            counters.completed.fetch_add(1, std::memory_order_relaxed);
+            counters.running.fetch_sub(1);
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+            }
+            idle_cv_.notify_all();
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(mutex_);
+        work_cv_.wait(lock, [&] { return stop_ || has_work_for(worker); });
+        if (stop_ && !has_work_for(worker)) {
+            return;
+        }
+    }
+}
+
+void ThreadPool::apply_thread_settings(const Worker& worker) const {
+#ifdef __linux__
+    const auto& cpus = worker.priority == HIGH ? options_.high_cpus : options_.low_cpus;
+    if (!cpus.empty()) {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(cpus[worker.index % cpus.size()], &set);
+        if (pthread_setaffinity_np(pthread_self(), sizeof(set), &set) != 0) {
+            logger_->warn("Failed to pin ", name(worker.priority), " priority worker");
+        }
+    }
+
+    // Linux applies both per thread when given a thread id
+    auto tid = static_cast<id_t>(syscall(SYS_gettid));
+    int nice = worker.priority == HIGH ? options_.high_nice : options_.low_nice;
+    if (nice != 0 && setpriority(PRIO_PROCESS, tid, nice) != 0) {
+        logger_->warn("Failed to set nice ", nice, " on ", name(worker.priority), " priority worker");
+    }
+    if (worker.priority == LOW && options_.low_io_idle &&
+        syscall(SYS_ioprio_set, IOPRIO_WHO_PROCESS, tid, IOPRIO_CLASS_IDLE << IOPRIO_CLASS_SHIFT) != 0) {
+        logger_->warn("Failed to set idle I/O class on low priority worker");
+    }
+#else
+    (void)worker;
+#endif
+}
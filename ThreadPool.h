@@ -0,0 +1,135 @@
+#ifndef KVDB_THREADPOOL_H
+#define KVDB_THREADPOOL_H
+
+#include "Histogram.h"
+#include "Logger.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * Background executor with a high priority pool for flushes and a low priority pool for
+ * compactions and other deferrable work, shared by every tree it is handed to.
+ *
+ * Each worker has its own queue and jobs are spread over the workers of their pool. An idle
+ * worker steals from the back of its pool mates' queues, and an idle low priority worker also
+ * steals high priority jobs, so a flush never waits behind a long compaction while a thread
+ * is free. High priority workers never run low priority jobs.
+ *
+ * On Linux, workers can be pinned to cores and given a nice value, and low priority workers
+ * can be put in the idle I/O class. Settings the process isn't allowed to apply are skipped.
+ * Destroying the pool runs every job already queued before the workers exit.
+ */
+class ThreadPool {
+public:
+    enum Priority { HIGH, LOW, PRIORITY_COUNT };
+
+    static const char* name(Priority priority);
+
+    struct Options {
+        size_t high_threads;          // at least 1
+        size_t low_threads;           // at least 1
+        std::vector<int> high_cpus;   // cores high workers are pinned to in turn, empty leaves them unpinned
+        std::vector<int> low_cpus;    // same for low workers
+        int high_nice;                // nice value of high workers, 0 leaves it unchanged
+        int low_nice;                 // nice value of low workers, 0 leaves it unchanged
+        bool low_io_idle;             // low workers only get disk time nobody else wants
+        std::shared_ptr<Logger> logger;  // failed jobs and refused thread settings, nullptr logs to stderr
+
+        explicit Options(size_t high_threads_ = 1,
+                         size_t low_threads_ = 1,
+                         int high_nice_ = 0,
+                         int low_nice_ = 0,
+                         bool low_io_idle_ = false)
+            : high_threads(high_threads_),
+              low_threads(low_threads_),
+              high_nice(high_nice_),
+              low_nice(low_nice_),
+              low_io_idle(low_io_idle_)
+        {}
+    };
+
+    explicit ThreadPool(const Options& options = Options());
+    ~ThreadPool();
+
+    // No copying
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    /**
+     * Queue a job, exceptions it throws are logged and dropped
+     */
+    void schedule(Priority priority, std::function<void()> job);
+
+    /**
+     * Block until no job is queued or running
+     */
+    void wait_idle();
+
+    size_t thread_count(Priority priority) const;
+
+    struct Stats {
+        size_t queue_depth = 0;     // queued, not yet picked up
+        size_t running = 0;
+        uint64_t completed = 0;
+        uint64_t stolen = 0;        // picked up from another worker's queue
+        Histogram wait_ns;          // time from schedule until a worker picked the job up
+    };
+
+    Stats get_stats(Priority priority) const;
+
+private:
+    struct Job {
+        std::function<void()> fn;
+        Priority priority;
+        std::chrono::steady_clock::time_point queued_at;
+    };
+
+    struct Worker {
+        Priority priority;
+        size_t index;               // within its pool
+        std::mutex mutex;
+        std::deque<Job> jobs;
+        std::thread thread;
+    };
+
+    struct Counters {
+        std::atomic<size_t> queued{0};
+        std::atomic<size_t> running{0};
+        std::atomic<uint64_t> completed{0};
+        std::atomic<uint64_t> stolen{0};
+        ConcurrentHistogram wait_ns;
+    };
+
+    Options options_;
+    std::shared_ptr<Logger> logger_;
+    std::vector<std::unique_ptr<Worker>> workers_[PRIORITY_COUNT];
+    std::atomic<size_t> next_worker_[PRIORITY_COUNT];
+    Counters counters_[PRIORITY_COUNT];
+
+    // Sleeping workers and wait_idle callers wait on these
+    std::mutex mutex_;
+    std::condition_variable work_cv_;
+    std::condition_variable idle_cv_;
+    bool stop_ = false;
+
+    void worker_loop(Worker& worker);
+
+    // Apply the worker's affinity, nice value and I/O class to the calling thread
+    void apply_thread_settings(const Worker& worker) const;
+
+    // Own queue front first, then steal, false if nothing was found
+    bool take_job(Worker& worker, Job& job);
+    bool steal(Priority pool, const Worker& thief, Job& job);
+
+    bool has_work_for(const Worker& worker) const;
+    bool idle() const;
+};
+
+#endif // KVDB_THREADPOOL_H
@@ -0,0 +1,128 @@
+#include "TraceReplayer.h"
+#include "LSMTree.h"
+#include <algorithm>
+#include <chrono>
+#include <thread>
+
+namespace {
+    // Values only matter by size, one shared block is cut to length
+    const std::string& value_block() {
+        static const std::string block(1024 * 1024, 'v');
+        return block;
+    }
+
+    std::string make_value(uint32_t size) {
+        std::string value;
+        while (value.size() < size) {
+            value.append(value_block(), 0, std::min<size_t>(size - value.size(), value_block().size()));
+        }
+        return value;
+    }
+}
+
+const char* TraceReplayer::op_name(TraceOp op) {
+    switch (op) {
+        case TraceOp::PUT: return "put";
+        case TraceOp::GET: return "get";
+        case TraceOp::REMOVE: return "remove";
+        case TraceOp::SCAN: return "scan";
+        case TraceOp::WRITE_BATCH: return "write_batch";
+        case TraceOp::SCAN_PREFIX: return "scan_prefix";
+    }
+    return "unknown";
+}
+
+TraceReplayer::Result TraceReplayer::replay(std::vector<TraceRecord> records, const Options& options) {
+    std::stable_sort(records.begin(), records.end(), [](const TraceRecord& a, const TraceRecord& b) {
+        return a.timestamp_us < b.timestamp_us;
+    });
+
+    // Each traced thread goes to one replay thread, keeping its calls in order
+    const int threads = std::max(1, options.threads);
+    std::vector<std::vector<const TraceRecord*>> queues(threads);
+    for (const auto& record : records) {
+        queues[record.thread % threads].push_back(&record);
+    }
+
+    std::vector<Result> results(threads);
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; t++) {
+        workers.emplace_back([&, t] {
+            Result& result = results[t];
+            for (const TraceRecord* record : queues[t]) {
+                if (options.speed > 0) {
+                    auto due = start + std::chrono::microseconds(
+                        static_cast<int64_t>(static_cast<double>(record->timestamp_us) / options.speed));
+                    std::this_thread::sleep_until(due);
+                    auto lag = std::chrono::duration_cast<std::chrono::microseconds>(
+                        std::chrono::steady_clock::now() - due).count();
+                    result.max_lag_us = std::max(result.max_lag_us, static_cast<uint64_t>(std::max<int64_t>(0, lag)));
+                }
+
+                auto op_start = std::chrono::steady_clock::now();
+                bool ok = execute(*record, result);
+                result.latency[static_cast<size_t>(record->op)].add(static_cast<uint64_t>(
+                    std::chrono::duration_cast<std::chrono::nanoseconds>(
+                        std::chrono::steady_clock::now() - op_start).count()));
+                result.ops++;
+                if (!ok && record->op != TraceOp::GET && record->op != TraceOp::SCAN
+                    && record->op != TraceOp::SCAN_PREFIX) {
+                    result.failed++;
+                }
+            }
+        });
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+
+    Result total;
+    total.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    for (const auto& result : results) {
+        for (size_t op = 0; op < OP_COUNT; op++) {
+            total.latency[op].merge(result.latency[op]);
+        }
+        total.ops += result.ops;
+        total.found += result.found;
+        total.failed += result.failed;
+        total.max_lag_us = std::max(total.max_lag_us, result.max_lag_us);
+    }
+    return total;
+}
+
+bool TraceReplayer::execute(const TraceRecord& record, Result& result) {
+    switch (record.op) {
+        case TraceOp::PUT:
+            return db_.put(record.key, make_value(record.value_size));
+        case TraceOp::GET: {
+            bool found = db_.get(record.key).has_value();
+            result.found += found;
+            return found;
+        }
+        case TraceOp::REMOVE:
+            return db_.remove(record.key);
+        case TraceOp::SCAN: {
+            bool found = !db_.scan(record.key, record.end_key).empty();
+            result.found += found;
+            return found;
+        }
+        case TraceOp::SCAN_PREFIX: {
+            bool found = !db_.scan_prefix(record.key).empty();
+            result.found += found;
+            return found;
+        }
+        case TraceOp::WRITE_BATCH: {
+            WriteBatch batch;
+            for (const auto& entry : record.batch) {
+                if (entry.op == TraceOp::PUT) {
+                    batch.put(entry.key, make_value(entry.value_size));
+                } else {
+                    batch.remove(entry.key);
+                }
+            }
+            return db_.write(batch);
+        }
+    }
+    return false;
+}
@@ -0,0 +1,55 @@
+#ifndef KVDB_TRACEREPLAYER_H
+#define KVDB_TRACEREPLAYER_H
+
+#include "Tracer.h"
+#include "Histogram.h"
+#include <array>
+#include <cstdint>
+#include <vector>
+
+class LSMTree;
+
+/**
+ * Re-issues a trace against an LSMTree and measures every call.
+ *
+ * Records run in timestamp order. Each traced thread is pinned to one replay thread, so
+ * its calls keep their order, and with one replay thread the whole trace replays in the
+ * order it was recorded. Values are filled in at their traced size.
+ */
+class TraceReplayer {
+public:
+    static constexpr size_t OP_COUNT = static_cast<size_t>(TraceOp::SCAN_PREFIX) + 1;
+
+    struct Options {
+        int threads;   // replay threads, traced threads are spread over them
+        double speed;  // 1 keeps the traced timing, 2 runs twice as fast, 0 as fast as possible
+
+        explicit Options(int threads_ = 1, double speed_ = 1.0)
+            : threads(threads_),
+              speed(speed_)
+        {}
+    };
+
+    struct Result {
+        std::array<Histogram, OP_COUNT> latency;  // nanoseconds, by TraceOp
+        uint64_t ops = 0;
+        uint64_t found = 0;          // gets that found a value and scans that returned keys
+        uint64_t failed = 0;         // writes that returned false
+        uint64_t max_lag_us = 0;     // furthest a call started behind its schedule
+        double seconds = 0.0;
+    };
+
+    explicit TraceReplayer(LSMTree& db) : db_(db) {}
+
+    Result replay(std::vector<TraceRecord> records, const Options& options = Options());
+
+    static const char* op_name(TraceOp op);
+
+private:
+    LSMTree& db_;
+
+    // Run one record, true if it succeeded or found something
+    bool execute(const TraceRecord& record, Result& result);
+};
+
+#endif // KVDB_TRACEREPLAYER_H
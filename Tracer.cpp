@@ -0,0 +1,280 @@
+#include "Tracer.h"
+
+namespace {
+    constexpr size_t BUFFER_LIMIT = 64 * 1024;
+
+    void put_varint(std::string& out, uint64_t value) {
+        while (value >= 0x80) {
+            out.push_back(static_cast<char>(value | 0x80));
+            value >>= 7;
+        }
+        out.push_back(static_cast<char>(value));
+    }
+
+    void put_string(std::string& out, const std::string& value) {
+        put_varint(out, value.size());
+        out += value;
+    }
+
+    // Small id per thread, handed out on its first traced call
+    uint32_t trace_thread_id() {
+        static std::atomic<uint32_t> next_id{0};
+        thread_local uint32_t id = next_id.fetch_add(1, std::memory_order_relaxed);
+        return id;
+    }
+}
+
+Tracer::~Tracer() {
+    stop();
+}
+
+bool Tracer::start(const std::string& path, const Options& options) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (file_.is_open()) {
+        return false;
+    }
+
+    file_.open(path, std::ios::binary | std::ios::trunc);
+    if (!file_) {
+        return false;
+    }
+
+    options_ = options;
+    start_ = std::chrono::steady_clock::now();
+    uint64_t start_time_us = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count());
+
+    file_.write(reinterpret_cast<const char*>(&MAGIC), sizeof(MAGIC));
+    file_.write(reinterpret_cast<const char*>(&VERSION), sizeof(VERSION));
+    file_.write(reinterpret_cast<const char*>(&start_time_us), sizeof(start_time_us));
+    bytes_ = sizeof(MAGIC) + sizeof(VERSION) + sizeof(start_time_us);
+    records_.store(0, std::memory_order_relaxed);
+
+    enabled_.store(true, std::memory_order_release);
+    return true;
+}
+
+bool Tracer::stop() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!file_.is_open()) {
+        return false;
+    }
+
+    enabled_.store(false, std::memory_order_relaxed);
+    flush_buffer();
+    file_.close();
+    return true;
+}
+
+void Tracer::trace_put(const std::string& key, size_t value_size) {
+    if (!enabled_.load(std::memory_order_acquire)) {
+        return;
+    }
+    std::string record;
+    begin_record(record, TraceOp::PUT);
+    put_string(record, key);
+    put_varint(record, value_size);
+    append(record);
+}
+
+void Tracer::trace_get(const std::string& key) {
+    if (!enabled_.load(std::memory_order_acquire)) {
+        return;
+    }
+    std::string record;
+    begin_record(record, TraceOp::GET);
+    put_string(record, key);
+    append(record);
+}
+
+void Tracer::trace_remove(const std::string& key) {
+    if (!enabled_.load(std::memory_order_acquire)) {
+        return;
+    }
+    std::string record;
+    begin_record(record, TraceOp::REMOVE);
+    put_string(record, key);
+    append(record);
+}
+
+void Tracer::trace_scan(const std::string& start_key, const std::string& end_key) {
+    if (!enabled_.load(std::memory_order_acquire)) {
+        return;
+    }
+    std::string record;
+    begin_record(record, TraceOp::SCAN);
+    put_string(record, start_key);
+    put_string(record, end_key);
+    append(record);
+}
+
+void Tracer::trace_scan_prefix(const std::string& prefix) {
+    if (!enabled_.load(std::memory_order_acquire)) {
+        return;
+    }
+    std::string record;
+    begin_record(record, TraceOp::SCAN_PREFIX);
+    put_string(record, prefix);
+    append(record);
+}
+
+void Tracer::trace_write(const WriteBatch& batch) {
+    if (!enabled_.load(std::memory_order_acquire)) {
+        return;
+    }
+    std::string record;
+    begin_record(record, TraceOp::WRITE_BATCH);
+    put_string(record, "");
+    put_varint(record, batch.count());
+    for (const auto& op : batch.ops()) {
+        bool is_put = op.type == WriteAheadLog::OpType::PUT;
+        record.push_back(static_cast<char>(is_put ? TraceOp::PUT : TraceOp::REMOVE));
+        put_string(record, op.key);
+        if (is_put) {
+            put_varint(record, op.value.size());
+        }
+    }
+    append(record);
+}
+
+void Tracer::begin_record(std::string& out, TraceOp op) const {
+    out.push_back(static_cast<char>(op));
+    put_varint(out, trace_thread_id());
+    put_varint(out, static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - start_).count()));
+}
+
+void Tracer::append(const std::string& record) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    // The trace may have stopped since the caller checked
+    if (!enabled_.load(std::memory_order_relaxed)) {
+        return;
+    }
+    if (options_.max_trace_size > 0 && bytes_ + record.size() > options_.max_trace_size) {
+        enabled_.store(false, std::memory_order_relaxed);
+        return;
+    }
+
+    buffer_ += record;
+    bytes_ += record.size();
+    records_.fetch_add(1, std::memory_order_relaxed);
+    if (buffer_.size() >= BUFFER_LIMIT) {
+        flush_buffer();
+    }
+}
+
+void Tracer::flush_buffer() {
+    file_.write(buffer_.data(), static_cast<std::streamsize>(buffer_.size()));
+    file_.flush();
+    buffer_.clear();
+}
+
+bool TraceReader::open(const std::string& path) {
+    file_.open(path, std::ios::binary | std::ios::ate);
+    if (!file_) {
+        return false;
+    }
+    file_size_ = static_cast<uint64_t>(file_.tellg());
+    file_.seekg(0);
+
+    uint64_t magic = 0;
+    uint32_t version = 0;
+    file_.read(reinterpret_cast<char*>(&magic), sizeof(magic));
+    file_.read(reinterpret_cast<char*>(&version), sizeof(version));
+    file_.read(reinterpret_cast<char*>(&start_time_us_), sizeof(start_time_us_));
+    return file_ && magic == Tracer::MAGIC && version == Tracer::VERSION;
+}
+
+bool TraceReader::next(TraceRecord& record) {
+    char op = 0;
+    if (!file_.get(op) || static_cast<uint8_t>(op) > static_cast<uint8_t>(TraceOp::SCAN_PREFIX)) {
+        return false;
+    }
+
+    uint64_t thread = 0;
+    uint64_t value_size = 0;
+    record = TraceRecord();
+    record.op = static_cast<TraceOp>(op);
+    if (!read_varint(thread) || !read_varint(record.timestamp_us) || !read_string(record.key)) {
+        return false;
+    }
+    record.thread = static_cast<uint32_t>(thread);
+
+    switch (record.op) {
+        case TraceOp::PUT:
+            if (!read_varint(value_size)) {
+                return false;
+            }
+            record.value_size = static_cast<uint32_t>(value_size);
+            return true;
+        case TraceOp::SCAN:
+            return read_string(record.end_key);
+        case TraceOp::WRITE_BATCH: {
+            uint64_t count = 0;
+            if (!read_varint(count)) {
+                return false;
+            }
+            for (uint64_t i = 0; i < count; i++) {
+                TraceRecord::BatchEntry entry;
+                char entry_op = 0;
+                if (!file_.get(entry_op) || !read_string(entry.key)) {
+                    return false;
+                }
+                entry.op = static_cast<TraceOp>(entry_op);
+                if (entry.op == TraceOp::PUT) {
+                    if (!read_varint(value_size)) {
+                        return false;
+                    }
+                    entry.value_size = static_cast<uint32_t>(value_size);
+                }
+                record.batch.push_back(std::move(entry));
+            }
+            return true;
+        }
+        default:
+            return true;
+    }
+}
+
+std::vector<TraceRecord> TraceReader::read_all(const std::string& path) {
+    std::vector<TraceRecord> records;
+    TraceReader reader;
+    if (!reader.open(path)) {
+        return records;
+    }
+    TraceRecord record;
+    while (reader.next(record)) {
+        records.push_back(std::move(record));
+    }
+    return records;
+}
+
+bool TraceReader::read_varint(uint64_t& value) {
+    value = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        char byte = 0;
+        if (!file_.get(byte)) {
+            return false;
+        }
+        value |= static_cast<uint64_t>(static_cast<uint8_t>(byte) & 0x7F) << shift;
+        if ((static_cast<uint8_t>(byte) & 0x80) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool TraceReader::read_string(std::string& value) {
+    uint64_t size = 0;
+    if (!read_varint(size)) {
+        return false;
+    }
+
+    // A corrupt length would otherwise ask for an absurd allocation
+    auto pos = file_.tellg();
+    if (pos < 0 || size > file_size_ - static_cast<uint64_t>(pos)) {
+        return false;
+    }
+    value.resize(size);
+    return size == 0 || static_cast<bool>(file_.read(value.data(), static_cast<std::streamsize>(size)));
+}
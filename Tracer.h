@@ -0,0 +1,144 @@
+#ifndef KVDB_TRACER_H
+#define KVDB_TRACER_H
+
+#include "WriteBatch.h"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <vector>
+
+enum class TraceOp : uint8_t {
+    PUT = 0,
+    GET = 1,
+    REMOVE = 2,
+    SCAN = 3,
+    WRITE_BATCH = 4,
+    SCAN_PREFIX = 5     // key holds the prefix
+};
+
+/**
+ * One traced call. Values aren't kept, only their size, so a trace carries the shape of a
+ * workload and not its data
+ */
+struct TraceRecord {
+    struct BatchEntry {
+        TraceOp op;            // PUT or REMOVE
+        std::string key;
+        uint32_t value_size = 0;
+    };
+
+    TraceOp op = TraceOp::GET;
+    uint32_t thread = 0;        // small id per calling thread
+    uint64_t timestamp_us = 0;  // since the trace started
+    std::string key;            // start key for SCAN, prefix for SCAN_PREFIX
+    std::string end_key;        // SCAN only
+    uint32_t value_size = 0;    // PUT only
+    std::vector<BatchEntry> batch;  // WRITE_BATCH only
+};
+
+/**
+ * Records engine calls to a binary trace file, see LSMTree::start_trace.
+ *
+ * Records are encoded on the calling thread and appended to a buffer under a short lock,
+ * the buffer goes to the file once it holds 64 KB. While no trace is running a call costs
+ * one relaxed atomic load.
+ *
+ * File layout: MAGIC, VERSION and the start time in microseconds since the epoch, then one
+ * record after another: op byte, then varints for the thread, timestamp, key length and
+ * key bytes, followed by the value size (PUT), end key (SCAN) or entry count and entries
+ * (WRITE_BATCH). GET, REMOVE and SCAN_PREFIX records end after the key
+ */
+class Tracer {
+public:
+    static constexpr uint64_t MAGIC = 0x4B56444254524331ULL; // "KVDBTRC1"
+    static constexpr uint32_t VERSION = 1;
+
+    struct Options {
+        uint64_t max_trace_size;  // stop recording past this many bytes, 0 is unbounded
+
+        explicit Options(uint64_t max_trace_size_ = 0)
+            : max_trace_size(max_trace_size_)
+        {}
+    };
+
+    Tracer() = default;
+    ~Tracer();
+
+    /**
+     * Start writing a new trace to path
+     * @return false if a trace is already running or the file can't be created
+     */
+    bool start(const std::string& path, const Options& options = Options());
+
+    /**
+     * Write out what is buffered and close the file
+     * @return false if no trace was running
+     */
+    bool stop();
+
+    bool enabled() const { return enabled_.load(std::memory_order_relaxed); }
+
+    void trace_put(const std::string& key, size_t value_size);
+    void trace_get(const std::string& key);
+    void trace_remove(const std::string& key);
+    void trace_scan(const std::string& start_key, const std::string& end_key);
+    void trace_scan_prefix(const std::string& prefix);
+    void trace_write(const WriteBatch& batch);
+
+    // Records written by the current or last trace
+    uint64_t records() const { return records_.load(std::memory_order_relaxed); }
+
+    Tracer(const Tracer&) = delete;
+    Tracer& operator=(const Tracer&) = delete;
+
+private:
+    std::atomic<bool> enabled_{false};
+    std::atomic<uint64_t> records_{0};
+    std::mutex mutex_;
+    std::ofstream file_;
+    std::string buffer_;
+    uint64_t bytes_ = 0;  // written and buffered
+    Options options_;
+    std::chrono::steady_clock::time_point start_;
+
+    // Begin a record: op, thread and timestamp
+    void begin_record(std::string& out, TraceOp op) const;
+    void append(const std::string& record);
+    void flush_buffer();
+};
+
+/**
+ * Reads a trace written by Tracer
+ */
+class TraceReader {
+public:
+    /**
+     * @return false if the file is missing or isn't a trace
+     */
+    bool open(const std::string& path);
+
+    /**
+     * Next record in file order
+     * @return false at the end of the trace or on a truncated record
+     */
+    bool next(TraceRecord& record);
+
+    // Wall clock time the trace started, microseconds since the epoch
+    uint64_t start_time_us() const { return start_time_us_; }
+
+    // Read every record of a trace, empty if it can't be opened
+    static std::vector<TraceRecord> read_all(const std::string& path);
+
+private:
+    std::ifstream file_;
+    uint64_t file_size_ = 0;
+    uint64_t start_time_us_ = 0;
+
+    bool read_varint(uint64_t& value);
+    bool read_string(std::string& value);  // false if the length runs past the end of the file
+};
+
+#endif // KVDB_TRACER_H
@@ -0,0 +1,45 @@
+#include "Transaction.h"
+#include "LSMTree.h"
+
+void Transaction::track(const std::string& key) {
+    // Taken before the read, so a write racing with it counts as a conflict
+    tracked_.try_emplace(key, db_.sequence_number_.load());
+}
+
+std::optional<std::string> Transaction::get(const std::string& key) {
+    auto it = writes_.find(key);
+    if (it != writes_.end()) {
+        return it->second;
+    }
+
+    track(key);
+    return db_.get(key);
+}
+
+void Transaction::put(const std::string& key, const std::string& value) {
+    track(key);
+    batch_.put(key, value);
+    writes_[key] = value;
+}
+
+void Transaction::remove(const std::string& key) {
+    track(key);
+    batch_.remove(key);
+    writes_[key] = std::nullopt;
+}
+
+Transaction::Status Transaction::commit() {
+    if (finished_) {
+        return Status::FAILED;
+    }
+    finished_ = true;
+
+    return db_.commit_transaction(tracked_, batch_);
+}
+
+void Transaction::rollback() {
+    batch_.clear();
+    tracked_.clear();
+    writes_.clear();
+    finished_ = true;
+}
@@ -0,0 +1,76 @@
+#ifndef KVDB_TRANSACTION_H
+#define KVDB_TRANSACTION_H
+
+#include "WriteBatch.h"
+#include <string>
+#include <optional>
+#include <unordered_map>
+#include <cstdint>
+
+class LSMTree;
+
+/**
+ * Optimistic read-modify-write transaction over an LSMTree.
+ *
+ * Reads go straight to the tree without locking and remember the sequence number each
+ * key was first seen at. Writes are buffered in a WriteBatch and read back by later gets
+ * in the same transaction. commit() checks under the memtable lock that no tracked key
+ * was written since it was first touched, then applies the batch atomically. On
+ * CONFLICT nothing is applied and the caller can retry with a new transaction.
+ */
+class Transaction {
+public:
+    enum class Status {
+        COMMITTED,  // batch applied
+        CONFLICT,   // a tracked key changed, or its history is too old to tell
+        FAILED      // WAL write failed or the transaction was already finished
+    };
+
+    // No copying
+    Transaction(const Transaction&) = delete;
+    Transaction& operator=(const Transaction&) = delete;
+
+    /**
+     * Read a key, seeing this transaction's own writes first
+     */
+    std::optional<std::string> get(const std::string& key);
+
+    /**
+     * Buffer a put, applied on commit
+     */
+    void put(const std::string& key, const std::string& value);
+
+    /**
+     * Buffer a delete, applied on commit
+     */
+    void remove(const std::string& key);
+
+    /**
+     * Validate the tracked keys and apply the buffered writes
+     */
+    Status commit();
+
+    /**
+     * Drop buffered writes and tracked keys without applying anything
+     */
+    void rollback();
+
+    size_t tracked_key_count() const { return tracked_.size(); }
+    size_t write_count() const { return batch_.count(); }
+
+private:
+    friend class LSMTree;
+
+    explicit Transaction(LSMTree& db) : db_(db) {}
+
+    // Remember the sequence number a key was first touched at
+    void track(const std::string& key);
+
+    LSMTree& db_;
+    WriteBatch batch_;
+    std::unordered_map<std::string, uint64_t> tracked_;                // key -> sequence first seen at
+    std::unordered_map<std::string, std::optional<std::string>> writes_;  // latest buffered value, nullopt = delete
+    bool finished_ = false;
+};
+
+#endif // KVDB_TRANSACTION_H
@@ -3,40 +3,56 @@
 //
 
 #include "WriteAheadLog.h"
+#include "PerfContext.h"
 #include <iostream>
 #include <stdexcept>
 #include <algorithm>
+#include <cstring>
 #include <filesystem>
 
 namespace fs = std::filesystem;
 
-WriteAheadLog::WriteAheadLog(const std::string& filename)
-    : filename_(filename) {
+namespace {
+    // On-disk op codes for entries outside the default column family, followed by the
+    // family id. Default family entries keep the original PUT/DELETE codes
+    constexpr uint8_t PUT_CF = 2;
+    constexpr uint8_t DELETE_CF = 3;
+
+    // magic(8) + version(4) + entry_count(4)
+    constexpr size_t HEADER_SIZE = sizeof(uint64_t) + sizeof(uint32_t) + sizeof(uint32_t);
+}
+
+WriteAheadLog::WriteAheadLog(const std::string& filename, std::shared_ptr<Env> env, bool sync,
+                             OperationLatencies* latencies)
+    : filename_(filename), env_(env ? std::move(env) : Env::default_env()), sync_(sync), latencies_(latencies) {
     if (!open_file()) {
         throw std::runtime_error("Failed to open WAL file: " + filename);
     }
 }
 
-WriteAheadLog::~WriteAheadLog() {
-    if (file_.is_open()) {
-        file_.close();
-    }
-}
+WriteAheadLog::~WriteAheadLog() = default;
 
 // Move constructor
 WriteAheadLog::WriteAheadLog(WriteAheadLog&& other) noexcept
-    : filename_(std::move(other.filename_)) {
-    file_ = std::move(other.file_);
+    : filename_(std::move(other.filename_)),
+      env_(std::move(other.env_)),
+      file_(std::move(other.file_)),
+      sync_(other.sync_),
+      latencies_(other.latencies_),
+      entry_count_(other.entry_count_),
+      end_(other.end_) {
 }
 
 // Move assignment
 WriteAheadLog& WriteAheadLog::operator=(WriteAheadLog&& other) noexcept {
     if (this != &other) {
-        if (file_.is_open()) {
-            file_.close();
-        }
         filename_ = std::move(other.filename_);
+        env_ = std::move(other.env_);
         file_ = std::move(other.file_);
+        sync_ = other.sync_;
+        latencies_ = other.latencies_;
+        entry_count_ = other.entry_count_;
+        end_ = other.end_;
     }
     return *this;
 }
@@ -44,176 +60,172 @@ WriteAheadLog& WriteAheadLog::operator=(WriteAheadLog&& other) noexcept {
 bool WriteAheadLog::open_file() {
     // Create directory if it doesn't exist
     fs::path filepath(filename_);
-    if (filepath.has_parent_path()) {
-        try {
-            fs::create_directories(filepath.parent_path());
-        } catch (const fs::filesystem_error&) {
-            return false;
-        }
+    if (filepath.has_parent_path() && !env_->create_dirs(filepath.parent_path().string())) {
+        return false;
     }
 
-    // Try to open existing file for reading and appending
-    file_.open(filename_, std::ios::binary | std::ios::in | std::ios::out | std::ios::ate);
-
-    if (!file_ || !file_.is_open()) {
-        // File doesn't exist or couldn't open in read/write mode
-        // Create a new file
-        file_.open(filename_, std::ios::binary | std::ios::out);
-        if (!file_.is_open()) {
-            return false;
-        }
-
-        // Write initial header
-        if (!write_header(0)) {
-            file_.close();
-            return false;
-        }
-
-        file_.close();
-
-        // Reopen for both reading and writing
-        file_.open(filename_, std::ios::binary | std::ios::in | std::ios::out | std::ios::ate);
-        return file_.is_open();
+    file_ = env_->new_random_rw_file(filename_);
+    if (!file_) {
+        return false;
     }
 
-    // Verify the file is a valid WAL
-    if (!validate_file()) {
-        file_.close();
-
-        // Create a new valid file
-        file_.open(filename_, std::ios::binary | std::ios::out);
-        if (!file_.is_open()) {
+    // A new, truncated or foreign file starts over as an empty WAL
+    if (!validate_file() || !read_header(entry_count_)) {
+        file_.reset();
+        env_->remove_file(filename_);
+        file_ = env_->new_random_rw_file(filename_);
+        if (!file_ || !write_header(0)) {
+            file_.reset();
             return false;
         }
+        entry_count_ = 0;
+        end_ = HEADER_SIZE;
+        return true;
+    }
 
-        if (!write_header(0)) {
-            file_.close();
+    // Bytes past the last counted record are a batch torn by a crash. New records overwrite
+    // them, appending after them would make recovery read the torn records as the new ones
+    end_ = HEADER_SIZE;
+    if (entry_count_ > 0) {
+        std::string data;
+        if (!read_data(data)) {
+            file_.reset();
             return false;
         }
-
-        file_.close();
-        file_.open(filename_, std::ios::binary | std::ios::in | std::ios::out | std::ios::ate);
+        parse_records(data, entry_count_, nullptr, end_);
     }
-
-    return file_.is_open();
+    return true;
 }
 
 bool WriteAheadLog::validate_file() const {
-    if (!file_.is_open()) return false;
-
-    auto original_pos = file_.tellg();
+    if (!file_) return false;
 
-    // Check file size
-    file_.seekg(0, std::ios::end);
-    auto file_size = file_.tellg();
-    file_.seekg(original_pos);
-
-    if (file_size < static_cast<std::streampos>(sizeof(MAGIC) + sizeof(VERSION) + sizeof(uint32_t))) {
+    if (file_->size() < HEADER_SIZE) {
         return false;
     }
 
     // Check magic number
-    file_.seekg(0);
     uint64_t magic = 0;
-    file_.read(reinterpret_cast<char*>(&magic), sizeof(magic));
-    file_.seekg(original_pos);
+    size_t bytes_read = 0;
+    if (!file_->read(0, sizeof(magic), reinterpret_cast<char*>(&magic), bytes_read)) {
+        return false;
+    }
 
-    return magic == MAGIC && file_.good();
+    return bytes_read == sizeof(magic) && magic == MAGIC;
 }
 
 bool WriteAheadLog::write_header(uint32_t entry_count) {
-    if (!file_.is_open()) return false;
+    if (!file_) return false;
 
-    auto original_pos = file_.tellp();
-    file_.seekp(0);
+    char header[HEADER_SIZE];
+    std::memcpy(header, &MAGIC, sizeof(MAGIC));
+    std::memcpy(header + sizeof(MAGIC), &VERSION, sizeof(VERSION));
+    std::memcpy(header + sizeof(MAGIC) + sizeof(VERSION), &entry_count, sizeof(entry_count));
 
-    file_.write(reinterpret_cast<const char*>(&MAGIC), sizeof(MAGIC));
-    file_.write(reinterpret_cast<const char*>(&VERSION), sizeof(VERSION));
-    file_.write(reinterpret_cast<const char*>(&entry_count), sizeof(entry_count));
-
-    file_.flush();
-    file_.seekp(original_pos);
-
-    return file_.good();
+    return file_->write(0, header, sizeof(header));
 }
 
 bool WriteAheadLog::read_header(uint32_t& entry_count) const {
-    if (!file_.is_open()) return false;
+    if (!file_) return false;
 
-    auto original_pos = file_.tellg();
-    file_.seekg(0);
+    char header[HEADER_SIZE];
+    size_t bytes_read = 0;
+    if (!file_->read(0, sizeof(header), header, bytes_read) || bytes_read != sizeof(header)) {
+        return false;
+    }
 
     uint64_t magic = 0;
     uint32_t version = 0;
-
-    file_.read(reinterpret_cast<char*>(&magic), sizeof(magic));
-    file_.read(reinterpret_cast<char*>(&version), sizeof(version));
-    file_.read(reinterpret_cast<char*>(&entry_count), sizeof(entry_count));
-
-    file_.seekg(original_pos);
-
-    if (!file_.good()) {
-        return false;
-    }
+    std::memcpy(&magic, header, sizeof(magic));
+    std::memcpy(&version, header + sizeof(magic), sizeof(version));
+    std::memcpy(&entry_count, header + sizeof(magic) + sizeof(version), sizeof(entry_count));
 
     return magic == MAGIC && version == VERSION;
 }
 
-bool WriteAheadLog::seek_to_entry_start() const {
-    if (!file_.is_open()) return false;
-
-    file_.seekg(sizeof(MAGIC) + sizeof(VERSION) + sizeof(uint32_t));
-    return file_.good();
-}
-
-bool WriteAheadLog::write_entry(OpType type, const std::string& key, const std::string& value) {
-    if (!file_.is_open()) return false;
-
-    // Move to end of file
-    file_.seekp(0, std::ios::end);
-    auto entry_start_pos = file_.tellp();
-
-    // Write operation type
-    const uint8_t op_type = static_cast<uint8_t>(type);
-    file_.write(reinterpret_cast<const char*>(&op_type), sizeof(op_type));
+void WriteAheadLog::write_record(std::string& out, OpType type, const std::string& key, const std::string& value,
+                                 uint32_t column_family) {
+    const size_t start = out.size();
+
+    // Write operation type, and the family for non-default families
+    if (column_family == 0) {
+        const uint8_t op_type = static_cast<uint8_t>(type);
+        out.append(reinterpret_cast<const char*>(&op_type), sizeof(op_type));
+    } else {
+        const uint8_t op_type = type == OpType::PUT ? PUT_CF : DELETE_CF;
+        out.append(reinterpret_cast<const char*>(&op_type), sizeof(op_type));
+        out.append(reinterpret_cast<const char*>(&column_family), sizeof(column_family));
+    }
 
     // Write key length and key
     uint32_t key_len = static_cast<uint32_t>(key.size());
-    file_.write(reinterpret_cast<const char*>(&key_len), sizeof(key_len));
-    if (key_len > 0) {
-        file_.write(key.data(), key_len);
-    }
+    out.append(reinterpret_cast<const char*>(&key_len), sizeof(key_len));
+    out += key;
 
     // For PUT operations, write value
     if (type == OpType::PUT) {
         uint32_t value_len = static_cast<uint32_t>(value.size());
-        file_.write(reinterpret_cast<const char*>(&value_len), sizeof(value_len));
-        if (value_len > 0) {
-            file_.write(value.data(), value_len);
-        }
+        out.append(reinterpret_cast<const char*>(&value_len), sizeof(value_len));
+        out += value;
     }
     // For DELETE, no value is written
 
-    // Update header with new entry count
-    uint32_t current_count = 0;
-    if (!read_header(current_count)) {
-        // Rollback: truncate to where we started
-        file_.seekp(entry_start_pos);
-        // On Unix: we could use truncate() but for cross-platform, we'll leave it
-        // The next open will validate and potentially fix the file
+    perf_count(&PerfContext::wal_bytes, out.size() - start);
+}
+
+bool WriteAheadLog::commit_records(uint32_t record_count, const std::string& records) {
+    // Records first, so a crash before the header update leaves them uncounted
+    if (!file_->write(end_, records.data(), records.size())) {
         return false;
     }
 
-    current_count++;
-    if (!write_header(current_count)) {
-        // Couldn't update header, leave file as is
+    // Synced before the header counts them, or the disk could reorder the two writes and
+    // leave a header counting records that never arrived
+    if (sync_ && !sync_file()) {
         return false;
     }
 
-    // Ensure data is written to disk
-    file_.flush();
+    // Update header with new entry count
+    if (!write_header(entry_count_ + record_count)) {
+        // Couldn't update header, the records stay invisible to recovery and the next
+        // commit overwrites them
+        return false;
+    }
+    entry_count_ += record_count;
+    end_ += records.size();
 
-    return file_.good();
+    return !sync_ || sync_file();
+}
+
+bool WriteAheadLog::sync_file() {
+    PerfTimer timer(&PerfContext::wal_sync_ns);
+    if (!latencies_) {
+        return file_->sync();
+    }
+    OperationLatencies::Timer latency_timer(*latencies_, OperationLatencies::WAL_SYNC);
+    return file_->sync();
+}
+
+bool WriteAheadLog::write_entry(OpType type, const std::string& key, const std::string& value) {
+    if (!file_) return false;
+
+    std::string record;
+    write_record(record, type, key, value);
+    return commit_records(1, record);
+}
+
+bool WriteAheadLog::log_batch(const std::vector<LogEntry>& entries) {
+    if (!file_) return false;
+    if (entries.empty()) return true;
+
+    std::string records;
+    for (const auto& entry : entries) {
+        write_record(records, entry.type, entry.key, entry.value, entry.column_family);
+    }
+
+    // Recovery only reads as many entries as the header counts, so bumping it once
+    // for the whole batch makes the batch all or nothing
+    return commit_records(static_cast<uint32_t>(entries.size()), records);
 }
 
 bool WriteAheadLog::log_put(const std::string& key, const std::string& value) {
@@ -235,10 +247,71 @@ std::vector<WriteAheadLog::LogEntry> WriteAheadLog::read_all_entries() const {
     return temp;
 }
 
+bool WriteAheadLog::read_data(std::string& data) const {
+    data.assign(file_->size(), '\0');
+    size_t bytes_read = 0;
+    if (!file_->read(0, data.size(), data.data(), bytes_read)) {
+        return false;
+    }
+    data.resize(bytes_read);
+    return true;
+}
+
+uint32_t WriteAheadLog::parse_records(const std::string& data, uint32_t count, std::vector<LogEntry>* entries,
+                                      uint64_t& end) {
+    size_t pos = HEADER_SIZE;
+    auto read = [&](void* out, size_t n) {
+        if (data.size() - pos < n) return false;
+        std::memcpy(out, data.data() + pos, n);
+        pos += n;
+        return true;
+    };
+    auto read_string = [&](std::string& out, uint32_t n) {
+        if (data.size() - pos < n) return false;
+        out.assign(data, pos, n);
+        pos += n;
+        return true;
+    };
+
+    end = HEADER_SIZE;
+    uint32_t parsed = 0;
+    for (; parsed < count; ++parsed) {
+        // Read operation type
+        uint8_t op_type = 0;
+        if (!read(&op_type, sizeof(op_type))) break;
+
+        // Non-default families carry their id after the op code
+        uint32_t column_family = 0;
+        OpType type = static_cast<OpType>(op_type);
+        if (op_type == PUT_CF || op_type == DELETE_CF) {
+            if (!read(&column_family, sizeof(column_family))) break;
+            type = op_type == PUT_CF ? OpType::PUT : OpType::DELETE;
+        }
+
+        // Read key length and key
+        uint32_t key_len = 0;
+        std::string key;
+        if (!read(&key_len, sizeof(key_len)) || !read_string(key, key_len)) break;
+
+        std::string value;
+        if (type == OpType::PUT) {
+            // Read value length and value
+            uint32_t value_len = 0;
+            if (!read(&value_len, sizeof(value_len)) || !read_string(value, value_len)) break;
+        }
+
+        end = pos;
+        if (entries) {
+            entries->emplace_back(type, std::move(key), std::move(value), column_family);
+        }
+    }
+    return parsed;
+}
+
 bool WriteAheadLog::recover(std::vector<LogEntry>& entries) const {
     entries.clear();
 
-    if (!file_.is_open()) {
+    if (!file_) {
         return false;
     }
 
@@ -252,47 +325,15 @@ bool WriteAheadLog::recover(std::vector<LogEntry>& entries) const {
         return true;  // Empty WAL is valid
     }
 
-    // Seek to first entry
-    if (!seek_to_entry_start()) {
+    // The whole log is read at once and parsed from memory
+    std::string data;
+    if (!read_data(data)) {
         return false;
     }
 
     entries.reserve(entry_count);
-
-    for (uint32_t i = 0; i < entry_count; ++i) {
-        // Read operation type
-        uint8_t op_type = 0;
-        file_.read(reinterpret_cast<char*>(&op_type), sizeof(op_type));
-        if (!file_.good()) break;
-
-        // Read key length and key
-        uint32_t key_len = 0;
-        file_.read(reinterpret_cast<char*>(&key_len), sizeof(key_len));
-        if (!file_.good()) break;
-
-        std::string key;
-        if (key_len > 0) {
-            key.resize(key_len);
-            file_.read(key.data(), key_len);
-            if (!file_.good()) break;
-        }
-
-        std::string value;
-        if (static_cast<OpType>(op_type) == OpType::PUT) {
-            // Read value length and value
-            uint32_t value_len = 0;
-            file_.read(reinterpret_cast<char*>(&value_len), sizeof(value_len));
-            if (!file_.good()) break;
-
-            if (value_len > 0) {
-                value.resize(value_len);
-                file_.read(value.data(), value_len);
-                if (!file_.good()) break;
-            }
-        }
-
-        entries.emplace_back(static_cast<OpType>(op_type), std::move(key), std::move(value));
-    }
+    uint64_t end = 0;
+    parse_records(data, entry_count, &entries, end);
 
     // If we didn't read all entries, something went wrong
     if (entries.size() != entry_count) {
@@ -304,36 +345,23 @@ bool WriteAheadLog::recover(std::vector<LogEntry>& entries) const {
 }
 
 void WriteAheadLog::clear() {
-    if (file_.is_open()) {
-        file_.close();
-    }
-
     // Remove the file entirely
-    try {
-        fs::remove(filename_);
-    } catch (const fs::filesystem_error&) {
-        // Ignore if file doesn't exist
-    }
+    file_.reset();
+    env_->remove_file(filename_);
 
     // Create new empty file
     open_file();  // This will create a new file with header
 }
 
 size_t WriteAheadLog::size() const {
-    if (!file_.is_open()) return 0;
-
-    auto current_pos = file_.tellg();
-    file_.seekg(0, std::ios::end);
-    auto file_size = file_.tellg();
-    file_.seekg(current_pos);
-
-    return static_cast<size_t>(file_size);
+    if (!file_) return 0;
+    return static_cast<size_t>(end_);
 }
 
 bool WriteAheadLog::is_open() const {
-    return file_.is_open();
+    return file_ != nullptr;
 }
 
 const std::string& WriteAheadLog::get_filename() const {
     return filename_;
-}
\ No newline at end of file
+}
@@ -7,8 +7,10 @@
 
 #include <string>
 #include <vector>
-#include <fstream>
+#include <memory>
 #include <cstdint>
+#include "Env.h"
+#include "Histogram.h"
 
 class WriteAheadLog {
 public:
@@ -21,15 +23,19 @@ public:
         OpType type;
         std::string key;
         std::string value;
+        uint32_t column_family;  // 0 is the default family
 
-        LogEntry(OpType t, std::string k, std::string v)
-            : type(t), key(std::move(k)), value(std::move(v)) {}
+        LogEntry(OpType t, std::string k, std::string v, uint32_t cf = 0)
+            : type(t), key(std::move(k)), value(std::move(v)), column_family(cf) {}
     };
 
     static constexpr uint64_t MAGIC = 0x57414C5F53454D44ULL; // "WAL_SEMD"
     static constexpr uint32_t VERSION = 1;
 
-    explicit WriteAheadLog(const std::string& filename);
+    // env nullptr means Env::default_env(), sync false leaves flushing commits to the OS,
+    // latencies (may be nullptr) gets a WAL_SYNC sample for every sync
+    explicit WriteAheadLog(const std::string& filename, std::shared_ptr<Env> env = nullptr, bool sync = true,
+                           OperationLatencies* latencies = nullptr);
     ~WriteAheadLog();
 
     // Disable copying
@@ -43,6 +49,7 @@ public:
     // Core operations
     bool log_put(const std::string& key, const std::string& value);
     bool log_delete(const std::string& key);
+    bool log_batch(const std::vector<LogEntry>& entries);  // all entries recover, or none
 
     // File operations
     std::vector<LogEntry> read_all_entries() const;
@@ -56,15 +63,29 @@ public:
 
 private:
     std::string filename_;
-    mutable std::fstream file_;  // mutable for const operations
+    std::shared_ptr<Env> env_;
+    std::unique_ptr<RandomRWFile> file_;
+    bool sync_ = true;          // sync every commit before reporting it done
+    OperationLatencies* latencies_ = nullptr;
+    uint32_t entry_count_ = 0;  // as in the header
+    uint64_t end_ = 0;          // end of the last counted record, where the next one goes
 
     bool open_file();
     bool write_header(uint32_t entry_count);
     bool read_header(uint32_t& entry_count) const;
     bool write_entry(OpType type, const std::string& key, const std::string& value);
+    static void write_record(std::string& out, OpType type, const std::string& key, const std::string& value,
+                             uint32_t column_family = 0);
+    bool commit_records(uint32_t record_count, const std::string& records);
+    bool sync_file();  // timed as wal_sync_ns and WAL_SYNC
+    bool read_data(std::string& data) const;  // the whole file
+
+    // Parse up to count records after the header into entries (may be nullptr), returns how many
+    // were whole and sets end to the offset just past the last of them
+    static uint32_t parse_records(const std::string& data, uint32_t count, std::vector<LogEntry>* entries,
+                                  uint64_t& end);
 
     // Internal helpers
-    bool seek_to_entry_start() const;
     bool validate_file() const;
 };
 
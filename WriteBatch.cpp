@@ -0,0 +1,24 @@
+#include "WriteBatch.h"
+
+void WriteBatch::put(const std::string& key, const std::string& value) {
+    put(0, key, value);
+}
+
+void WriteBatch::remove(const std::string& key) {
+    remove(0, key);
+}
+
+void WriteBatch::put(uint32_t column_family, const std::string& key, const std::string& value) {
+    ops_.emplace_back(WriteAheadLog::OpType::PUT, key, value, column_family);
+    data_size_ += key.size() + value.size();
+}
+
+void WriteBatch::remove(uint32_t column_family, const std::string& key) {
+    ops_.emplace_back(WriteAheadLog::OpType::DELETE, key, "", column_family);
+    data_size_ += key.size();
+}
+
+void WriteBatch::clear() {
+    ops_.clear();
+    data_size_ = 0;
+}
@@ -0,0 +1,58 @@
+#ifndef KVDB_WRITEBATCH_H
+#define KVDB_WRITEBATCH_H
+
+#include "WriteAheadLog.h"
+#include <string>
+#include <vector>
+#include <cstdint>
+
+/**
+ * Ordered list of puts and deletes applied to an LSMTree as one unit.
+ *
+ * The batch is logged to the WAL in one step and applied under the memtable lock,
+ * so readers and recovery see either all of it or none of it.
+ */
+class WriteBatch {
+public:
+    using Op = WriteAheadLog::LogEntry;
+
+    /**
+     * Queue a put
+     */
+    void put(const std::string& key, const std::string& value);
+
+    /**
+     * Queue a delete
+     */
+    void remove(const std::string& key);
+
+    /**
+     * Queue a put or delete for a column family, see ColumnFamilyDB
+     */
+    void put(uint32_t column_family, const std::string& key, const std::string& value);
+    void remove(uint32_t column_family, const std::string& key);
+
+    /**
+     * Drop every queued operation
+     */
+    void clear();
+
+    /**
+     * Queued operations, in the order they will be applied
+     */
+    const std::vector<Op>& ops() const { return ops_; }
+
+    size_t count() const { return ops_.size(); }
+    bool empty() const { return ops_.empty(); }
+
+    /**
+     * Bytes of keys and values queued
+     */
+    size_t data_size() const { return data_size_; }
+
+private:
+    std::vector<Op> ops_;
+    size_t data_size_ = 0;
+};
+
+#endif // KVDB_WRITEBATCH_H